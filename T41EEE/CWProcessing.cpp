@@ -53,12 +53,7 @@ FLASHMEM void SelectCWOffset() {
   // Now generate the values for the buffer which is used to create the CW tone.  The values are discrete because there must be whole cycles.
   if (EEPROMData.CWOffset < 4) sineTone(numCycles[EEPROMData.CWOffset]);
   // sinBuffer is used by the CW decoder.  Load the buffer per chosen frequency.
-  float32_t theta = 0.0;  //AFP 10-25-22
-  float freq[4] = { 562.5, 656.5, 750.0, 843.75 };
-  for (int kf = 0; kf < 255; kf++) {                                   //Calc sine wave
-    theta = (float)kf * TWO_PI * freq[EEPROMData.CWOffset] / 24000.0;  // theta = kf * 2 * PI * freqSideTone / 24000
-    sinBuffer[kf] = sin(theta);
-  }
+  CWDetectPrep();
   // Clear the current CW filter graphics and then restore the bandwidth indicator bar.  KF5N July 30, 2023
   tft.writeTo(L2);
   tft.clearMemory();
@@ -69,6 +64,92 @@ FLASHMEM void SelectCWOffset() {
 }
 
 
+static float32_t cwCorrBuffer[2 * CW_DETECT_FFT];     // L + jR, then the L and R correlations
+DMAMEM static float32_t cwSineSpectrum[2 * CW_DETECT_FFT];  // Conjugate spectrum of sinBuffer, zero padded
+static uint32_t cwGoertzelBin;                                // Goertzel bin of the CW offset, in CW_DETECT_FFT bins
+
+/*****
+  Purpose: Load sinBuffer with the CW offset tone and work out the CWDetect() template spectrum and Goertzel bin.
+           Call when EEPROMData.CWOffset changes.
+
+  Parameter list:
+    void
+
+  Return value:
+    void
+*****/
+void CWDetectPrep() {
+  float freq[4] = { 562.5, 656.5, 750.0, 843.75 };  // User selectable CW offset frequencies.
+  float32_t theta;
+
+  for (int kf = 0; kf < 255; kf++) {  //Calc sine wave
+    theta = (float)kf * TWO_PI * freq[EEPROMData.CWOffset] / decimatedRate;  // theta = kf * 2 * PI * freqSideTone / 24000
+    sinBuffer[kf] = sin(theta);
+  }
+  for (int i = 0; i < CW_DETECT_FFT; i++) {
+    cwSineSpectrum[2 * i] = (i < 256) ? sinBuffer[i] : 0.0;
+    cwSineSpectrum[2 * i + 1] = 0.0;
+  }
+  arm_cfft_f32(&arm_cfft_sR_f32_len512, cwSineSpectrum, 0, 1);
+  for (int i = 0; i < CW_DETECT_FFT; i++) {
+    cwSineSpectrum[2 * i + 1] = -cwSineSpectrum[2 * i + 1];
+  }
+  // Same rounding as goertzel_mag(), which took the frequency and rate as int.  Bin k of 256 is bin 2k of 512.
+  cwGoertzelBin = 2 * (int)(0.5 + (256.0 * (int)freq[EEPROMData.CWOffset]) / (int)decimatedRate);
+}
+
+/*****
+  Purpose: CW tone detector.  Gives the same result as the original time domain detector, with two 512 point FFTs
+           in place of its two 256 x 256 point correlations and two Goertzel filters.
+
+           L and R go in as one complex signal, L + jR.  Multiplying its spectrum by the conjugate template spectrum
+           and transforming back gives the cross correlation with sinBuffer at every lag, L in the real parts and
+           R in the imaginary parts.  The zero padding to 512 points keeps the circular lags from wrapping.  The
+           Goertzel magnitudes are the L and R spectra at the CW offset bin, split out of the complex spectrum
+           before the multiply.
+
+  Parameter list:
+    void
+
+  Return value:
+    float32_t      the combined correlation and Goertzel coefficient, the lock threshold is 50
+*****/
+float32_t CWDetect() {
+  float32_t zRe, zIm, mRe, mIm;
+  float32_t goertzelMagnitude1;
+  float32_t goertzelMagnitude2;
+
+  for (int i = 0; i < 256; i++) {
+    cwCorrBuffer[2 * i] = float_buffer_L_CW[i];
+    cwCorrBuffer[2 * i + 1] = float_buffer_R_CW[i];
+  }
+  arm_fill_f32(0.0, &cwCorrBuffer[512], 2 * CW_DETECT_FFT - 512);
+  arm_cfft_f32(&arm_cfft_sR_f32_len512, cwCorrBuffer, 0, 1);
+
+  // Z[k] = L[k] + jR[k] and Z[N - k] = conj(L[k]) + j conj(R[k]) for real L and R.  Goertzel scaling is 2 / 256.
+  zRe = cwCorrBuffer[2 * cwGoertzelBin];
+  zIm = cwCorrBuffer[2 * cwGoertzelBin + 1];
+  mRe = cwCorrBuffer[2 * (CW_DETECT_FFT - cwGoertzelBin)];
+  mIm = cwCorrBuffer[2 * (CW_DETECT_FFT - cwGoertzelBin) + 1];
+  goertzelMagnitude1 = sqrtf((zRe + mRe) * (zRe + mRe) + (zIm - mIm) * (zIm - mIm)) / 256.0;
+  goertzelMagnitude2 = sqrtf((zIm + mIm) * (zIm + mIm) + (zRe - mRe) * (zRe - mRe)) / 256.0;
+  goertzelMagnitude = (goertzelMagnitude1 + goertzelMagnitude2) / 2;
+
+  arm_cmplx_mult_cmplx_f32(cwCorrBuffer, cwSineSpectrum, cwCorrBuffer, CW_DETECT_FFT);
+  arm_cfft_f32(&arm_cfft_sR_f32_len512, cwCorrBuffer, 1, 1);  // Inverse, scaled by 1 / 512
+  corrResultL = cwCorrBuffer[0];
+  corrResultR = cwCorrBuffer[1];
+  for (int i = 1; i < CW_DETECT_FFT; i++) {
+    if (i == 256) continue;  // The one lag the 256 point signals never reach
+    if (cwCorrBuffer[2 * i] > corrResultL) corrResultL = cwCorrBuffer[2 * i];
+    if (cwCorrBuffer[2 * i + 1] > corrResultR) corrResultR = cwCorrBuffer[2 * i + 1];
+  }
+  aveCorrResultR = .7 * corrResultR + .3 * aveCorrResultR;
+  aveCorrResultL = .7 * corrResultL + .3 * aveCorrResultL;
+  aveCorrResult = (corrResultR + corrResultL) / 2;
+  return 10 * aveCorrResult * 100 * goertzelMagnitude;
+}
+
 //=================  AFP10-18-22 ================
 /*****
   Purpose: to process CW specific signals
@@ -81,10 +162,10 @@ FLASHMEM void SelectCWOffset() {
 
 *****/
 void DoCWReceiveProcessing() {  // All New AFP 09-19-22
-  float goertzelMagnitude1;
-  float goertzelMagnitude2;
   int audioTemp;                                    // KF5N
-  float freq[4] = { 562.5, 656.5, 750.0, 843.75 };  // User selectable CW offset frequencies.
+  char c;
+
+  cwSampleClock += 256;  // This block's samples, the decoder's time base
   //arm_copy_f32(float_buffer_R, float_buffer_R_CW, 256);
   //arm_biquad_cascade_df2T_f32(&S1_CW_Filter, float_buffer_R, float_buffer_R_CW, 256);//AFP 09-01-22
   //arm_biquad_cascade_df2T_f32(&S1_CW_Filter, float_buffer_L, float_buffer_L_CW, 256);//AFP 09-01-22
@@ -94,25 +175,7 @@ void DoCWReceiveProcessing() {  // All New AFP 09-19-22
 
   if (EEPROMData.decoderFlag == DECODE_ON) {  // JJP 7/20/23
 
-    // ----------------------  Correlation calculation  AFP 02-04-22 -------------------------
-    //Calculate correlation between calc sine and incoming signal
-
-    arm_correlate_f32(float_buffer_R_CW, 256, sinBuffer, 256, float_Corr_BufferR);
-    arm_max_f32(float_Corr_BufferR, 511, &corrResultR, &corrResultIndexR);
-    // Running average of corr coeff. R
-    aveCorrResultR = .7 * corrResultR + .3 * aveCorrResultR;
-    arm_correlate_f32(float_buffer_L_CW, 256, sinBuffer, 256, float_Corr_BufferL);
-    // Get max value of correlation
-    arm_max_f32(float_Corr_BufferL, 511, &corrResultL, &corrResultIndexL);
-    // Running average of corr coeff. L
-    aveCorrResultL = .7 * corrResultL + .3 * aveCorrResultL;
-    aveCorrResult = (corrResultR + corrResultL) / 2;
-    // Calculate Goertzel Mahnitude of incomming signal
-    goertzelMagnitude1 = goertzel_mag(256, freq[EEPROMData.CWOffset], 24000, float_buffer_L_CW);  //AFP 10-25-22
-    goertzelMagnitude2 = goertzel_mag(256, freq[EEPROMData.CWOffset], 24000, float_buffer_R_CW);  //AFP 10-25-22
-    goertzelMagnitude = (goertzelMagnitude1 + goertzelMagnitude2) / 2;
-    //Combine Correlation and Gowetzel Coefficients
-    combinedCoeff = 10 * aveCorrResult * 100 * goertzelMagnitude;
+    combinedCoeff = CWDetect();
     combinedCoeff2 = combinedCoeff;
     // ==========  Changed CW decode "lock" indicator
     if (combinedCoeff > 50) {  // AFP 10-26-22
@@ -133,7 +196,21 @@ void DoCWReceiveProcessing() {  // All New AFP 09-19-22
       audioTemp = 0;
     }
     //==============  acquire data on CW  ================
-    DoCWDecoding(audioTemp);
+    c = DoCWDecoding(&cwDecoder, audioTemp, CWDecoderTime());
+    if (c) {
+      MorseCharacterDisplay(c);
+    }
+    if (c == ' ') {
+      tft.setFontScale((enum RA8875tsize)0);  // Show estimated WPM
+      tft.setTextColor(RA8875_GREEN);
+      tft.fillRect(DECODER_X + 104, DECODER_Y, tft.getFontWidth() * 10, tft.getFontHeight(), RA8875_BLACK);
+      tft.setCursor(DECODER_X + 105, DECODER_Y);
+      tft.print("(");
+      tft.print(CWDecoderWPM(&cwDecoder));
+      tft.print(" WPM)");
+      tft.setTextColor(RA8875_WHITE);
+      tft.setFontScale((enum RA8875tsize)3);
+    }
   }
 }
 
@@ -216,7 +293,7 @@ void SetTransmitDitLength(int wpm) {
     void
 *****/
 void SetKeyType() {
-  const char *keyChoice[] = { "Straight Key", "Keyer", "Iambic A". "Cancel" };
+  const char *keyChoice[] = { "Straight Key", "Keyer", "Iambic A", "Cancel" };
 
   EEPROMData.keyType = SubmenuSelect(keyChoice, 3, 0);
   // Make sure the EEPROMData.paddleDit and EEPROMData.paddleDah variables are set correctly for straight key.
@@ -378,6 +455,44 @@ void MorseCharacterDisplay(char currentLetter) {
 }
 
 
+/*****
+  Purpose: Put a Morse decoder in its starting state, 15 WPM, with empty histograms.  The main decoder is in
+           DMAMEM, which is not cleared at startup, so this has to run before the first DoCWDecoding().
+
+  Parameter list:
+    struct cwDecoder_t *dec     the decoder
+    uint32_t time               decoder time now, ms
+
+  Return value
+    void
+*****/
+void CWDecoderReset(struct cwDecoder_t *dec, uint32_t time) {
+  dec->decodeState = state0;
+  dec->signalStart = dec->signalEnd = dec->signalStartOld = time;
+  dec->gapLength = 0;
+  dec->signalElapsedTime = 0;
+  dec->gapAtom = 80;
+  dec->ditLength = 80;  // Start with 15wpm ditLength
+  dec->gapChar = 240;
+  dec->dahLength = 240;
+  dec->thresholdGeometricMean = 160;  // Use simple mean for starters so we don't have 0
+  dec->thresholdArithmeticMean = 160;
+  dec->aveDitLength = dec->ditLength;
+  dec->aveDahLength = dec->dahLength;
+  dec->valRef1 = 0;
+  dec->valRef2 = 0;
+  dec->gapRef1 = 0;
+  dec->valFlag = 0;
+  dec->decoderIndex = 0;
+  dec->dashJump = DECODER_BUFFER_SIZE;
+  dec->charProcessFlag = false;
+  dec->blankFlag = false;
+  // Clear graph arrays
+  CWHistogramClear(&dec->signalHistogram);
+  CWHistogramClear(&dec->gapHistogram);
+}
+
+
 /*****
   Purpose: This function uses the current WPM to set an estimate ditLength any time the tune
            endcoder is changed
@@ -389,26 +504,50 @@ void MorseCharacterDisplay(char currentLetter) {
     void
 *****/
 void ResetHistograms() {
-  gapAtom = 80;
-  ditLength = 80;  // Start with 15wpm ditLength
-  gapChar = 240;
-  dahLength = 240;
-  thresholdGeometricMean = 160;  // Use simple mean for starters so we don't have 0
-  aveDitLength = ditLength;
-  aveDahLength = dahLength;
-  valRef1 = 0;
-  valRef2 = 0;
-  // Clear graph arrays
-  memset(signalHistogram, 0, HISTOGRAM_ELEMENTS * sizeof(uint32_t));
-  memset(gapHistogram, 0, HISTOGRAM_ELEMENTS * sizeof(uint32_t));
-  EEPROMData.currentWPM = 1200 / ditLength;
+  CWDecoderReset(&cwDecoder, CWDecoderTime());
+  EEPROMData.currentWPM = 1200 / cwDecoder.ditLength;
+  SetDitLength(EEPROMData.currentWPM);
   UpdateWPMField();
 }
 
 
+/*****
+  Purpose: Estimated speed of a Morse decoder, from its dah length.
+
+  Parameter list:
+    struct cwDecoder_t *dec     the decoder
+
+  Return value
+    int             words per minute
+*****/
+int CWDecoderWPM(struct cwDecoder_t *dec) {
+  return 1200L / max(dec->dahLength / 3, (int32_t)1);
+}
+
+
+uint64_t cwSampleClock = 0;  // Decimated samples through DoCWReceiveProcessing()
+
+/*****
+  Purpose: Decoder time stamp, from the count of decimated samples rather than millis().  A key transition is
+           timed by the block it is detected in, whatever the display and SPI work delayed that block by, so the
+           same audio always decodes the same way.
+
+  Parameter list:
+    void
+
+  Return value;
+    uint32_t        milliseconds of received audio, to the end of the current block
+*****/
+uint32_t CWDecoderTime() {
+  return (uint32_t)(cwSampleClock * 1000 / (uint32_t)decimatedRate);
+}
+
+char *bigMorseCodeTree = (char *)"-EISH5--4--V---3--UF--------?-2--ARL---------.--.WP------J---1--TNDB6--.--X/-----KC------Y------MGZ7----,Q------O-8------9--0----";
+
 // This function was re-factored into a state machine by KF5N October 29, 2023.
 /*****
-  Purpose: Called when in CW mode and decoder flag is set. Function assumes:
+  Purpose: Called when in CW mode and decoder flag is set, and by the skimmer for each of its channels.
+           Function assumes:
 
       dit           = 1
       dah           = dit * 3
@@ -419,111 +558,276 @@ void ResetHistograms() {
       You can distinguish between dah and inter-letter by presence/absence of signal. Same for inter-atom.
 
   Parameter list:
-    float audioValue        the strength of audio signal
+    struct cwDecoder_t *dec     the decoder, with its timing and histograms
+    int audioValue              1 if the key is down
+    uint32_t time               decoder time, ms
 
   Return value;
-    void
+    char            the decoded character, a blank at the end of a word, or 0 for none yet
 *****/
-// charProcessFlag means a character is being decoded.  blankFlag indicates a blank has already been printed.
-bool charProcessFlag, blankFlag;
-int currentTime, interElementGap, noSignalTimeStamp;
-char *bigMorseCodeTree = (char *)"-EISH5--4--V---3--UF--------?-2--ARL---------.--.WP------J---1--TNDB6--.--X/-----KC------Y------MGZ7----,Q------O-8------9--0----";
-FASTRUN void DoCWDecoding(int audioValue) {
+FASTRUN char DoCWDecoding(struct cwDecoder_t *dec, int audioValue, uint32_t time) {
+  char decoded = 0;
+  int interElementGap;
 
   for (int i = 0; i < 2; i = i + 1) {
-    switch (decodeStates) {
+    switch (dec->decodeState) {
       // State 0.  Detects start of signal and starts timer.
       case state0:
         // Detect signal and redirect to appropriate state.
         if (audioValue == 1) {
-          signalStart = millis();                                                                    // Time stamp beginning of signal.
-          gapLength = signalStart - signalEnd;                                                       // Calculate the time gap between the start of this new signal and the end of the last one.
-                                                                                                     //        Serial.printf("gapLength state0 = %d\n", gapLength);
-          if (gapLength > LOWEST_ATOM_TIME && gapLength < (uint32_t)(thresholdGeometricMean * 3)) {  // range  LOWEST_ATOM_TIME = 20
-            DoGapHistogram(gapLength);                                                               // Map the gap in the signal
+          dec->signalStart = time;                            // Time stamp beginning of signal.
+          dec->gapLength = dec->signalStart - dec->signalEnd;  // Calculate the time gap between the start of this new signal and the end of the last one.
+          if (dec->gapLength > LOWEST_ATOM_TIME && dec->gapLength < (uint32_t)(dec->thresholdGeometricMean * 3)) {  // range  LOWEST_ATOM_TIME = 20
+            DoGapHistogram(dec, dec->gapLength);                                                                    // Map the gap in the signal
           }
-          //        Serial.printf("gapLength = %d gapChar = %d gapAtom = %d\n", gapLength, gapChar, gapAtom);
-          decodeStates = state1;  // Go to "signalStart" state.
-          break;                  // Go to state1;
+          dec->decodeState = state1;  // Go to "signalStart" state.
+          break;                      // Go to state1;
         }
         // audioValue = 0, no signal:
-        noSignalTimeStamp = millis();
-        interElementGap = noSignalTimeStamp - signalEnd;
-        //      if ((interElementGap > ditLength * 1.5) && charProcessFlag) {  // use thresholdGeometricMean??? was ditLength. End of character!  65 * 2
-        if ((interElementGap > (gapAtom * 2)) && charProcessFlag) {  // use thresholdGeometricMean??? was ditLength. End of character!  65 * 2
-          decodeStates = state3;                                     // Character ended, print it!
+        interElementGap = time - dec->signalEnd;
+        if ((interElementGap > (dec->gapAtom * 2)) && dec->charProcessFlag) {  // use thresholdGeometricMean??? was ditLength. End of character!  65 * 2
+          dec->decodeState = state3;                                           // Character ended, print it!
           break;
         }
-        if (interElementGap > (gapAtom * 5) && not blankFlag && not charProcessFlag) {  // A big gap, print a blank, but don't repeat a blank.  85 * 3.5
-          decodeStates = state4;
+        if (interElementGap > (dec->gapAtom * 5) && not dec->blankFlag && not dec->charProcessFlag) {  // A big gap, print a blank, but don't repeat a blank.  85 * 3.5
+          dec->decodeState = state4;
           break;
         }
-        decodeStates = state0;  // Stay in state0; no signal.
-        break;                  // End state0
-      case state1:              // This state times a signal and measures its duration.  The next state determines if the signal is a dit or a dah.
+        dec->decodeState = state0;  // Stay in state0; no signal.
+        break;                      // End state0
+      case state1:                  // This state times a signal and measures its duration.  The next state determines if the signal is a dit or a dah.
         if (audioValue == 0) {
-          currentTime = millis();
-          signalElapsedTime = currentTime - signalStart;  // Calculate the duration of the signal.
+          dec->signalElapsedTime = time - dec->signalStart;  // Calculate the duration of the signal.
           // Ignore short noisy signal bursts:
-          if (signalElapsedTime < LOWEST_ATOM_TIME) {  // A hiccup or a real signal?  Make this a fraction of ditLength instead???
-            decodeStates = state0;                     // False signal, start over.
+          if (dec->signalElapsedTime < LOWEST_ATOM_TIME) {  // A hiccup or a real signal?  Make this a fraction of ditLength instead???
+            dec->decodeState = state0;                      // False signal, start over.
             break;
           }
-          //        Serial.printf("SET = %d TGM = %f dit = %d dah = %d gapChar = %d gapAtom =%d\n", signalElapsedTime, thresholdGeometricMean, ditLength, dahLength, gapChar, gapAtom);
-          if (signalElapsedTime > LOWEST_ATOM_TIME && signalElapsedTime < HISTOGRAM_ELEMENTS) {  // Valid elapsed time?
-            DoSignalHistogram(signalElapsedTime);                                                //Yep
+          if (dec->signalElapsedTime > LOWEST_ATOM_TIME && dec->signalElapsedTime < HISTOGRAM_ELEMENTS) {  // Valid elapsed time?
+            DoSignalHistogram(dec, dec->signalElapsedTime, time);                                          //Yep
           }
-          signalEnd = currentTime;  // Time gap to next signal.
-          decodeStates = state2;    // Proceed to state2.  A timed signal is available and must be processed.
+          dec->signalEnd = time;       // Time gap to next signal.
+          dec->decodeState = state2;  // Proceed to state2.  A timed signal is available and must be processed.
           break;
         }
-        decodeStates = state1;  // Signal still present, stay in state1.
-        break;                  // End state1
-
-      case state2:                                                                             // Determine if a timed signal was a dit or a dah and increment the decode tree.
-        if (signalElapsedTime > (0.5 * ditLength) && signalElapsedTime < (1.5 * dahLength)) {  // All this does is provide a wide boundary for dit and dah lengths.
-          currentDashJump = currentDashJump >> 1;                                              // Fast divide by 2
-          if (signalElapsedTime < (int)thresholdGeometricMean) {                               // It was a dit
-            charProcessFlag = true;
-            currentDecoderIndex++;
+        dec->decodeState = state1;  // Signal still present, stay in state1.
+        break;                      // End state1
+
+      case state2:                                                                                                // Determine if a timed signal was a dit or a dah and increment the decode tree.
+        if (dec->signalElapsedTime > (0.5 * dec->ditLength) && dec->signalElapsedTime < (1.5 * dec->dahLength)) {  // All this does is provide a wide boundary for dit and dah lengths.
+          dec->dashJump = dec->dashJump >> 1;                                                                     // Fast divide by 2
+          if (dec->signalElapsedTime < (int)dec->thresholdGeometricMean) {                                        // It was a dit
+            dec->charProcessFlag = true;
+            dec->decoderIndex++;
           } else {  // It's a dah!
-            charProcessFlag = true;
-            currentDecoderIndex += currentDashJump;
+            dec->charProcessFlag = true;
+            dec->decoderIndex += dec->dashJump;
           }
         }
-        decodeStates = state0;  // Begin process again.
-        break;                  // End state2
+        dec->decodeState = state0;  // Begin process again.
+        break;                      // End state2
       case state3:
-        MorseCharacterDisplay(bigMorseCodeTree[currentDecoderIndex]);  // This always prints.  How do blanks get printed.
-        currentDecoderIndex = 0;                                       //Reset everything if char or word
-        currentDashJump = DECODER_BUFFER_SIZE;
-        charProcessFlag = false;  // Char printed and no longer in progress.
-        decodeStates = state0;    // Start process for next incoming character.
-        blankFlag = false;
-        //      Serial.printf("IEG = %d\n", interElementGap);
-        break;      // End state5
+        if (dec->decoderIndex < DECODER_BUFFER_SIZE) {
+          decoded = bigMorseCodeTree[dec->decoderIndex];
+        }
+        dec->decoderIndex = 0;  //Reset everything if char or word
+        dec->dashJump = DECODER_BUFFER_SIZE;
+        dec->charProcessFlag = false;  // Char printed and no longer in progress.
+        dec->decodeState = state0;     // Start process for next incoming character.
+        dec->blankFlag = false;
+        break;      // End state3
       case state4:  //  Blank printing state.
-        MorseCharacterDisplay(' ');
-
-        tft.setFontScale((enum RA8875tsize)0);  // Show estimated WPM
-        tft.setTextColor(RA8875_GREEN);
-        tft.fillRect(DECODER_X + 104, DECODER_Y, tft.getFontWidth() * 10, tft.getFontHeight(), RA8875_BLACK);
-        tft.setCursor(DECODER_X + 105, DECODER_Y);
-        tft.print("(");
-        tft.print(1200L / (dahLength / 3));
-        tft.print(" WPM)");
-        tft.setTextColor(RA8875_WHITE);
-        tft.setFontScale((enum RA8875tsize)3);
-        //Serial.printf("gapLength = %d thresholdGeometricMean = %f interElementGap = %d\n", gapLength, thresholdGeometricMean, interElementGap);
-        blankFlag = true;
-        decodeStates = state0;  // Start process for next incoming character.
+        decoded = ' ';
+        dec->blankFlag = true;
+        dec->decodeState = state0;  // Start process for next incoming character.
         break;
       default:
         break;
     }
   }
+  return decoded;
+}
+
+
+/*****
+  Purpose: One cluster of a decoder histogram, the weights of a cell and its neighbours.
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+    int s                         0 for the +-1 cell clusters, 1 for the +-3 cell clusters
+    int i                         the center cell
+
+  Return value;
+    float32_t                     the summed weights
+*****/
+static float32_t CWHistogramCluster(struct cwHistogram_t *hist, int s, int i) {
+  const int spread[2] = { 1, 3 };
+  float32_t sum = 0.0;
+
+  for (int j = max(0, i - spread[s]); j <= min(HISTOGRAM_ELEMENTS - 1, i + spread[s]); j++) {
+    sum += hist->weight[j];
+  }
+  return sum;
+}
+
+/*****
+  Purpose: Pick the larger of two clusters of a decoder histogram.  A tie goes to the higher index, the same
+           as the >= scan in JackClusteredArrayMax().
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+    int s                         0 for the +-1 cell clusters, 1 for the +-3 cell clusters
+    int a, b                      the cluster indexes, -1 for none
+
+  Return value;
+    int                           the index of the larger cluster
+*****/
+static int CWHistogramLarger(struct cwHistogram_t *hist, int s, int a, int b) {
+  float32_t clusterA, clusterB;
+
+  if (a < 0) return b;
+  if (b < 0) return a;
+  clusterA = CWHistogramCluster(hist, s, a);
+  clusterB = CWHistogramCluster(hist, s, b);
+  if (clusterA > clusterB || (clusterA == clusterB && a > b)) return a;
+  return b;
+}
+
+// The largest cluster below a node of a max tree.  A leaf is its own cell.
+static int CWHistogramNode(struct cwHistogram_t *hist, int s, int node) {
+  return (node >= HISTOGRAM_ELEMENTS) ? node - HISTOGRAM_ELEMENTS : hist->tree[s][node];
+}
+
+/*****
+  Purpose: Rebuild both max trees from the cell weights.
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+
+  Return value;
+    void
+*****/
+static void CWHistogramRebuild(struct cwHistogram_t *hist) {
+  for (int s = 0; s < 2; s++) {
+    hist->tree[s][0] = -1;  // Not used
+    for (int node = HISTOGRAM_ELEMENTS - 1; node > 0; node--) {
+      hist->tree[s][node] = CWHistogramLarger(hist, s, CWHistogramNode(hist, s, 2 * node), CWHistogramNode(hist, s, 2 * node + 1));
+    }
+  }
 }
 
+/*****
+  Purpose: Empty a decoder histogram
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+
+  Return value;
+    void
+*****/
+void CWHistogramClear(struct cwHistogram_t *hist) {
+  memset(hist->weight, 0, sizeof(hist->weight));
+  hist->scale = 1.0;
+  CWHistogramRebuild(hist);
+}
+
+/*****
+  Purpose: Count one element in a decoder histogram.  The new count is stored as 1 / scale so it comes out
+           as 1 against the older, decayed counts.  Only the paths to the top of the max trees from the 10
+           clusters that include the cell are updated.
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+    int32_t index                 the cell, the element length in ms
+
+  Return value;
+    void
+*****/
+FASTRUN void CWHistogramAdd(struct cwHistogram_t *hist, int32_t index) {
+  const int spread[2] = { 1, 3 };
+
+  if (index < 0 || index >= HISTOGRAM_ELEMENTS) return;
+  hist->weight[index] += 1.0 / hist->scale;
+  for (int s = 0; s < 2; s++) {
+    for (int i = max(0, (int)index - spread[s]); i <= min(HISTOGRAM_ELEMENTS - 1, (int)index + spread[s]); i++) {
+      for (int node = (HISTOGRAM_ELEMENTS + i) >> 1; node > 0; node >>= 1) {
+        hist->tree[s][node] = CWHistogramLarger(hist, s, CWHistogramNode(hist, s, 2 * node), CWHistogramNode(hist, s, 2 * node + 1));
+      }
+    }
+  }
+}
+
+/*****
+  Purpose: Scale all the counts in a decoder histogram by factor.  Only the scale changes, which leaves the
+           order of the clusters and so the max trees as they are.  The weights are renormalized when the
+           scale gets small, HISTOGRAM_MIN_SCALE, before new counts lose precision against the old ones.
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+    float32_t factor              the decay, 0 to 1
+
+  Return value;
+    void
+*****/
+FASTRUN void CWHistogramDecay(struct cwHistogram_t *hist, float32_t factor) {
+  hist->scale *= factor;
+  if (hist->scale < HISTOGRAM_MIN_SCALE) {
+    for (int i = 0; i < HISTOGRAM_ELEMENTS; i++) {
+      hist->weight[i] *= hist->scale;
+    }
+    hist->scale = 1.0;
+    CWHistogramRebuild(hist);
+  }
+}
+
+/*****
+  Purpose: Read one cell of a decoder histogram
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+    int32_t index                 the cell
+
+  Return value;
+    float32_t                     the decayed count in the cell, 0 outside the histogram
+*****/
+FASTRUN float32_t CWHistogramValue(struct cwHistogram_t *hist, int32_t index) {
+  if (index < 0 || index >= HISTOGRAM_ELEMENTS) return 0.0;
+  return hist->weight[index] * hist->scale;
+}
+
+/*****
+  Purpose: JackClusteredArrayMax() for a decoder histogram.  The scan of every cell is replaced by a walk
+           up the max tree, at most two nodes for each of its 10 levels.
+
+  Parameter list:
+    struct cwHistogram_t *hist    the histogram
+    int32_t base                  the first cell of the range to search
+    int32_t elements              the number of cells in the range
+    float32_t *maxCount           the count in the center cell of the largest cluster
+    int32_t *maxIndex             the index of the center of the cluster, from base
+    int32_t spread                1 or 3, how many cells either side are included in a cluster
+
+  Return value;
+    void
+*****/
+FASTRUN void CWHistogramClusterMax(struct cwHistogram_t *hist, int32_t base, int32_t elements, float32_t *maxCount, int32_t *maxIndex, int32_t spread) {
+  int s = (spread > 1) ? 1 : 0;
+  int lo = base + spread;  // Same cells JackClusteredArrayMax() looks at
+  int hi = min(base + elements - spread, (int32_t)HISTOGRAM_ELEMENTS);
+  int best = -1;
+
+  *maxCount = 0.0;
+  *maxIndex = 0;
+  if (lo < 0) lo = 0;
+  for (lo += HISTOGRAM_ELEMENTS, hi += HISTOGRAM_ELEMENTS; lo < hi; lo >>= 1, hi >>= 1) {
+    if (lo & 1) best = CWHistogramLarger(hist, s, best, CWHistogramNode(hist, s, lo++));
+    if (hi & 1) best = CWHistogramLarger(hist, s, best, CWHistogramNode(hist, s, --hi));
+  }
+  if (best - base > 0) {
+    *maxCount = CWHistogramValue(hist, best);
+    *maxIndex = best - base;
+  }
+}
 
 /*****
   Purpose: This function creates a distribution of the gaps between signals, expressed
@@ -533,55 +837,36 @@ FASTRUN void DoCWDecoding(int audioValue) {
             3. word end (seven dit lengths)
 
   Parameter list:
-    long val        the duration of the signal gap (ms)
+    struct cwDecoder_t *dec     the decoder
+    long gapLen                 the duration of the signal gap (ms)
 
   Return value;
     void
 
 *****/
-FASTRUN void DoGapHistogram(long gapLen) {
-  int32_t tempAtom, tempChar;
-  int32_t atomIndex, charIndex, firstDit, temp;
-  uint32_t offset;
-
-  if (gapHistogram[gapLen] > 10) {  // Need over 1 so we don't have fractional value
-    for (int k = 0; k < HISTOGRAM_ELEMENTS; k++) {
-      gapHistogram[k] = (uint32_t)(.8 * (float)gapHistogram[k]);
-    }
+FASTRUN void DoGapHistogram(struct cwDecoder_t *dec, long gapLen) {
+  float32_t tempAtom, tempChar;
+  int32_t atomIndex, charIndex;
+
+  if (CWHistogramValue(&dec->gapHistogram, gapLen) > 10) {  // Decay the old gaps.  Only the scale factor changes.
+    CWHistogramDecay(&dec->gapHistogram, 0.8);
   }
 
-  gapHistogram[gapLen]++;  // Add new signal to distribution
+  CWHistogramAdd(&dec->gapHistogram, gapLen);  // Add new signal to distribution
 
   atomIndex = charIndex = 0;
-  if (gapLen <= thresholdGeometricMean) {                                                                                 // Find new dit length
-    JackClusteredArrayMax(gapHistogram, (uint32_t)thresholdGeometricMean, &tempAtom, &atomIndex, &firstDit, (int32_t)1);  // Find max dit gap
-    if (atomIndex) {                                                                                                      // if something found
-      gapAtom = atomIndex;
-    }
-    for (int j = 0; j < HISTOGRAM_ELEMENTS; j++) {                        // count down
-      if (gapHistogram[HISTOGRAM_ELEMENTS - j] > 0 && endGapFlag == 0) {  //Look for non-zero entries in the histogram
-        if (HISTOGRAM_ELEMENTS - j < gapAtom * 2) {                       // limit search to probable gapAtom entries
-          topGapIndex = HISTOGRAM_ELEMENTS - j;                           //Upper end of gapAtom range
-          endGapFlag = 1;                                                 // set flag so we know tha this is the top of the gapAtom range
-        }
-      }
-      if (topGapIndex > 2 * gapAtom) topGapIndex = topGapIndexOld;  // discard outliers
-    }
-    endGapFlag = 0;                //reset flag
-    topGapIndexOld = topGapIndex;  //Keep good value for reference
-  } else {                         // dah calculation
-    if (gapLen <= thresholdGeometricMean * 2) {
-      offset = (uint32_t)(thresholdGeometricMean * 2);  // Find number of elements to check
-      JackClusteredArrayMax(&gapHistogram[(int32_t)thresholdGeometricMean + 1], offset, &tempChar, &charIndex, &temp, (int32_t)3);
-      if (charIndex)  // if something found
-        gapChar = charIndex;
+  if (gapLen <= dec->thresholdGeometricMean) {                                                                     // Find new dit length
+    CWHistogramClusterMax(&dec->gapHistogram, 0, (int32_t)dec->thresholdGeometricMean, &tempAtom, &atomIndex, 1);  // Find max dit gap
+  } else {                                                                                                           // dah calculation
+    if (gapLen <= dec->thresholdGeometricMean * 2) {
+      CWHistogramClusterMax(&dec->gapHistogram, (int32_t)dec->thresholdGeometricMean + 1, (int32_t)(dec->thresholdGeometricMean * 2), &tempChar, &charIndex, 3);
     }
   }
   if (atomIndex) {
-    gapAtom = atomIndex;
+    dec->gapAtom = atomIndex;
   }
   if (charIndex) {
-    gapChar = charIndex;
+    dec->gapChar = charIndex;
   }
 }
 
@@ -637,67 +922,59 @@ void JackClusteredArrayMax(int32_t *array, int32_t elements, int32_t *maxCount,
   (60wpm) and 240 (5wpm)
 
   Parameter list:
-  long val        the strength of audio signal
+  struct cwDecoder_t *dec     the decoder
+  long val                    the length of the signal (ms)
+  uint32_t time               decoder time, ms
 
   Return value;
   void
 
 *****/
-FASTRUN void DoSignalHistogram(long val) {
+FASTRUN void DoSignalHistogram(struct cwDecoder_t *dec, long val, uint32_t time) {
   float compareFactor = 2.0;
-  int32_t firstNonEmpty;
-  int32_t tempDit, tempDah;
+  float32_t tempDit, tempDah;
+  int32_t ditIndex, dahIndex;
   int32_t offset;
 
-  if (valFlag == 0) {
-    valRef1 = signalElapsedTime;
-    signalStartOld = millis();
-    valFlag = 1;
+  if (dec->valFlag == 0) {
+    dec->valRef1 = dec->signalElapsedTime;
+    dec->signalStartOld = time;
+    dec->valFlag = 1;
   }
 
-  if (millis() - signalStartOld > LOWEST_ATOM_TIME && valFlag == 1) {
-    gapRef1 = gapLength;
-    valRef2 = signalElapsedTime;
-    valFlag = 0;
+  if (time - dec->signalStartOld > LOWEST_ATOM_TIME && dec->valFlag == 1) {
+    dec->gapRef1 = dec->gapLength;
+    dec->valRef2 = dec->signalElapsedTime;
+    dec->valFlag = 0;
   }
 
-  if ((valRef2 >= valRef1 * compareFactor && gapRef1 <= valRef1 * compareFactor)
-      || (valRef1 >= valRef2 * compareFactor && gapRef1 <= valRef2 * compareFactor)) {
+  if ((dec->valRef2 >= dec->valRef1 * compareFactor && dec->gapRef1 <= dec->valRef1 * compareFactor)
+      || (dec->valRef1 >= dec->valRef2 * compareFactor && dec->gapRef1 <= dec->valRef2 * compareFactor)) {
     // See if consecutive signal lengths in approximate dit to dah ratio and which one is larger
-    if (valRef2 >= valRef1) {
-      aveDitLength = (long)(0.9 * aveDitLength + 0.1 * valRef1);  //Do some dit length averaging
-      aveDahLength = (long)(0.9 * aveDahLength + 0.1 * valRef2);
+    if (dec->valRef2 >= dec->valRef1) {
+      dec->aveDitLength = (long)(0.9 * dec->aveDitLength + 0.1 * dec->valRef1);  //Do some dit length averaging
+      dec->aveDahLength = (long)(0.9 * dec->aveDahLength + 0.1 * dec->valRef2);
     } else {
-      aveDitLength = (long)(0.9 * aveDitLength + 0.1 * valRef2);  // Use larger one. Note reversal of calc order
-      aveDahLength = (long)(0.9 * aveDahLength + 0.1 * valRef1);  // Do some dah length averaging
+      dec->aveDitLength = (long)(0.9 * dec->aveDitLength + 0.1 * dec->valRef2);  // Use larger one. Note reversal of calc order
+      dec->aveDahLength = (long)(0.9 * dec->aveDahLength + 0.1 * dec->valRef1);  // Do some dah length averaging
     }
   }
-  thresholdGeometricMean = sqrt(aveDitLength * aveDahLength);    //calculate geometric mean
-  thresholdArithmeticMean = (aveDitLength + aveDahLength) >> 1;  // Fast divide by 2 on integer data
-
-  signalHistogram[val]++;  // Don't care which half it's in, just put it in
+  dec->thresholdGeometricMean = sqrt(dec->aveDitLength * dec->aveDahLength);    //calculate geometric mean
+  dec->thresholdArithmeticMean = (dec->aveDitLength + dec->aveDahLength) >> 1;  // Fast divide by 2 on integer data
 
-  offset = (uint32_t)thresholdGeometricMean - 1;  // Only do cast once
-  // Dit calculation
-  // 2nd parameter means we only look for dits below the geomean.
+  CWHistogramAdd(&dec->signalHistogram, val);  // Don't care which half it's in, just put it in
 
-  for (int32_t j = (int32_t)thresholdGeometricMean; j; j--) {
-    if (signalHistogram[j] != 0) {
-      firstNonEmpty = j;
-      break;
-    }
-  }
-
-  JackClusteredArrayMax(signalHistogram, offset, &tempDit, (int32_t *)&ditLength, &firstNonEmpty, (int32_t)1);
+  offset = (int32_t)dec->thresholdGeometricMean - 1;
+  // Dit calculation, only below the geomean
+  CWHistogramClusterMax(&dec->signalHistogram, 0, offset, &tempDit, &ditIndex, 1);
   // dah calculation
   // Elements above the geomean. Note larger spread: higher variance
-  JackClusteredArrayMax(&signalHistogram[offset], HISTOGRAM_ELEMENTS - offset, &tempDah, (int32_t *)&dahLength, &firstNonEmpty, (uint32_t)3);
-  dahLength += (uint32_t)offset;
+  CWHistogramClusterMax(&dec->signalHistogram, offset, HISTOGRAM_ELEMENTS - offset, &tempDah, &dahIndex, 3);
+  dec->ditLength = ditIndex;
+  dec->dahLength = dahIndex + offset;
 
-  if (tempDit > SCALE_CONSTANT && tempDah > SCALE_CONSTANT) {  //Adaptive dit signalHistogram[]
-    for (int k = 0; k < HISTOGRAM_ELEMENTS; k++) {
-      signalHistogram[k] = ADAPTIVE_SCALE_FACTOR * signalHistogram[k];
-    }
+  if (tempDit > SCALE_CONSTANT && tempDah > SCALE_CONSTANT) {  // Adaptive dit signalHistogram, one multiply
+    CWHistogramDecay(&dec->signalHistogram, ADAPTIVE_SCALE_FACTOR);
   }
 }
 
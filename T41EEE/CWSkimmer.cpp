@@ -0,0 +1,323 @@
+#ifndef BEENHERE
+#include "SDT.h"
+#endif
+
+// Multi-channel CW skimmer.  Turn it on with the Skimmer entry in the CW Options menu.
+// CWSkimmer() runs on the decimated I and Q in ProcessIQData().  A SKIM_FFT point channelizer FFT every SKIM_HOP
+// samples gives the power in each bin of the receive passband.  Every bin tracks its noise floor and its peak.  A
+// bin whose peak stands well above its floor is a keyed carrier, and it gets a decoder from a fixed pool of
+// SKIM_CHANNELS.  Each channel keys its own struct cwDecoder_t through DoCWDecoding(), the main decoder with its own
+// dit/dah and gap histograms.  Decoder time comes from the sample clock, so the timing is to SKIM_HOP samples whatever
+// the loop is doing.
+// Decoded text and WPM by frequency go to the waterfall area, which the skimmer uses in place of the waterfall, and
+// each decoded word goes out over Serial.
+
+struct cwSkimChannel_t DMAMEM cwSkimChannels[SKIM_CHANNELS];  // The decoder pool, CWSkimmerReset() before use
+uint32_t skimHops = 0;      // Channelizer FFTs since the last DSPTimingReport()
+uint64_t skimCycles = 0;    // Cycles used by CWSkimmer() since the last DSPTimingReport()
+
+static float32_t skimHistory[2 * SKIM_FFT];  // The last SKIM_FFT complex samples
+static float32_t skimBuffer[2 * SKIM_FFT];   // Windowed FFT input, then the bin powers
+static float32_t skimWindow[SKIM_FFT];
+DMAMEM static float32_t skimLevel[SKIM_FFT];  // Bin power, averaged over the last two channelizer FFTs
+DMAMEM static float32_t skimLast[SKIM_FFT];   // Bin power from the last channelizer FFT
+DMAMEM static float32_t skimFloor[SKIM_FFT];  // Bin noise floor, follows the level down quickly and up slowly
+DMAMEM static float32_t skimPeak[SKIM_FFT];   // Bin peak, follows the level up at once and down slowly
+static int8_t skimOwner[SKIM_FFT];            // Channel decoding each bin, -1 for none
+static uint64_t skimClock = 0;                // Sample clock, counts SKIM_HOP samples per channelizer FFT
+static int64_t skimFreq = 0;                  // TxRxFreq the bins were measured at
+static int skimMode = -1;                     // Demodulation mode the bins were measured in
+static bool skimPrimed = false;               // The trackers hold a measured level
+static bool skimDisplayClear = false;         // The waterfall area has been cleared for the skimmer
+
+/*****
+  Purpose: Free all the skimmer channels and restart the bin trackers.  Called when the skimmer is turned on or off
+           and when the receive frequency or mode changes.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void CWSkimmerReset() {
+  for (int i = 0; i < SKIM_CHANNELS; i++) {
+    cwSkimChannels[i].bin = -1;
+    cwSkimChannels[i].changed = true;
+  }
+  memset(skimOwner, -1, sizeof(skimOwner));
+  memset(skimHistory, 0, sizeof(skimHistory));
+  skimPrimed = false;
+  skimDisplayClear = false;
+  for (int i = 0; i < SKIM_FFT; i++) {  // Hann window, scaled so a full scale tone reads about 1.0
+    skimWindow[i] = (0.5 - 0.5 * cosf(TWO_PI * i / SKIM_FFT)) * 2.0 / SKIM_FFT;
+  }
+}
+
+/*****
+  Purpose: Skimmer time, from the sample clock, for the channel decoders.
+
+  Parameter list:
+    void
+
+  Return value;
+    uint32_t        milliseconds of received audio
+*****/
+static uint32_t SkimTime() {
+  return (uint32_t)(skimClock * 1000 / (uint32_t)decimatedRate);
+}
+
+/*****
+  Purpose: Start a decoder on a bin, with the same starting timing as ResetHistograms(), 15 WPM.
+
+  Parameter list:
+    struct cwSkimChannel_t *ch    the free channel
+    int bin                       the channelizer bin, 0 to SKIM_FFT - 1
+
+  Return value;
+    void
+*****/
+static void SkimChannelStart(struct cwSkimChannel_t *ch, int bin) {
+  ch->bin = bin;
+  ch->key = false;
+  ch->lastActivity = SkimTime();
+  CWDecoderReset(&ch->decoder, ch->lastActivity);
+  ch->decoder.blankFlag = true;  // No leading blank
+  ch->col = 0;
+  ch->text[0] = '\0';
+  ch->wordCol = 0;
+  ch->word[0] = '\0';
+  ch->changed = true;
+}
+
+/*****
+  Purpose: Receive frequency of a skimmer channel.  The tuned frequency sounds at the CW offset, so a bin at audio
+           frequency f is f - offset above the tuned frequency in USB, and below it in LSB.
+
+  Parameter list:
+    struct cwSkimChannel_t *ch    an active channel
+
+  Return value;
+    float32_t       frequency in Hz
+*****/
+static float32_t SkimChannelFreq(struct cwSkimChannel_t *ch) {
+  float32_t audioHz;
+  float32_t offsetHz = (EEPROMData.CWOffset + 6) * decimatedRate / 256.0;  // As UpdateNCO()
+
+  audioHz = (ch->bin < SKIM_FFT / 2 ? ch->bin : ch->bin - SKIM_FFT) * decimatedRate / SKIM_FFT;
+  return (float32_t)TxRxFreq + (audioHz >= 0.0 ? audioHz - offsetHz : audioHz + offsetHz);
+}
+
+/*****
+  Purpose: Estimated speed of a skimmer channel, from its dah length like the main decoder.
+
+  Parameter list:
+    struct cwSkimChannel_t *ch    an active channel
+
+  Return value;
+    int             words per minute
+*****/
+static int SkimChannelWPM(struct cwSkimChannel_t *ch) {
+  return CWDecoderWPM(&ch->decoder);
+}
+
+/*****
+  Purpose: Add a decoded character to a channel's text line, and send each finished word over Serial.
+
+  Parameter list:
+    struct cwSkimChannel_t *ch    the channel
+    char currentLetter            the decoded character, or a blank at the end of a word
+
+  Return value;
+    void
+*****/
+static void SkimCharacter(struct cwSkimChannel_t *ch, char currentLetter) {
+  if (ch->col < SKIM_TEXT_CHARS) {
+    ch->text[ch->col++] = currentLetter;
+  } else {
+    memmove(ch->text, &ch->text[1], SKIM_TEXT_CHARS - 1);  // Slide the line down one character
+    ch->text[SKIM_TEXT_CHARS - 1] = currentLetter;
+  }
+  ch->text[ch->col] = '\0';
+  ch->changed = true;
+
+  if (currentLetter != ' ') {
+    if (ch->wordCol < SKIM_WORD_CHARS) {
+      ch->word[ch->wordCol++] = currentLetter;
+      ch->word[ch->wordCol] = '\0';
+    }
+  } else if (ch->wordCol > 0) {
+    Serial.printf("CW %.2f kHz %d WPM: %s\n", SkimChannelFreq(ch) / 1000.0, SkimChannelWPM(ch), ch->word);
+    ch->wordCol = 0;
+    ch->word[0] = '\0';
+  }
+}
+
+/*****
+  Purpose: Update the bin trackers from one channelizer FFT, start decoders on new keyed carriers, and run the
+           decoders of the active channels.
+
+  Parameter list:
+    float32_t *power      bin powers, SKIM_FFT bins, in FFT order
+    int loBin             lowest passband bin, signed
+    int hiBin             highest passband bin, signed
+
+  Return value;
+    void
+*****/
+static void SkimBins(float32_t *power, int loBin, int hiBin) {
+  int k, free;
+  bool key;
+  char c;
+  uint32_t now = SkimTime();
+  float32_t threshold;
+  struct cwSkimChannel_t *ch;
+
+  for (int b = loBin; b <= hiBin; b++) {
+    k = (b + SKIM_FFT) % SKIM_FFT;
+    if (!skimPrimed) {
+      skimLast[k] = skimLevel[k] = skimFloor[k] = skimPeak[k] = power[k];
+      continue;
+    }
+    skimLevel[k] = 0.5 * (power[k] + skimLast[k]);  // Short, so the key edges are not smeared
+    skimLast[k] = power[k];
+    skimFloor[k] = (skimLevel[k] < skimFloor[k]) ? skimFloor[k] + SKIM_FLOOR_FALL * (skimLevel[k] - skimFloor[k]) : skimFloor[k] * SKIM_FLOOR_RISE;
+    skimPeak[k] = (skimLevel[k] > skimPeak[k]) ? skimLevel[k] : skimPeak[k] * SKIM_PEAK_DECAY;
+  }
+  if (!skimPrimed) {
+    skimPrimed = true;
+    return;
+  }
+
+  // Look for keyed carriers without a decoder: a peak well above the floor, and the strongest of its neighbours.
+  for (int b = loBin + 1; b < hiBin; b++) {
+    k = (b + SKIM_FFT) % SKIM_FFT;
+    if (skimPeak[k] < SKIM_DETECT_RATIO * skimFloor[k] || skimLevel[k] < skimPeak[k] * SKIM_KEY_LEVEL) {
+      continue;
+    }
+    if (skimLevel[k] < skimLevel[(k + 1) % SKIM_FFT] || skimLevel[k] < skimLevel[(k + SKIM_FFT - 1) % SKIM_FFT]) {
+      continue;
+    }
+    if (skimOwner[k] >= 0 || skimOwner[(k + 1) % SKIM_FFT] >= 0 || skimOwner[(k + SKIM_FFT - 1) % SKIM_FFT] >= 0) {
+      continue;
+    }
+    for (free = 0; free < SKIM_CHANNELS && cwSkimChannels[free].bin >= 0; free++)
+      ;
+    if (free == SKIM_CHANNELS) {  // Pool is full
+      break;
+    }
+    SkimChannelStart(&cwSkimChannels[free], k);
+    skimOwner[k] = free;
+  }
+
+  // Key each active channel at the geometric mean of its floor and peak, but no more than SKIM_KEY_LEVEL below the
+  // peak, so a strong signal keys near the middle of its edges.  Some hysteresis stops chatter.
+  for (int i = 0; i < SKIM_CHANNELS; i++) {
+    ch = &cwSkimChannels[i];
+    if (ch->bin < 0) {
+      continue;
+    }
+    k = ch->bin;
+    threshold = max(sqrtf(skimPeak[k] * skimFloor[k]), (float32_t)(skimPeak[k] * SKIM_KEY_LEVEL));
+    key = ch->key ? (skimLevel[k] > threshold / SKIM_KEY_HYSTERESIS) : (skimLevel[k] > threshold * SKIM_KEY_HYSTERESIS);
+    if (skimPeak[k] < SKIM_DETECT_RATIO * skimFloor[k] / 2.0) {  // Faded into the noise
+      key = false;
+    }
+    ch->key = key;
+    c = DoCWDecoding(&ch->decoder, key, now);
+    if (c) {
+      SkimCharacter(ch, c);
+      ch->lastActivity = now;
+    }
+    if (now - ch->lastActivity > SKIM_IDLE_TIME) {  // Nothing decoded for a while, free the decoder
+      if (ch->wordCol > 0) {
+        SkimCharacter(ch, ' ');  // Send the last word
+      }
+      skimOwner[k] = -1;
+      ch->bin = -1;
+      ch->changed = true;
+    }
+  }
+}
+
+/*****
+  Purpose: Run the skimmer on one block of decimated I and Q, float_buffer_L and float_buffer_R.  Called from
+           ProcessIQData() in CW receive when the skimmer is on.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void CWSkimmer() {
+  uint32_t start = ARM_DWT_CYCCNT;
+  int loBin, hiBin;
+  float32_t binHz = decimatedRate / SKIM_FFT;
+
+  if (TxRxFreq != skimFreq || bands[EEPROMData.currentBand].mode != skimMode) {  // Tuned, the bins have moved
+    CWSkimmerReset();
+    skimFreq = TxRxFreq;
+    skimMode = bands[EEPROMData.currentBand].mode;
+  }
+  loBin = max((int)ceilf(bands[EEPROMData.currentBand].FLoCut / binHz), -SKIM_FFT / 2 + 2);
+  hiBin = min((int)floorf(bands[EEPROMData.currentBand].FHiCut / binHz), SKIM_FFT / 2 - 2);
+  if (loBin >= hiBin) {
+    return;
+  }
+
+  for (uint32_t hop = 0; hop + SKIM_HOP <= BUF_N_DF; hop += SKIM_HOP) {
+    memmove(skimHistory, &skimHistory[2 * SKIM_HOP], 2 * (SKIM_FFT - SKIM_HOP) * sizeof(float32_t));
+    for (int i = 0; i < SKIM_HOP; i++) {
+      skimHistory[2 * (SKIM_FFT - SKIM_HOP + i)] = float_buffer_L[hop + i];
+      skimHistory[2 * (SKIM_FFT - SKIM_HOP + i) + 1] = float_buffer_R[hop + i];
+    }
+    for (int i = 0; i < SKIM_FFT; i++) {
+      skimBuffer[2 * i] = skimHistory[2 * i] * skimWindow[i];
+      skimBuffer[2 * i + 1] = skimHistory[2 * i + 1] * skimWindow[i];
+    }
+    arm_cfft_f32(&arm_cfft_sR_f32_len256, skimBuffer, 0, 1);
+    arm_cmplx_mag_squared_f32(skimBuffer, skimBuffer, SKIM_FFT);  // In place, the powers fill the first half
+    skimClock += SKIM_HOP;
+    SkimBins(skimBuffer, loBin, hiBin);
+    skimHops++;
+  }
+  skimCycles += ARM_DWT_CYCCNT - start;
+}
+
+/*****
+  Purpose: Draw the skimmer channels in the waterfall area, one row per channel: frequency in kHz, WPM, and the
+           decoded text.  Only changed rows are drawn.  Called by ShowSpectrum() in place of the waterfall update.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void CWSkimmerDisplay() {
+  char line[16];
+  struct cwSkimChannel_t *ch;
+
+  tft.setFontScale((enum RA8875tsize)0);
+  if (!skimDisplayClear) {
+    tft.fillRect(WATERFALL_LEFT_X, FIRST_WATERFALL_LINE, MAX_WATERFALL_WIDTH, MAX_WATERFALL_ROWS, RA8875_BLACK);
+    skimDisplayClear = true;
+  }
+  for (int i = 0; i < SKIM_CHANNELS; i++) {
+    ch = &cwSkimChannels[i];
+    if (!ch->changed) {
+      continue;
+    }
+    tft.fillRect(WATERFALL_LEFT_X, FIRST_WATERFALL_LINE + 2 + i * SKIM_ROW_HEIGHT, MAX_WATERFALL_WIDTH, tft.getFontHeight(), RA8875_BLACK);
+    if (ch->bin >= 0) {
+      tft.setCursor(WATERFALL_LEFT_X + 2, FIRST_WATERFALL_LINE + 2 + i * SKIM_ROW_HEIGHT);
+      tft.setTextColor(RA8875_GREEN);
+      sprintf(line, "%8.1f %2d ", SkimChannelFreq(ch) / 1000.0, SkimChannelWPM(ch));
+      tft.print(line);
+      tft.setTextColor(RA8875_WHITE);
+      tft.print(ch->text);
+    }
+    ch->changed = false;
+  }
+}
@@ -46,256 +46,229 @@ void NoiseBlanker(float32_t* inputsamples, float32_t* outputsamples)
 
 }
 
+uint32_t nbBlocks = 0;          // Blocks offered to the noise blanker
+uint32_t nbBlocksAnalysed = 0;  // Blocks that passed the impulse gate and had the LPC analysis
+uint32_t nbBlocksBlanked = 0;   // Blocks with at least one impulse restored
+uint32_t nbImpulses = 0;        // Impulses restored
+uint64_t nbCycles = 0;          // Cycles spent in AltNoiseBlanking()
+
+// Noise blanker working set.  Sized for the largest order and impulse length so nothing is allocated per block.
+static float32_t nbLpcs[NB_ORDER_MAX + 1];         // LPC coefficients with the leading 1
+static float32_t nbReverseLpcs[NB_ORDER_MAX + 1];  // The same in reverse order, for the matched impulse filter
+static float32_t nbAny[NB_ORDER_MAX + 1];          // Levinson-Durbin scratch
+static float32_t nbR[NB_ORDER_MAX + 1];            // Autocorrelation
+static float32_t nbFirState[NB_FFT_SIZE + NB_ORDER_MAX];
+static float32_t nbResidual[NB_FFT_SIZE];          // Inverse and matched filtered samples
+static float32_t nbRfw[NB_IMPULSE_MAX + NB_ORDER_MAX];  // Forward predicted restoration
+static float32_t nbRbw[NB_IMPULSE_MAX + NB_ORDER_MAX];  // Backward predicted restoration
+static float32_t nbWfw[NB_IMPULSE_MAX], nbWbw[NB_IMPULSE_MAX];  // Cross fade of the two predictions
+static float32_t nbLastFrameEnd[NB_ORDER_MAX + NB_IMPULSE_MAX];  // Tail of the previous frame, for the left boundary
+static int nbWindowLength = 0;                     // Impulse length nbWfw and nbWbw were made for
+
 /*****
-  Purpose: void AltNoiseBlanking(
+  Purpose: Cheap impulse pre-detector for the noise blanker.  The receive audio is band limited well below 12 kHz,
+           and the sixth difference, a 36 dB per octave high pass, takes out nearly all of it, while an impulse has
+           energy right up to 12 kHz and stands out the way it does after the LPC inverse filter.  The LPC detector
+           restores an impulse that peaks at NB_thresh times its residual RMS.  Over the sixth difference such an
+           impulse peaks at more than 2.5 times NB_thresh, and clean speech and noise stay under 1.8 times, so blocks
+           whose sixth difference peak is within NB_GATE_FACTOR * NB_thresh of its RMS skip the LPC analysis.  Below
+           NB_GATE_MIN_THRESH the LPC detector starts to take speech onsets for impulses, which the gate would miss,
+           so every block is analysed.  The NoiseBlanker host test checks this with impulses near the detector
+           threshold.
   Parameter list:
-    void
+    float32_t *insamp     audio samples
+    int Nsam              number of samples
   Return value;
-    void
+    bool                  true if the block may contain an impulse
+*****/
+static bool NBImpulseSuspected(float32_t *insamp, int Nsam)
+{
+  float32_t d;
+  float32_t peak = 0.0;
+  float32_t energy = 0.0;
+  float32_t ratio = NB_GATE_FACTOR * NB_thresh;
 
-  alt noise blanking is trying to localize some impulse noise within the samples and after that
-  trying to replace corrupted samples by linear predicted samples.
-  therefore, first we calculate the lpc coefficients which represent the actual status of the
-  speech or sound generating "instrument" (in case of speech this is an estimation of the current
-  filter-function of the voice generating tract behind our lips :-) )
-  after finding this function we inverse filter the actual samples by this function
-  so we are eliminating the speech, but not the noise. Then we do a matched filtering an thereby detecting impulses
-  After that we threshold the remaining samples by some
-  level and so detecting impulse noise's positions within the current frame - if one (or more) impulses are there.
-  finally some area around the impulse position will be replaced by predicted samples from both sides (forward and
-  backward prediction)
-  hopefully we have enough processor power left....
+  if (NB_thresh < NB_GATE_MIN_THRESH) {
+    return true;
+  }
+  for (int i = 6; i < Nsam; i++) {
+    d = insamp[i] - 6.0 * insamp[i - 1] + 15.0 * insamp[i - 2] - 20.0 * insamp[i - 3] + 15.0 * insamp[i - 4]
+        - 6.0 * insamp[i - 5] + insamp[i - 6];
+    energy += d * d;
+    if (d < 0.0) d = -d;
+    if (d > peak) peak = d;
+  }
+  return peak * peak * (Nsam - 6) > ratio * ratio * energy;
+}
+
+/*****
+  Purpose: LPC impulse detection and restoration for one block, in place.  This is the analysis from the original
+           AltNoiseBlanking(), working in the static buffers above.
+  Parameter list:
+    float32_t *insamp     audio samples
+    int Nsam              number of samples, NB_FFT_SIZE
+    int order             LPC order
+    int length            impulse length, odd
+  Return value;
+    int                   number of impulses restored
 *****/
-void AltNoiseBlanking(float* insamp, int Nsam, float* E )
+static int NBRestore(float32_t *insamp, int Nsam, int order, int length)
 {
-  int impulse_positions[20];      //we allow a maximum of 5 impulses per frame
-  int search_pos    = 0;
+  int impulse_positions[20];  // We allow a maximum of 20 impulses per frame
+  int half = (length - 1) / 2;
+  int search_pos;
   int impulse_count = 0;
-  int order         = NB_taps;    //10 // lpc's order
-  static float32_t last_frame_end[80]; //this takes the last samples from the previous frame to do the prediction within the boundaries
-
+  bool restore = true;
   arm_fir_instance_f32 LPC;
-  float32_t lpcs[order + 1];                      // we reserve one more than "order" because of a leading "1"
-  float32_t reverse_lpcs[order + 1];              //this takes the reversed order lpc coefficients
-  float32_t firStateF32[NB_FFT_SIZE + order];
-  float32_t tempsamp[NB_FFT_SIZE];
-  float32_t sigma2;                               //taking the variance of the inpo
+  float32_t sigma2;
   float32_t lpc_power;
   float32_t impulse_threshold;
+  float32_t k, alfa, s;
 
-#ifdef debug_alternate_NR
-  static int frame_count = 0; //only used for the distortion insertion - can alter be deleted
-  int dist_level         = 0; //only used for the distortion insertion - can alter be deleted
-#endif
+#ifdef debug_alternate_NR  // Test frames, selected with NB_test
+  static int frame_count = 0;
+  int dist_level;
+  int nr_setting = NB_test;
 
-  int nr_setting = 0;
-  float32_t R[11];            // takes the autocorrelation results
-  float32_t k, alfa;
-
-  float32_t any[order + 1];   //some internal buffers for the levinson durben algorithm
-
-  float32_t Rfw[impulse_length + order]; // takes the forward predicted audio restauration
-  float32_t Rbw[impulse_length + order]; // takes the backward predicted audio restauration
-  float32_t Wfw[impulse_length], Wbw[impulse_length]; // taking linear windows for the combination of fwd and bwd
-
-  float32_t s;
-
-  memset(R, 0, sizeof(float32_t) * 11);
-
-#ifdef debug_alternate_NR  // generate test frames to test the noise blanker function
-  // using the NR-setting (0..55) to select the test frame
-  // 00 = noise blanker active on orig. audio; threshold factor=3
-  // 01 = frame of vocal "a" undistorted
-  // 02 .. 05 = frame of vocal "a" with different impulse distortion levels
-  // 06 .. 09 = frame of vocal "a" with different impulse distortion levels
-  //            noise blanker operating!!
-  //************
-  // 01..09 are now using the original received audio and applying a rythmic "click" distortion
-  // 06..09 is detecting and removing the click by restoring the predicted audio!!!
-  //************
-  // 5 / 9 is the biggest "click" and it is slightly noticeable in the restored audio (9)
-  // 10 = noise blanker active on orig. audio threshold factor=3
-  // 11  = sinusoidal signal undistorted
-  // 12 ..15 = sinusoidal signal with different impulse distortion levels
-  // 16 ..19 = sinusoidal signal with different impulse distortion levels
-  //            noise blanker operating!!
-  // 20 ..50   noise blanker active on orig. audio; threshold factor varying between 3 and 0.26
-
-  nr_setting = NB_test; //(int)ts.dsp_nr_strength;
-
-  //*********************************from here just debug impulse / signal generation
-  if ((nr_setting > 0) && (nr_setting < 10)) // we use the vocal "a" frame
-  {
-    //for (int i=0; i<128;i++)          // not using vocal "a" but the original signal
-    //    insamp[i]=NR_test_samp[i];
-
-    if ((frame_count > 19) && (nr_setting > 1))    // insert a distorting pulse
-    {
-      dist_level = nr_setting;
-      if (dist_level > 5) {
-        dist_level = dist_level - 4; // distortion level is 1...5
-      }
-      insamp[4] = insamp[4] + dist_level * 3000; // overlaying a short  distortion pulse +/-
-      insamp[5] = insamp[5] - dist_level * 1000;
-    }
+  if ((nr_setting > 1) && (nr_setting < 10) && (frame_count > 19)) {
+    dist_level = nr_setting > 5 ? nr_setting - 4 : nr_setting;
+    insamp[4] = insamp[4] + dist_level * 3000;
+    insamp[5] = insamp[5] - dist_level * 1000;
   }
-
-  if ((nr_setting > 10) && (nr_setting < 20))             // we use the sinus frame
-  {
-    for (int i = 0; i < 128; i++)
-      if ((frame_count > 19) && (nr_setting > 11))        // insert a distorting pulse
-      {
-        dist_level = nr_setting - 10;
-        if (dist_level > 5) dist_level = dist_level - 4;
-        insamp[24] = insamp[24] + dist_level * 1000;      // overlaying a short  distortion pulse +/-
-        insamp[25] = insamp[25] + dist_level * 500;
-        insamp[26] = insamp[26] - dist_level * 200;       // overlaying a short  distortion pulse +/-
-        insamp[27] = insamp[27] - dist_level * 100;
-      }
+  if ((nr_setting > 11) && (nr_setting < 20) && (frame_count > 19)) {
+    dist_level = nr_setting - 10;
+    if (dist_level > 5) dist_level = dist_level - 4;
+    insamp[24] = insamp[24] + dist_level * 1000;
+    insamp[25] = insamp[25] + dist_level * 500;
+    insamp[26] = insamp[26] - dist_level * 200;
+    insamp[27] = insamp[27] - dist_level * 100;
   }
   frame_count++;
   if (frame_count > 20)
     frame_count = 0;
-
+  restore = !(((nr_setting > 0) && (nr_setting < 6)) || ((nr_setting > 10) && (nr_setting < 16)));  // Let the test pulse pass
 #endif
-  //*****************************end of debug impulse generation
 
-  //  start of test timing zone
-
-  for (int i = 0; i < impulse_length; i++) // generating 2 Windows for the combination of the 2 predictors
-  { // will be a constant window later!
-    Wbw[i] = 1.0 * i / (impulse_length - 1);
-    Wfw[impulse_length - i - 1] = Wbw[i];
+  // Autocorrelation and Levinson-Durbin
+  for (int i = 0; i < (order + 1); i++) {
+    arm_dot_prod_f32(&insamp[0], &insamp[i], Nsam - i, &nbR[i]);
   }
-
-  // calculate the autocorrelation of insamp (moving by max. of #order# samples)
-  for (int i = 0; i < (order + 1); i++)
-  {
-    arm_dot_prod_f32(&insamp[0], &insamp[i], Nsam - i, &R[i]); // R is carrying the crosscorrelations
-  }
-  // end of autocorrelation
-
-  //alternative levinson durben algorithm to calculate the lpc coefficients from the crosscorrelation
-
-  R[0] = R[0] * (1.0 + 1.0e-9);
-
-  lpcs[0] = 1;   //set lpc 0 to 1
-
+  nbR[0] = nbR[0] * (1.0 + 1.0e-9);
+  nbLpcs[0] = 1;
   for (int i = 1; i < order + 1; i++)
-    lpcs[i] = 0;                    // fill rest of array with zeros - could be done by memfill
-
-  alfa = R[0];
-
-  for (int m = 1; m <= order; m++)
-  {
+    nbLpcs[i] = 0;
+  alfa = nbR[0];
+  for (int m = 1; m <= order; m++) {
     s = 0.0;
     for (int u = 1; u < m; u++)
-      s = s + lpcs[u] * R[m - u];
-
-    k = -(R[m] + s) / alfa;
-
+      s = s + nbLpcs[u] * nbR[m - u];
+    k = -(nbR[m] + s) / alfa;
     for (int v = 1; v < m; v++)
-      any[v] = lpcs[v] + k * lpcs[m - v];
-
+      nbAny[v] = nbLpcs[v] + k * nbLpcs[m - v];
     for (int w = 1; w < m; w++)
-      lpcs[w] = any[w];
-
-    lpcs[m] = k;
+      nbLpcs[w] = nbAny[w];
+    nbLpcs[m] = k;
     alfa = alfa * (1 - k * k);
   }
-
-  // end of levinson durben algorithm
-
-  for (int o = 0; o < order + 1; o++ )           //store the reverse order coefficients separately
-    reverse_lpcs[order - o] = lpcs[o];    // for the matched impulse filter
-
-  arm_fir_init_f32(&LPC, order + 1, &reverse_lpcs[0], &firStateF32[0], NB_FFT_SIZE);                                   // we are using the same function as used in freedv
-  arm_fir_f32(&LPC, insamp, tempsamp, Nsam); //do the inverse filtering to eliminate voice and enhance the impulses
-  arm_fir_init_f32(&LPC, order + 1, &lpcs[0], &firStateF32[0], NB_FFT_SIZE);                                   // we are using the same function as used in freedv
-  arm_fir_f32(&LPC, tempsamp, tempsamp, Nsam); // do a matched filtering to detect an impulse in our now voiceless signal
-
-  arm_var_f32(tempsamp, NB_FFT_SIZE, &sigma2); //calculate sigma2 of the original signal ? or tempsignal
-  arm_power_f32(lpcs, order, &lpc_power); // calculate the sum of the squares (the "power") of the lpc's
-
-  impulse_threshold = NB_thresh * sqrtf(sigma2 * lpc_power);  //set a detection level (3 is not really a final setting)
-
-  search_pos = order + PL; // lower boundary problem has been solved! - so here we start from 1 or 0?
-  impulse_count = 0;
-
-  do {        //going through the filtered samples to find an impulse larger than the threshold
-    if ((tempsamp[search_pos] > impulse_threshold) || (tempsamp[search_pos] < (-impulse_threshold)))
-    {
-      impulse_positions[impulse_count] = search_pos - order;  // save the impulse positions and correct it by the filter delay
+  for (int o = 0; o < order + 1; o++)
+    nbReverseLpcs[order - o] = nbLpcs[o];
+
+  // Inverse filter to remove the voice, then matched filter to bring up the impulses
+  arm_fir_init_f32(&LPC, order + 1, &nbReverseLpcs[0], &nbFirState[0], NB_FFT_SIZE);
+  arm_fir_f32(&LPC, insamp, nbResidual, Nsam);
+  arm_fir_init_f32(&LPC, order + 1, &nbLpcs[0], &nbFirState[0], NB_FFT_SIZE);
+  arm_fir_f32(&LPC, nbResidual, nbResidual, Nsam);
+
+  arm_var_f32(nbResidual, NB_FFT_SIZE, &sigma2);
+  arm_power_f32(nbLpcs, order, &lpc_power);
+  impulse_threshold = NB_thresh * sqrtf(sigma2 * lpc_power);
+
+  search_pos = order + half;
+  do {
+    if ((nbResidual[search_pos] > impulse_threshold) || (nbResidual[search_pos] < (-impulse_threshold))) {
+      impulse_positions[impulse_count] = search_pos - order;  // Corrected by the filter delay
       impulse_count++;
-      search_pos += PL;                                       //  set search_pos a bit away, cause we are already repairing this area later
-    }                                                         //  and the next impulse should not be that close
+      search_pos += half;  // The restoration covers the next few samples
+    }
     search_pos++;
-  } while (( (unsigned int) search_pos < NB_FFT_SIZE - (unsigned int) boundary_blank) && ( (unsigned int) impulse_count < 20U)); // avoid upper boundary
-
-  //boundary handling has to be fixed later
-  //as a result we now will not find any impulse in these areas
-
-  // from here: reconstruction of the impulse-distorted audio part:
-
-  // first we form the forward and backward prediction transfer functions from the lpcs
-  // that is easy, as they are just the negated coefficients  without the leading "1"
-  // we can do this in place of the lpcs, as they are not used here anymore and being recalculated in the next frame!
-
-  arm_negate_f32(&lpcs[1], &lpcs[1], order);
-  arm_negate_f32(&reverse_lpcs[0], &reverse_lpcs[0], order);
-
-  for (int j = 0; j < impulse_count; j++)
-  {
-    for (int k = 0; k < order; k++) // we have to copy some samples from the original signal as
-    { // basis for the reconstructions - could be done by memcopy
-
-      if ((impulse_positions[j] - PL - order + k) < 0) // this solves the prediction problem at the left boundary
-      {
-        Rfw[k] = last_frame_end[impulse_positions[j] + k]; //take the sample from the last frame
-      }
-      else
-      {
-        Rfw[k] = insamp[impulse_positions[j] - PL - order + k]; //take the sample from this frame as we are away from the boundary
+  } while ((search_pos < Nsam - boundary_blank) && (impulse_count < 20));
+
+  // Forward and backward prediction from the negated coefficients
+  arm_negate_f32(&nbLpcs[1], &nbLpcs[1], order);
+  arm_negate_f32(&nbReverseLpcs[0], &nbReverseLpcs[0], order);
+
+  for (int j = 0; j < impulse_count; j++) {
+    for (int k = 0; k < order; k++) {
+      if ((impulse_positions[j] - half - order + k) < 0) {
+        nbRfw[k] = nbLastFrameEnd[impulse_positions[j] + k];  // Left boundary, from the last frame
+      } else {
+        nbRfw[k] = insamp[impulse_positions[j] - half - order + k];
       }
+      nbRbw[length + k] = insamp[impulse_positions[j] + half + k + 1];
+    }
+    for (int i = 0; i < length; i++) {
+      arm_dot_prod_f32(&nbReverseLpcs[0], &nbRfw[i], order, &nbRfw[i + order]);
+      arm_dot_prod_f32(&nbLpcs[1], &nbRbw[length - i], order, &nbRbw[length - i - 1]);
+    }
+    arm_mult_f32(&nbWfw[0], &nbRfw[order], &nbRfw[order], length);
+    arm_mult_f32(&nbWbw[0], &nbRbw[0], &nbRbw[0], length);
+    if (restore) {
+      arm_add_f32(&nbRfw[order], &nbRbw[0], &insamp[impulse_positions[j] - half], length);
+    }
+  }
+  return impulse_count;
+}
 
-      Rbw[impulse_length + k] = insamp[impulse_positions[j] + PL + k + 1];
-    }     //bis hier alles ok
+/*****
+  Purpose: void AltNoiseBlanking(
+  Parameter list:
+    float *insamp         audio samples, restored in place
+    int Nsam              number of samples, NB_FFT_SIZE
+    float *E              not used
+  Return value;
+    void
 
-    for (int i = 0; i < impulse_length; i++) //now we calculate the forward and backward predictions
-    {
-      arm_dot_prod_f32(&reverse_lpcs[0], &Rfw[i], order, &Rfw[i + order]);
-      arm_dot_prod_f32(&lpcs[1], &Rbw[impulse_length - i], order, &Rbw[impulse_length - i - 1]);
+  Same LPC impulse blanker as the original, but gated and allocation free.  The working set is
+  in static buffers, the prediction cross fade windows are made only when the impulse length changes, and blocks that
+  NBImpulseSuspected() clears skip the LPC analysis and restoration.  nbBlocks, nbBlocksAnalysed, nbBlocksBlanked,
+  nbImpulses, and nbCycles count the work and are printed by DSPTimingReport().
+*****/
+void AltNoiseBlanking(float* insamp, int Nsam, float* E )
+{
+  uint32_t start = ARM_DWT_CYCCNT;
+  int order = NB_taps;
+  int length = NB_impulse_samples;
+  int impulses;
+
+  if (order > NB_ORDER_MAX) order = NB_ORDER_MAX;
+  if (length > NB_IMPULSE_MAX) length = NB_IMPULSE_MAX;
+  if (length != nbWindowLength) {
+    for (int i = 0; i < length; i++) {
+      nbWbw[i] = 1.0 * i / (length - 1);
+      nbWfw[length - i - 1] = nbWbw[i];
     }
-    arm_mult_f32(&Wfw[0], &Rfw[order], &Rfw[order], impulse_length); // do the windowing, or better: weighing
-    arm_mult_f32(&Wbw[0], &Rbw[0], &Rbw[0], impulse_length);
+    nbWindowLength = length;
+  }
 
-#ifdef debug_alternate_NR
-    // in debug mode do the restoration only in some cases
-    if (((nr_setting > 0) && (nr_setting < 6)) || ((nr_setting > 10) && (nr_setting < 16)))
-    {
-      // just let the distortion pass at setting 1...5 and 11...15
-      //    arm_add_f32(&Rfw[order],&Rbw[0],&insamp[impulse_positions[j]-PL],impulse_length);
-    } else {
-      //finally add the two weighted predictions and insert them into the original signal - thereby eliminating the distortion
-      arm_add_f32(&Rfw[order], &Rbw[0], &insamp[impulse_positions[j] - PL], impulse_length);
+  nbBlocks++;
+  if (NB_test != 0 || NBImpulseSuspected(insamp, Nsam)) {
+    nbBlocksAnalysed++;
+    impulses = NBRestore(insamp, Nsam, order, length);
+    if (impulses > 0) {
+      nbBlocksBlanked++;
+      nbImpulses += impulses;
     }
-#else
-    //finally add the two weighted predictions and insert them into the original signal - thereby eliminating the distortion
-    arm_add_f32(&Rfw[order], &Rbw[0], &insamp[impulse_positions[j] - PL], impulse_length);
-
-#endif
   }
 
-  for (int p = 0; p < (order + PL); p++)
-  {
-    last_frame_end[p] = insamp[NB_FFT_SIZE - 1 - order - PL + p]; // store 13 samples from the current frame to use at the next frame
+  for (int p = 0; p < (order + (length - 1) / 2); p++) {
+    nbLastFrameEnd[p] = insamp[Nsam - 1 - order - (length - 1) / 2 + p];  // Kept for every block, gated or not
   }
-  //end of test timing zone
+  nbCycles += ARM_DWT_CYCCNT - start;
 }
 
 void CalcNotchBins()
 {
-  bin_BW =  SR[SampleRate].rate / 16; // sample rate/2/8
+  bin_BW = decimatedRate / FFT_length;  // Bin width of the 512 point convolution FFT
   // calculate notch centre bin for FFT512
   notchCenterBin = roundf(notchFreq / bin_BW);
   // calculate bins  for deletion of bins in the iFFT_buffer
@@ -304,11 +277,157 @@ void CalcNotchBins()
 
 // ================= AGC
 
+int agcPeakIndex[RB_SIZE];  // abs_ring positions that can still become the window maximum, values falling from the head
+int agcPeakHead = 0;        // Oldest candidate, the current ring_max
+int agcPeakCount = 0;
+
+/*****
+  Purpose: Add the newest look-ahead sample to the AGC peak detector.  Candidates that are not larger than the new
+           sample can never be the window maximum again, so they are dropped from the tail.  Each sample is added and
+           dropped once, so the cost is O(1) per sample averaged over the block.
+  Parameter list:
+    int k         abs_ring position of the new sample
+  Return value;
+    void
+*****/
+static inline void AGCPeakPush(int k)
+{
+  float32_t value = abs_ring[k];
+  int tail;
+
+  while (agcPeakCount > 0) {
+    tail = agcPeakHead + agcPeakCount - 1;
+    if (tail >= RB_SIZE) tail -= RB_SIZE;
+    if (abs_ring[agcPeakIndex[tail]] > value) {
+      break;
+    }
+    agcPeakCount--;
+  }
+  tail = agcPeakHead + agcPeakCount;
+  if (tail >= RB_SIZE) tail -= RB_SIZE;
+  agcPeakIndex[tail] = k;
+  agcPeakCount++;
+}
+
+/*****
+  Purpose: Sliding window maximum of abs_ring over the attack look-ahead, out_index + 1 to in_index.  Call once per
+           sample after the new sample is in abs_ring[in_index].  Gives the same ring_max as a rescan of the window.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void AGCPeakUpdate()
+{
+  if (agcPeakCount > 0 && agcPeakIndex[agcPeakHead] == out_index) {  // The oldest sample has left the window
+    if (++agcPeakHead >= RB_SIZE) agcPeakHead = 0;
+    agcPeakCount--;
+  }
+  AGCPeakPush(in_index);
+  ring_max = abs_ring[agcPeakIndex[agcPeakHead]];
+}
+
+/*****
+  Purpose: Reload the AGC peak detector from the samples now in the look-ahead window.  Needed when
+           AGCLoadValues() moves in_index.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void AGCPeakReset()
+{
+  int k = out_index;
+
+  agcPeakHead = 0;
+  agcPeakCount = 0;
+  for (int j = 0; j < attack_buffsize; j++) {
+    if (++k >= (int)ring_buffsize) k = 0;
+    AGCPeakPush(k);
+  }
+  ring_max = abs_ring[agcPeakIndex[agcPeakHead]];
+}
+
+float32_t agcLastMult = 0.0;   // Gain at the end of the last AGC sub-block
+float32_t agcLastVolts = 0.0;  // volts at the end of the last AGC sub-block, 0 to start without a ramp
+float32_t agcSubblockVolts[AGC_GAIN_SUBBLOCK];  // volts for each sample of the current sub-block
+#ifdef AGC_GAIN_REFERENCE
+bool agcPerSampleGain = true;   // The original AGC, the gain law for every sample
+#else
+bool agcPerSampleGain = false;  // The gain law once per sub-block, ramped in between
+#endif
+
+/*****
+  Purpose: The AGC gain law, the gain that brings a signal at volts to out_target.
+  Parameter list:
+    float32_t v     AGC detector level, at least min_volts
+  Return value;
+    float32_t       gain
+*****/
+static inline float32_t AGCGain(float32_t v)
+{
+  return (out_target - slope_constant * min (0.0, log10f_fast(inv_max_input * v))) / v;
+}
+
+/*****
+  Purpose: Scale one AGC sub-block.  The gain law is only evaluated at the end of the sub-block, and the gain is
+           ramped linearly from the end of the last sub-block, so every sample still gets its own gain.  volts
+           changes slowly compared with AGC_GAIN_SUBBLOCK samples at 24K, so the log and the division are done 16
+           times less often.
+
+           The gain law falls as volts rises, and no faster than 1 / volts.  So while volts stays within a ratio of
+           AGC_GAIN_RAMP_RATIO over the sub-block and the end of the last one, the ramp and the per-sample law both
+           lie between the gains at the ends of that range and differ by less than AGC_GAIN_RAMP_RATIO - 1.  When
+           volts moves further, as in an attack, the sub-block gets the per-sample law instead.
+  Parameter list:
+    float32_t *buffer     AGC_GAIN_SUBBLOCK interleaved I/Q samples, scaled in place
+  Return value;
+    void
+*****/
+void AGCApplyGain(float32_t *buffer)
+{
+  float32_t ramp[2 * AGC_GAIN_SUBBLOCK];
+  float32_t lastVolts = agcSubblockVolts[AGC_GAIN_SUBBLOCK - 1];
+  float32_t vMin, vMax;
+  float32_t step;
+  float32_t m;
+  uint32_t index;
+
+  if (agcLastVolts <= 0.0) {
+    agcLastVolts = lastVolts;
+    agcLastMult = AGCGain(lastVolts);
+  }
+  arm_min_f32(agcSubblockVolts, AGC_GAIN_SUBBLOCK, &vMin, &index);
+  arm_max_f32(agcSubblockVolts, AGC_GAIN_SUBBLOCK, &vMax, &index);
+  vMin = min(vMin, agcLastVolts);
+  vMax = max(vMax, agcLastVolts);
+
+  if (vMax > AGC_GAIN_RAMP_RATIO * vMin) {
+    for (int j = 0; j < AGC_GAIN_SUBBLOCK; j++) {
+      m = AGCGain(agcSubblockVolts[j]);
+      ramp[2 * j + 0] = m;
+      ramp[2 * j + 1] = m;
+    }
+  } else {
+    m = AGCGain(lastVolts);
+    step = (m - agcLastMult) / AGC_GAIN_SUBBLOCK;
+    m = agcLastMult;
+    for (int j = 0; j < AGC_GAIN_SUBBLOCK; j++) {
+      m += step;
+      ramp[2 * j + 0] = m;  // Same gain for I and Q
+      ramp[2 * j + 1] = m;
+    }
+  }
+  arm_mult_f32(buffer, ramp, buffer, 2 * AGC_GAIN_SUBBLOCK);
+  agcLastMult = m;
+  agcLastVolts = lastVolts;
+}
+
 // G0ORX broke this code out so can be called from other places
 
 void AGCLoadValues() {
   float32_t tmp;
-  float32_t sample_rate = (float32_t)SR[SampleRate].rate / DF;
+  float32_t sample_rate = decimatedRate;
 
   //calculate internal parameters
   switch (EEPROMData.AGCMode)
@@ -373,6 +492,8 @@ void AGCLoadValues() {
   onemhang_backmult = 1.0 - hang_backmult;
 
   hang_decay_mult = 1.0 - expf(-1.0 / (sample_rate * tau_hang_decay));
+  AGCPeakReset();
+  agcLastVolts = 0.0;  // The gain law may have changed, so do not ramp from the old gain
 }
 
 /*****
@@ -423,9 +544,8 @@ void AGCThresholdChanged() {
 *****/
 void AGC()
 {
-
-  int k;
   float32_t mult;
+
   if (EEPROMData.AGCMode == 0)  // AGC OFF
   {
     for (unsigned i = 0; i < FFT_length / 2; i++)
@@ -456,20 +576,7 @@ void AGC()
     fast_backaverage = fast_backmult * abs_out_sample + onemfast_backmult * fast_backaverage;
     hang_backaverage = hang_backmult * abs_out_sample + onemhang_backmult * hang_backaverage;
 
-    if ((abs_out_sample >= ring_max) && (abs_out_sample > 0.0))
-    {
-      ring_max = 0.0;
-      k = out_index;
-      for (int j = 0; j < attack_buffsize; j++)
-      {
-        if (++k == (int)ring_buffsize)
-          k = 0;
-        if (abs_ring[k] > ring_max)
-          ring_max = abs_ring[k];
-      }
-    }
-    if (abs_ring[in_index] > ring_max)
-      ring_max = abs_ring[in_index];
+    AGCPeakUpdate();
 
     if (hang_counter > 0)
       --hang_counter;
@@ -486,7 +593,7 @@ void AGC()
           } else {
             if (hang_enable && (hang_backaverage > hang_level)) {
               state = 2;
-              hang_counter = (int)(hangtime * SR[SampleRate].rate / DF);
+              hang_counter = (int)(hangtime * decimatedRate);
               decay_type = 1;
             } else {
               state = 3;
@@ -560,13 +667,18 @@ void AGC()
       agc_action = 1;                           // LED indicator for AGC action
     }
 
-    //#ifdef USE_LOG10FAST
-    mult = (out_target - slope_constant * min (0.0, log10f_fast(inv_max_input * volts))) / volts;
-    //#else
-    //  mult = (out_target - slope_constant * min (0.0, log10f(inv_max_input * volts))) / volts;
-    //#endif
-    iFFT_buffer[FFT_length + 2 * i + 0] = out_sample[0] * mult;
-    iFFT_buffer[FFT_length + 2 * i + 1] = out_sample[1] * mult;
+    if (agcPerSampleGain) {
+      mult = AGCGain(volts);
+      iFFT_buffer[FFT_length + 2 * i + 0] = out_sample[0] * mult;
+      iFFT_buffer[FFT_length + 2 * i + 1] = out_sample[1] * mult;
+    } else {
+      iFFT_buffer[FFT_length + 2 * i + 0] = out_sample[0];  // Scaled a sub-block at a time
+      iFFT_buffer[FFT_length + 2 * i + 1] = out_sample[1];
+      agcSubblockVolts[i % AGC_GAIN_SUBBLOCK] = volts;
+      if ((i + 1) % AGC_GAIN_SUBBLOCK == 0) {
+        AGCApplyGain(&iFFT_buffer[FFT_length + 2 * (i + 1 - AGC_GAIN_SUBBLOCK)]);
+      }
+    }
   }
 }
 
@@ -788,3 +900,118 @@ void SetCompressionRelease()
   }
   EraseMenus();
 }
+
+
+/*****
+  Purpose: Receive front end, per-stage reference version.  This is the original sequence of passes over the
+           I and Q buffers: RF gain, DC high pass, band RF gain, IQ amplitude and phase correction.
+           Selected with FRONT_END_REFERENCE, and checked against ReceiveFrontEnd() by host/tests/FrontEnd.cpp.
+  Parameter list:
+    float32_t *I_buffer     the I (L) channel, modified in place
+    float32_t *Q_buffer     the Q (R) channel, modified in place
+    uint32_t blocksize      number of samples in each buffer
+  Return value;
+    void
+*****/
+void ReceiveFrontEndReference(float32_t *I_buffer, float32_t *Q_buffer, uint32_t blocksize) {
+  float rfGainValue;
+
+  //  Set RFGain for all bands.
+  rfGainValue = pow(10, (float)EEPROMData.rfGainAllBands / 20);
+  arm_scale_f32(I_buffer, rfGainValue, I_buffer, blocksize);  //AFP 09-27-22
+  arm_scale_f32(Q_buffer, rfGainValue, Q_buffer, blocksize);  //AFP 09-27-22
+
+  arm_biquad_cascade_df2T_f32(&s1_Receive2, I_buffer, I_buffer, blocksize);  //AFP 11-03-22
+  arm_biquad_cascade_df2T_f32(&s1_Receive2, Q_buffer, Q_buffer, blocksize);  //AFP 11-03-22
+
+  // Scale the data buffers by the RFgain value defined in bands[EEPROMData.currentBand] structure
+  arm_scale_f32(I_buffer, bands[EEPROMData.currentBand].RFgain, I_buffer, blocksize);  //AFP 09-23-22
+  arm_scale_f32(Q_buffer, bands[EEPROMData.currentBand].RFgain, Q_buffer, blocksize);  //AFP 09-23-22
+
+  // Manual IQ amplitude correction
+  // to be honest: we only correct the amplitude of the I channel ;-)
+  if (bands[EEPROMData.currentBand].mode == DEMOD_LSB || bands[EEPROMData.currentBand].mode == DEMOD_AM || bands[EEPROMData.currentBand].mode == DEMOD_SAM) {
+    arm_scale_f32(I_buffer, -EEPROMData.IQAmpCorrectionFactor[EEPROMData.currentBand], I_buffer, blocksize);  //AFP 04-14-22
+    IQPhaseCorrection(I_buffer, Q_buffer, EEPROMData.IQPhaseCorrectionFactor[EEPROMData.currentBand], blocksize);
+  } else {
+    if (bands[EEPROMData.currentBand].mode == DEMOD_USB || bands[EEPROMData.currentBand].mode == DEMOD_AM || bands[EEPROMData.currentBand].mode == DEMOD_SAM) {
+      arm_scale_f32(I_buffer, -EEPROMData.IQAmpCorrectionFactor[EEPROMData.currentBand], I_buffer, blocksize);  //AFP 04-14-22
+      IQPhaseCorrection(I_buffer, Q_buffer, EEPROMData.IQPhaseCorrectionFactor[EEPROMData.currentBand], blocksize);
+    }
+  }
+}
+
+
+float32_t frontEndState[2] = { 0, 0 };  // DC high pass state for ReceiveFrontEnd()
+int frontEndRFGaindB = -1000;           // rfGainAllBands the cached linear gain was computed for
+float32_t frontEndRFGain = 1.0;
+
+/*****
+  Purpose: Receive front end, fused version.  Does the work of ReceiveFrontEndReference() in one pass over the
+           I buffer and one pass over the Q buffer.  The filter is linear, so the RF gain, band gain and IQ amplitude
+           correction are combined into one gain per channel and applied to the filter output.  The
+           IQ phase correction is done in the Q pass, so the temporary buffer of IQPhaseCorrection() is not needed.
+           pow() is only called when the RF gain setting changes.
+
+           The reference runs the I and then the Q channel through the one s1_Receive2 state, so this does
+           the same to give the same result.
+  Parameter list:
+    float32_t *I_buffer     the I (L) channel, modified in place
+    float32_t *Q_buffer     the Q (R) channel, modified in place
+    uint32_t blocksize      number of samples in each buffer
+  Return value;
+    void
+*****/
+void ReceiveFrontEnd(float32_t *I_buffer, float32_t *Q_buffer, uint32_t blocksize) {
+  const float32_t b0 = HP_DC_Filter_Coeffs2[0];
+  const float32_t b1 = HP_DC_Filter_Coeffs2[1];
+  const float32_t b2 = HP_DC_Filter_Coeffs2[2];
+  const float32_t a1 = HP_DC_Filter_Coeffs2[3];
+  const float32_t a2 = HP_DC_Filter_Coeffs2[4];
+  float32_t d1 = frontEndState[0];
+  float32_t d2 = frontEndState[1];
+  float32_t gainI, gainQ, phase = 0.0;
+  float32_t x, y;
+  int mode = bands[EEPROMData.currentBand].mode;
+
+  if (EEPROMData.rfGainAllBands != frontEndRFGaindB) {
+    frontEndRFGaindB = EEPROMData.rfGainAllBands;
+    frontEndRFGain = pow(10, (float)frontEndRFGaindB / 20);
+  }
+  gainQ = frontEndRFGain * bands[EEPROMData.currentBand].RFgain;
+  gainI = gainQ;
+  if (mode == DEMOD_LSB || mode == DEMOD_USB || mode == DEMOD_AM || mode == DEMOD_SAM) {
+    gainI = -gainQ * EEPROMData.IQAmpCorrectionFactor[EEPROMData.currentBand];
+    phase = EEPROMData.IQPhaseCorrectionFactor[EEPROMData.currentBand];
+  }
+
+  for (uint32_t i = 0; i < blocksize; i++) {  // I pass: filter and gain
+    x = I_buffer[i];
+    y = b0 * x + d1;
+    d1 = b1 * x + a1 * y + d2;
+    d2 = b2 * x + a2 * y;
+    I_buffer[i] = gainI * y;
+  }
+
+  if (phase < 0.0) {  // Q pass: filter, gain, and mix a bit of I into Q
+    for (uint32_t i = 0; i < blocksize; i++) {
+      x = Q_buffer[i];
+      y = b0 * x + d1;
+      d1 = b1 * x + a1 * y + d2;
+      d2 = b2 * x + a2 * y;
+      Q_buffer[i] = gainQ * y + phase * I_buffer[i];
+    }
+  } else {  // Q pass: filter, gain, and mix a bit of Q into I
+    for (uint32_t i = 0; i < blocksize; i++) {
+      x = Q_buffer[i];
+      y = b0 * x + d1;
+      d1 = b1 * x + a1 * y + d2;
+      d2 = b2 * x + a2 * y;
+      Q_buffer[i] = gainQ * y;
+      I_buffer[i] += phase * Q_buffer[i];
+    }
+  }
+  frontEndState[0] = d1;
+  frontEndState[1] = d2;
+}
+
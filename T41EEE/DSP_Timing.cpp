@@ -0,0 +1,140 @@
+#ifndef BEENHERE
+#include "SDT.h"
+#endif
+
+// Receive DSP stage timing.  Uncomment DSP_TIMING in DebugConfiguration.h to use.
+// The stages are bracketed in ProcessIQData() with DSP_TIMING_START() and DSP_TIMING_STOP().  With DSP_TIMING
+// undefined the macros compile to nothing and the receive chain is not affected.
+
+struct dspTiming_t dspTiming[DSP_TIMING_STAGES];
+uint32_t dspTimingBlocks = 0;
+
+const char *dspTimingNames[DSP_TIMING_STAGES] = { "Total", "Front end", "Freq shift", "Decimate", "Convolve",
+                                                  "AGC", "Demod", "NR", "CW", "Output", "Spectrum",
+                                                  "Skimmer", "RTTY" };
+
+/*****
+  Purpose: Clear the stage timing accumulators and make sure the cycle counter is running
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void DSPTimingInit() {
+  ARM_DEMCR |= ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+  for (int i = 0; i < DSP_TIMING_STAGES; i++) {
+    dspTiming[i].start = 0;
+    dspTiming[i].minCycles = 0xFFFFFFFF;
+    dspTiming[i].maxCycles = 0;
+    dspTiming[i].sumCycles = 0;
+    dspTiming[i].count = 0;
+  }
+  dspTimingBlocks = 0;
+}
+
+/*****
+  Purpose: Accumulate the cycles used by one stage since its DSP_TIMING_START()
+
+  Parameter list:
+    int stage         one of the DSP_TIMING_ stage indexes
+
+  Return value;
+    void
+*****/
+void DSPTimingStop(int stage) {
+  uint32_t cycles = ARM_DWT_CYCCNT - dspTiming[stage].start;  // Unsigned math handles counter wrap
+
+  if (cycles < dspTiming[stage].minCycles) dspTiming[stage].minCycles = cycles;
+  if (cycles > dspTiming[stage].maxCycles) dspTiming[stage].maxCycles = cycles;
+  dspTiming[stage].sumCycles += cycles;
+  dspTiming[stage].count++;
+  if (stage == DSP_TIMING_TOTAL) {
+    dspTimingBlocks++;
+  }
+}
+
+/*****
+  Purpose: Print min/max microseconds per call and mean microseconds per block for each stage, the share of
+           the real time block budget each stage uses and the mean cycles per input sample, and the estimated end
+           to end audio latency, then start a new interval.  With CONVOLUTION_BENCHMARK each interval runs the next
+           convolution FFT size, so the reports compare latency and load for all four.
+           Called once per loop(); it only prints after DSP_TIMING_REPORT_BLOCKS blocks.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void DSPTimingReport() {
+  float32_t cyclesPerMicro;
+  float32_t blockMicros;
+  float32_t meanMicros;
+  float32_t rate;
+  float32_t filterMicros;
+  float32_t processMicros;
+
+  if (dspTimingBlocks < DSP_TIMING_REPORT_BLOCKS) {
+    return;
+  }
+  cyclesPerMicro = (float32_t)F_CPU_ACTUAL / 1000000.0;
+  blockMicros = 1000000.0 * BUFFER_SIZE * N_BLOCKS / (float32_t)SR[SampleRate].rate;  // Real time available per block
+
+  Serial.printf("DSP timing, %lu blocks, %.0f us per block available\n", dspTimingBlocks, blockMicros);
+  Serial.printf("Scheduler: %lu blocks, %lu deadline misses, %lu overruns, deepest queue %lu buffers\n",
+                dspBlocksProcessed, dspDeadlineMisses, dspOverruns, dspMaxQueued);
+  Serial.printf("Filter mask cache: %lu hits, %lu misses\n", filterMaskHits, filterMaskMisses);
+  if (nbBlocks > 0) {
+    Serial.printf("Noise blanker: %lu blocks, %lu analysed, %lu blanked, %lu impulses, %.1f us/block\n",
+                  nbBlocks, nbBlocksAnalysed, nbBlocksBlanked, nbImpulses, (float32_t)nbCycles / nbBlocks / cyclesPerMicro);
+    nbBlocks = nbBlocksAnalysed = nbBlocksBlanked = nbImpulses = 0;
+    nbCycles = 0;
+  }
+  if (skimHops > 0) {
+    int active = 0;
+    for (int i = 0; i < SKIM_CHANNELS; i++) {
+      if (cwSkimChannels[i].bin >= 0) active++;
+    }
+    Serial.printf("CW skimmer: %d of %d channels active, %.1f us per channelizer FFT\n", active, SKIM_CHANNELS,
+                  (float32_t)skimCycles / skimHops / cyclesPerMicro);
+    skimHops = 0;
+    skimCycles = 0;
+  }
+  if (rttyBlocks > 0) {
+    Serial.printf("RTTY decoder: %.1f us per block, %.1f us max, %lu of %lu blocks over the %.1f us budget\n",
+                  (float32_t)rttyCycles / rttyBlocks / cyclesPerMicro, rttyMaxCycles / cyclesPerMicro, rttyOverBudget,
+                  rttyBlocks, RTTY_CYCLE_BUDGET / cyclesPerMicro);
+    rttyBlocks = rttyMaxCycles = rttyOverBudget = 0;
+    rttyCycles = 0;
+  }
+  Serial.printf("%-11s %9s %9s %9s %7s %9s\n", "Stage", "min us", "us/block", "max us", "load %", "cyc/smp");
+  for (int i = 0; i < DSP_TIMING_STAGES; i++) {
+    if (dspTiming[i].count == 0) {  // Stage was not used in this interval.
+      continue;
+    }
+    meanMicros = (float32_t)dspTiming[i].sumCycles / dspTimingBlocks / cyclesPerMicro;  // Some stages do not run every block
+    Serial.printf("%-11s %9.1f %9.1f %9.1f %7.1f %9.2f\n", dspTimingNames[i],
+                  dspTiming[i].minCycles / cyclesPerMicro, meanMicros, dspTiming[i].maxCycles / cyclesPerMicro,
+                  100.0 * meanMicros / blockMicros, meanMicros * cyclesPerMicro / (BUFFER_SIZE * N_BLOCKS));  // Per input sample
+  }
+
+  // End to end audio latency estimate: one block to fill the input queues, the processing time, the group delay of
+  // the decimation, convolution, and interpolation filters, and one block to play out of the output queues.
+  rate = (float32_t)SR[SampleRate].rate;
+  filterMicros = 1000000.0 * ((n_dec2_taps - 1) / 2.0 / (rate / DF1) + (m_NumTaps - 1) / 2.0 / (rate / DF) + (48 - 1) / 2.0 / (rate / DF1));
+  if (DF1 > 1.0) {  // No first decimation or last interpolation stage at 48K
+    filterMicros += 1000000.0 * ((n_dec1_taps - 1) / 2.0 / rate + (32 - 1) / 2.0 / rate);
+  }
+  processMicros = (float32_t)dspTiming[DSP_TIMING_TOTAL].sumCycles / dspTimingBlocks / cyclesPerMicro;
+  Serial.printf("Convolution %lu points, %lu taps: latency %.1f ms (blocks %.1f, filters %.1f, processing %.1f), load %.1f %%\n",
+                convFFTLength, m_NumTaps, (2.0 * blockMicros + filterMicros + processMicros) / 1000.0,
+                2.0 * blockMicros / 1000.0, filterMicros / 1000.0, processMicros / 1000.0, 100.0 * processMicros / blockMicros);
+  dspMaxQueued = 0;
+  DSPTimingInit();
+#ifdef CONVOLUTION_BENCHMARK
+  SetConvolutionSize(convFFTLength == 2048 ? 256 : convFFTLength * 2);  // Step through the sizes, one per report
+#endif
+}
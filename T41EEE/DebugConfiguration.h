@@ -0,0 +1,10 @@
+
+//====================== Developer Switches =============
+// Measurement switches, and the reference versions of sped up receive DSP stages for A/B listening.  Leave these
+// commented out in a normal build.  The DSP regression checks run on a Linux host instead, see host/ and README.md.
+
+//#define DSP_TIMING                                                        // Uncomment to print receive DSP stage timing to the Serial port
+//#define CONVOLUTION_BENCHMARK                                             // With DSP_TIMING, step through the convolution FFT sizes once per report
+//#define FRONT_END_REFERENCE                                               // Uncomment to use the original per-stage receive front end
+//#define DECIMATE_REFERENCE                                                // Uncomment to use the original arm_fir_decimate_f32() receive decimators
+//#define AGC_GAIN_REFERENCE                                                // Uncomment to start with the AGC gain law evaluated for every sample
@@ -12,9 +12,82 @@ float32_t phzerror = 0.0;
 float32_t det = 0.0;
 float32_t fil_out = 0.0;
 float32_t SAM_carrier = 0.0;                 //AFP 11-02-22
-float32_t SAM_lowpass = 2700.0;              //AFP 11-02-22
-float32_t SAM_carrier_freq_offset = 0.0;     //AFP 11-02-22
-float32_t SAM_carrier_freq_offsetOld = 0.0;  //AFP 11-02-22
+float32_t samCos = 1.0;                      // PLL oscillator, cos and sin of phzerror
+float32_t samSin = 0.0;
+float32_t samAtanTable[SAM_ATAN_TABLE_SIZE + 1];  // atan(z) for z from 0 to 1
+struct samStatus_t samStatus;                // Carrier offset for the display, written once per block
+
+// PLL and fade leveler coefficients.  These only change with omegaN, pll_fmax, and the decimated rate, so they are
+// worked out by SAMLoadValues() instead of on every block.
+struct {
+  float32_t g1;
+  float32_t g2;
+  float32_t omega_min;
+  float32_t omega_max;
+  float32_t mtauR;
+  float32_t onem_mtauR;
+  float32_t mtauI;
+  float32_t onem_mtauI;
+} samCoefficients;
+
+/*****
+  Purpose: Work out the SAM PLL and fade leveler coefficients and the phase detector arctangent table.
+           Call after the decimated rate, omegaN, or pll_fmax changes.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void SAMLoadValues() {
+  const float32_t zeta = 0.65;  // PLL step response: smaller, slower response 1.0 - 0.1
+  const float32_t samplePeriod = 1.0 / decimatedRate;
+  const float32_t tauR = 0.02;  // original 0.02;
+  const float32_t tauI = 1.4;   // original 1.4;
+
+  samCoefficients.g1 = 1.0 - exp(-2.0 * EEPROMData.omegaN * zeta * samplePeriod);
+  samCoefficients.g2 = -samCoefficients.g1 + 2.0 * (1 - exp(-EEPROMData.omegaN * zeta * samplePeriod) * cosf(EEPROMData.omegaN * samplePeriod * sqrtf(1.0 - zeta * zeta)));
+  samCoefficients.omega_min = TWO_PI * -EEPROMData.pll_fmax * samplePeriod;
+  samCoefficients.omega_max = TWO_PI * EEPROMData.pll_fmax * samplePeriod;
+  samCoefficients.mtauR = exp(-samplePeriod / tauR);  // WDSP: exp(-1 / (rate * tauR))
+  samCoefficients.onem_mtauR = 1.0 - samCoefficients.mtauR;
+  samCoefficients.mtauI = exp(-samplePeriod / tauI);
+  samCoefficients.onem_mtauI = 1.0 - samCoefficients.mtauI;
+
+  for (int i = 0; i <= SAM_ATAN_TABLE_SIZE; i++) {
+    samAtanTable[i] = atanf((float32_t)i / SAM_ATAN_TABLE_SIZE);
+  }
+}
+
+/*****
+  Purpose: Phase detector arctangent.  One division, then atan() of the ratio from a table with linear
+           interpolation, folded out to the full circle.  Error is below 2e-5 radians.
+  Parameter list:
+    float32_t y     imaginary part
+    float32_t x     real part
+  Return value;
+    float32_t       angle, -PI to PI
+*****/
+static inline float32_t SAMAtan2(float32_t y, float32_t x) {
+  float32_t ax = fabsf(x);
+  float32_t ay = fabsf(y);
+  float32_t z, angle;
+  int index;
+
+  if (ax == 0.0 && ay == 0.0) {
+    return 0.0;
+  }
+  z = (ay <= ax) ? ay / ax : ax / ay;  // 0 to 1
+  z *= SAM_ATAN_TABLE_SIZE;
+  index = (int)z;
+  if (index >= SAM_ATAN_TABLE_SIZE) {
+    index = SAM_ATAN_TABLE_SIZE - 1;
+  }
+  angle = samAtanTable[index] + (z - index) * (samAtanTable[index + 1] - samAtanTable[index]);
+  if (ay > ax) angle = HALF_PI - angle;
+  if (x < 0.0) angle = PI - angle;
+  if (y < 0.0) angle = -angle;
+  return angle;
+}
 
 /*****  AFP 11-03-22
   Purpose: AMDecodeSAM()
@@ -26,33 +99,27 @@ float32_t SAM_carrier_freq_offsetOld = 0.0;  //AFP 11-02-22
   This algorithm works best of those implemented.
       // taken from Warren Pratt´s WDSP, 2016
   // http://svn.tapr.org/repos_sdr_hpsdr/trunk/W5WC/PowerSDR_HPSDR_mRX_PS/Source/wdsp/
+  The oscillator is advanced by rotating samCos/samSin by the loop filter output, with the sine and cosine of that
+  small step from a short series, and the phase detector uses SAMAtan2().  This removes the per-sample sin, cos,
+  and atan2.  The carrier offset is left in samStatus for ShowSAMStatus(), nothing is
+  drawn from the audio path.
 *****/
 void AMDecodeSAM() {
-
-  int zeta_help = 65;
-  float32_t zeta = (float32_t)zeta_help / 100.0;  // PLL step response: smaller, slower response 1.0 - 0.1
-  float32_t g1 = 1.0 - exp(-2.0 * EEPROMData.omegaN * zeta * 1 / 24000);
-  float32_t g2 = -g1 + 2.0 * (1 - exp(-EEPROMData.omegaN * zeta * 1 / 24000) * cosf(EEPROMData.omegaN * 1 / 24000 * sqrtf(1.0 - zeta * zeta)));
-  const float32_t omega_min = TWO_PI * -EEPROMData.pll_fmax * 1 / 24000;
-  const float32_t omega_max = TWO_PI * EEPROMData.pll_fmax * 1 / 24000;
-  const float32_t tauR = 0.02;  // original 0.02;
-  const float32_t tauI = 1.4;   // original 1.4;
-  float32_t mtauR = exp(-1 / 24000 * tauR);
-  float32_t onem_mtauR = 1.0 - mtauR;
-  float32_t mtauI = exp(-1 / 24000 * tauI);
-  float32_t onem_mtauI = 1.0 - mtauI;
+  const float32_t g1 = samCoefficients.g1;
+  const float32_t g2 = samCoefficients.g2;
+  const float32_t omega_min = samCoefficients.omega_min;
+  const float32_t omega_max = samCoefficients.omega_max;
+  const float32_t mtauR = samCoefficients.mtauR;
+  const float32_t onem_mtauR = samCoefficients.onem_mtauR;
+  const float32_t mtauI = samCoefficients.mtauI;
+  const float32_t onem_mtauI = samCoefficients.onem_mtauI;
   uint8_t fade_leveler = 1;
   float32_t Sin, Cos;
-
-  tft.setFontScale((enum RA8875tsize)0);
-  tft.fillRect(OPERATION_STATS_X + 160, FREQUENCY_Y + 30, tft.getFontWidth() * 11, tft.getFontHeight(), RA8875_BLUE);  // AFP 11-01-22 Clear top-left menu area
-  tft.setCursor(OPERATION_STATS_X + 160, FREQUENCY_Y + 30);                                                            // AFP 11-01-22
-  tft.setTextColor(RA8875_WHITE);
-  tft.print("(SAM) ");  //AFP 11-01-22
+  float32_t step2, stepSin, stepCos, oscTemp;
 
   for (unsigned i = 0; i < FFT_length / 2; i++) {
-    Sin = arm_sin_f32(phzerror);
-    Cos = arm_cos_f32(phzerror);
+    Sin = samSin;
+    Cos = samCos;
     ai = Cos * iFFT_buffer[FFT_length + i * 2];
     bi = Sin * iFFT_buffer[FFT_length + i * 2];
     aq = Cos * iFFT_buffer[FFT_length + i * 2 + 1];
@@ -76,35 +143,31 @@ void AMDecodeSAM() {
     }
     float_buffer_R[i] = audiou;
 
-    det = ApproxAtan2(corr[1], corr[0]);
+    det = SAMAtan2(corr[1], corr[0]);
 
     del_out = fil_out;
     omega2 = omega2 + g2 * det;
     if (omega2 < omega_min) omega2 = omega_min;
     else if (omega2 > omega_max) omega2 = omega_max;
     fil_out = g1 * det + omega2;
-    phzerror = phzerror + del_out;
-
-    //Wrap round 2PI, modulus
-    while (phzerror >= TWO_PI) phzerror -= TWO_PI;
-    while (phzerror < 0.0) phzerror += TWO_PI;
+    // Rotate the oscillator by del_out.  The step is at most omega_max plus g1 * PI, well under a radian with the
+    // default pll_fmax, so the series are good to float precision.
+    step2 = del_out * del_out;
+    stepSin = del_out * (1.0 - step2 / 6.0 * (1.0 - step2 / 20.0 * (1.0 - step2 / 42.0)));
+    stepCos = 1.0 - step2 / 2.0 * (1.0 - step2 / 12.0 * (1.0 - step2 / 30.0));
+    oscTemp = samCos * stepCos - samSin * stepSin;
+    samSin = samSin * stepCos + samCos * stepSin;
+    samCos = oscTemp;
+    oscTemp = 1.5 - 0.5 * (samCos * samCos + samSin * samSin);  // Hold the amplitude at 1
+    samCos *= oscTemp;
+    samSin *= oscTemp;
   }
 
-  // In the small frequency display
-  // we calculate carrier offset here and the display function is
-  // then called in main loop every 100ms.
-  // To make this smoother, a simple lowpass/exponential averager here . . .
-  SAM_carrier = 0.08 * (omega2 * 24000) / (2 * TWO_PI);
-  SAM_carrier = SAM_carrier + 0.92 * SAM_lowpass;
-  SAM_carrier_freq_offset = (int)10 * SAM_carrier;
-  SAM_carrier_freq_offset = 0.9 * SAM_carrier_freq_offsetOld + 0.1 * SAM_carrier_freq_offset;
-  SAM_lowpass = SAM_carrier;
-
-  if (SAM_carrier_freq_offset != SAM_carrier_freq_offsetOld) {
-    tft.fillRect(OPERATION_STATS_X + 200, FREQUENCY_Y + 30, tft.getFontWidth() * 8, tft.getFontHeight(), RA8875_BLUE);
-    tft.print(0.20024 * SAM_carrier_freq_offset, 1);  //AFP 11-01-22
-  }
-  SAM_carrier_freq_offsetOld = SAM_carrier_freq_offset;
+  // Carrier offset for the small frequency display, smoothed with a simple lowpass/exponential averager.  The
+  // display reads it at its own rate.
+  SAM_carrier = 0.08 * (omega2 * decimatedRate) / TWO_PI + 0.92 * SAM_carrier;
+  samStatus.carrierOffset = 0.9 * samStatus.carrierOffset + 0.1 * SAM_carrier;
+  samStatus.updates++;
 }
 
 /*****  AFP 11-03-22
@@ -133,19 +196,19 @@ float ApproxAtan2(float y, float x) {
       const float z = x / y;
       if (y > 0.0f) {
         // atan2(y,x) = PI/2 - atan(x/y) if |y/x| > 1, y > 0
-        return -ApproxAtan(z) + TWO_PI;
+        return -ApproxAtan(z) + HALF_PI;
       } else {
         // atan2(y,x) = -PI/2 - atan(x/y) if |y/x| > 1, y < 0
-        return -ApproxAtan(z) - TWO_PI;
+        return -ApproxAtan(z) - HALF_PI;
       }
     }
   } else {
     if (y > 0.0f)  // x = 0, y > 0
     {
-      return TWO_PI;
+      return HALF_PI;
     } else if (y < 0.0f)  // x = 0, y < 0
     {
-      return -TWO_PI;
+      return -HALF_PI;
     }
   }
   return 0.0f;  // x,y = 0. Could return NaN instead.
@@ -19,6 +19,7 @@ const uint16_t gradient[] = {  // Color array for waterfall background
 
 uint16_t waterfall[MAX_WATERFALL_WIDTH];
 int maxYPlot;
+float32_t samOffsetShown = -99999.0;  // SAM carrier offset on the screen, Hz
 
 /*****
   Purpose: Draw audio spectrum box  AFP added 3-14-21
@@ -76,10 +77,12 @@ void ShowName() {
 
 /*****
   Purpose: Show Spectrum display
-            Note that this routine calls the Audio process Function during each display cycle,
-            for each of the 512 display frequency bins.  This means that the audio is refreshed at the maximum rate
-            and does not have to wait for the display to complete drawing the full spectrum.
-            However, the display data are only updated ONCE during each full display cycle,
+            Note that this routine gives the receive scheduler, ServiceReceiveDSP(), a chance to run before
+            each of the 512 display frequency bins is drawn.  The scheduler only runs ProcessIQData() when a full
+            block of audio is waiting, so the audio is processed as soon as it is ready and the display
+            is drawn in the time left over.  The filter encoder and front panel tuning are checked once
+            every DISPLAY_SLICE_PIXELS bins.
+            The display data are only updated ONCE during each full display cycle,
             ensuring consistent data for the erase/draw cycle at each frequency point.
 
   Parameter list:
@@ -110,44 +113,23 @@ FASTRUN void ShowSpectrum()  //AFP Extensively Modified 3-15-21 Adjusted 12-13-2
   for (x1 = 1; x1 < MAX_WATERFALL_WIDTH - 1; x1++)  //AFP, JJP changed init from 0 to 1 for x1: out of bounds addressing in line 112
   //Draws the main Spectrum, Waterfall and Audio displays
   {
-    updateDisplayFlag = 0;
-    if ((EEPROMData.spectrum_zoom == 0) && ((uint32_t)Q_in_L.available() > N_BLOCKS + 0 && (uint32_t)Q_in_R.available() > N_BLOCKS + 0)) {
-      updateDisplayCounter = updateDisplayCounter + 1;
-      if (updateDisplayCounter == 1) updateDisplayFlag = 1;
-    }
-    if ((EEPROMData.spectrum_zoom == 1) && ((uint32_t)Q_in_L.available() > N_BLOCKS + 0 && (uint32_t)Q_in_R.available() > N_BLOCKS + 0)) {
-      updateDisplayCounter = updateDisplayCounter + 1;
-      if (updateDisplayCounter == 1) updateDisplayFlag = 1;
-    }
-    if ((EEPROMData.spectrum_zoom == 2) && ((uint32_t)Q_in_L.available() > N_BLOCKS + 0 && (uint32_t)Q_in_R.available() > N_BLOCKS + 0)) {
-      updateDisplayCounter = updateDisplayCounter + 1;
-      if (updateDisplayCounter == 1) updateDisplayFlag = 1;
-    }
-    if ((EEPROMData.spectrum_zoom == 3) && ((uint32_t)Q_in_L.available() > N_BLOCKS + 0 && (uint32_t)Q_in_R.available() > N_BLOCKS + 0)) {
-      updateDisplayCounter = updateDisplayCounter + 1;
-      if (updateDisplayCounter == 3) updateDisplayFlag = 1;
-    }
-    if ((EEPROMData.spectrum_zoom == 4) && ((uint32_t)Q_in_L.available() > N_BLOCKS + 0 && (uint32_t)Q_in_R.available() > N_BLOCKS + 0)) {
-      updateDisplayCounter = updateDisplayCounter + 1;
-      if (updateDisplayCounter == 7) updateDisplayFlag = 1;
-    }
+    ServiceReceiveDSP();  // Audio first.  This only does work when a full block is waiting.
 
-    FilterSetSSB();                                           // Insert Filter encoder update here  AFP 06-22-22
-    if (T41State == SSB_RECEIVE || T41State == CW_RECEIVE) {  // AFP 08-24-22
-      ProcessIQData();                                        // Call the Audio process from within the display routine to eliminate conflicts with drawing the spectrum and waterfall displays
-    }
+    if ((x1 % DISPLAY_SLICE_PIXELS) == 1) {  // User interface work once per slice, not once per bin.
+      FilterSetSSB();                        // Insert Filter encoder update here  AFP 06-22-22
 #ifdef G0ORX_FRONTPANEL
-    EncoderCenterTune();  //Moved the tuning encoder to reduce lag times and interference during tuning.
+      EncoderCenterTune();  //Moved the tuning encoder to reduce lag times and interference during tuning.
 #endif
 #ifdef G0ORX_FRONTPANEL_2
-    if( centerTuneFlag== 1) {
-      SetFreq();  //  Change to receiver tuning process.  KF5N July 22, 2023
-      DrawBandWidthIndicatorBar();  // AFP 10-20-22
-      ShowFrequency();
-      BandInformation();
-      centerTuneFlag = 0;
-    }
+      if (centerTuneFlag == 1) {
+        SetFreq();                    //  Change to receiver tuning process.  KF5N July 22, 2023
+        DrawBandWidthIndicatorBar();  // AFP 10-20-22
+        ShowFrequency();
+        BandInformation();
+        centerTuneFlag = 0;
+      }
 #endif
+    }
     y_new = pixelnew[x1];
     y1_new = pixelnew[x1 - 1];
     y_old = pixelold[x1];  // pixelold spectrum is saved by the FFT function prior to a new FFT which generates the pixelnew spectrum.  KF5N
@@ -224,6 +206,17 @@ FASTRUN void ShowSpectrum()  //AFP Extensively Modified 3-15-21 Adjusted 12-13-2
     tft.writeTo(L1);
   }
   // End for(...) Draw MAX_WATERFALL_WIDTH spectral points
+  ShowSAMStatus();
+  if (EEPROMData.xmtMode == CW_MODE && EEPROMData.cwSkimmer) {  // The skimmer text has the waterfall area
+    if (keyPressedOn == 0) {
+      CWSkimmerDisplay();
+    }
+    return;
+  }
+  if (!spectrumFresh) {  // No spectrum FFT in this sweep, so no new waterfall row
+    return;
+  }
+  spectrumFresh = false;
   // Use the Block Transfer Engine (BTE) to move waterfall down a line
 
   if (keyPressedOn == 1) {
@@ -441,8 +434,8 @@ void DrawFrequencyBarValue() {
 
   if (EEPROMData.spectrum_zoom < 5) {
     freq_calc = roundf(freq_calc / 1000);  // round graticule frequency to the nearest kHz
-  } else if (EEPROMData.spectrum_zoom < 5) {
-    freq_calc = roundf(freq_calc / 100) / 10;  // round graticule frequency to the nearest 100Hz
+  } else {
+    freq_calc = roundf(freq_calc / 10) / 100;  // 32x and up, round graticule frequency to the nearest 10Hz
     // === AFP 10-30-22
     // } else if (EEPROMData.spectrum_zoom == 5) {              // 32x
     //  freq_calc = roundf(freq_calc / 50) / 20;    // round graticule frequency to the nearest 50Hz
@@ -465,6 +458,9 @@ void DrawFrequencyBarValue() {
   disp_freq = freq_calc + (centerIdx * grat);
   bignum = (int)disp_freq;
   itoa(bignum, txt, DEC);  // Make into a string
+  if (EEPROMData.spectrum_zoom >= 5) {
+    dtostrf(disp_freq, 0, 2, txt);  // The graticule steps are less than 1 kHz
+  }
   //=================== AFP 10-21-22 =====
   tft.setTextColor(RA8875_GREEN);
 
@@ -485,6 +481,9 @@ void DrawFrequencyBarValue() {
     pos_help = idx2pos[EEPROMData.spectrum_zoom < 3 ? 0 : 1][idx + 4];
     if (idx != centerIdx) {
       ultoa((freq_calc + (idx * grat)), txt, DEC);
+      if (EEPROMData.spectrum_zoom >= 5) {
+        dtostrf(freq_calc + (idx * grat), 0, 2, txt);
+      }
       //================== AFP 10-21-22 =============
       if (EEPROMData.spectrum_zoom == 0) {
         tft.setCursor(WATERFALL_LEFT_X + pos_help * xExpand + 40, WATERFALL_TOP_Y);  // AFP 10-20-22
@@ -571,7 +570,7 @@ void BandInformation()  // SSB or CW
   tft.setCursor(100, FREQUENCY_Y + 30);
   tft.setTextColor(RA8875_LIGHT_ORANGE);
   if (EEPROMData.spectrum_zoom == SPECTRUM_ZOOM_1) {  // AFP 11-02-22
-    tft.print(EEPROMData.centerFreq + 48000);
+    tft.print(EEPROMData.centerFreq + IFFreq);
   } else {
     tft.print(EEPROMData.centerFreq);
   }
@@ -654,11 +653,43 @@ void BandInformation()  // SSB or CW
       break;
     case DEMOD_SAM:         //AFP 11-01-22
       tft.print("(SAM) ");  //AFP 11-01-22
+      samOffsetShown = -99999.0;  // Area was cleared, so draw the carrier offset again
       break;
   }
   ShowCurrentPowerSetting();
 }
 
+/*****
+  Purpose: Show the SAM carrier offset next to the "(SAM)" label.  Reads samStatus, which AMDecodeSAM() updates
+           once per block, no more than every SAM_STATUS_INTERVAL milliseconds, and only draws when the value shown
+           changes.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void ShowSAMStatus() {
+  static uint32_t lastShown = 0;
+  float32_t offset;
+
+  if (bands[EEPROMData.currentBand].mode != DEMOD_SAM || millis() - lastShown < SAM_STATUS_INTERVAL) {
+    return;
+  }
+  lastShown = millis();
+  offset = roundf(samStatus.carrierOffset * 10.0) / 10.0;  // The 0.1 Hz that is displayed
+  if (offset == samOffsetShown) {
+    return;
+  }
+  samOffsetShown = offset;
+  tft.setFontScale((enum RA8875tsize)0);
+  tft.fillRect(OPERATION_STATS_X + 200, FREQUENCY_Y + 30, tft.getFontWidth() * 8, tft.getFontHeight(), RA8875_BLACK);
+  tft.setCursor(OPERATION_STATS_X + 200, FREQUENCY_Y + 30);
+  tft.setTextColor(RA8875_WHITE);
+  tft.print(offset, 1);
+}
+
 /*****
   Purpose: Display current power setting
 
@@ -1479,11 +1510,12 @@ FASTRUN void DrawBandWidthIndicatorBar()  // AFP 10-30-22
 {
   float zoomMultFactor = 0.0;
   float Zoom1Offset = 0.0;
+  float pixelsPerHz = 2.0 * SPECTRUM_RES / SR[SampleRate].rate;  // At 2x zoom, 0.0053333 at 192K
 
   switch (zoomIndex) {
     case 0:
       zoomMultFactor = 0.5;
-      Zoom1Offset = 24000 * 0.0053333;
+      Zoom1Offset = IFFreq / 2 * pixelsPerHz;
       break;
 
     case 1:
@@ -1501,12 +1533,12 @@ FASTRUN void DrawBandWidthIndicatorBar()  // AFP 10-30-22
       Zoom1Offset = 0;
       break;
 
-    case 4:
-      zoomMultFactor = 8.0;
+    default:  // 16x and up
+      zoomMultFactor = (1 << zoomIndex) / 2.0;
       Zoom1Offset = 0;
       break;
   }
-  newCursorPosition = (int)(NCOFreq * 0.0053333) * zoomMultFactor - Zoom1Offset;  // AFP 10-28-22
+  newCursorPosition = (int)(NCOFreq * pixelsPerHz * zoomMultFactor - Zoom1Offset);  // AFP 10-28-22  Rounded after scaling for the high zooms
 
   tft.writeTo(L2);
   //  tft.clearMemory();              // This destroys the CW filter graphics, removed.  KF5N July 30, 2023
@@ -1514,6 +1546,9 @@ FASTRUN void DrawBandWidthIndicatorBar()  // AFP 10-30-22
 
   pixel_per_khz = ((1 << EEPROMData.spectrum_zoom) * SPECTRUM_RES * 1000.0 / SR[SampleRate].rate);
   filterWidth = (int)(((bands[EEPROMData.currentBand].FHiCut - bands[EEPROMData.currentBand].FLoCut) / 1000.0) * pixel_per_khz * 1.06);  // AFP 10-30-22
+  if (filterWidth > MAX_WATERFALL_WIDTH / 2) {  // Wider than half the display at the highest zooms
+    filterWidth = MAX_WATERFALL_WIDTH / 2;
+  }
   //======================= AFP 09-22-22
 
   switch (bands[EEPROMData.currentBand].mode) {
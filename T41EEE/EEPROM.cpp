@@ -275,6 +275,7 @@ void EEPROMDataDefaults() {
   EEPROMData = *defaultConfig;                    // Copy the defaults to EEPROMData struct.
   // Initialize the frequency setting based on the last used frequency stored to EEPROM.
   TxRxFreq = EEPROMData.centerFreq = EEPROMData.lastFrequencies[EEPROMData.currentBand][EEPROMData.activeVFO];
+  ApplyConfiguration();   // Rebuild the DSP for the default settings.
   RedrawDisplayScreen();  //  Need to refresh display here.
 }
 
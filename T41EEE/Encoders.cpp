@@ -505,13 +505,13 @@ FASTRUN  // Causes function to be allocated in RAM1 at startup for fastest perfo
   }
   // ===============  Recentering at band edges ==========
   if (EEPROMData.spectrum_zoom != 0) {
-    if (NCOFreq >= (95000 / (1 << EEPROMData.spectrum_zoom)) || NCOFreq < (-93000 / (1 << EEPROMData.spectrum_zoom))) {  // 47500 with 2x zoom.
+    if (NCOFreq >= ((2 * IFFreq - 1000) / (1 << EEPROMData.spectrum_zoom)) || NCOFreq < (-(2 * IFFreq - 3000) / (1 << EEPROMData.spectrum_zoom))) {  // 47500 with 2x zoom at 192K.
       centerTuneFlag = 0;
       resetTuningFlag = 1;
       return;
     }
   } else {
-    if (NCOFreq > 142000 || NCOFreq < -43000) {  // Offset tuning window in zoom 1x
+    if (NCOFreq > 3 * IFFreq - 2000 || NCOFreq < -(IFFreq - 5000)) {  // Offset tuning window in zoom 1x, 142000 and -43000 at 192K
       centerTuneFlag = 0;
       resetTuningFlag = 1;
       return;
@@ -2,171 +2,436 @@
 #include "SDT.h"
 #endif
 
+// Spectrum FFT windows.  Each is a cosine sum, w[i] = a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x) + a4 cos(4x) with
+// x = 2 pi i / spectrumFFTLength.  The table is scaled by 0.5 / a0 so a steady carrier reads the same level on the
+// display with every window as it does with the Hann window.
+const struct spectrumWindowType_t spectrumWindowTypes[SPECTRUM_WINDOWS] = {
+  { "Hann", { 0.5, 0.5, 0.0, 0.0, 0.0 } },
+  { "Blackman-Harris", { 0.35875, 0.48829, 0.14128, 0.01168, 0.0 } },
+  { "Flat top", { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 } }
+};
+
+float32_t spectrumWindow[SPECTRUM_FFT_MAX];  // Active window, gain corrected, shared by ZoomFFTExe() and CalcZoom1Magn()
+
+/*****
+  Purpose: Fill spectrumWindow[] with one of the spectrumWindowTypes[] windows.  Called at startup and when the
+           window is changed from the Spectrum Options menu, so the spectrum FFTs only do a table lookup.
+  Parameter list:
+    int type          SPECTRUM_WINDOW_HANN, SPECTRUM_WINDOW_BLACKMAN_HARRIS, or SPECTRUM_WINDOW_FLAT_TOP
+  Return value;
+    void
+*****/
+void SetSpectrumWindow(int type)
+{
+  const float32_t *a;
+  float32_t x;
+
+  if (type < 0 || type >= SPECTRUM_WINDOWS) {
+    type = SPECTRUM_WINDOW_HANN;
+  }
+  a = spectrumWindowTypes[type].a;
+  for (uint32_t i = 0; i < spectrumFFTLength; i++) {
+    x = TWO_PI * i / spectrumFFTLength;
+    spectrumWindow[i] = (a[0] - a[1] * cosf(x) + a[2] * cosf(2.0 * x) - a[3] * cosf(3.0 * x) + a[4] * cosf(4.0 * x)) * 0.5 / a[0];
+  }
+}
+
+uint32_t spectrumFFTLength = SPECTRUM_RES;  // Spectrum FFT points in use, set by SetSpectrumFFTSize()
+uint32_t spectrumSweeps = 0;                // Display sweeps started, counted by ServiceReceiveDSP()
+uint32_t spectrumFFTSweep = 0;              // spectrumSweeps at the last spectrum FFT
+bool spectrumFresh = false;                 // A spectrum FFT has run since ShowSpectrum() last scrolled the waterfall
+
+/*****
+  Purpose: Set the spectrum FFT size for the current zoom.  The 1x spectrum transforms one input block, so at 1x and
+           the lower sample rates the size is limited to BUFFER_SIZE * N_BLOCKS.  The zoom spectra fill their own
+           ring and always get the full size.  The window table is rebuilt for the new size.  ZoomFFTPrep() calls
+           this for every zoom, sample rate, and size change.
+  Parameter list:
+    uint32_t length       512, 1024, or 2048
+  Return value;
+    void
+*****/
+void SetSpectrumFFTSize(uint32_t length)
+{
+  if (length != 1024 && length != SPECTRUM_FFT_MAX) {
+    length = SPECTRUM_RES;
+  }
+  if (EEPROMData.spectrum_zoom == SPECTRUM_ZOOM_1 && length > BUFFER_SIZE * N_BLOCKS) {
+    length = BUFFER_SIZE * N_BLOCKS;
+  }
+  spectrumFFTLength = length;
+  switch (spectrumFFTLength) {
+    case 1024:
+      spec_FFT = &arm_cfft_sR_f32_len1024;
+      break;
+    case SPECTRUM_FFT_MAX:
+      spec_FFT = &arm_cfft_sR_f32_len2048;
+      break;
+    default:
+      spec_FFT = &arm_cfft_sR_f32_len512;
+      break;
+  }
+  SetSpectrumWindow(EEPROMData.spectrumWindow);
+}
+
+/*****
+  Purpose: Decide whether a spectrum FFT may run in this display sweep.  Larger FFTs run in fewer sweeps, so the
+           spectrum costs about the same at every size: a 512 point FFT every sweep, 1024 every second sweep, and
+           2048 every fourth.  Counting sweeps rather than time means the 1x spectrum, which only has the first
+           block of a sweep to work with, is never turned away.  ShowSpectrum() only scrolls the waterfall after a
+           sweep that had an FFT.
+  Parameter list:
+    void
+  Return value;
+    bool          true if the FFT should run, and the sweep is noted
+*****/
+bool SpectrumFFTDue()
+{
+  if (spectrumSweeps - spectrumFFTSweep < spectrumFFTLength / SPECTRUM_RES) {
+    return false;
+  }
+  spectrumFFTSweep = spectrumSweeps;
+  return true;
+}
+
+/*****
+  Purpose: Turn the spectrum FFT in buffer_spec_FFT into SPECTRUM_RES display columns in FFT_spec, with the
+           negative frequencies on the left.  When the FFT has more bins than the display has columns, each column
+           takes the largest of its bins, so a narrow carrier keeps its height instead of being averaged into the
+           noise.  The magnitudes are scaled by (SPECTRUM_RES / spectrumFFTLength)^2 so a carrier reads the same at
+           every FFT size.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void SpectrumBinning()
+{
+  uint32_t binsPerColumn = spectrumFFTLength / SPECTRUM_RES;
+  uint32_t index;
+  float32_t scale = (float32_t)SPECTRUM_RES / spectrumFFTLength;
+
+  arm_cmplx_mag_squared_f32(buffer_spec_FFT, buffer_spec_FFT, spectrumFFTLength);  // In place, I*I + Q*Q
+  if (binsPerColumn == 1) {
+    arm_copy_f32(&buffer_spec_FFT[SPECTRUM_RES / 2], FFT_spec, SPECTRUM_RES / 2);
+    arm_copy_f32(buffer_spec_FFT, &FFT_spec[SPECTRUM_RES / 2], SPECTRUM_RES / 2);
+    return;
+  }
+  for (int i = 0; i < SPECTRUM_RES; i++) {  // Columns never straddle DC because binsPerColumn divides spectrumFFTLength / 2
+    arm_max_f32(&buffer_spec_FFT[(i * binsPerColumn + spectrumFFTLength / 2) % spectrumFFTLength], binsPerColumn, &FFT_spec[i], &index);
+  }
+  arm_scale_f32(FFT_spec, scale * scale, FFT_spec, SPECTRUM_RES);
+}
+
+// Spectrum averaging, see SpectrumAverage()
+const char *spectrumAverageNames[SPECTRUM_AVERAGE_MODES] = { "Off", "Exponential", "Linear", "Peak hold", "Min hold" };
+float32_t DMAMEM spectrumFrames[SPECTRUM_AVERAGE_FRAMES][SPECTRUM_RES];  // Last frames for the linear average
+float32_t spectrumFrameSum[SPECTRUM_RES];                                // Running sum of spectrumFrames[]
+float32_t DMAMEM spectrumDisplay[SPECTRUM_RES];                          // Averaged or held spectrum for the display
+int spectrumFrameIndex = 0;                                              // Oldest frame in spectrumFrames[]
+uint32_t spectrumAverageTime = 0;                                        // millis() at the last spectrum
+bool spectrumAverageRestart = true;                                      // Start the average again from the next spectrum
+
+/*****
+  Purpose: Start the spectrum average again from the next spectrum.  Called when the mode, zoom, sample rate, or
+           receive frequency changes, so the old spectrum is not mixed into the new one.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void SpectrumAverageReset()
+{
+  spectrumAverageRestart = true;
+}
+
+/*****
+  Purpose: Average the squared magnitude spectrum between the FFT and the pixel conversion, by the mode in
+           EEPROMData.spectrumAverage:
+             Exponential   first order lowpass with a time constant of SPECTRUM_AVERAGE_TAU seconds
+             Linear        mean of the last SPECTRUM_AVERAGE_FRAMES spectra
+             Peak hold     highest value, falling SPECTRUM_PEAK_DECAY dB per second
+             Min hold      lowest value since the last reset
+           The exponential and peak decay use the measured time between spectra, so they behave the same at every
+           zoom and display rate.  The result is kept in spectrumDisplay and copied back to spec.
+
+           The S-meter reads FFT_spec_old, which always gets the exponential average whatever the display mode,
+           so a held display does not hold the meter.
+  Parameter list:
+    float32_t *spec       SPECTRUM_RES squared magnitudes, averaged in place
+  Return value;
+    void
+*****/
+void SpectrumAverage(float32_t *spec)
+{
+  uint32_t now = millis();
+  float32_t dt = (now - spectrumAverageTime) / 1000.0;  // Seconds since the last spectrum
+  float32_t factor;
+
+  spectrumAverageTime = now;
+  if (dt > 1.0) dt = 1.0;
+  if (spectrumAverageRestart) {
+    for (int k = 0; k < SPECTRUM_AVERAGE_FRAMES; k++) {
+      arm_copy_f32(spec, spectrumFrames[k], SPECTRUM_RES);
+    }
+    arm_scale_f32(spec, SPECTRUM_AVERAGE_FRAMES, spectrumFrameSum, SPECTRUM_RES);
+    arm_copy_f32(spec, spectrumDisplay, SPECTRUM_RES);
+    arm_copy_f32(spec, FFT_spec_old, SPECTRUM_RES);
+    spectrumFrameIndex = 0;
+    spectrumAverageRestart = false;
+    return;
+  }
+
+  // S-meter average, old += (1 - e^(-dt / tau)) * (new - old)
+  factor = 1.0 - expf(-dt / SPECTRUM_AVERAGE_TAU);
+  for (int i = 0; i < SPECTRUM_RES; i++) {
+    FFT_spec_old[i] += factor * (spec[i] - FFT_spec_old[i]);
+  }
+
+  switch (EEPROMData.spectrumAverage) {
+    case SPECTRUM_AVERAGE_EXPONENTIAL:  // The same average as the S-meter
+      arm_copy_f32(FFT_spec_old, spectrumDisplay, SPECTRUM_RES);
+      break;
+
+    case SPECTRUM_AVERAGE_LINEAR:
+      arm_sub_f32(spectrumFrameSum, spectrumFrames[spectrumFrameIndex], spectrumFrameSum, SPECTRUM_RES);
+      arm_add_f32(spectrumFrameSum, spec, spectrumFrameSum, SPECTRUM_RES);
+      arm_copy_f32(spec, spectrumFrames[spectrumFrameIndex], SPECTRUM_RES);
+      spectrumFrameIndex++;
+      if (spectrumFrameIndex == SPECTRUM_AVERAGE_FRAMES) {  // Add the frames up again, so rounding cannot build up
+        spectrumFrameIndex = 0;
+        arm_copy_f32(spectrumFrames[0], spectrumFrameSum, SPECTRUM_RES);
+        for (int k = 1; k < SPECTRUM_AVERAGE_FRAMES; k++) {
+          arm_add_f32(spectrumFrameSum, spectrumFrames[k], spectrumFrameSum, SPECTRUM_RES);
+        }
+      }
+      arm_scale_f32(spectrumFrameSum, 1.0 / SPECTRUM_AVERAGE_FRAMES, spectrumDisplay, SPECTRUM_RES);
+      break;
+
+    case SPECTRUM_AVERAGE_PEAK_HOLD:
+      factor = powf(10.0, -SPECTRUM_PEAK_DECAY * dt / 10.0);
+      arm_scale_f32(spectrumDisplay, factor, spectrumDisplay, SPECTRUM_RES);
+      for (int i = 0; i < SPECTRUM_RES; i++) {
+        if (spec[i] > spectrumDisplay[i]) spectrumDisplay[i] = spec[i];
+      }
+      break;
+
+    case SPECTRUM_AVERAGE_MIN_HOLD:
+      for (int i = 0; i < SPECTRUM_RES; i++) {
+        if (spec[i] < spectrumDisplay[i]) spectrumDisplay[i] = spec[i];
+      }
+      break;
+
+    default:  // Off
+      arm_copy_f32(spec, spectrumDisplay, SPECTRUM_RES);
+      break;
+  }
+  arm_copy_f32(spectrumDisplay, spec, SPECTRUM_RES);
+}
+
 int Zoom_FFT_M1;
 int Zoom_FFT_M2;
+int Zoom_FFT_M3;
+
+#define Zoom_FFT_no_coeff1 12
+#define Zoom_FFT_no_coeff2 8
+#define Zoom_FFT_no_coeff3 24
+
+// Third decimation stage, only used above 16x.  Its input is at most one 2048 sample block decimated by 16.
+arm_fir_decimate_instance_f32 Fir_Zoom_FFT_Decimate_I3;
+arm_fir_decimate_instance_f32 Fir_Zoom_FFT_Decimate_Q3;
+float32_t DMAMEM Fir_Zoom_FFT_Decimate_I3_state[Zoom_FFT_no_coeff3 + FFT_LENGTH_MAX / 16 - 1];
+float32_t DMAMEM Fir_Zoom_FFT_Decimate_Q3_state[Zoom_FFT_no_coeff3 + FFT_LENGTH_MAX / 16 - 1];
+float32_t DMAMEM Fir_Zoom_FFT_Decimate3_coeffs[Zoom_FFT_no_coeff3];
+
+int zoomFreshSamples = 0;     // Samples added to the zoom FFT ring since the last zoom FFT
+int zoomSamplesNeeded = 512;  // Fresh samples required before the next zoom FFT
+bool zoomSweepDone = false;   // A zoom FFT has already been displayed in this display sweep
+
+/*****
+  Purpose: Design one zoom FFT decimation stage and initialize its I and Q decimators.  Every stage but the last
+           only has to keep the signals that would alias into the final span out, so it is cut off at half its
+           output rate.  The last stage is cut off at the edge of the displayed span.
+  Parameter list:
+    arm_fir_decimate_instance_f32 *I, *Q    the I and Q decimators
+    float32_t *coeffs                       coefficient storage, numTaps long
+    float32_t *stateI, *stateQ              state storage
+    int numTaps                             filter length
+    int M                                   decimation factor
+    float32_t rate                          input sample rate
+    float32_t fStop                         edge of the displayed span, used for the last stage
+    bool last                               true for the last stage in use
+    uint32_t blockSize                      input samples per call
+  Return value;
+    void
+*****/
+static void ZoomFFTStageInit(arm_fir_decimate_instance_f32 *I, arm_fir_decimate_instance_f32 *Q, float32_t *coeffs,
+                             float32_t *stateI, float32_t *stateQ, int numTaps, int M, float32_t rate, float32_t fStop,
+                             bool last, uint32_t blockSize)
+{
+  CalcFIRCoeffs(coeffs, numTaps, last ? fStop : 0.5 * rate / M, 60, 0, 0.0, rate);
+  if (arm_fir_decimate_init_f32(I, numTaps, M, coeffs, stateI, blockSize)) {
+    Serial.println("Init of decimation failed");
+    while(1);
+  }
+  // same coefficients, but specific state variables
+  if (arm_fir_decimate_init_f32(Q, numTaps, M, coeffs, stateQ, blockSize)) {
+    Serial.println("Init of decimation failed");
+    while(1);
+  }
+}
+
 void ZoomFFTPrep()
 { // take value of spectrum_zoom and initialize FIR decimation filters for the right values
 
   /****************************************************************************************
      Zoom FFT: Initiate decimation FIR filters
   ****************************************************************************************/
-  // two-stage decimation
+  SetSpectrumFFTSize(EEPROMData.spectrumFFTSize);  // The size in use depends on the zoom
+
+  // up to three decimation stages, a stage with a factor of 1 is skipped
   switch (EEPROMData.spectrum_zoom) 
   {
     case SPECTRUM_ZOOM_1:
-      Zoom_FFT_M1 = 1; Zoom_FFT_M2 = 1; 
+      Zoom_FFT_M1 = 1; Zoom_FFT_M2 = 1; Zoom_FFT_M3 = 1;
       break;
     case SPECTRUM_ZOOM_2:       
-      Zoom_FFT_M1 = 2; Zoom_FFT_M2 = 1; 
+      Zoom_FFT_M1 = 2; Zoom_FFT_M2 = 1; Zoom_FFT_M3 = 1;
       break;
     case SPECTRUM_ZOOM_4:       
-      Zoom_FFT_M1 = 2; Zoom_FFT_M2 = 2; 
+      Zoom_FFT_M1 = 2; Zoom_FFT_M2 = 2; Zoom_FFT_M3 = 1;
       break;
     case SPECTRUM_ZOOM_8:       
-      Zoom_FFT_M1 = 4; Zoom_FFT_M2 = 2; 
+      Zoom_FFT_M1 = 4; Zoom_FFT_M2 = 2; Zoom_FFT_M3 = 1;
       break;
     case SPECTRUM_ZOOM_16:       
-      Zoom_FFT_M1 = 8; Zoom_FFT_M2 = 2; 
+      Zoom_FFT_M1 = 8; Zoom_FFT_M2 = 2; Zoom_FFT_M3 = 1;
+      break;
+    case SPECTRUM_ZOOM_32:
+      Zoom_FFT_M1 = 8; Zoom_FFT_M2 = 2; Zoom_FFT_M3 = 2;
+      break;
+    case SPECTRUM_ZOOM_64:
+      Zoom_FFT_M1 = 8; Zoom_FFT_M2 = 4; Zoom_FFT_M3 = 2;
+      break;
+    case SPECTRUM_ZOOM_128:
+      Zoom_FFT_M1 = 8; Zoom_FFT_M2 = 4; Zoom_FFT_M3 = 4;
+      break;
+    case SPECTRUM_ZOOM_256:
+      Zoom_FFT_M1 = 8; Zoom_FFT_M2 = 8; Zoom_FFT_M3 = 4;
       break;
     default:
-      Zoom_FFT_M1 = 1; Zoom_FFT_M2 = 1; 
+      Zoom_FFT_M1 = 1; Zoom_FFT_M2 = 1; Zoom_FFT_M3 = 1;
       break;
   }
-// init 1st stage 
-  float32_t Fstop_Zoom = 0.5 * (float32_t) SR[SampleRate].rate / (1 << EEPROMData.spectrum_zoom); // Fstop should be the stop band at the final sample rate
+  float32_t rate = (float32_t)SR[SampleRate].rate;
+  float32_t Fstop_Zoom = 0.5 * rate / (1 << EEPROMData.spectrum_zoom); // Fstop should be the stop band at the final sample rate
 
-#define Zoom_FFT_no_coeff1 12
-#define Zoom_FFT_no_coeff2 8
 // did not do proper calculation of the number of taps, just took a number for the start
 // attenuation 70dB should be sufficient for the spectrum display
-// 1st decimation stage
-CalcFIRCoeffs (Fir_Zoom_FFT_Decimate1_coeffs, Zoom_FFT_no_coeff1, Fstop_Zoom, 60, 0, 0.0, (float32_t)SR[SampleRate].rate);
-
-//[in,out]  S points to an instance of the floating-point FIR decimator structure
-//[in]  numTaps number of coefficients in the filter
-//[in]  M decimation factor
-//[in]  pCoeffs points to the filter coefficients
-//[in]  pState  points to the state buffer
-//[in]  blockSize number of input samples to process per call 
-
-  if (arm_fir_decimate_init_f32(&Fir_Zoom_FFT_Decimate_I1, Zoom_FFT_no_coeff1, Zoom_FFT_M1, Fir_Zoom_FFT_Decimate1_coeffs, Fir_Zoom_FFT_Decimate_I1_state, BUFFER_SIZE * N_BLOCKS)) {
-    Serial.println("Init of decimation failed");
-    while(1);
+  if (Zoom_FFT_M1 > 1) {
+    ZoomFFTStageInit(&Fir_Zoom_FFT_Decimate_I1, &Fir_Zoom_FFT_Decimate_Q1, Fir_Zoom_FFT_Decimate1_coeffs,
+                     Fir_Zoom_FFT_Decimate_I1_state, Fir_Zoom_FFT_Decimate_Q1_state, Zoom_FFT_no_coeff1, Zoom_FFT_M1,
+                     rate, Fstop_Zoom, Zoom_FFT_M2 == 1, BUFFER_SIZE * N_BLOCKS);
   }
-  // same coefficients, but specific state variables
-  if (arm_fir_decimate_init_f32(&Fir_Zoom_FFT_Decimate_Q1, Zoom_FFT_no_coeff1, Zoom_FFT_M1, Fir_Zoom_FFT_Decimate1_coeffs, Fir_Zoom_FFT_Decimate_Q1_state, BUFFER_SIZE * N_BLOCKS)) {
-    Serial.println("Init of decimation failed");
-    while(1);
+  if (Zoom_FFT_M2 > 1) {
+    ZoomFFTStageInit(&Fir_Zoom_FFT_Decimate_I2, &Fir_Zoom_FFT_Decimate_Q2, Fir_Zoom_FFT_Decimate2_coeffs,
+                     Fir_Zoom_FFT_Decimate_I2_state, Fir_Zoom_FFT_Decimate_Q2_state, Zoom_FFT_no_coeff2, Zoom_FFT_M2,
+                     rate / Zoom_FFT_M1, Fstop_Zoom, Zoom_FFT_M3 == 1, BUFFER_SIZE * N_BLOCKS / Zoom_FFT_M1);
   }
-
-// 2nd decimation stage
-  CalcFIRCoeffs (Fir_Zoom_FFT_Decimate2_coeffs, Zoom_FFT_no_coeff2, Fstop_Zoom, 60, 0, 0.0, (float32_t)SR[SampleRate].rate / Zoom_FFT_M1);
-
-  if (arm_fir_decimate_init_f32(&Fir_Zoom_FFT_Decimate_I2, Zoom_FFT_no_coeff2, Zoom_FFT_M2, Fir_Zoom_FFT_Decimate2_coeffs, Fir_Zoom_FFT_Decimate_I2_state, BUFFER_SIZE * N_BLOCKS / Zoom_FFT_M1)) {
-    Serial.println("Init of decimation failed");
-    while(1);
-  }
-  // same coefficients, but specific state variables
-  if (arm_fir_decimate_init_f32(&Fir_Zoom_FFT_Decimate_Q2, Zoom_FFT_no_coeff2, Zoom_FFT_M2, Fir_Zoom_FFT_Decimate2_coeffs, Fir_Zoom_FFT_Decimate_Q2_state, BUFFER_SIZE * N_BLOCKS / Zoom_FFT_M1)) {
-    Serial.println("Init of decimation failed");
-    while(1);
+  if (Zoom_FFT_M3 > 1) {
+    ZoomFFTStageInit(&Fir_Zoom_FFT_Decimate_I3, &Fir_Zoom_FFT_Decimate_Q3, Fir_Zoom_FFT_Decimate3_coeffs,
+                     Fir_Zoom_FFT_Decimate_I3_state, Fir_Zoom_FFT_Decimate_Q3_state, Zoom_FFT_no_coeff3, Zoom_FFT_M3,
+                     rate / (Zoom_FFT_M1 * Zoom_FFT_M2), Fstop_Zoom, true, BUFFER_SIZE * N_BLOCKS / (Zoom_FFT_M1 * Zoom_FFT_M2));
   }
   zoom_sample_ptr = 0;
+  zoomFreshSamples = 0;
+  zoomSamplesNeeded = spectrumFFTLength;  // Start with a full ring of samples at the new zoom
+  zoomSweepDone = false;
+  SpectrumAverageReset();
 }
 
 
-const int fftWidth = 512;
+const int fftWidth = 512;  // Display columns
+/*****
+  Purpose: Zoom FFT for 2x to 256x.  Decimates every block into the FFT ring buffer, and runs the FFT once the ring
+           has enough fresh samples: a full ring after a zoom change, then (100 - ZOOM_FFT_OVERLAP) percent of the
+           ring, and at most once per display sweep.  The decimation cost falls with each stage and the FFT runs less
+           often at higher zoom, so the load does not grow with the zoom.  At 256x and 192K the ring fills in about
+           64 blocks.
+  Parameter list:
+    uint32_t blockSize      input samples, BUFFER_SIZE * N_BLOCKS
+  Return value;
+    void
+*****/
 void ZoomFFTExe (uint32_t blockSize)
 {
   // totally rebuilt 27.8.2020 DD4WH
-  // however, I did not manage to implement a correct routine for magnifications > 2048x
-  // maybe the next days
-  float32_t x_buffer[blockSize]; // can be 2048 (FFT length == 512), or 4096 [FFT length == 1024] or even 8192 [FFT length == 2048]
-  float32_t y_buffer[blockSize];
-  static float32_t FFT_ring_buffer_x[fftWidth*2];
-  static float32_t FFT_ring_buffer_y[fftWidth*2];
-  static int32_t flag_2nd_decimation = 0;
-  //static uint32_t high_Zoom_buffer_ptr = 0;
-  uint8_t high_Zoom = 0;
-  //uint32_t high_Zoom_2nd_dec_rounds = (1 << (EEPROMData.spectrum_zoom - 11));
-  //Serial.print("2nd dec rounds"); Serial.println(high_Zoom_2nd_dec_rounds);
-  int sample_no = 256;
-  // sample_no is 256, in high magnify modes it is smaller!
-  // but it must never be > 256
-
-  sample_no = BUFFER_SIZE * N_BLOCKS / (1 << EEPROMData.spectrum_zoom);
-
-  if (sample_no > fftWidth)
-  {
-    sample_no = fftWidth;
+  float32_t x_buffer[blockSize / 2]; // Stage 1 decimates by at least 2
+  float32_t y_buffer[blockSize / 2];
+  static float32_t FFT_ring_buffer_x[SPECTRUM_FFT_MAX];
+  static float32_t FFT_ring_buffer_y[SPECTRUM_FFT_MAX];
+  int ringLength = spectrumFFTLength;
+  int sample_no;
+  int first;
+
+  if (updateDisplayFlag == 1) {  // A new display sweep has started
+    zoomSweepDone = false;
   }
- 
+
+  sample_no = blockSize >> EEPROMData.spectrum_zoom;
+
       // decimation stage 1
           arm_fir_decimate_f32(&Fir_Zoom_FFT_Decimate_I1, float_buffer_L, x_buffer, blockSize);
           arm_fir_decimate_f32(&Fir_Zoom_FFT_Decimate_Q1, float_buffer_R, y_buffer, blockSize);
-          if(high_Zoom ==1) flag_2nd_decimation++;
       // decimation stage 2
+          if (Zoom_FFT_M2 > 1) {
             arm_fir_decimate_f32(&Fir_Zoom_FFT_Decimate_I2, x_buffer, x_buffer, blockSize / Zoom_FFT_M1);
             arm_fir_decimate_f32(&Fir_Zoom_FFT_Decimate_Q2, y_buffer, y_buffer, blockSize / Zoom_FFT_M1);
-  
-    //this puts the sample_no samples into the ringbuffer -->
-    // the right order has to be thought about!
-    // we take all the samples from zoom_sample_ptr to 256 and
-    // then all samples from 0 to zoom_sampl_ptr - 1
-
-    // fill into ringbuffer
-    for (int i = 0; i < sample_no; i++)
-    { // interleave real and imaginary input values [real, imag, real, imag . . .]
+          }
+      // decimation stage 3
+          if (Zoom_FFT_M3 > 1) {
+            arm_fir_decimate_f32(&Fir_Zoom_FFT_Decimate_I3, x_buffer, x_buffer, blockSize / (Zoom_FFT_M1 * Zoom_FFT_M2));
+            arm_fir_decimate_f32(&Fir_Zoom_FFT_Decimate_Q3, y_buffer, y_buffer, blockSize / (Zoom_FFT_M1 * Zoom_FFT_M2));
+          }
+
+    // fill into ringbuffer, only the newest ringLength samples matter at 2x
+    first = (sample_no > ringLength) ? sample_no - ringLength : 0;
+    for (int i = first; i < sample_no; i++)
+    {
       FFT_ring_buffer_x[zoom_sample_ptr] = x_buffer[i];
       FFT_ring_buffer_y[zoom_sample_ptr] = y_buffer[i];
       zoom_sample_ptr++;
-      if (zoom_sample_ptr >= fftWidth) zoom_sample_ptr = 0;
+      if (zoom_sample_ptr >= ringLength) zoom_sample_ptr = 0;
     }
- 
-  // when do we want to display a new spectrum?
-  // if we wait for zoom_sample_ptr to be 255,
-  // it can last more than a few seconds in 4096x Zoom
-  // so we calculate an FFT and display the spectrum every time this function is called?
+    zoomFreshSamples += sample_no - first;
 
-//    zoom_display = 1;
+    if (zoomSweepDone || zoomFreshSamples < zoomSamplesNeeded || !SpectrumFFTDue()) {
+      return;  // Keep accumulating
+    }
+    zoomSweepDone = true;
+    zoomFreshSamples = 0;
+    zoomSamplesNeeded = ringLength * (100 - ZOOM_FFT_OVERLAP) / 100;
 
     // copy from ringbuffer to FFT_buffer
     // in the right order and
     // apply FFT window here
-    // Nuttall window
     // zoom_sample_ptr points to the oldest sample now
 
     float32_t multiplier = (float32_t)EEPROMData.spectrum_zoom * (float32_t)EEPROMData.spectrum_zoom;
 
     // G0ORX
-    float32_t hanning;
+    float32_t window;
 
-    for (int idx = 0; idx < fftWidth; idx++)
+    for (int idx = 0; idx < ringLength; idx++)
     {
-      hanning = multiplier * (0.5 - 0.5 * cos(6.28 * idx / SPECTRUM_RES)); // G0ORX
-   //   buffer_spec_FFT[idx * 2 + 0] =  multiplier * FFT_ring_buffer_x[zoom_sample_ptr] * nuttallWindow256[idx];
-   //   buffer_spec_FFT[idx * 2 + 1] =  multiplier * FFT_ring_buffer_y[zoom_sample_ptr] * nuttallWindow256[idx];
-      //buffer_spec_FFT[idx * 2 + 0] =  multiplier * FFT_ring_buffer_x[zoom_sample_ptr] * (0.5 - 0.5 * cos(6.28 * idx / SPECTRUM_RES)); //Hanning Window AFP 03-12-21
-      //buffer_spec_FFT[idx * 2 + 1] =  multiplier * FFT_ring_buffer_y[zoom_sample_ptr] * (0.5 - 0.5 * cos(6.28 * idx / SPECTRUM_RES));
-      buffer_spec_FFT[idx * 2 + 0] =  FFT_ring_buffer_x[zoom_sample_ptr] * hanning; //Hanning Window AFP 03-12-21
-      buffer_spec_FFT[idx * 2 + 1] =  FFT_ring_buffer_y[zoom_sample_ptr] * hanning;
+      window = multiplier * spectrumWindow[idx];  // Window selected by SetSpectrumWindow()
+      buffer_spec_FFT[idx * 2 + 0] =  FFT_ring_buffer_x[zoom_sample_ptr] * window;
+      buffer_spec_FFT[idx * 2 + 1] =  FFT_ring_buffer_y[zoom_sample_ptr] * window;
       zoom_sample_ptr++;
-      if (zoom_sample_ptr >= fftWidth) zoom_sample_ptr = 0;
+      if (zoom_sample_ptr >= ringLength) zoom_sample_ptr = 0;
     }
 
-    //***************
-    // adjust lowpass filter coefficient, so that
-    // "spectrum display smoothness" is the same across the different sample rates
-    // and the same across different magnify modes . . .
-//    float32_t LPFcoeff = LPF_spectrum * (AUDIO_SAMPLE_RATE_EXACT / SR[SampleRate].rate);
-    float32_t LPFcoeff = 0.6;
-    if (LPFcoeff > 1.0) LPFcoeff = 1.0;
-    if (LPFcoeff < 0.001) LPFcoeff = 0.001;
-    float32_t onem_LPFcoeff = 1.0 - LPFcoeff;
-
-    // The rest of the function is activated when the buffers are full and ready.
     // Save old pixels for lowpass filter.
-    if(updateDisplayFlag == 1) {
     for (int i = 0; i < fftWidth; i++)
     {
       pixelold[i] = pixelCurrent[i];
@@ -175,27 +440,17 @@ void ZoomFFTExe (uint32_t blockSize)
     // calculation is performed in-place the FFT_buffer [re, im, re, im, re, im . . .]
     arm_cfft_f32(spec_FFT, buffer_spec_FFT, 0, 1);
     // calculate mag = I*I + Q*Q,
-    // and simultaneously put them into the right order
-          for (int i = 0; i < fftWidth/2; i++)
-          {
-            FFT_spec[i + fftWidth/2] = (buffer_spec_FFT[i * 2] * buffer_spec_FFT[i * 2] + buffer_spec_FFT[i * 2 + 1] * buffer_spec_FFT[i * 2 + 1]);
-            FFT_spec[i] = (buffer_spec_FFT[(i + fftWidth/2) * 2] * buffer_spec_FFT[(i + fftWidth/2)  * 2] + buffer_spec_FFT[(i + fftWidth/2)  * 2 + 1] * buffer_spec_FFT[(i + fftWidth/2)  * 2 + 1]);
-          }
-    // apply low pass filter and scale the magnitude values and convert to int for spectrum display
-    // apply spectrum AGC
-    //
-    for (int16_t x = 0; x < fftWidth; x++)
-    {
-      FFT_spec[x] = LPFcoeff * FFT_spec[x] + onem_LPFcoeff * FFT_spec_old[x];
-      FFT_spec_old[x] = FFT_spec[x];
-    }
+    // and simultaneously put them into the right order, one value per display column
+    SpectrumBinning();
+    // average, then scale the magnitude values and convert to int for spectrum display
+    SpectrumAverage(FFT_spec);
 
     for (int16_t x = 0; x < fftWidth; x++)
     {
       pixelnew[x] = displayScale[EEPROMData.currentScale].baseOffset + bands[EEPROMData.currentBand].pixel_offset + (int16_t)(displayScale[EEPROMData.currentScale].dBScale * log10f_fast(FFT_spec[x]));
       if (pixelnew[x] > 220)   pixelnew[x] = 220;
     }
-}
+    spectrumFresh = true;
 }
 
 
@@ -210,19 +465,14 @@ void ZoomFFTExe (uint32_t blockSize)
 *****/
 void CalcZoom1Magn()
 {
- if (updateDisplayFlag == 1) {
-  // float32_t spec_help = 0.0; // G0ORX
-  float32_t LPFcoeff = 0.7;  // Is this a global or not?
-  if (LPFcoeff > 1.0) {
-    LPFcoeff = 1.0;
-  }
+ if (updateDisplayFlag == 1 && SpectrumFFTDue()) {
   for (int i = 0; i < fftWidth; i++) {
     pixelold[i] = pixelCurrent[i];
   }
 
-  for (int i = 0; i < fftWidth; i++) { // interleave real and imaginary input values [real, imag, real, imag . . .]
-    buffer_spec_FFT[i * 2] =      float_buffer_L[i] * (0.5 - 0.5 * cos(6.28 * i / fftWidth)); //Hanning
-    buffer_spec_FFT[i * 2 + 1] =  float_buffer_R[i] * (0.5 - 0.5 * cos(6.28 * i / fftWidth));
+  for (uint32_t i = 0; i < spectrumFFTLength; i++) { // interleave real and imaginary input values [real, imag, real, imag . . .]
+    buffer_spec_FFT[i * 2] =      float_buffer_L[i] * spectrumWindow[i];  // Window selected by SetSpectrumWindow()
+    buffer_spec_FFT[i * 2 + 1] =  float_buffer_R[i] * spectrumWindow[i];
   }
   // perform complex FFT
   // calculation is performed in-place the FFT_buffer [re, im, re, im, re, im . . .]
@@ -233,23 +483,17 @@ void CalcZoom1Magn()
   // calculate mag = I*I + Q*Q, because we are doing a log10-transformation later anyway
   // and simultaneously put them into the right order
   // 38.50%, saves 0.05% of processor power and 1kbyte RAM ;-)
-
-  for (int i = 0; i < SPECTRUM_RES/2; i++) {
-      FFT_spec[i + SPECTRUM_RES/2] = (buffer_spec_FFT[i * 2] * buffer_spec_FFT[i * 2] + buffer_spec_FFT[i * 2 + 1] * buffer_spec_FFT[i * 2 + 1]);
-      FFT_spec[i]                  = (buffer_spec_FFT[(i + SPECTRUM_RES/2) * 2] * buffer_spec_FFT[(i + SPECTRUM_RES/2)  * 2] + buffer_spec_FFT[(i + SPECTRUM_RES/2)  * 2 + 1] * buffer_spec_FFT[(i + SPECTRUM_RES/2)  * 2 + 1]);
-    }
-  // apply low pass filter and scale the magnitude values and convert to int for spectrum display
+  SpectrumBinning();
+  // average, then scale the magnitude values and convert to int for spectrum display
+  SpectrumAverage(FFT_spec);
 
   for (int16_t x = 0; x < SPECTRUM_RES; x++) {
-    // G0ORX
-    //spec_help = EEPROMData.LPFcoeff * FFT_spec[x] + (1.0 - EEPROMData.LPFcoeff) * FFT_spec_old[x];
-    //FFT_spec_old[x] = spec_help;
-
 #ifdef USE_LOG10FAST
     pixelnew[x] = displayScale[EEPROMData.currentScale].baseOffset + bands[EEPROMData.currentBand].pixel_offset + (int16_t) (displayScale[EEPROMData.currentScale].dBScale * log10f_fast(FFT_spec[x]));
 #else
-    pixelnew[x] = displayScale[EEPROMData.currentScale].baseOffset + bands[EEPROMData.currentBand].pixel_offset + (int16_t) (displayScale[EEPROMData.currentScale].dBScale * log10f(spec_help));
+    pixelnew[x] = displayScale[EEPROMData.currentScale].baseOffset + bands[EEPROMData.currentBand].pixel_offset + (int16_t) (displayScale[EEPROMData.currentScale].dBScale * log10f(FFT_spec[x]));
 #endif
   }
+  spectrumFresh = true;
  }
 } // end calc_256_magn
@@ -3,117 +3,230 @@
 #endif
 
 
+uint32_t receiveEQGeneration = 1;  // Bumped when the receive EQ levels change, so cached masks and the bank are rebuilt
+static float32_t receiveEQBinGain[FFT_LENGTH_MAX / 2 + 1];  // ReceiveEQGain() at each bin from 0 to convFFTLength / 2
+static uint32_t receiveEQBinGeneration = 0;                 // receiveEQGeneration in receiveEQBinGain[]
+static uint32_t receiveEQBinLength = 0;                     // convFFTLength of receiveEQBinGain[]
+
 /*****
-  Purpose: void DoReceiveEQ  Parameter list:
-    void
-  Return value;
-    void
-*****/
-void DoReceiveEQ() //AFP 08-09-22
-{
-//  for (int i = 0; i < 14; i++) {
-//    recEQ_LevelScale[i] = (float)EEPROMData.equalizerRec[i] / 100.0;
-//  }
-  arm_biquad_cascade_df2T_f32(&S1_Rec, float_buffer_L, rec_EQ1_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S2_Rec, float_buffer_L, rec_EQ2_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S3_Rec, float_buffer_L, rec_EQ3_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S4_Rec, float_buffer_L, rec_EQ4_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S5_Rec, float_buffer_L, rec_EQ5_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S6_Rec, float_buffer_L, rec_EQ6_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S7_Rec, float_buffer_L, rec_EQ7_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S8_Rec, float_buffer_L, rec_EQ8_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S9_Rec, float_buffer_L, rec_EQ9_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S10_Rec, float_buffer_L, rec_EQ10_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S11_Rec, float_buffer_L, rec_EQ11_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S12_Rec, float_buffer_L, rec_EQ12_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S13_Rec, float_buffer_L, rec_EQ13_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S14_Rec, float_buffer_L, rec_EQ14_float_buffer_L, 256);
-
-  arm_scale_f32(rec_EQ1_float_buffer_L, -(float)EEPROMData.equalizerRec[0] / 100.0, rec_EQ1_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ2_float_buffer_L, (float)EEPROMData.equalizerRec[1] / 100.0, rec_EQ2_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ3_float_buffer_L, -(float)EEPROMData.equalizerRec[2] / 100.0, rec_EQ3_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ4_float_buffer_L, (float)EEPROMData.equalizerRec[3] / 100.0, rec_EQ4_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ5_float_buffer_L, -(float)EEPROMData.equalizerRec[4] / 100.0, rec_EQ5_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ6_float_buffer_L, (float)EEPROMData.equalizerRec[5] / 100.0, rec_EQ6_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ7_float_buffer_L, -(float)EEPROMData.equalizerRec[6] / 100.0, rec_EQ7_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ8_float_buffer_L, (float)EEPROMData.equalizerRec[7] / 100.0, rec_EQ8_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ9_float_buffer_L, -(float)EEPROMData.equalizerRec[8] / 100.0, rec_EQ9_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ10_float_buffer_L, (float)EEPROMData.equalizerRec[9] / 100.0, rec_EQ10_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ11_float_buffer_L, -(float)EEPROMData.equalizerRec[10] / 100.0, rec_EQ11_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ12_float_buffer_L, (float)EEPROMData.equalizerRec[11] / 100.0, rec_EQ12_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ13_float_buffer_L, -(float)EEPROMData.equalizerRec[12] / 100.0, rec_EQ13_float_buffer_L, 256);
-  arm_scale_f32(rec_EQ14_float_buffer_L, (float)EEPROMData.equalizerRec[13] / 100.0, rec_EQ14_float_buffer_L, 256);
-
-  arm_add_f32(rec_EQ1_float_buffer_L , rec_EQ2_float_buffer_L, float_buffer_L , 256 ) ;
-
-  arm_add_f32(float_buffer_L , rec_EQ3_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ4_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ5_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ6_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ7_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ8_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ9_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ10_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ11_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ12_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ13_float_buffer_L, float_buffer_L , 256 ) ;
-  arm_add_f32(float_buffer_L , rec_EQ14_float_buffer_L, float_buffer_L , 256 ) ;
-}
-
-/*****
-  Purpose: void DoExciterEQ
-
-  Parameter list:
-    void
-  Return value;
-    void
-*****/
-void DoExciterEQ() //AFP 10-02-22
-{
-  arm_biquad_cascade_df2T_f32(&S1_Xmt,  float_buffer_L_EX, xmt_EQ1_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S2_Xmt,  float_buffer_L_EX, xmt_EQ2_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S3_Xmt,  float_buffer_L_EX, xmt_EQ3_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S4_Xmt,  float_buffer_L_EX, xmt_EQ4_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S5_Xmt,  float_buffer_L_EX, xmt_EQ5_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S6_Xmt,  float_buffer_L_EX, xmt_EQ6_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S7_Xmt,  float_buffer_L_EX, xmt_EQ7_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S8_Xmt,  float_buffer_L_EX, xmt_EQ8_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S9_Xmt,  float_buffer_L_EX, xmt_EQ9_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S10_Xmt, float_buffer_L_EX, xmt_EQ10_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S11_Xmt, float_buffer_L_EX, xmt_EQ11_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S12_Xmt, float_buffer_L_EX, xmt_EQ12_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S13_Xmt, float_buffer_L_EX, xmt_EQ13_float_buffer_L, 256);
-  arm_biquad_cascade_df2T_f32(&S14_Xmt, float_buffer_L_EX, xmt_EQ14_float_buffer_L, 256);
-
-  arm_scale_f32(xmt_EQ1_float_buffer_L,  -(float)EEPROMData.equalizerXmt[0] / 100.0,  xmt_EQ1_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ2_float_buffer_L,   (float)EEPROMData.equalizerXmt[1] / 100.0,  xmt_EQ2_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ3_float_buffer_L,  -(float)EEPROMData.equalizerXmt[2] / 100.0,  xmt_EQ3_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ4_float_buffer_L,   (float)EEPROMData.equalizerXmt[3] / 100.0,  xmt_EQ4_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ5_float_buffer_L,  -(float)EEPROMData.equalizerXmt[4] / 100.0,  xmt_EQ5_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ6_float_buffer_L,   (float)EEPROMData.equalizerXmt[5] / 100.0,  xmt_EQ6_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ7_float_buffer_L,  -(float)EEPROMData.equalizerXmt[6] / 100.0,  xmt_EQ7_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ8_float_buffer_L,   (float)EEPROMData.equalizerXmt[7] / 100.0,  xmt_EQ8_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ9_float_buffer_L,  -(float)EEPROMData.equalizerXmt[8] / 100.0,  xmt_EQ9_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ10_float_buffer_L,  (float)EEPROMData.equalizerXmt[9] / 100.0,  xmt_EQ10_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ11_float_buffer_L, -(float)EEPROMData.equalizerXmt[10] / 100.0, xmt_EQ11_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ12_float_buffer_L,  (float)EEPROMData.equalizerXmt[11] / 100.0, xmt_EQ12_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ13_float_buffer_L, -(float)EEPROMData.equalizerXmt[12] / 100.0, xmt_EQ13_float_buffer_L, 256);
-  arm_scale_f32(xmt_EQ14_float_buffer_L,  (float)EEPROMData.equalizerXmt[13] / 100.0, xmt_EQ14_float_buffer_L, 256);
-
-  arm_add_f32(xmt_EQ1_float_buffer_L , xmt_EQ2_float_buffer_L, float_buffer_L_EX , 256 ) ;
-
-  arm_add_f32(float_buffer_L_EX , xmt_EQ3_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ4_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ5_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ6_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ7_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ8_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ9_float_buffer_L,  float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ10_float_buffer_L, float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ11_float_buffer_L, float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ12_float_buffer_L, float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ13_float_buffer_L, float_buffer_L_EX , 256 ) ;
-  arm_add_f32(float_buffer_L_EX , xmt_EQ14_float_buffer_L, float_buffer_L_EX , 256 ) ;
+  Purpose: Gain of the receive equalizer at one frequency.  This is the response of DoReceiveEQ(), the sum of the 14
+           band filters scaled by equalizerRec[] with alternating signs, worked out from the band filter coefficients.
+
+  Parameter list:
+    float32_t omega   frequency, radians per sample at the decimated rate
+
+  Return value;
+    float32_t         magnitude of the equalizer response
+*****/
+float32_t ReceiveEQGain(float32_t omega)
+{
+  arm_biquad_cascade_df2T_instance_f32 *eqBands[] = { &S1_Rec, &S2_Rec, &S3_Rec, &S4_Rec, &S5_Rec, &S6_Rec, &S7_Rec,
+                                                      &S8_Rec, &S9_Rec, &S10_Rec, &S11_Rec, &S12_Rec, &S13_Rec, &S14_Rec };
+  float32_t c1 = cosf(omega), s1 = -sinf(omega);           // z^-1
+  float32_t c2 = cosf(2.0 * omega), s2 = -sinf(2.0 * omega);  // z^-2
+  float32_t sumRe = 0.0, sumIm = 0.0;
+  float32_t re, im, numRe, numIm, denRe, denIm, den, tempRe;
+  const float32_t *coeffs;
+
+  for (int band = 0; band < 14; band++) {
+    re = (band % 2 == 0 ? -1.0 : 1.0) * EEPROMData.equalizerRec[band] / 100.0;
+    im = 0.0;
+    coeffs = eqBands[band]->pCoeffs;
+    for (int stage = 0; stage < eqBands[band]->numStages; stage++, coeffs += 5) {
+      // CMSIS biquad: H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 - a1 z^-1 - a2 z^-2)
+      numRe = coeffs[0] + coeffs[1] * c1 + coeffs[2] * c2;
+      numIm = coeffs[1] * s1 + coeffs[2] * s2;
+      denRe = 1.0 - coeffs[3] * c1 - coeffs[4] * c2;
+      denIm = -coeffs[3] * s1 - coeffs[4] * s2;
+      den = denRe * denRe + denIm * denIm;
+      tempRe = (numRe * denRe + numIm * denIm) / den;  // num / den
+      numIm = (numIm * denRe - numRe * denIm) / den;
+      numRe = tempRe;
+      tempRe = re * numRe - im * numIm;
+      im = re * numIm + im * numRe;
+      re = tempRe;
+    }
+    sumRe += re;
+    sumIm += im;
+  }
+  return sqrtf(sumRe * sumRe + sumIm * sumIm);
+}
+
+/*****
+  Purpose: Fold the receive equalizer into a filter mask, so the equalizer costs nothing per block.  Each bin is
+           scaled by the equalizer gain at its audio frequency, which is the absolute bin frequency for USB, LSB,
+           AM, and CW alike.  The gains are worked out once for each receiveEQGeneration and FFT size.  The scaled
+           mask is taken back to the time domain and cut to m_NumTaps so the overlap-save convolution does not wrap
+           around, then transformed again.  The plain cut is the closest fit to the asked response with m_NumTaps;
+           a tapered cut only makes the narrow low bands shallower.  Below RECEIVE_EQ_FULL_FFT there are too few
+           taps for the 200 to 400 Hz bands, which would be 4 to 5 dB off at 256 and 512 points, so InitFilterMask()
+           leaves the equalizer out of the mask and DoReceiveEQ() runs it on the audio instead.
+
+  Parameter list:
+    float32_t *mask   convFFTLength complex bins, changed in place
+
+  Return value;
+    void
+*****/
+void ApplyReceiveEQ(float32_t *mask)
+{
+  uint32_t bin;
+
+  if (receiveEQBinGeneration != receiveEQGeneration || receiveEQBinLength != convFFTLength) {
+    for (bin = 0; bin <= convFFTLength / 2; bin++) {
+      receiveEQBinGain[bin] = ReceiveEQGain(TWO_PI * bin / convFFTLength);
+    }
+    receiveEQBinGeneration = receiveEQGeneration;
+    receiveEQBinLength = convFFTLength;
+  }
+  for (uint32_t i = 0; i < convFFTLength; i++) {
+    bin = (i <= convFFTLength / 2) ? i : convFFTLength - i;  // |frequency|, the upper half of the FFT is negative
+    mask[i * 2] *= receiveEQBinGain[bin];
+    mask[i * 2 + 1] *= receiveEQBinGain[bin];
+  }
+  arm_cfft_f32(maskS, mask, 1, 1);  // Inverse, scaled by 1 / convFFTLength
+  for (uint32_t i = m_NumTaps * 2; i < convFFTLength * 2; i++) {
+    mask[i] = 0.0;
+  }
+  arm_cfft_f32(maskS, mask, 0, 1);
+}
+
+struct eqBank_t xmtEQBank;
+
+/*****
+  Purpose: Set up an equalizer filter bank from its band filters and levels.  Each band's level, with the alternating
+           sign the 14 buffer equalizers used, is multiplied into the numerator of its last stage, so the bank output
+           is just the sum of the band outputs.  Bands set to zero are left out, and the others are packed to the front
+           of the bank.  The filter state is cleared.
+
+  Parameter list:
+    struct eqBank_t *bank                                 the bank
+    arm_biquad_cascade_df2T_instance_f32 *const filters[] EQUALIZER_CELL_COUNT band filters
+    const int levels[]                                    EQUALIZER_CELL_COUNT levels, 100 for unity gain
+  Return value;
+    void
+*****/
+void EQBankLoad(struct eqBank_t *bank, arm_biquad_cascade_df2T_instance_f32 *const filters[], const int levels[])
+{
+  float32_t level;
+  int k = 0;
+
+  for (int band = 0; band < EQUALIZER_CELL_COUNT; band++) {
+    level = (band % 2 == 0 ? -1.0 : 1.0) * levels[band] / 100.0;
+    if (level == 0.0) continue;
+    for (int stage = 0; stage < IIR_NUMSTAGES; stage++) {
+      for (int i = 0; i < 5; i++) {
+        bank->coeffs[stage][i][k] = filters[band]->pCoeffs[5 * stage + i];
+      }
+    }
+    for (int i = 0; i < 3; i++) {
+      bank->coeffs[IIR_NUMSTAGES - 1][i][k] *= level;  // b0, b1, b2
+    }
+    k++;
+  }
+  bank->bands = k;
+  memset(bank->state, 0, sizeof(bank->state));
+}
+
+/*****
+  Purpose: Run a block through an equalizer filter bank.  Each sample goes through every band, one stage at a time
+           across all the bands, and the band outputs are summed.  The bands are independent, so the work of one
+           stage is a loop over bands with no chain from one band to the next, and the compiler can keep several
+           bands in flight.  This gives the same result as separate cascades, scales, and adds, without the
+           intermediate buffers.
+
+  Parameter list:
+    struct eqBank_t *bank     the bank, from EQBankLoad()
+    const float32_t *in       blockSize samples
+    float32_t *out            blockSize samples, may be in
+    uint32_t blockSize        samples to run
+  Return value;
+    void
+*****/
+void EQBankRun(struct eqBank_t *bank, const float32_t *in, float32_t *out, uint32_t blockSize)
+{
+  const int bands = bank->bands;
+  float32_t x[EQUALIZER_CELL_COUNT];
+  float32_t y, sum;
+
+  for (uint32_t i = 0; i < blockSize; i++) {
+    for (int k = 0; k < bands; k++) {
+      x[k] = in[i];
+    }
+    for (int stage = 0; stage < IIR_NUMSTAGES; stage++) {
+      const float32_t *b0 = bank->coeffs[stage][0], *b1 = bank->coeffs[stage][1], *b2 = bank->coeffs[stage][2];
+      const float32_t *a1 = bank->coeffs[stage][3], *a2 = bank->coeffs[stage][4];
+      float32_t *d1 = bank->state[stage][0], *d2 = bank->state[stage][1];
+      for (int k = 0; k < bands; k++) {
+        y = b0[k] * x[k] + d1[k];
+        d1[k] = b1[k] * x[k] + a1[k] * y + d2[k];
+        d2[k] = b2[k] * x[k] + a2[k] * y;
+        x[k] = y;
+      }
+    }
+    sum = 0.0;
+    for (int k = 0; k < bands; k++) {
+      sum += x[k];
+    }
+    out[i] = sum;
+  }
+}
+
+struct eqBank_t recEQBank;
+static uint32_t recEQBankGeneration = 0;  // receiveEQGeneration loaded into recEQBank
+
+/*****
+  Purpose: Receive equalizer for filter FFTs shorter than RECEIVE_EQ_FULL_FFT, in place on the 256 demodulated
+           samples in float_buffer_L, which are then copied to float_buffer_R.  The bank is reloaded from
+           equalizerRec[] when receiveEQGeneration has moved on.  From RECEIVE_EQ_FULL_FFT up the equalizer is
+           folded into the filter mask instead, see ApplyReceiveEQ().
+
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void DoReceiveEQ()
+{
+  arm_biquad_cascade_df2T_instance_f32 *const eqBands[] = { &S1_Rec, &S2_Rec, &S3_Rec, &S4_Rec, &S5_Rec, &S6_Rec, &S7_Rec,
+                                                            &S8_Rec, &S9_Rec, &S10_Rec, &S11_Rec, &S12_Rec, &S13_Rec, &S14_Rec };
+
+  if (recEQBankGeneration != receiveEQGeneration) {
+    EQBankLoad(&recEQBank, eqBands, EEPROMData.equalizerRec);
+    recEQBankGeneration = receiveEQGeneration;
+  }
+  EQBankRun(&recEQBank, float_buffer_L, float_buffer_L, FFT_length / 2);
+  arm_copy_f32(float_buffer_L, float_buffer_R, FFT_length / 2);
+}
+
+/*****
+  Purpose: Set up the transmit equalizer filter bank from the band filters and equalizerXmt[].
+           Call after the transmit EQ levels change.
+
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void XmitEQLoadValues()
+{
+  arm_biquad_cascade_df2T_instance_f32 *const eqBands[] = { &S1_Xmt, &S2_Xmt, &S3_Xmt, &S4_Xmt, &S5_Xmt, &S6_Xmt, &S7_Xmt,
+                                                            &S8_Xmt, &S9_Xmt, &S10_Xmt, &S11_Xmt, &S12_Xmt, &S13_Xmt, &S14_Xmt };
+
+  EQBankLoad(&xmtEQBank, eqBands, EEPROMData.equalizerXmt);
+}
+
+/*****
+  Purpose: Transmit equalizer, in place on the 256 samples in float_buffer_L_EX.
+
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void DoExciterEQ()
+{
+  EQBankRun(&xmtEQBank, float_buffer_L_EX, float_buffer_L_EX, 256);
 }
 
 /*****
@@ -124,9 +237,8 @@ void DoExciterEQ() //AFP 10-02-22
 *****/
 void FilterBandwidth()
 {
-  AudioNoInterrupts();
-
-  CalcCplxFIRCoeffs(FIR_Coef_I, FIR_Coef_Q, m_NumTaps, (float32_t)bands[EEPROMData.currentBand].FLoCut, (float32_t)bands[EEPROMData.currentBand].FHiCut, (float)SR[SampleRate].rate / DF);
+  // Nothing here is touched by the audio interrupt, and the new filter mask is swapped in by ProcessIQData() at a
+  // block boundary, so the audio interrupts are left running and the input queues keep filling.
   InitFilterMask();
 
   // also adjust IIR AM filter
@@ -144,12 +256,25 @@ void FilterBandwidth()
   SetDecIntFilters();
   ShowBandwidth();
 //BandInformation();
-  MyDelay(1L);
-  AudioInterrupts();
 } // end filter_bandwidth
 
+float32_t DMAMEM filterMaskCache[FILTER_MASK_CACHE_SIZE][FFT_LENGTH_MAX * 2] __attribute__((aligned(4)));
+struct filterMaskEntry_t filterMaskEntry[FILTER_MASK_CACHE_SIZE];
+float32_t *FIR_filter_mask = filterMaskCache[0];  // Mask used by the convolution
+float32_t *filterMaskPending = NULL;              // Mask to use from the next block on
+static struct filterMaskEntry_t filterMaskRequest;  // Mask waiting for FilterMaskBuild(), if valid
+uint32_t filterMaskUseCount = 0;
+uint32_t filterMaskHits = 0;
+uint32_t filterMaskMisses = 0;
+
 /*****
   Purpose: InitFilterMask()
+           Select the FIR filter mask for the current band's mode and filter edges, with the receive equalizer
+           folded in when it is on and the FFT has RECEIVE_EQ_FULL_FFT points or more.  A cached mask is reused if
+           there is one, and becomes active at the start of the next ProcessIQData() block.  Otherwise the mask is
+           left for FilterMaskBuild() to make when the receive scheduler is idle, and the convolution keeps the
+           mask it has until then.  Only the latest request is kept, so turning the filter encoder quickly does not
+           build the masks it passes through.
 
   Parameter list:
     void
@@ -159,30 +284,165 @@ void FilterBandwidth()
 *****/
 void InitFilterMask()
 {
+  int mode = bands[EEPROMData.currentBand].mode;
+  int FLoCut = bands[EEPROMData.currentBand].FLoCut;
+  int FHiCut = bands[EEPROMData.currentBand].FHiCut;
+  uint32_t eqGeneration = 0;  // 0 for no equalizer in the mask
+  int slot = -1;
+
+  if (EEPROMData.receiveEQFlag == ON && convFFTLength >= RECEIVE_EQ_FULL_FFT) {  // Shorter FFTs use DoReceiveEQ()
+    eqGeneration = receiveEQGeneration;
+  }
+
+  filterMaskUseCount++;
+  for (int i = 0; i < FILTER_MASK_CACHE_SIZE; i++) {
+    if (filterMaskEntry[i].valid && filterMaskEntry[i].mode == mode && filterMaskEntry[i].FLoCut == FLoCut
+        && filterMaskEntry[i].FHiCut == FHiCut && filterMaskEntry[i].fftLength == convFFTLength
+        && filterMaskEntry[i].eqGeneration == eqGeneration) {
+      slot = i;
+      break;
+    }
+  }
+
+  if (slot >= 0) {
+    filterMaskHits++;
+    filterMaskRequest.valid = false;  // Cancel a build for an earlier setting
+    filterMaskEntry[slot].lastUsed = filterMaskUseCount;
+    filterMaskPending = filterMaskCache[slot];
+  } else {
+    filterMaskMisses++;
+    filterMaskRequest.valid = true;
+    filterMaskRequest.mode = mode;
+    filterMaskRequest.FLoCut = FLoCut;
+    filterMaskRequest.FHiCut = FHiCut;
+    filterMaskRequest.fftLength = convFFTLength;
+    filterMaskRequest.eqGeneration = eqGeneration;
+    filterMaskPending = NULL;  // A mask selected earlier is out of date too
+  }
+} // end init_filter_mask
+
+/*****
+  Purpose: Make the filter mask InitFilterMask() left waiting, in the least recently used slot the convolution is
+           not using, with CalcCplxFIRCoeffs() and the mask FFT.  It becomes active at the start of the next
+           ProcessIQData() block.  Called by ServiceReceiveDSP() when no block is waiting, and straight after
+           InitFilterMask() where the mask is needed at once.  Does nothing if no mask is waiting.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void FilterMaskBuild()
+{
+  int slot = -1;
+  float32_t *mask;
+
+  if (filterMaskRequest.valid == false) {
+    return;
+  }
+  for (int i = 0; i < FILTER_MASK_CACHE_SIZE; i++) {  // Empty slots have lastUsed == 0 and go first
+    if (filterMaskCache[i] == FIR_filter_mask) continue;  // The convolution is still using this one
+    if (slot < 0 || filterMaskEntry[i].lastUsed < filterMaskEntry[slot].lastUsed) slot = i;
+  }
+  mask = filterMaskCache[slot];
+
+  CalcCplxFIRCoeffs(FIR_Coef_I, FIR_Coef_Q, m_NumTaps, (float32_t)filterMaskRequest.FLoCut,
+                    (float32_t)filterMaskRequest.FHiCut, decimatedRate);
 
   /****************************************************************************************
      Calculate the FFT of the FIR filter coefficients once to produce the FIR filter mask
   ****************************************************************************************/
-  // the FIR has exactly m_NumTaps and a maximum of (FFT_length / 2) + 1 taps = coefficients, so we have to add (FFT_length / 2) -1 zeros before the FFT
-  // in order to produce a FFT_length point input buffer for the FFT
+  // the FIR has exactly m_NumTaps and a maximum of (convFFTLength / 2) + 1 taps = coefficients, so we have to add (convFFTLength / 2) -1 zeros before the FFT
+  // in order to produce a convFFTLength point input buffer for the FFT
   // copy coefficients into real values of first part of buffer, rest is zero
 
   for (unsigned i = 0; i < m_NumTaps; i++) {
     // try out a window function to eliminate ringing of the filter at the stop frequency
     //             sd.FFT_Samples[i] = (float32_t)((0.53836 - (0.46164 * arm_cos_f32(PI*2 * (float32_t)i / (float32_t)(FFT_IQ_BUFF_LEN-1)))) * sd.FFT_Samples[i]);
-    FIR_filter_mask[i * 2] = FIR_Coef_I [i];
-    FIR_filter_mask[i * 2 + 1] = FIR_Coef_Q [i];
+    mask[i * 2] = FIR_Coef_I [i];
+    mask[i * 2 + 1] = FIR_Coef_Q [i];
   }
 
-  for (unsigned i = FFT_length + 1; i < FFT_length * 2; i++) {
-    FIR_filter_mask[i] = 0.0;
+  for (unsigned i = convFFTLength + 1; i < convFFTLength * 2; i++) {
+    mask[i] = 0.0;
   }
 
-  // FFT of FIR_filter_mask
+  // FFT of the mask
   // perform FFT (in-place), needs only to be done once (or every time the filter coeffs change)
-  arm_cfft_f32(maskS, FIR_filter_mask, 0, 1);
+  arm_cfft_f32(maskS, mask, 0, 1);
+  if (filterMaskRequest.eqGeneration != 0) {
+    ApplyReceiveEQ(mask);
+  }
+  filterMaskEntry[slot] = filterMaskRequest;
+  filterMaskEntry[slot].lastUsed = filterMaskUseCount;
+  filterMaskRequest.valid = false;
+  filterMaskPending = mask;
+}
 
-} // end init_filter_mask
+/*****
+  Purpose: Re-plan the overlap-save convolution for a new FFT size: the CFFT instances, the filter length, the
+           samples taken per FFT and the history.  The decimated block stays FFT_length / 2 = 256 samples because
+           the demodulators, noise reduction and CW code are all written for that block, so the input queue depth
+           does not change.  Each FFT takes min(length / 2, 256) new samples after length - that many samples of
+           history.  256 points runs two 128 sample FFTs per block with a 129 tap filter for the least delay.
+           1024 and 2048 points keep 768 or 1792 samples of history and give 513 or 1025 taps for steeper skirts.
+           Only the group delay of the filter, length / 4 samples, changes with the size.  The wait for a whole
+           block, 10.7 ms, the AGC look-ahead, 4 ms, and the decimation and interpolation filters do not, so the
+           Latency host test measures 19, 22, 27, and 38 ms from a click to its sound.  The Filter FFT menu shows it.
+           Called between blocks, so the new mask is made active straight away.
+
+  Parameter list:
+    uint32_t length   256, 512, 1024, or 2048.  Anything else selects 512.
+
+  Return value;
+    void
+*****/
+void SetConvolutionSize(uint32_t length)
+{
+  switch (length) {
+    case 256:
+      S = &arm_cfft_sR_f32_len256;
+      break;
+    case 1024:
+      S = &arm_cfft_sR_f32_len1024;
+      break;
+    case 2048:
+      S = &arm_cfft_sR_f32_len2048;
+      break;
+    default:
+      length = 512;
+      S = &arm_cfft_sR_f32_len512;
+      break;
+  }
+  iS = S;
+  maskS = S;
+  convFFTLength = length;
+  convNewSamples = (length / 2 < FFT_length / 2) ? length / 2 : FFT_length / 2;
+  m_NumTaps = (length / 2) + 1;
+  memset(convHistory, 0, sizeof(float32_t) * 2 * (convFFTLength - convNewSamples));
+  InitFilterMask();
+  FilterMaskBuild();  // The old mask is the wrong size, so this one cannot wait for the scheduler
+  FilterMaskSwap();
+}
+
+/*****
+  Purpose: Make a newly selected filter mask active.  Called by ProcessIQData() at the start of a block, so a block
+           is always filtered with one complete mask.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void FilterMaskSwap()
+{
+  if (filterMaskPending != NULL) {
+    FIR_filter_mask = filterMaskPending;
+    filterMaskPending = NULL;
+  }
+}
 
 /*****
   Purpose: void control_filter_f()
@@ -238,10 +498,177 @@ void SetDecIntFilters()
   if (LP_F_help > 10000) {
     LP_F_help = 10000;
   }
+#ifdef DECIMATE_REFERENCE
   CalcFIRCoeffs(FIR_dec1_coeffs, n_dec1_taps, (float32_t)(LP_F_help), n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate));
   CalcFIRCoeffs(FIR_dec2_coeffs, n_dec2_taps, (float32_t)(LP_F_help), n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
-
   CalcFIRCoeffs(FIR_int1_coeffs, 48, (float32_t)(LP_F_help), n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
   CalcFIRCoeffs(FIR_int2_coeffs, 32, (float32_t)(LP_F_help), n_att, 0, 0.0, (float32_t)SR[SampleRate].rate);
+#else
+  SetDecimatorBandwidth(LP_F_help);
+  SetInterpolatorBandwidth(LP_F_help);
+#endif
   bin_BW = 1.0 / (DF * FFT_length) * (float32_t)SR[SampleRate].rate;
 }
+
+struct polyphaseDecimator_t decimator1;  // Front end rate to 48K, not used at 48K
+struct polyphaseDecimator_t decimator2;  // 48K to 24K
+float32_t decimateCoeffs1[DECIMATE_BUCKETS][DECIMATE_MAX_TAPS];
+float32_t decimateCoeffs2[DECIMATE_BUCKETS][DECIMATE_MAX_TAPS];
+bool decimateBucketReady[DECIMATE_BUCKETS];
+
+/*****
+  Purpose: Set up the two receive polyphase decimators.  They use the same tap counts as the original
+           arm_fir_decimate_f32() filters, and share their state buffers because only one of the two paths runs.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void InitPolyphaseDecimators()
+{
+  if (n_dec1_taps > DECIMATE_MAX_TAPS || n_dec2_taps > DECIMATE_MAX_TAPS) {
+    Serial.println("DECIMATE_MAX_TAPS is too small");
+    while (1)
+      ;
+  }
+  decimator1.numTaps = n_dec1_taps;
+  decimator1.factor = (uint16_t)DF1;
+  decimator1.blockSize = BUFFER_SIZE * N_BLOCKS;
+  decimator1.stateI = FIR_dec1_I_state;
+  decimator1.stateQ = FIR_dec1_Q_state;
+
+  decimator2.numTaps = n_dec2_taps;
+  decimator2.factor = (uint16_t)DF2;
+  decimator2.blockSize = BUFFER_SIZE * N_BLOCKS / (uint32_t)DF1;
+  decimator2.stateI = FIR_dec2_I_state;
+  decimator2.stateQ = FIR_dec2_Q_state;
+
+  memset(decimator1.stateI, 0, (decimator1.numTaps - 1) * sizeof(float32_t));
+  memset(decimator1.stateQ, 0, (decimator1.numTaps - 1) * sizeof(float32_t));
+  memset(decimator2.stateI, 0, (decimator2.numTaps - 1) * sizeof(float32_t));
+  memset(decimator2.stateQ, 0, (decimator2.numTaps - 1) * sizeof(float32_t));
+  for (int i = 0; i < DECIMATE_BUCKETS; i++) {
+    decimateBucketReady[i] = false;
+  }
+  SetDecimatorBandwidth((int)(n_desired_BW * 1000.0));
+}
+
+/*****
+  Purpose: Point both decimators at the cached design for a bandwidth, designing it the first time the bucket is used.
+           The cutoff is rounded up to the top of its DECIMATE_BUCKET_HZ bucket, so the passband is never narrower
+           than asked for.  Only the coefficient pointers change, so the filter state carries over.
+
+  Parameter list:
+    int bandwidth     highest audio frequency to pass, Hz
+
+  Return value;
+    void
+*****/
+void SetDecimatorBandwidth(int bandwidth)
+{
+  int bucket = (bandwidth + DECIMATE_BUCKET_HZ - 1) / DECIMATE_BUCKET_HZ - 1;
+
+  if (bucket < 0) bucket = 0;
+  if (bucket >= DECIMATE_BUCKETS) bucket = DECIMATE_BUCKETS - 1;
+  if (decimateBucketReady[bucket] == false) {
+    float32_t cutoff = (float32_t)((bucket + 1) * DECIMATE_BUCKET_HZ);
+    CalcFIRCoeffs(decimateCoeffs1[bucket], n_dec1_taps, cutoff, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate));
+    CalcFIRCoeffs(decimateCoeffs2[bucket], n_dec2_taps, cutoff, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
+    decimateBucketReady[bucket] = true;
+  }
+  decimator1.coeffs = decimateCoeffs1[bucket];
+  decimator2.coeffs = decimateCoeffs2[bucket];
+}
+
+float32_t interpolateCoeffs1[DECIMATE_BUCKETS][INTERPOLATE1_TAPS];
+float32_t interpolateCoeffs2[DECIMATE_BUCKETS][INTERPOLATE2_TAPS];
+bool interpolateBucketReady[DECIMATE_BUCKETS];
+static uint32_t interpolateRate = 0;  // Front end rate the cached designs were made for
+
+/*****
+  Purpose: Point the audio interpolators at the cached design for a bandwidth, designing it the first time the bucket
+           is used at this front end rate.  The buckets are the decimators' DECIMATE_BUCKET_HZ buckets, rounded up the
+           same way.  The images the interpolators remove start at 24 kHz less the bandwidth, well clear of the top
+           of the bucket.  Only the coefficient pointers change, so the filter state carries over.
+
+  Parameter list:
+    int bandwidth     highest audio frequency to pass, Hz
+
+  Return value;
+    void
+*****/
+void SetInterpolatorBandwidth(int bandwidth)
+{
+  int bucket = (bandwidth + DECIMATE_BUCKET_HZ - 1) / DECIMATE_BUCKET_HZ - 1;
+
+  if (interpolateRate != SR[SampleRate].rate) {
+    for (int i = 0; i < DECIMATE_BUCKETS; i++) {
+      interpolateBucketReady[i] = false;
+    }
+    interpolateRate = SR[SampleRate].rate;
+  }
+  if (bucket < 0) bucket = 0;
+  if (bucket >= DECIMATE_BUCKETS) bucket = DECIMATE_BUCKETS - 1;
+  if (interpolateBucketReady[bucket] == false) {
+    float32_t cutoff = (float32_t)((bucket + 1) * DECIMATE_BUCKET_HZ);
+    CalcFIRCoeffs(interpolateCoeffs1[bucket], INTERPOLATE1_TAPS, cutoff, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
+    CalcFIRCoeffs(interpolateCoeffs2[bucket], INTERPOLATE2_TAPS, cutoff, n_att, 0, 0.0, (float32_t)SR[SampleRate].rate);
+    interpolateBucketReady[bucket] = true;
+  }
+  FIR_int1_I.pCoeffs = FIR_int1_Q.pCoeffs = interpolateCoeffs1[bucket];
+  FIR_int2_I.pCoeffs = FIR_int2_Q.pCoeffs = interpolateCoeffs2[bucket];
+}
+
+/*****
+  Purpose: Decimate I and Q together, in place, evaluating only the outputs that are kept.
+
+           Each output is the dot product of the taps with the numTaps input samples ending at that output, which is
+           the polyphase sum over the M input phases done without splitting the coefficients.  I and Q share every
+           coefficient load.  CalcFIRCoeffs() low pass designs are symmetric about numTaps / 2 apart from the first
+           tap, so the symmetric part is folded to halve the multiplies.
+
+  Parameter list:
+    struct polyphaseDecimator_t *S    decimator to run
+    float32_t *I_buffer               blockSize samples in, blockSize / factor samples out
+    float32_t *Q_buffer
+
+  Return value;
+    void
+*****/
+void PolyphaseDecimate(struct polyphaseDecimator_t *S, float32_t *I_buffer, float32_t *Q_buffer)
+{
+  uint32_t numTaps = S->numTaps;
+  uint32_t factor = S->factor;
+  uint32_t blockSize = S->blockSize;
+  uint32_t folded = (numTaps - 1) / 2;  // Symmetric pairs in coeffs[1] to coeffs[numTaps - 1]
+  const float32_t *h = S->coeffs;
+  const float32_t *xI, *xQ;
+  float32_t sumI, sumQ;
+  uint32_t i, k, out;
+
+  // The last numTaps - 1 inputs of the previous block are already at the start of the state buffers.
+  memcpy(&S->stateI[numTaps - 1], I_buffer, blockSize * sizeof(float32_t));
+  memcpy(&S->stateQ[numTaps - 1], Q_buffer, blockSize * sizeof(float32_t));
+
+  for (i = factor - 1, out = 0; i < blockSize; i += factor, out++) {
+    xI = &S->stateI[i];  // Oldest sample of this output's window
+    xQ = &S->stateQ[i];
+    sumI = h[0] * xI[0];
+    sumQ = h[0] * xQ[0];
+    for (k = 1; k <= folded; k++) {
+      sumI += h[k] * (xI[k] + xI[numTaps - k]);
+      sumQ += h[k] * (xQ[k] + xQ[numTaps - k]);
+    }
+    if (((numTaps - 1) & 1) != 0) {  // Centre tap
+      sumI += h[folded + 1] * xI[folded + 1];
+      sumQ += h[folded + 1] * xQ[folded + 1];
+    }
+    I_buffer[out] = sumI;
+    Q_buffer[out] = sumQ;
+  }
+
+  memmove(S->stateI, &S->stateI[blockSize], (numTaps - 1) * sizeof(float32_t));
+  memmove(S->stateQ, &S->stateQ[blockSize], (numTaps - 1) * sizeof(float32_t));
+}
@@ -37,103 +37,93 @@ void FreqShift1()
     float_buffer_L[i + 3] = hh1;
     float_buffer_R[i + 3] = hh2;
   }
-  for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS; i ++) {
-    float_buffer_L_3[i] = float_buffer_L[i];
-    float_buffer_R_3[i] = float_buffer_R[i];
-  }
   // this is for -Fs/4 [moves receive frequency to the right in the spectrumdisplay]
 }
 
 /*****
-  Purpose: Shift Receive frequency by an arbitray amount
+  Purpose: Update TxRxFreq and work out the NCO phase step, including the CW sidetone offset.
 
   Parameter list:
     void
 
   Return value;
-    void
-    Notes:  Routine includes checks to ensure the frequency selection stays within the bounds of the
-    displayed spectrum
-    Also included a variable frequency step, depending on how fast the encoder id turned.  Step varies from 50Hz/step to 10KHz/step
-
-    freq_conv2()
-
-    FREQUENCY CONVERSION USING A SOFTWARE QUADRATURE OSCILLATOR (NCO)
-
-    THIS VERSION calculates the COS AND SIN WAVE on the fly AND IS SLOW
-
-    MAJOR ADVANTAGE: frequency conversion can be done for any frequency !
-
-    large parts of the code taken from the mcHF code by Clint, KA7OEI, thank you!
-      see here for more info on quadrature oscillators:
-    Wheatley, M. (2011): CuteSDR Technical Manual Ver. 1.01. - http://sourceforge.net/projects/cutesdr/
-    Lyons, R.G. (2011): Understanding Digital Processing. – Pearson, 3rd edition.
-    Requires 4 complex multiplies and two adds per data point within the time domain buffer.  Applied after the data
-    stream is sent to the Zoom FFT , but befor decimation.
+    float32_t         NCO phase increment in radians per front end sample, also left in NCO_INC
 *****/
-void FreqShift2()
+float32_t UpdateNCO()
 {
-  uint i;
-  //long currentFreqAOld;  Not used.  KF5N July 22, 2023
   int sideToneShift = 0;
   int cwFreqOffset;
 
   if (fineTuneEncoderMove != 0L) {
-   // SetFreq();           //AFP 10-04-22
-   // ShowFrequency();
-   // DrawBandWidthIndicatorBar();
-
-    // ); //AFP 10-04-22
-    // EncoderFineTune();      //AFP 10-04-22
-
-    if (NCOFreq > 40000L) {
-      NCOFreq = 40000L;
+    if (NCOFreq > IFFreq * 5 / 6) {  // 40 kHz at 192K
+      NCOFreq = IFFreq * 5 / 6;
     }
-    // EEPROMData.centerFreq += EEPROMData.freqIncrement;
     currentFreq = EEPROMData.centerFreq + NCOFreq;
-    //SetFreq(); //AFP 10-04-22
-    //ShowFrequency();
   }
 
   encoderStepOld = fineTuneEncoderMove;
-  //currentFreqAOld = TxRxFreq;
   TxRxFreq = EEPROMData.centerFreq + NCOFreq;
-  //if (abs(currentFreqAOld - TxRxFreq) < 9 * EEPROMData.stepFineTune && currentFreqAOld != TxRxFreq) {  // AFP 10-30-22
-  //  ShowFrequency();
-  //  DrawBandWidthIndicatorBar();
-  //}
-  if (EEPROMData.xmtMode == SSB_MODE ) {
-    sideToneShift = 0;
-  } else {
-    if (EEPROMData.xmtMode == CW_MODE ) {
-      cwFreqOffset = (EEPROMData.CWOffset + 6) * 24000 / 256;
-      if (bands[EEPROMData.currentBand].mode == 1) {
-        sideToneShift = cwFreqOffset;  // KF5N experiment
-      } else {
-        if (bands[EEPROMData.currentBand].mode == 0) {
-          sideToneShift = -cwFreqOffset;  // KF5N experiment
-        }
+  if (EEPROMData.xmtMode == CW_MODE ) {
+    cwFreqOffset = (EEPROMData.CWOffset + 6) * (int)decimatedRate / 256;
+    if (bands[EEPROMData.currentBand].mode == 1) {
+      sideToneShift = cwFreqOffset;  // KF5N experiment
+    } else {
+      if (bands[EEPROMData.currentBand].mode == 0) {
+        sideToneShift = -cwFreqOffset;  // KF5N experiment
       }
     }
   }
-  NCO_INC = 2.0 * PI * (NCOFreq + sideToneShift) / 192000.0; //192000 SPS is the actual sample rate used in the Receive ADC
-
-  OSC_COS = cos (NCO_INC);
-  OSC_SIN = sin (NCO_INC);
-
-  for (i = 0; i < BUFFER_SIZE * N_BLOCKS; i++) {
-    // generate local oscillator on-the-fly:  This takes a lot of processor time!
-    Osc_Q = (Osc_Vect_Q * OSC_COS) - (Osc_Vect_I * OSC_SIN);  // Q channel of oscillator
-    Osc_I = (Osc_Vect_I * OSC_COS) + (Osc_Vect_Q * OSC_SIN);  // I channel of oscillator
-    Osc_Gain = 1.95 - ((Osc_Vect_Q * Osc_Vect_Q) + (Osc_Vect_I * Osc_Vect_I));  // Amplitude control of oscillator
-
-    // rotate vectors while maintaining constant oscillator amplitude
-    Osc_Vect_Q = Osc_Gain * Osc_Q;
-    Osc_Vect_I = Osc_Gain * Osc_I;
-    //
-    // do actual frequency conversion
-    float freqAdjFactor = 1.1;
-    float_buffer_L[i] = (float_buffer_L_3[i] * freqAdjFactor * Osc_Q) + (float_buffer_R_3[i] * freqAdjFactor * Osc_I); // multiply I/Q data by sine/cosine data to do translation
-    float_buffer_R[i] = (float_buffer_R_3[i] * freqAdjFactor * Osc_Q) - (float_buffer_L_3[i] * freqAdjFactor * Osc_I);
+  NCO_INC = 2.0 * PI * (NCOFreq + sideToneShift) / (float32_t)SR[SampleRate].rate;  // The receive ADC sample rate
+  return NCO_INC;
+}
+
+double ncoPhase = 0.0;  // FreqShiftMixer() oscillator phase at the start of the next block, radians
+
+/*****
+  Purpose: Fused Fs/4 and NCO frequency shift, in place on float_buffer_L/R.
+
+           The Fs/4 shift is a rotation by pi/2 per sample, so it folds into the oscillator step and the pair costs
+           one complex multiply per sample.  When the zoom FFT needs the Fs/4 shifted samples, FreqShift1() has
+           already run and includeFs4 is false.  The Fs/4 phase restarts at every block, so both cases share the
+           same phase accumulator.
+
+           The oscillator is a complex rotation in single precision.  It is re-anchored from the double precision
+           phase accumulator every BUFFER_SIZE samples, which keeps amplitude and phase drift below the float
+           rounding of 128 steps without the per-sample amplitude control of the original oscillator.
+
+  Parameter list:
+    bool includeFs4   true to do the Fs/4 shift here as well
+
+  Return value;
+    void
+*****/
+void FreqShiftMixer(bool includeFs4)
+{
+  float32_t increment;
+  float32_t stepCos, stepSin;
+  float32_t oscCos, oscSin, oscTemp;
+  float32_t I_sample, Q_sample;
+  uint32_t i, j;
+
+  increment = -UpdateNCO();  // The original oscillator rotated the opposite way to NCO_INC
+  if (includeFs4) {
+    increment += HALF_PI;
+  }
+  stepCos = cosf(increment);
+  stepSin = sinf(increment);
+
+  for (i = 0; i < BUFFER_SIZE * N_BLOCKS; i += BUFFER_SIZE) {
+    oscCos = FREQ_SHIFT_GAIN * cos(ncoPhase);
+    oscSin = FREQ_SHIFT_GAIN * sin(ncoPhase);
+    for (j = i; j < i + BUFFER_SIZE; j++) {
+      I_sample = float_buffer_L[j];
+      Q_sample = float_buffer_R[j];
+      float_buffer_L[j] = I_sample * oscCos - Q_sample * oscSin;
+      float_buffer_R[j] = I_sample * oscSin + Q_sample * oscCos;
+      oscTemp = oscCos * stepCos - oscSin * stepSin;
+      oscSin = oscCos * stepSin + oscSin * stepCos;
+      oscCos = oscTemp;
+    }
+    ncoPhase = fmod(ncoPhase - (double)NCO_INC * BUFFER_SIZE, TWO_PI);  // Fs/4 adds whole turns over BUFFER_SIZE samples
   }
 }
@@ -67,8 +67,6 @@ volatile bool has_moved = false;
 volatile long start_freq;
 volatile long new_freq;
 
-static long zoomBandwidth[5]= {192000L,96000L,48000L,24000L,12000L};
-
 volatile int16_t last_X;
 
 volatile int16_t encoder_value[4] = {0,0,0,0};
@@ -108,7 +106,8 @@ FASTRUN
 static void process_touch() {
   Debug(String(__FUNCTION__));
   if(menuStatus==NO_MENUS_ACTIVE) {
-    long hzPerPixel = zoomBandwidth[EEPROMData.spectrum_zoom]/SPECTRUM_RES;;
+    long zoomBandwidth = (long)SR[SampleRate].rate >> EEPROMData.spectrum_zoom;  // Displayed span
+    long hzPerPixel = zoomBandwidth/SPECTRUM_RES;
     if(touch_status==TOUCH_PRESSED) {
       if(!pressed) {
         if(touch_X<SPECTRUM_RES) {
@@ -143,9 +142,9 @@ static void process_touch() {
         } else {
           int x=last_X-SPECTRUM_LEFT_X;
           if (EEPROMData.activeVFO == VFO_A) {
-            start_freq = EEPROMData.currentFreqA - (zoomBandwidth[EEPROMData.spectrum_zoom]/2);
+            start_freq = EEPROMData.currentFreqA - (zoomBandwidth/2);
           } else {
-            start_freq = EEPROMData.currentFreqB - (zoomBandwidth[EEPROMData.spectrum_zoom]/2);
+            start_freq = EEPROMData.currentFreqB - (zoomBandwidth/2);
           }
           new_freq = start_freq + (x * hzPerPixel);
           new_freq = (new_freq/EEPROMData.freqIncrement)*EEPROMData.freqIncrement;
@@ -426,12 +425,12 @@ void front_panel_interrupt() {
       }
       // ===============  Recentering at band edges ==========
       if (EEPROMData.spectrum_zoom != 0) {
-        if (NCOFreq > (95000 / (1 << EEPROMData.spectrum_zoom)) || NCOFreq < (-93000 / (1 << EEPROMData.spectrum_zoom))) {
+        if (NCOFreq > ((2 * IFFreq - 1000) / (1 << EEPROMData.spectrum_zoom)) || NCOFreq < (-(2 * IFFreq - 3000) / (1 << EEPROMData.spectrum_zoom))) {
           NCOFreq    = 0L;
           EEPROMData.centerFreq = TxRxFreq = EEPROMData.currentFreqA;
         }
       } else {
-        if (NCOFreq > (142000) || NCOFreq < (-43000)) {  // Offset tuning window in zoom 1x
+        if (NCOFreq > (3 * IFFreq - 2000) || NCOFreq < (-(IFFreq - 5000))) {  // Offset tuning window in zoom 1x
           NCOFreq    = 0L;
           EEPROMData.centerFreq = TxRxFreq = EEPROMData.currentFreqA;  //AFP 10-28-22
         }
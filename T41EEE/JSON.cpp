@@ -102,6 +102,13 @@ FLASHMEM void loadConfiguration(const char *filename, config_t &EEPROMData) {
   EEPROMData.buttonThresholdPressed = doc["buttonThresholdPressed"] | 944;
   EEPROMData.buttonThresholdReleased = doc["buttonThresholdReleased"] | 964;
   EEPROMData.buttonRepeatDelay = doc["buttonRepeatDelay"] | 300000;
+  EEPROMData.convFFTLength = doc["convFFTLength"] | FFT_LENGTH;
+  EEPROMData.rxSampleRate = doc["rxSampleRate"] | SAMPLE_RATE_192K;
+  EEPROMData.spectrumWindow = doc["spectrumWindow"] | SPECTRUM_WINDOW_HANN;
+  EEPROMData.spectrumAverage = doc["spectrumAverage"] | SPECTRUM_AVERAGE_EXPONENTIAL;
+  EEPROMData.spectrumFFTSize = doc["spectrumFFTSize"] | SPECTRUM_RES;
+  EEPROMData.cwSkimmer = doc["cwSkimmer"] | false;
+  EEPROMData.rttyDecoder = doc["rttyDecoder"] | RTTY_OFF;
 
   // How to copy strings:
   //  strlcpy(EEPROMData.myCall,                  // <- destination
@@ -197,6 +204,13 @@ FLASHMEM void saveConfiguration(const char *filename, const config_t &EEPROMData
   doc["buttonThresholdPressed"] = EEPROMData.buttonThresholdPressed;
   doc["buttonThresholdReleased"] = EEPROMData.buttonThresholdReleased;
   doc["buttonRepeatDelay"] = EEPROMData.buttonRepeatDelay;
+  doc["convFFTLength"] = EEPROMData.convFFTLength;
+  doc["rxSampleRate"] = EEPROMData.rxSampleRate;
+  doc["spectrumWindow"] = EEPROMData.spectrumWindow;
+  doc["spectrumAverage"] = EEPROMData.spectrumAverage;
+  doc["spectrumFFTSize"] = EEPROMData.spectrumFFTSize;
+  doc["cwSkimmer"] = EEPROMData.cwSkimmer;
+  doc["rttyDecoder"] = EEPROMData.rttyDecoder;
 
   if (toFile) {
     // Delete existing file, otherwise EEPROMData is appended to the file
@@ -151,10 +151,12 @@ int CalibrateOptions() {
 *****/
 int CWOptions()  // new option for Sidetone and Delay JJP 9/1/22
 {
-  const char *cwChoices[]{ "WPM", "Key Type", "CW Filter", "Paddle Flip", "CW Offset", "Sidetone Volume", "Transmit Delay", "Cancel" };  // AFP 10-18-22
+  const char *cwChoices[]{ "WPM", "Key Type", "CW Filter", "Paddle Flip", "CW Offset", "Sidetone Volume", "Transmit Delay", "Skimmer", "Cancel" };  // AFP 10-18-22
+  const char *skimmerChoices[] = { "Off", "On", "Cancel" };
   int CWChoice = 0;
+  int skimmerSet;
 
-  CWChoice = SubmenuSelect(cwChoices, 8, 0);
+  CWChoice = SubmenuSelect(cwChoices, 9, 0);
 
   switch (CWChoice) {
     case 0:  // WPM
@@ -189,15 +191,46 @@ int CWOptions()  // new option for Sidetone and Delay JJP 9/1/22
       SetTransmitDelay();  // Transmit relay hold delay
       break;
 
+    case 7:  // Multi-channel skimmer in place of the waterfall
+      skimmerSet = SubmenuSelect(skimmerChoices, 3, EEPROMData.cwSkimmer ? 1 : 0);
+      if (skimmerSet < 2) {
+        EEPROMData.cwSkimmer = (skimmerSet == 1);
+        CWSkimmerReset();
+        EEPROMWrite();
+      }
+      break;
+
     default:  // Cancel
       break;
   }
   return CWChoice;
 }
 
+/*****
+  Purpose: Turn the RTTY decoder on or off.  Reverse swaps mark and space for stations sending inverted.
+
+  Parameter list:
+    void
+
+  Return value
+    int           the selection
+*****/
+int RTTYOptions() {
+  const char *rttyChoices[] = { "Off", "Normal", "Reverse", "Cancel" };
+  int rttyChoice;
+
+  rttyChoice = SubmenuSelect(rttyChoices, 4, EEPROMData.rttyDecoder);
+  if (rttyChoice >= RTTY_OFF && rttyChoice <= RTTY_REVERSE) {
+    EEPROMData.rttyDecoder = rttyChoice;
+    RTTYReset();
+    EEPROMWrite();
+  }
+  return rttyChoice;
+}
+
 
 /*****
-  Purpose: Show the list of scales for the spectrum divisions
+  Purpose: Show the list of scales for the spectrum divisions, and the spectrum FFT window, averaging, and size choices
 
   Parameter list:
     void
@@ -215,13 +248,63 @@ int SpectrumOptions() { /*
     {"1 dB/",  200.0, 40, 200, 0.05}
   };
   */
-  const char *spectrumChoices[] = { "20 dB/unit", "10 dB/unit", "5 dB/unit", "2 dB/unit", "1 dB/unit", "Cancel" };
+  const char *spectrumChoices[] = { "20 dB/unit", "10 dB/unit", "5 dB/unit", "2 dB/unit", "1 dB/unit", "Window", "Averaging", "FFT size", "Cancel" };
+  const char *windowChoices[SPECTRUM_WINDOWS + 1];
+  const char *averageChoices[SPECTRUM_AVERAGE_MODES + 1];
+  const char *sizeChoices[] = { "512", "1024", "2048", "Cancel" };
+  const int sizes[] = { 512, 1024, 2048 };
+  char sizeLabels[3][32];
   int spectrumSet = EEPROMData.currentScale;  // JJP 7/14/23
+  int windowSet;
+  int averageSet;
+  int sizeSet = 0;
 
-  spectrumSet = SubmenuSelect(spectrumChoices, 6, spectrumSet);
+  spectrumSet = SubmenuSelect(spectrumChoices, 9, spectrumSet);
   if (strcmp(spectrumChoices[spectrumSet], "Cancel") == 0) {
     return EEPROMData.currentScale;  // Nope.
   }
+  if (strcmp(spectrumChoices[spectrumSet], "Window") == 0) {
+    for (int i = 0; i < SPECTRUM_WINDOWS; i++) {
+      windowChoices[i] = spectrumWindowTypes[i].name;
+    }
+    windowChoices[SPECTRUM_WINDOWS] = "Cancel";
+    windowSet = SubmenuSelect(windowChoices, SPECTRUM_WINDOWS + 1, EEPROMData.spectrumWindow);
+    if (windowSet < SPECTRUM_WINDOWS) {
+      EEPROMData.spectrumWindow = windowSet;
+      SetSpectrumWindow(EEPROMData.spectrumWindow);
+      EEPROMWrite();
+    }
+    return EEPROMData.currentScale;
+  }
+  if (strcmp(spectrumChoices[spectrumSet], "Averaging") == 0) {
+    for (int i = 0; i < SPECTRUM_AVERAGE_MODES; i++) {
+      averageChoices[i] = spectrumAverageNames[i];
+    }
+    averageChoices[SPECTRUM_AVERAGE_MODES] = "Cancel";
+    averageSet = SubmenuSelect(averageChoices, SPECTRUM_AVERAGE_MODES + 1, EEPROMData.spectrumAverage);
+    if (averageSet < SPECTRUM_AVERAGE_MODES) {
+      EEPROMData.spectrumAverage = averageSet;
+      SpectrumAverageReset();
+      EEPROMWrite();
+    }
+    return EEPROMData.currentScale;
+  }
+  if (strcmp(spectrumChoices[spectrumSet], "FFT size") == 0) {
+    for (int i = 0; i < 3; i++) {
+      if (sizes[i] == EEPROMData.spectrumFFTSize) sizeSet = i;
+      if (sizes[i] > (int)(BUFFER_SIZE * N_BLOCKS)) {  // The 1x spectrum is limited to one block, 512 at 48K and 1024 at 96K
+        snprintf(sizeLabels[i], sizeof(sizeLabels[i]), "%d, %d at 1x", sizes[i], (int)(BUFFER_SIZE * N_BLOCKS));
+        sizeChoices[i] = sizeLabels[i];
+      }
+    }
+    sizeSet = SubmenuSelect(sizeChoices, 4, sizeSet);
+    if (sizeSet < 3) {
+      EEPROMData.spectrumFFTSize = sizes[sizeSet];
+      ZoomFFTPrep();  // Sets the size in use for the current zoom
+      EEPROMWrite();
+    }
+    return EEPROMData.currentScale;
+  }
   EEPROMData.currentScale = spectrumSet;  // Yep...
   //EEPROMData.currentScale = EEPROMData.currentScale;
   EEPROMWrite();
@@ -450,14 +533,18 @@ int EqualizerRecOptions() {
   switch (EQChoice) {
     case 0:
       EEPROMData.receiveEQFlag = true;
+      InitFilterMask();  // The EQ is part of the filter mask from RECEIVE_EQ_FULL_FFT points up
       break;
     case 1:
       EEPROMData.receiveEQFlag = false;
+      InitFilterMask();
       break;
     case 2:
       for (int iFreq = 0; iFreq < EQUALIZER_CELL_COUNT; iFreq++) {
       }
       ProcessEqualizerChoices(0, (char *)"Receive Equalizer");
+      receiveEQGeneration++;  // New levels, so rebuild the filter mask
+      InitFilterMask();
       EEPROMWrite();
       RedrawDisplayScreen();
       break;
@@ -491,6 +578,7 @@ int EqualizerXmtOptions() {
       break;
     case 2:
       ProcessEqualizerChoices(1, (char *)"Transmit Equalizer");
+      XmitEQLoadValues();  // New levels
       EEPROMWrite();
       RedrawDisplayScreen();
       break;
@@ -613,11 +701,18 @@ int MicOptions()  // AFP 09-22-22 All new
     int           an index into the band array
 *****/
 int RFOptions() {
-  const char *rfOptions[] = { "Power level", "Gain", "Cancel" };
+  const char *rfOptions[] = { "Power level", "Gain", "Filter FFT", "Sample rate", "Cancel" };
+  const char *fftChoices[] = { NULL, NULL, NULL, NULL, "Cancel" };
+  const uint32_t fftSizes[] = { 256, 512, 1024, 2048 };
+  char fftLabels[4][16];
+  const char *rateChoices[] = { "192k Wide", "96k", "48k Low power", "Cancel" };
+  const int rates[] = { SAMPLE_RATE_192K, SAMPLE_RATE_96K, SAMPLE_RATE_48K };
   int rfSet = 0;
+  int fftSet = 0;
+  int rateSet = 0;
   int returnValue = 0;
 
-  rfSet = SubmenuSelect(rfOptions, 3, rfSet);
+  rfSet = SubmenuSelect(rfOptions, 5, rfSet);
 
   switch (rfSet) {
     case 0:  // AFP 10-21-22
@@ -646,6 +741,41 @@ int RFOptions() {
       returnValue = EEPROMData.rfGainAllBands;
       break;
 
+    case 2:  // Convolution filter FFT size
+      for (int i = 0; i < 4; i++) {
+        if (fftSizes[i] == (uint32_t)EEPROMData.convFFTLength) fftSet = i;
+        // The block wait, the AGC look-ahead, and the group delay of the (size / 2 + 1) tap filter, which is the
+        // only part that changes.  The decimation and interpolation filters add about 1 ms more.
+        snprintf(fftLabels[i], sizeof(fftLabels[i]), "%d, %d ms", (int)fftSizes[i],
+                 (int)(1000.0 * (FFT_length / 2 + attack_buffsize + fftSizes[i] / 4) / decimatedRate + 1.5));
+        fftChoices[i] = fftLabels[i];
+      }
+      fftSet = SubmenuSelect(fftChoices, 5, fftSet);
+      if (fftSet == 4) {  // Cancel
+        break;
+      }
+      EEPROMData.convFFTLength = fftSizes[fftSet];
+      SetConvolutionSize(EEPROMData.convFFTLength);
+      EEPROMWrite();
+      returnValue = EEPROMData.convFFTLength;
+      break;
+
+    case 3:  // Receive sample rate
+      for (int i = 0; i < 3; i++) {
+        if (rates[i] == EEPROMData.rxSampleRate) rateSet = i;
+      }
+      rateSet = SubmenuSelect(rateChoices, 4, rateSet);
+      if (rateSet == 3) {  // Cancel
+        break;
+      }
+      EEPROMData.rxSampleRate = rates[rateSet];
+      SetReceiveSampleRate(EEPROMData.rxSampleRate);
+      RedrawDisplayScreen();  // New span on the spectrum and frequency bar
+      ResetTuning();          // New IF, and the old offset may be off the display
+      EEPROMWrite();
+      returnValue = EEPROMData.rxSampleRate;
+      break;
+
       // Where is the 3rd option and default???
   }
   return returnValue;
@@ -829,6 +959,7 @@ int EEPROMOptions() {  // 0               1                2               3
       TxRxFreq = EEPROMData.centerFreq = EEPROMData.lastFrequencies[EEPROMData.currentBand][EEPROMData.activeVFO];
       // Set the frequency correction of the Si5351:
       si5351.set_correction(EEPROMData.freqCorrectionFactor, SI5351_PLL_INPUT_XO);
+      ApplyConfiguration();   // Rebuild the DSP for the loaded settings.
       RedrawDisplayScreen();  // Assume there are lots of changes and do a heavy-duty refresh.  KF5N August 7, 2023
       break;
 
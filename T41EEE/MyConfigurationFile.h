@@ -37,6 +37,7 @@
 #define FINE_TUNE_STEP        	  50			 		                              //  This is an array: { 10, 50, 250, 500 }
 #define SPLASH_DELAY              4000L                                     // How long to show Splash screen. Use 1000 for testing, 4000 normally
 #define STARTUP_BAND        			1                                         // This is the 40M band. see around line 575 in SDT.h
+#define ZOOM_FFT_OVERLAP          50                                        // Percent of the zoom FFT reused from the previous spectrum, 0 to 75
 
 #define CENTER_SCREEN_X           400
 #define CENTER_SCREEN_Y           245
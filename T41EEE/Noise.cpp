@@ -123,8 +123,8 @@ void Kim1_NR()
         lf_freq = -(float32_t)bands[EEPROMData.currentBand].FHiCut;
       }
     }
-    lf_freq /= ((SR[SampleRate].rate / DF) / NR_FFT_L); // bin BW is 46.9Hz [12000Hz / 256 bins] @96kHz
-    uf_freq /= ((SR[SampleRate].rate / DF) / NR_FFT_L);
+    lf_freq /= (decimatedRate / NR_FFT_L); // bin BW is 46.9Hz [12000Hz / 256 bins] @96kHz
+    uf_freq /= (decimatedRate / NR_FFT_L);
 
     VAD_low = (int)lf_freq;
     VAD_high = (int)uf_freq;
@@ -283,6 +283,11 @@ void Kim1_NR()
 }
 /*****
   Purpose:   void xanr
+             Same variable leak LMS as the original, on a mirrored delay line.  Each sample is written to ANR_d
+             twice, ANR_dline_size apart, so the ANR_taps samples the filter needs always sit in one contiguous run
+             and the filter output and weight update are straight loops with no index masking.  The input energy
+             sigma is worked out once per block and then kept up to date with the sample that enters and the sample
+             that leaves the window.
   Parameter list:
     void
   Return value;
@@ -290,22 +295,23 @@ void Kim1_NR()
 *****/
 void Xanr() // variable leak LMS algorithm for automatic notch or noise reduction
 { // (c) Warren Pratt wdsp library 2016
-  int idx;
   float32_t c0, c1;
   float32_t y, error, sigma, inv_sigp;
   float32_t nel, nev;
+  float32_t *x;  // Filter input window, ANR_taps samples from ANR_delay samples back
 
   for (int i = 0; i < ANR_buff_size; i++) {
     ANR_d[ANR_in_idx] = float_buffer_L[i];
+    ANR_d[ANR_in_idx + ANR_dline_size] = float_buffer_L[i];
+    x = &ANR_d[ANR_in_idx + ANR_delay];  // ANR_delay + ANR_taps must not be more than ANR_dline_size
 
-    y = 0;
-    sigma = 0;
-
-    for (int j = 0; j < ANR_taps; j++) {
-      idx = (ANR_in_idx + j + ANR_delay) & ANR_mask;
-      y += ANR_w[j] * ANR_d[idx];
-      sigma += ANR_d[idx] * ANR_d[idx];
+    if (i == 0) {
+      arm_dot_prod_f32(x, x, ANR_taps, &sigma);
+    } else {
+      sigma += x[0] * x[0] - x[ANR_taps] * x[ANR_taps];  // x[ANR_taps] left the window
+      if (sigma < 0.0) sigma = 0.0;  // Rounding
     }
+    arm_dot_prod_f32(ANR_w, x, ANR_taps, &y);
     inv_sigp = 1.0 / (sigma + 1e-10);
     error = ANR_d[ANR_in_idx] - y;
 
@@ -330,66 +336,82 @@ void Xanr() // variable leak LMS algorithm for automatic notch or noise reductio
     c1 = ANR_two_mu * error * inv_sigp;
 
     for (int j = 0; j < ANR_taps; j++) {
-      idx = (ANR_in_idx + j + ANR_delay) & ANR_mask;
-      ANR_w[j] = c0 * ANR_w[j] + c1 * ANR_d[idx];
+      ANR_w[j] = c0 * ANR_w[j] + c1 * x[j];
     }
     ANR_in_idx = (ANR_in_idx + ANR_mask) & ANR_mask;
   }
 }
 
+// Spectral noise reduction engine.  The constants of the noise and speech probability estimators are set by
+// SpectralNRLoadValues() instead of on every call, and the per-bin work is done in a few straight passes over
+// contiguous arrays.
+struct {
+  float32_t ax;            // Noise output smoothing factor, exp(-tinc / tax)
+  float32_t onem_ax;
+  float32_t ap;            // Speech probability smoothing factor, exp(-tinc / tap)
+  float32_t onem_ap;
+  float32_t xih1r;         // 1 / (1 + xih1) - 1, xih1 is the active SNR as a ratio
+  float32_t pfac;          // (1 / pspri - 1) * (1 + xih1)
+  float32_t snr_prio_min;  // -20 dB
+} spectralNR;
+
+float32_t nrPower[NR_FFT_L / 2];       // Squared magnitude of the current frame
+float32_t nrNoise[NR_FFT_L / 2];       // Noise power estimate, xt in the reference
+float32_t nrSpeechProb[NR_FFT_L / 2];  // Smoothed speech probability, pslp in the reference
+float32_t nrScratch[NR_FFT_L / 2];
+int nrTrainState = 1;                  // 1 to restart, 2 while averaging the noise, 3 when running
+int nrTrainFrames = 0;
+
 /*****
-  Purpose: spectral_noise_reduction
+  Purpose: Work out the spectral noise reduction constants and restart the noise estimate.  Called from
+           SpectralNoiseReductionInit(), so on NR, band, and mode changes.
   Parameter list:
     void
   Return value;
     void
 *****/
-void SpectralNoiseReduction()
-/************************************************************************************************************
-
-      Noise reduction with spectral subtraction rule
-      based on Romanin et al. 2009 & Schmitt et al. 2002
-      and MATLAB voicebox
-      and Gerkmann & Hendriks 2002
-      and Yao et al. 2016
-
-   STAND: UHSDR github 14.1.2018
-   ************************************************************************************************************/
+void SpectralNRLoadValues()
 {
-  static uint8_t NR_init_counter = 0;
-  uint8_t VAD_low = 0;
-  uint8_t VAD_high = 127;
-  float32_t lf_freq; // = (offset - width/2) / (12000 / NR_FFT_L); // bin BW is 46.9Hz [12000Hz / 256 bins] @96kHz
-  float32_t uf_freq; //= (offset + width/2) / (12000 / NR_FFT_L);
-
-  const float32_t tinc = 0.00533333;  // frame time 5.3333ms
+  const float32_t tinc = (NR_FFT_L / 2) / decimatedRate;  // frame time 5.3333ms
   const float32_t tax = 0.0239;       // noise output smoothing time constant = -tinc/ln(0.8)
   const float32_t tap = 0.05062;      // speech prob smoothing time constant = -tinc/ln(0.9) tinc = frame time (5.33ms)
+  const float32_t asnr = 20;          // active SNR in dB
+  const float32_t pspri = 0.5;        // prior speech probability [0.5]
+  float32_t xih1;
+
+  spectralNR.ax = expf(-tinc / tax);
+  spectralNR.onem_ax = 1.0 - spectralNR.ax;
+  spectralNR.ap = expf(-tinc / tap);
+  spectralNR.onem_ap = 1.0 - spectralNR.ap;
+  xih1 = powf(10, asnr / 10.0);
+  spectralNR.xih1r = 1.0 / (1.0 + xih1) - 1.0;
+  spectralNR.pfac = (1.0 / pspri - 1.0) * (1.0 + xih1);
+  spectralNR.snr_prio_min = powf(10, -20.0 / 20.0);
+  nrTrainState = 1;
+}
+
+/*****
+  Purpose: spectral_noise_reduction
+           Same rule as SpectralNoiseReductionReference().  The gain of every bin is worked out before the musical
+           noise smoothing, which runs once per frame as a sliding sum.  The reference ran the smoothing once per
+           bin from inside the gain loop.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+void SpectralNoiseReduction()
+{
   const float32_t psthr = 0.99;       // threshold for smoothed speech probability [0.99]
   const float32_t pnsaf = 0.01;       // noise probability safety value [0.01]
-  const float32_t asnr = 20;          // active SNR in dB
   const float32_t psini = 0.5;        // initial speech probability [0.5]
-  const float32_t pspri = 0.5;        // prior speech probability [0.5]
-  static float32_t ax;                //=0.8;       // ax=exp(-tinc/tax); % noise output smoothing factor
-  static float32_t ap;                //=0.9;        // ap=exp(-tinc/tap); % noise output smoothing factor
-  static float32_t xih1;              // = 31.6;
-  ax = expf(-tinc / tax);
-  ap = expf(-tinc / tap);
-  xih1 = powf(10, (float32_t)asnr / 10.0);
-  static float32_t xih1r = 1.0 / (1.0 + xih1) - 1.0;
-  static float32_t pfac = (1.0 / pspri - 1.0) * (1.0 + xih1);
-  float32_t snr_prio_min = powf(10, - (float32_t)20 / 20.0);
-  static float32_t pslp[NR_FFT_L / 2];
-  static float32_t xt[NR_FFT_L / 2];
-  static float32_t xtr;
-  static float32_t pre_power;
-  static float32_t post_power;
-  static float32_t power_ratio;
-  static int16_t NN;
   const int16_t NR_width = 4;
   const float32_t power_threshold = 0.4;
-  float32_t ph1y[NR_FFT_L / 2];
-  static int NR_first_time_2 = 1;
+  const float32_t alpha = EEPROMData.NR_alpha;
+  float32_t lf_freq, uf_freq;
+  float32_t x, ph1y, xtr, v, pre_power, post_power, power_ratio, sum;
+  int VAD_low, VAD_high, NN;
+  float32_t *input;
 
   if (bands[EEPROMData.currentBand].FLoCut <= 0 && bands[EEPROMData.currentBand].FHiCut >= 0) {
     lf_freq = 0.0;
@@ -403,213 +425,109 @@ void SpectralNoiseReduction()
       lf_freq = -(float32_t)bands[EEPROMData.currentBand].FHiCut;
     }
   }
-  // / rate DF SR[SampleRate].rate/DF
-  lf_freq /= ((SR[SampleRate].rate / DF) / NR_FFT_L); // bin BW is 46.9Hz [12000Hz / 256 bins] @96kHz
-  uf_freq /= ((SR[SampleRate].rate / DF) / NR_FFT_L);
-
-
-  // INITIALIZATION ONCE 1
-  if (NR_first_time_2 == 1) { // TODO: properly initialize all the variables
-    for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
-      NR_last_sample_buffer_L[bindx] = 0.0;
-      NR_G[bindx] = 1.0;
-      //xu[bindx] = 1.0;  //has to be replaced by other variable
-      NR_Hk_old[bindx] = 1.0; // old gain or xu in development mode
-      NR_Nest[bindx][0] = 0.0;
-      NR_Nest[bindx][1] = 1.0;
-      pslp[bindx] = 0.5;
-    }
-    NR_first_time_2 = 2; // we need to do some more a bit later down
+  VAD_low = (int)(lf_freq / (decimatedRate / NR_FFT_L));
+  VAD_high = (int)(uf_freq / (decimatedRate / NR_FFT_L));
+  if (VAD_low == VAD_high) {
+    VAD_high++;
+  }
+  VAD_low = constrain(VAD_low, 1, NR_FFT_L / 2 - 2);
+  VAD_high = constrain(VAD_high, 1, NR_FFT_L / 2);
+
+  if (nrTrainState == 1) {
+    arm_fill_f32(0.0, NR_last_sample_buffer_L, NR_FFT_L / 2);
+    arm_fill_f32(1.0, NR_G, NR_FFT_L / 2);
+    arm_fill_f32(1.0, NR_Hk_old, NR_FFT_L / 2);
+    arm_fill_f32(0.0, nrNoise, NR_FFT_L / 2);
+    arm_fill_f32(0.5, nrSpeechProb, NR_FFT_L / 2);
+    nrTrainFrames = 0;
+    nrTrainState = 2;
   }
 
   for (int k = 0; k < 2; k++) {
-    // NR_FFT_buffer is 512 floats big
-    // interleaved r, i, r, i . . .
-    // fill first half of FFT_buffer with last events audio samples
-    for (int i = 0; i < NR_FFT_L / 2; i++) {
-      NR_FFT_buffer[i * 2] = NR_last_sample_buffer_L[i]; // real
-      NR_FFT_buffer[i * 2 + 1] = 0.0; // imaginary
-    }
-    // copy recent samples to last_sample_buffer for next time!
-    for (int i = 0; i < NR_FFT_L  / 2; i++) {
-      NR_last_sample_buffer_L [i] = float_buffer_L[i + k * (NR_FFT_L / 2)];
-    }
-    // now fill recent audio samples into second half of FFT_buffer
+    // Last frame's samples then this frame's, sqrt Hann windowed, into the real parts of NR_FFT_buffer
+    input = &float_buffer_L[k * (NR_FFT_L / 2)];
     for (int i = 0; i < NR_FFT_L / 2; i++) {
-      NR_FFT_buffer[NR_FFT_L + i * 2] = float_buffer_L[i + k * (NR_FFT_L / 2)]; // real
+      NR_FFT_buffer[i * 2] = NR_last_sample_buffer_L[i] * sqrtHann[i];
+      NR_FFT_buffer[i * 2 + 1] = 0.0;
+      NR_FFT_buffer[NR_FFT_L + i * 2] = input[i] * sqrtHann[NR_FFT_L / 2 + i];
       NR_FFT_buffer[NR_FFT_L + i * 2 + 1] = 0.0;
     }
-#if 1
-    // perform windowing on samples in the NR_FFT_buffer
-    for (int idx = 0; idx < NR_FFT_L; idx++) { // sqrt Hann window
-      //float32_t temp_sample = 0.5 * (float32_t)(1.0 - (cosf(PI * 2.0 * (float32_t)idx / (float32_t)((NR_FFT_L) - 1))));
-      //NR_FFT_buffer[idx * 2] *= temp_sample;
-      NR_FFT_buffer[idx * 2] *= sqrtHann[idx];
-    }
-#endif
+    arm_copy_f32(input, NR_last_sample_buffer_L, NR_FFT_L / 2);
 
-    // NR_FFT
-    // calculation is performed in-place the FFT_buffer [re, im, re, im, re, im . . .]
     arm_cfft_f32(NR_FFT, NR_FFT_buffer, 0, 1);
+    arm_cmplx_mag_squared_f32(NR_FFT_buffer, nrPower, NR_FFT_L / 2);
+
+    if (nrTrainState == 2) {  // Average the noise over 20 frames, about 100 ms, before starting
+      arm_scale_f32(nrPower, 0.05, nrScratch, NR_FFT_L / 2);
+      arm_add_f32(nrNoise, nrScratch, nrNoise, NR_FFT_L / 2);
+      if (++nrTrainFrames >= 20) {
+        arm_scale_f32(nrNoise, psini, nrNoise, NR_FFT_L / 2);
+        nrTrainState = 3;
+      }
+      continue;  // The audio passes through untouched until then
+    }
 
+    // Noise estimate, a posteriori and a priori SNR
     for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
-      // this is squared magnitude for the current frame
-      NR_X[bindx][0] = (NR_FFT_buffer[bindx * 2] * NR_FFT_buffer[bindx * 2] + NR_FFT_buffer[bindx * 2 + 1] * NR_FFT_buffer[bindx * 2 + 1]);
+      x = nrPower[bindx];
+      ph1y = 1.0 / (1.0 + spectralNR.pfac * expf(spectralNR.xih1r * x / nrNoise[bindx]));
+      nrSpeechProb[bindx] = spectralNR.ap * nrSpeechProb[bindx] + spectralNR.onem_ap * ph1y;
+      ph1y = (nrSpeechProb[bindx] > psthr) ? 1.0 - pnsaf : fminf(ph1y, 1.0);
+      xtr = (1.0 - ph1y) * x + ph1y * nrNoise[bindx];
+      nrNoise[bindx] = spectralNR.ax * nrNoise[bindx] + spectralNR.onem_ax * xtr;
+      NR_SNR_post[bindx] = fmaxf(fminf(x / nrNoise[bindx], 1000.0), spectralNR.snr_prio_min);  // limited to +30 /-20 dB
+      NR_SNR_prio[bindx] = fmaxf(alpha * NR_Hk_old[bindx] + (1.0 - alpha) * fmaxf(NR_SNR_post[bindx] - 1.0, 0.0), 0.0);
     }
 
-    if (NR_first_time_2 == 2) { // TODO: properly initialize all the variables
-      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
-        NR_Nest[bindx][0] = NR_Nest[bindx][0] + 0.05 * NR_X[bindx][0]; // we do it 20 times to average over 20 frames for app. 100ms only on NR_on/bandswitch/modeswitch,...
-        xt[bindx] = psini * NR_Nest[bindx][0];
-      }
-      NR_init_counter++;
-      if (NR_init_counter > 19)  { //average over 20 frames for app. 100ms
-        NR_init_counter = 0;
-        NR_first_time_2 = 3;  // now we did all the necessary initialization to actually start the noise reduction
-      }
+    // Gains within the filter passband, and the signal power before and after
+    pre_power = 0.0;
+    post_power = 0.0;
+    for (int bindx = VAD_low; bindx < VAD_high; bindx++) {
+      v = NR_SNR_prio[bindx] * NR_SNR_post[bindx] / (1.0 + NR_SNR_prio[bindx]);
+      NR_G[bindx] = sqrtf(0.7212 * v + v * v) / NR_SNR_post[bindx];
+      NR_Hk_old[bindx] = NR_SNR_post[bindx] * NR_G[bindx] * NR_G[bindx];
+      pre_power += nrPower[bindx];
+      post_power += NR_G[bindx] * NR_G[bindx] * nrPower[bindx];
     }
 
-    if (NR_first_time_2 == 3) {
-      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) { // 1. Step of NR - calculate the SNR's
-        ph1y[bindx] = 1.0 / (1.0 + pfac * expf(xih1r * NR_X[bindx][0] / xt[bindx]));
-        pslp[bindx] = ap * pslp[bindx] + (1.0 - ap) * ph1y[bindx];
-
-        if (pslp[bindx] > psthr) {
-          ph1y[bindx] = 1.0 - pnsaf;
-        } else {
-          ph1y[bindx] = fmin(ph1y[bindx] , 1.0);
-        }
-        xtr = (1.0 - ph1y[bindx]) * NR_X[bindx][0] + ph1y[bindx] * xt[bindx];
-        xt[bindx] = ax * xt[bindx] + (1.0 - ax) * xtr;
-      }
-      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) { // 1. Step of NR - calculate the SNR's
-        NR_SNR_post[bindx] = fmax(fmin(NR_X[bindx][0] / xt[bindx], 1000.0), snr_prio_min); // limited to +30 /-15 dB, might be still too much of reduction, let's try it?
-        NR_SNR_prio[bindx] = fmax(EEPROMData.NR_alpha * NR_Hk_old[bindx] + (1.0 - EEPROMData.NR_alpha) * fmax(NR_SNR_post[bindx] - 1.0, 0.0), 0.0);
-      }
-
-      VAD_low = (int)lf_freq;
-      VAD_high = (int)uf_freq;
-      if (VAD_low == VAD_high) {
-        VAD_high++;
-      }
-      if (VAD_low < 1) {
-        VAD_low = 1;
-      } else if (VAD_low > NR_FFT_L / 2 - 2) {
-        VAD_low = NR_FFT_L / 2 - 2;
-      }
-      if (VAD_high < 1) {
-        VAD_high = 1;
-      } else if (VAD_high > NR_FFT_L / 2) {
-        VAD_high = NR_FFT_L / 2;
-      }
-
-      float32_t v;
-      for (int bindx = VAD_low; bindx < VAD_high; bindx++) { // maybe we should limit this to the signal containing bins (filtering!!)
-        {
-          v = NR_SNR_prio[bindx] * NR_SNR_post[bindx] / (1.0 + NR_SNR_prio[bindx]);
-          NR_G[bindx] = 1.0 / NR_SNR_post[bindx] * sqrtf((0.7212 * v + v * v));
-          NR_Hk_old[bindx] = NR_SNR_post[bindx] * NR_G[bindx] * NR_G[bindx]; //
-        }
-
-        // MUSICAL NOISE TREATMENT HERE, DL2FW
-
-        // musical noise "artefact" reduction by dynamic averaging - depending on SNR ratio
-        pre_power  = 0.0;
-        post_power = 0.0;
-        for (int bindx = VAD_low; bindx < VAD_high; bindx++) {
-          pre_power += NR_X[bindx][0];
-          post_power += NR_G[bindx] * NR_G[bindx]  * NR_X[bindx][0];
-        }
-
-        power_ratio = post_power / pre_power;
-        if (power_ratio > power_threshold) {
-          power_ratio = 1.0;
-          NN = 1;
-        } else {
-          NN = 1 + 2 * (int)(0.5 + NR_width * (1.0 - power_ratio / power_threshold));
-        }
-
-        for (int bindx = VAD_low + NN / 2; bindx < VAD_high - NN / 2; bindx++) {
-          NR_Nest[bindx][0] = 0.0;
-          for (int m = bindx - NN / 2; m <= bindx + NN / 2; m++) {
-            NR_Nest[bindx][0] += NR_G[m];
-          }
-          NR_Nest[bindx][0] /= (float32_t)NN;
-        }
-
-        // and now the edges - only going NN steps forward and taking the average
-        // lower edge
-        for (int bindx = VAD_low; bindx < VAD_low + NN / 2; bindx++) {
-          NR_Nest[bindx][0] = 0.0;
-          for (int m = bindx; m < (bindx + NN); m++) {
-            NR_Nest[bindx][0] += NR_G[m];
-          }
-          NR_Nest[bindx][0] /= (float32_t)NN;
-        }
-
-        // upper edge - only going NN steps backward and taking the average
-        for (int bindx = VAD_high - NN; bindx < VAD_high; bindx++) {
-          NR_Nest[bindx][0] = 0.0;
-          for (int m = bindx; m > (bindx - NN); m--) {
-            NR_Nest[bindx][0] += NR_G[m];
-          }
-          NR_Nest[bindx][0] /= (float32_t)NN;
-        }
-
-        // end of edge treatment
-
-        for (int bindx = VAD_low + NN / 2; bindx < VAD_high - NN / 2; bindx++) {
-          NR_G[bindx] = NR_Nest[bindx][0];
-        }
-        // end of musical noise reduction
-      } //end of "if ts.nr_first_time == 3"
-
-#if 1
-      // FINAL SPECTRAL WEIGHTING: Multiply current FFT results with NR_FFT_buffer for 128 bins with the 128 bin-specific gain factors G
-      //              for(int bindx = 0; bindx < NR_FFT_L / 2; bindx++)                 // try 128:
-      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {                              // try 128:
-        NR_FFT_buffer[bindx * 2]                    = NR_FFT_buffer [bindx * 2] * NR_G[bindx] * NR_long_tone_gain[bindx];              // real part
-        NR_FFT_buffer[bindx * 2 + 1]                = NR_FFT_buffer [bindx * 2 + 1] * NR_G[bindx] * NR_long_tone_gain[bindx];      // imag part
-        NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 2] = NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 2] * NR_G[bindx] * NR_long_tone_gain[bindx]; // real part conjugate symmetric
-        NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 1] = NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 1] * NR_G[bindx] * NR_long_tone_gain[bindx]; // imag part conjugate symmetric
+    // MUSICAL NOISE TREATMENT, DL2FW
+    // musical noise "artefact" reduction by dynamic averaging - depending on SNR ratio.  A sliding sum over NN bins.
+    power_ratio = post_power / pre_power;
+    if (power_ratio > power_threshold) {
+      NN = 1;
+    } else {
+      NN = 1 + 2 * (int)(0.5 + NR_width * (1.0 - power_ratio / power_threshold));
+    }
+    if (NN > 1 && VAD_high - VAD_low > NN) {
+      sum = 0.0;
+      for (int m = VAD_low; m < VAD_low + NN - 1; m++) {
+        sum += NR_G[m];
       }
-
-#endif
-      /*****************************************************************
-         NOISE REDUCTION CODE ENDS HERE
-       *****************************************************************/
-      // very interesting!
-      // if I leave the FFT_buffer as is and just multiply the 19 bins below with 0.1, the audio
-      // is distorted a little bit !
-      // To me, this is an indicator of a problem with windowing . . .
-      //
-
-#if 0
-      for (int bindx = 1; bindx < 20; bindx++)
-        // bins 2 to 29 attenuated
-        // set real values to 0.1 of their original value
-      {
-        NR_FFT_buffer[bindx * 2] *= 0.1;
-        NR_FFT_buffer[bindx * 2 + 1] *= 0.1; //NR_iFFT_buffer[idx] * 0.1;
+      for (int bindx = VAD_low + NN / 2; bindx < VAD_high - NN / 2; bindx++) {
+        sum += NR_G[bindx + NN / 2];
+        nrScratch[bindx] = sum / NN;
+        sum -= NR_G[bindx - NN / 2];
       }
-#endif
+      arm_copy_f32(&nrScratch[VAD_low + NN / 2], &NR_G[VAD_low + NN / 2], VAD_high - VAD_low - 2 * (NN / 2));
+    }
 
-      arm_cfft_f32(NR_iFFT, NR_FFT_buffer, 1, 1);
+    // FINAL SPECTRAL WEIGHTING: the same gain for each bin and its conjugate
+    arm_mult_f32(NR_G, NR_long_tone_gain, nrScratch, NR_FFT_L / 2);
+    for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
+      NR_FFT_buffer[bindx * 2] *= nrScratch[bindx];
+      NR_FFT_buffer[bindx * 2 + 1] *= nrScratch[bindx];
+      NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 2] *= nrScratch[bindx];
+      NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 1] *= nrScratch[bindx];
+    }
 
-      for (int idx = 0; idx < NR_FFT_L; idx++) {
-        NR_FFT_buffer[idx * 2] *= sqrtHann[idx];      // sqrt Hann window
-      }
+    arm_cfft_f32(NR_iFFT, NR_FFT_buffer, 1, 1);
 
-      // do the overlap & add
-      for (int i = 0; i < NR_FFT_L / 2; i++) {        // take real part of first half of current iFFT result and add to 2nd half of last iFFT_result
-        float_buffer_L[i + k * (NR_FFT_L / 2)] = NR_FFT_buffer[i * 2] + NR_last_iFFT_result[i];
-        float_buffer_R[i + k * (NR_FFT_L / 2)] = float_buffer_L[i + k * (NR_FFT_L / 2)];
-      }
-      for (int i = 0; i < NR_FFT_L / 2; i++) {
-        NR_last_iFFT_result[i] = NR_FFT_buffer[NR_FFT_L + i * 2];
-      }
-      // end of "for" loop which repeats the FFT_iFFT_chain two times !!!
+    // Window and overlap-add: the first half of this result plus the second half of the last one
+    for (int i = 0; i < NR_FFT_L / 2; i++) {
+      input[i] = NR_FFT_buffer[i * 2] * sqrtHann[i] + NR_last_iFFT_result[i];
+      NR_last_iFFT_result[i] = NR_FFT_buffer[NR_FFT_L + i * 2] * sqrtHann[NR_FFT_L / 2 + i];
     }
+    arm_copy_f32(input, &float_buffer_R[k * (NR_FFT_L / 2)], NR_FFT_L / 2);
   }
 }
 
@@ -697,4 +615,5 @@ void SpectralNoiseReductionInit()
     NR_first_time = 2;
     NR_long_tone_gain[bindx] = 1.0;
   }
+  SpectralNRLoadValues();  // And restart the spectral noise estimate
 }
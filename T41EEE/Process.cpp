@@ -4,6 +4,63 @@
 
 char atom, currentAtom;
 
+uint32_t dspBlocksProcessed = 0;  // Receive scheduler statistics
+uint32_t dspDeadlineMisses = 0;   // Times a full block period passed with a block left waiting
+uint32_t dspOverruns = 0;         // Times the input queues were cleared and samples were lost
+uint32_t dspMaxQueued = 0;        // Deepest input queue seen by the scheduler, in 128 sample buffers
+
+/*****
+  Purpose: Block-driven receive scheduler.  Runs ProcessIQData() once for every complete set of N_BLOCKS
+           buffers waiting in the input queues, so the audio is processed as soon as it is ready no matter
+           what the display is doing.  The display code calls this between the pieces of work it does, and
+           draws in whatever time is left over.
+
+           When no block is waiting, the time to the next one goes to FilterMaskBuild(), so a filter mask that
+           was not in the cache is made between blocks and not in the middle of a menu or encoder change.
+
+           updateDisplayCounter counts blocks since ShowSpectrum() started its current sweep.  It is
+           used to raise updateDisplayFlag on the first block of the sweep, and spectrumSweeps counts the sweeps
+           for SpectrumFFTDue().  The zoom FFT keeps its own count of fresh samples and displays at most one
+           spectrum per sweep.
+
+   Parameter List:
+      void
+
+   Return value:
+      void
+ *****/
+void ServiceReceiveDSP() {
+  uint32_t queued;
+
+  if ((T41State != SSB_RECEIVE && T41State != CW_RECEIVE) || keyPressedOn == 1) {
+    return;
+  }
+  queued = min((uint32_t)Q_in_L.available(), (uint32_t)Q_in_R.available());
+  if (queued <= N_BLOCKS) {  // Nothing to do yet.  ProcessIQData() needs more than N_BLOCKS buffers.
+    FilterMaskBuild();
+    return;
+  }
+  if (queued > dspMaxQueued) {
+    dspMaxQueued = queued;
+  }
+  if (queued > 2 * N_BLOCKS) {  // A whole block period went by without the DSP being serviced.
+    dspDeadlineMisses++;
+  }
+  while (queued > N_BLOCKS && keyPressedOn == 0) {  // Catch up if more than one block is waiting.
+    updateDisplayCounter++;
+    updateDisplayFlag = (updateDisplayCounter == 1) ? 1 : 0;
+    if (updateDisplayFlag == 1) {
+      spectrumSweeps++;
+    }
+    ProcessIQData();
+    dspBlocksProcessed++;
+    queued = min((uint32_t)Q_in_L.available(), (uint32_t)Q_in_R.available());
+  }
+  if (queued <= N_BLOCKS) {  // Caught up
+    FilterMaskBuild();
+  }
+}
+
 /*****
   Purpose: Read audio from Teensy Audio Library
              Calculate FFT for display
@@ -33,11 +90,16 @@ void ProcessIQData()
      **********************************************************************************/
   float32_t audioMaxSquared;
   uint32_t AudioMaxIndex;
-  float rfGainValue;
+  bool zoomFFTBlock;  // This block goes to ZoomFFTExe(), which needs the Fs/4 shift on its own
+  uint32_t historyLength;  // Overlap-save samples kept from earlier FFTs
+  uint32_t spectBin;
 
   // Are there at least N_BLOCKS buffers in each channel available ?  N_BLOCKS should be 16.
   if ( (uint32_t) Q_in_L.available() > N_BLOCKS && (uint32_t) Q_in_R.available() > N_BLOCKS ) {     // Removed addition of 0 to N_BLOCKS.
     usec = 0;
+    FilterMaskSwap();  // Take up a new filter mask between blocks, never part way through one
+    DSP_TIMING_START(DSP_TIMING_TOTAL);
+    DSP_TIMING_START(DSP_TIMING_FRONT_END);
     // Get audio samples from the audio  buffers and convert them to float.
     // Read in 32 blocks and 128 samples in I and Q.
     for (unsigned i = 0; i < N_BLOCKS; i++) {
@@ -71,37 +133,18 @@ void ProcessIQData()
     }
     resetTuningFlag = 0;
 
-    //  Set RFGain for all bands.
-    rfGainValue = pow(10, (float)EEPROMData.rfGainAllBands / 20);
-    arm_scale_f32 (float_buffer_L, rfGainValue, float_buffer_L, BUFFER_SIZE * N_BLOCKS); //AFP 09-27-22
-    arm_scale_f32 (float_buffer_R, rfGainValue, float_buffer_R, BUFFER_SIZE * N_BLOCKS); //AFP 09-27-22
-    /**********************************************************************************  AFP 12-31-20
-        Remove DC offset to reduce central spike.  First read the Mean value of
-        left and right channels.  Then fill L and R correction arrays with those Means
-        and subtract the Means from the float L and R buffer data arrays.  Again use Arm_Math functions
-        to manipulate the arrays.  Arrays are all BUFFER_SIZE * N_BLOCKS long
-    **********************************************************************************/
-
-    /*arm_mean_f32(float_buffer_L, BUFFER_SIZE * N_BLOCKS, &sample_meanL);
-    arm_mean_f32(float_buffer_R, BUFFER_SIZE * N_BLOCKS, &sample_meanR);
-
-    for (uint32_t j = 0; j < BUFFER_SIZE * N_BLOCKS  ; j++) {
-      L_BufferOffset [j] = -sample_meanL;
-      R_BufferOffset [j] = -sample_meanR;
-    }
-    arm_add_f32(float_buffer_L , L_BufferOffset, float_buffer_L2 , BUFFER_SIZE * N_BLOCKS ) ;
-    arm_add_f32(float_buffer_R , R_BufferOffset, float_buffer_R2 , BUFFER_SIZE * N_BLOCKS ) ;
-
-    arm_biquad_cascade_df2T_f32(&s1_Receive, float_buffer_L, float_buffer_L, 2048); //AFP 09-23-22
-    arm_biquad_cascade_df2T_f32(&s1_Receive, float_buffer_R, float_buffer_R, 2048); //AFP 09-23-22*/
-    arm_biquad_cascade_df2T_f32(&s1_Receive2, float_buffer_L, float_buffer_L, 2048); //AFP 11-03-22
-    arm_biquad_cascade_df2T_f32(&s1_Receive2, float_buffer_R, float_buffer_R, 2048); //AFP 11-03-22
-
     /**********************************************************************************  AFP 12-31-20
-        Scale the data buffers by the RFgain value defined in bands[EEPROMData.currentBand] structure
+        RF gain, DC high pass filter, band RF gain, and IQ amplitude and phase correction.
+        For this scaled down version the I an Q chnnels are equalized and phase corrected manually.
+        This is done by applying a correction, which is the difference, to the L channel only.
+        ReceiveFrontEnd() does all of this in a single pass per channel.  The original pass-per-stage
+        code is kept as ReceiveFrontEndReference(), selected by FRONT_END_REFERENCE.
     **********************************************************************************/
-    arm_scale_f32 (float_buffer_L, bands[EEPROMData.currentBand].RFgain, float_buffer_L, BUFFER_SIZE * N_BLOCKS); //AFP 09-23-22
-    arm_scale_f32 (float_buffer_R, bands[EEPROMData.currentBand].RFgain, float_buffer_R, BUFFER_SIZE * N_BLOCKS); //AFP 09-23-22
+#ifdef FRONT_END_REFERENCE
+    ReceiveFrontEndReference(float_buffer_L, float_buffer_R, BUFFER_SIZE * N_BLOCKS);
+#else
+    ReceiveFrontEnd(float_buffer_L, float_buffer_R, BUFFER_SIZE * N_BLOCKS);
+#endif
 
     /**********************************************************************************  AFP 12-31-20
       Clear Buffers
@@ -112,7 +155,7 @@ void ProcessIQData()
       **********************************************************************************/
     if (Q_in_L.available() > 25) {
       Q_in_L.clear();
-    //  n_clear++; // just for debugging to check how often this occurs
+      dspOverruns++;
       AudioInterrupts();
     }
     if (Q_in_R.available() > 25) {
@@ -120,23 +163,7 @@ void ProcessIQData()
     //  n_clear++; // just for debugging to check how often this occurs
       AudioInterrupts();
     }
-    /**********************************************************************************  AFP 12-31-20
-      IQ amplitude and phase correction.  For this scaled down version the I an Q chnnels are
-      equalized and phase corrected manually. This is done by applying a correction, which is the difference, to
-      the L channel only.  The phase is corrected in the IQPhaseCorrection() function.
-    ***********************************************************************************************/
-
-    // Manual IQ amplitude correction
-    // to be honest: we only correct the amplitude of the I channel ;-)
-    if (bands[EEPROMData.currentBand].mode == DEMOD_LSB || bands[EEPROMData.currentBand].mode == DEMOD_AM || bands[EEPROMData.currentBand].mode == DEMOD_SAM) {
-      arm_scale_f32 (float_buffer_L, -EEPROMData.IQAmpCorrectionFactor[EEPROMData.currentBand], float_buffer_L, BUFFER_SIZE * N_BLOCKS); //AFP 04-14-22
-      IQPhaseCorrection(float_buffer_L, float_buffer_R, EEPROMData.IQPhaseCorrectionFactor[EEPROMData.currentBand], BUFFER_SIZE * N_BLOCKS);
-    } else {
-      if (bands[EEPROMData.currentBand].mode == DEMOD_USB || bands[EEPROMData.currentBand].mode == DEMOD_AM || bands[EEPROMData.currentBand].mode == DEMOD_SAM) {
-        arm_scale_f32 (float_buffer_L, -EEPROMData.IQAmpCorrectionFactor[EEPROMData.currentBand], float_buffer_L, BUFFER_SIZE * N_BLOCKS); //AFP 04-14-22
-        IQPhaseCorrection(float_buffer_L, float_buffer_R, EEPROMData.IQPhaseCorrectionFactor[EEPROMData.currentBand], BUFFER_SIZE * N_BLOCKS);
-      }
-    }
+    DSP_TIMING_STOP(DSP_TIMING_FRONT_END);
 
     display_S_meter_or_spectrum_state++;
     if ( keyPressedOn == 1) { ////AFP 09-01-22.  Is this a duplicate here???
@@ -158,24 +185,32 @@ void ProcessIQData()
     // X1 zoom must be done before the frequency shift!
     if ((EEPROMData.spectrum_zoom == 0) && (updateDisplayCounter == 1)) {
       updateDisplayFlag = 1;
+      DSP_TIMING_START(DSP_TIMING_SPECTRUM);
       CalcZoom1Magn();
+      DSP_TIMING_STOP(DSP_TIMING_SPECTRUM);
     }
 
-    FreqShift1();
+    // The zoom FFT decimator takes every block.  At 1x the Fs/4 shift is folded into FreqShiftMixer().
+    zoomFFTBlock = (EEPROMData.spectrum_zoom != 0);
+    if (zoomFFTBlock) {
+      DSP_TIMING_START(DSP_TIMING_FREQ_SHIFT);
+      FreqShift1();
+      DSP_TIMING_STOP(DSP_TIMING_FREQ_SHIFT);
+    }
 
     /**********************************************************************************  AFP 12-31-20
         EEPROMData.spectrum_zoom_2 and larger here after frequency conversion!
         Spectrum zoom displays a magnified display of the data around the translated receive frequency.
-        Processing is done in the ZoomFFTExe(BUFFER_SIZE * N_BLOCKS) function.  For magnifications of 2x to 16X
-        Larger magnifications are possible.
+        Processing is done in the ZoomFFTExe(BUFFER_SIZE * N_BLOCKS) function, for magnifications of 2x to 256x.
 
         Spectrum Zoom uses the shifted spectrum, so the center "hump" around DC is shifted by fs/4
     **********************************************************************************/
 
-    if((EEPROMData.spectrum_zoom == 1) && (updateDisplayCounter == 1))  ZoomFFTExe(BUFFER_SIZE * N_BLOCKS);
-    if((EEPROMData.spectrum_zoom == 2) && (updateDisplayCounter < 2))  ZoomFFTExe(BUFFER_SIZE * N_BLOCKS);
-    if((EEPROMData.spectrum_zoom == 3) && (updateDisplayCounter < 4))  ZoomFFTExe(BUFFER_SIZE * N_BLOCKS);
-    if((EEPROMData.spectrum_zoom == 4) && (updateDisplayCounter < 8))  ZoomFFTExe(BUFFER_SIZE * N_BLOCKS);
+    if (EEPROMData.spectrum_zoom != 0) {
+      DSP_TIMING_START(DSP_TIMING_SPECTRUM);
+      ZoomFFTExe(BUFFER_SIZE * N_BLOCKS);
+      DSP_TIMING_STOP(DSP_TIMING_SPECTRUM);
+    }
 
     /**********************************************************************************  AFP 12-31-20
         S-Meter & dBm-display ?? not usually called
@@ -200,7 +235,9 @@ void ProcessIQData()
         Lyons, R.G. (2011): Understanding Digital Processing. – Pearson, 3rd edition.
      *************************************************************************************************/
 
-    FreqShift2();  //AFP 12-14-21
+    DSP_TIMING_START(DSP_TIMING_FREQ_SHIFT);
+    FreqShiftMixer(!zoomFFTBlock);
+    DSP_TIMING_STOP(DSP_TIMING_FREQ_SHIFT);
 
     /**********************************************************************************  AFP 12-31-20
         Decimation
@@ -212,16 +249,38 @@ void ProcessIQData()
         If the statring sample rate is 192K SPS after the combined decimation, the sample rate is
         now 192K/8 = 24K SPS.  The array size is also reduced by 8, making FFT calculations much faster.
         The effective bandwidth (up to Nyquist frequency) is 12KHz.
+        At 96K the first stage decimates by 2, and at 48K it is skipped, so every rate ends at
+        256 samples at DECIMATED_RATE.
      **********************************************************************************/
-    // decimation-by-4 in-place!
-    arm_fir_decimate_f32(&FIR_dec1_I, float_buffer_L, float_buffer_L, BUFFER_SIZE * N_BLOCKS);
-    arm_fir_decimate_f32(&FIR_dec1_Q, float_buffer_R, float_buffer_R, BUFFER_SIZE * N_BLOCKS);
+    DSP_TIMING_START(DSP_TIMING_DECIMATE);
+#ifdef DECIMATE_REFERENCE
+    // decimation-by-DF1 in-place!  There is no first stage at 48K.
+    if (DF1 > 1.0) {
+      arm_fir_decimate_f32(&FIR_dec1_I, float_buffer_L, float_buffer_L, BUFFER_SIZE * N_BLOCKS);
+      arm_fir_decimate_f32(&FIR_dec1_Q, float_buffer_R, float_buffer_R, BUFFER_SIZE * N_BLOCKS);
+    }
 
     // decimation-by-2 in-place
     arm_fir_decimate_f32(&FIR_dec2_I, float_buffer_L, float_buffer_L, BUFFER_SIZE * N_BLOCKS / (uint32_t)DF1);
     arm_fir_decimate_f32(&FIR_dec2_Q, float_buffer_R, float_buffer_R, BUFFER_SIZE * N_BLOCKS / (uint32_t)DF1);
+#else
+    // I and Q together, in place, by DF1 then by 2
+    if (DF1 > 1.0) {
+      PolyphaseDecimate(&decimator1, float_buffer_L, float_buffer_R);
+    }
+    PolyphaseDecimate(&decimator2, float_buffer_L, float_buffer_R);
+#endif
+    DSP_TIMING_STOP(DSP_TIMING_DECIMATE);
+
+    // Multi-channel CW skimmer, on the receive passband before the convolution filter narrows it
+    if (T41State == CW_RECEIVE && EEPROMData.cwSkimmer) {
+      DSP_TIMING_START(DSP_TIMING_SKIM);
+      CWSkimmer();
+      DSP_TIMING_STOP(DSP_TIMING_SKIM);
+    }
 
     // =================  AFP 10-21-22 Level Adjust ===========
+    DSP_TIMING_START(DSP_TIMING_CONVOLVE);
     float freqKHzFcut;
     float volScaleFactor;
     if (bands[EEPROMData.currentBand].mode == DEMOD_LSB) {
@@ -245,94 +304,93 @@ void ProcessIQData()
         Then interleave RE and IM parts to create signal for FFT.
      **********************************************************************************/
     // Prepare the audio signal buffers:
-    // ONLY FOR the VERY FIRST FFT: fill first samples with zeros
-
-    if (first_block) { // Fill real & imaginaries with zeros for the first BLOCKSIZE samples.
-      for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF / 2.0); i++) {
-        FFT_buffer[i] = 0.0;
+    // Each FFT is convFFTLength - convNewSamples samples of history followed by convNewSamples new samples.
+    // The history starts as zeros and is cleared again by SetConvolutionSize().
+    historyLength = convFFTLength - convNewSamples;
+    for (uint32_t pass = 0; pass < FFT_length / 2; pass += convNewSamples) {  // Two passes at 256 points, else one
+      // Fill FFT_buffer with the history, then the recent audio samples (left channel: re, right channel: im)
+      arm_copy_f32(convHistory, FFT_buffer, 2 * historyLength);
+      for (unsigned i = 0; i < convNewSamples; i++) {
+        FFT_buffer[2 * (historyLength + i)] = float_buffer_L[pass + i]; // real
+        FFT_buffer[2 * (historyLength + i) + 1] = float_buffer_R[pass + i]; // imaginary
       }
-      first_block = 0;
-    } else  // All other FFTs
-
-      // Fill FFT_buffer with last events audio samples for all other FFT instances.
-      for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF); i++) {
-        FFT_buffer[i * 2] = last_sample_buffer_L[i]; // real
-        FFT_buffer[i * 2 + 1] = last_sample_buffer_R[i]; // imaginary
-      }
-
-    for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF); i++) {   // Copy recent samples to last_sample_buffer for next time!
-      last_sample_buffer_L [i] = float_buffer_L[i];
-      last_sample_buffer_R [i] = float_buffer_R[i];
-    }
-
-    //------------------------------ now fill recent audio samples into FFT_buffer (left channel: re, right channel: im)
-    for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF); i++) {
-      FFT_buffer[FFT_length + i * 2] = float_buffer_L[i]; // real
-      FFT_buffer[FFT_length + i * 2 + 1] = float_buffer_R[i]; // imaginary
-    }
+      arm_copy_f32(&FFT_buffer[2 * convNewSamples], convHistory, 2 * historyLength);  // The newest samples for next time!
 
-    /**********************************************************************************  AFP 12-31-20
-       Perform complex FFT on the audio time signals
-       calculation is performed in-place the FFT_buffer [re, im, re, im, re, im . . .]
-     **********************************************************************************/
-    arm_cfft_f32(S, FFT_buffer, 0, 1);
+      /**********************************************************************************  AFP 12-31-20
+         Perform complex FFT on the audio time signals
+         calculation is performed in-place the FFT_buffer [re, im, re, im, re, im . . .]
+       **********************************************************************************/
+      arm_cfft_f32(S, FFT_buffer, 0, 1);
 
-    /**********************************************************************************  AFP 12-31-20
-      Continuing FFT Convolution
-          Next, prepare the filter mask (done in the Filter.cpp file).  Only need to do this once for each filter setting.
-          Allows efficient real-time variable LP and HP audio filters, without the overhead of time-domain convolution filtering.
+      /**********************************************************************************  AFP 12-31-20
+        Continuing FFT Convolution
+            Next, prepare the filter mask (done in the Filter.cpp file).  Only need to do this once for each filter setting.
+            Allows efficient real-time variable LP and HP audio filters, without the overhead of time-domain convolution filtering.
 
-          After the Filter mask in the frequency domain is created, complex multiply  filter mask with the frequency domain audio data.
-          Filter mask previously calculated in setup Array of filter mask coefficients:
-          FIR_filter_mask[]
-     **********************************************************************************/
+            After the Filter mask in the frequency domain is created, complex multiply  filter mask with the frequency domain audio data.
+            Filter mask previously calculated in setup Array of filter mask coefficients:
+            FIR_filter_mask[]
+       **********************************************************************************/
 
-    arm_cmplx_mult_cmplx_f32 (FFT_buffer, FIR_filter_mask, iFFT_buffer, FFT_length);
-    if (updateDisplayFlag == 1) {
-      for (int k = 0; k < 1024; k++) {
-        audioSpectBuffer[1024 - k] = (iFFT_buffer[k] * iFFT_buffer[k]);
-      }
-      for (int k = 0; k < 256; k++) {
-        if (bands[EEPROMData.currentBand].mode == 0  || bands[EEPROMData.currentBand].mode == DEMOD_AM || bands[EEPROMData.currentBand].mode == DEMOD_SAM) {  //AFP 10-26-22
-          //audioYPixel[k] = 20+  map((int)displayScale[EEPROMData.currentScale].dBScale * log10f((audioSpectBuffer[1024 - k] + audioSpectBuffer[1024 - k + 1] + audioSpectBuffer[1024 - k + 2]) / 3), 0, 100, 0, 120);
-          audioYPixel[k] = 50 +  map(15 * log10f((audioSpectBuffer[1024 - k] + audioSpectBuffer[1024 - k + 1] + audioSpectBuffer[1024 - k + 2]) / 3), 0, 100, 0, 120);
-        }
-        else if (bands[EEPROMData.currentBand].mode == 1) {//AFP 10-26-22
-          //audioYPixel[k] = 20+   map((int)displayScale[EEPROMData.currentScale].dBScale * log10f((audioSpectBuffer[k] + audioSpectBuffer[k + 1] + audioSpectBuffer[k + 2]) / 3), 0, 100, 0, 120);
-          audioYPixel[k] = 50 +   map(15 * log10f((audioSpectBuffer[k] + audioSpectBuffer[k + 1] + audioSpectBuffer[k + 2]) / 3), 0, 100, 0, 120);
+      arm_cmplx_mult_cmplx_f32 (FFT_buffer, FIR_filter_mask, iFFT_buffer, convFFTLength);
+      if (pass + convNewSamples == FFT_length / 2) {  // Audio spectrum from the last pass of the block
+        DSP_TIMING_STOP(DSP_TIMING_CONVOLVE);
+        if (updateDisplayFlag == 1) {
+          for (int k = 0; k < 1024; k++) {  // 512 bins wide whatever the convolution size
+            spectBin = 2 * (((uint32_t)k / 2) * convFFTLength / 512) + (k & 1);
+            audioSpectBuffer[1024 - k] = (iFFT_buffer[spectBin] * iFFT_buffer[spectBin]);
+          }
+          for (int k = 0; k < 256; k++) {
+            if (bands[EEPROMData.currentBand].mode == 0  || bands[EEPROMData.currentBand].mode == DEMOD_AM || bands[EEPROMData.currentBand].mode == DEMOD_SAM) {  //AFP 10-26-22
+              //audioYPixel[k] = 20+  map((int)displayScale[EEPROMData.currentScale].dBScale * log10f((audioSpectBuffer[1024 - k] + audioSpectBuffer[1024 - k + 1] + audioSpectBuffer[1024 - k + 2]) / 3), 0, 100, 0, 120);
+              audioYPixel[k] = 50 +  map(15 * log10f((audioSpectBuffer[1024 - k] + audioSpectBuffer[1024 - k + 1] + audioSpectBuffer[1024 - k + 2]) / 3), 0, 100, 0, 120);
+            }
+            else if (bands[EEPROMData.currentBand].mode == 1) {//AFP 10-26-22
+              //audioYPixel[k] = 20+   map((int)displayScale[EEPROMData.currentScale].dBScale * log10f((audioSpectBuffer[k] + audioSpectBuffer[k + 1] + audioSpectBuffer[k + 2]) / 3), 0, 100, 0, 120);
+              audioYPixel[k] = 50 +   map(15 * log10f((audioSpectBuffer[k] + audioSpectBuffer[k + 1] + audioSpectBuffer[k + 2]) / 3), 0, 100, 0, 120);
+            }
+            if (audioYPixel[k] < 0)
+              audioYPixel[k] = 0;
+          }
+          arm_max_f32 (audioSpectBuffer, 1024, &audioMaxSquared, &AudioMaxIndex);  // AFP 09-18-22 Max value of squared abin magnitued in audio
+          audioMaxSquaredAve = .5 * audioMaxSquared + .5 * audioMaxSquaredAve;  //AFP 09-18-22Running averaged values
+          DisplaydbM();
         }
-        if (audioYPixel[k] < 0)
-          audioYPixel[k] = 0;
+        DSP_TIMING_START(DSP_TIMING_CONVOLVE);
       }
-      arm_max_f32 (audioSpectBuffer, 1024, &audioMaxSquared, &AudioMaxIndex);  // AFP 09-18-22 Max value of squared abin magnitued in audio
-      audioMaxSquaredAve = .5 * audioMaxSquared + .5 * audioMaxSquaredAve;  //AFP 09-18-22Running averaged values
-      DisplaydbM();
-    }
 
-    /**********************************************************************************
-          Additional Convolution Processes:
-              // filter by just deleting bins - principle of Linrad
-      only works properly when we have the right window function!
-
-        (automatic) notch filter = Tone killer --> the name is stolen from SNR ;-)
-        first test, we set a notch filter at 1kHz
-        which bin is that?
-        positive & negative frequency -1kHz and +1kHz --> delete 2 bins
-        we are not deleting one bin, but five bins for the test
-        1024 bins in 12ksps = 11.71Hz per bin
-        SR[SampleRate].rate / 8.0 / 1024 = bin BW
-        1000Hz / 11.71Hz = bin 85.333
+      /**********************************************************************************
+            Additional Convolution Processes:
+                // filter by just deleting bins - principle of Linrad
+        only works properly when we have the right window function!
 
-     **********************************************************************************/
+          (automatic) notch filter = Tone killer --> the name is stolen from SNR ;-)
+          first test, we set a notch filter at 1kHz
+          which bin is that?
+          positive & negative frequency -1kHz and +1kHz --> delete 2 bins
+          we are not deleting one bin, but five bins for the test
+          1024 bins in 12ksps = 11.71Hz per bin
+          SR[SampleRate].rate / 8.0 / 1024 = bin BW
+          1000Hz / 11.71Hz = bin 85.333
 
-    /**********************************************************************************  AFP 12-31-20
-      After the frequency domain filter mask and other processes are complete, do a
-      complex inverse FFT to return to the time domain
-        (if sample rate = 192kHz, we are in 24ksps now, because we decimated by 8)
-        perform iFFT (in-place)  IFFT is selected by the IFFT flag=1 in the Arm CFFT function.
-     **********************************************************************************/
+       **********************************************************************************/
+
+      /**********************************************************************************  AFP 12-31-20
+        After the frequency domain filter mask and other processes are complete, do a
+        complex inverse FFT to return to the time domain
+          (if sample rate = 192kHz, we are in 24ksps now, because we decimated by 8)
+          perform iFFT (in-place)  IFFT is selected by the IFFT flag=1 in the Arm CFFT function.
+       **********************************************************************************/
 
-    arm_cfft_f32(iS, iFFT_buffer, 1, 1);
+      arm_cfft_f32(iS, iFFT_buffer, 1, 1);
+
+      // The last convNewSamples outputs are the valid ones.  Move them to where AGC() and the demodulators expect
+      // this pass's samples: iFFT_buffer[FFT_length] on, the layout of the 512 point convolution.
+      if (2 * historyLength != FFT_length + 2 * pass) {
+        memmove(&iFFT_buffer[FFT_length + 2 * pass], &iFFT_buffer[2 * historyLength], 2 * convNewSamples * sizeof(float32_t));
+      }
+    }
+    DSP_TIMING_STOP(DSP_TIMING_CONVOLVE);
 
     // Adjust for level alteration because of filters.
 
@@ -342,7 +400,9 @@ void ProcessIQData()
         we´re back in time domain
         AGC acts upon I & Q before demodulation on the decimated audio data in iFFT_buffer
      **********************************************************************************/
+    DSP_TIMING_START(DSP_TIMING_AGC);
     AGC();  //AGC function works with time domain I and Q data buffers created in the last step.
+    DSP_TIMING_STOP(DSP_TIMING_AGC);
 
     /**********************************************************************************
           Demodulation
@@ -350,7 +410,7 @@ void ProcessIQData()
             The demod mode is accomplished by selecting/combining the real and imaginary parts of the output of the IFFT process.
        **********************************************************************************/
     //===================== AFP 10-27-22  =========
-
+    DSP_TIMING_START(DSP_TIMING_DEMOD);
     switch (bands[EEPROMData.currentBand].mode) {
       case DEMOD_LSB :
         for (unsigned i = 0; i < FFT_length / 2; i++) {
@@ -390,11 +450,12 @@ void ProcessIQData()
     
 
     //============================  Receive EQ  ========================  AFP 08-08-22
-    if (EEPROMData.receiveEQFlag == ON ) {
+    // From RECEIVE_EQ_FULL_FFT points up the equalizer is part of the filter mask
+    if (EEPROMData.receiveEQFlag == ON && convFFTLength < RECEIVE_EQ_FULL_FFT) {
       DoReceiveEQ();
-      arm_copy_f32(float_buffer_L, float_buffer_R, FFT_length / 2);
     }
     //============================ End Receive EQ
+    DSP_TIMING_STOP(DSP_TIMING_DEMOD);
 
     /**********************************************************************************
       Noise Reduction
@@ -403,6 +464,7 @@ void ProcessIQData()
       Spectral NR
       LMS variable leak NR
     **********************************************************************************/
+    DSP_TIMING_START(DSP_TIMING_NR);
     switch (NR_Index) {
       case 0:                               // NR Off
         break;
@@ -439,8 +501,18 @@ void ProcessIQData()
      NoiseBlanker(float_buffer_L, float_buffer_R);
       arm_copy_f32(float_buffer_R, float_buffer_L, FFT_length / 2);
     }
- 
+    DSP_TIMING_STOP(DSP_TIMING_NR);
+
+    // RTTY decoder on the sideband audio
+    if (T41State == SSB_RECEIVE && EEPROMData.rttyDecoder != RTTY_OFF
+        && (bands[EEPROMData.currentBand].mode == DEMOD_LSB || bands[EEPROMData.currentBand].mode == DEMOD_USB)) {
+      DSP_TIMING_START(DSP_TIMING_RTTY);
+      RTTYDecoder(float_buffer_L);
+      DSP_TIMING_STOP(DSP_TIMING_RTTY);
+    }
+
     if (T41State == CW_RECEIVE) {
+      DSP_TIMING_START(DSP_TIMING_CW);
       DoCWReceiveProcessing(); //AFP 09-19-22
 
       // ----------------------  CW Narrow band filters  AFP 10-18-22 -------------------------
@@ -475,18 +547,23 @@ void ProcessIQData()
             break;
         }
       }
-
-
+      DSP_TIMING_STOP(DSP_TIMING_CW);
     }
 
     // ======================================Interpolation  ================
+    DSP_TIMING_START(DSP_TIMING_OUTPUT);
 
     arm_fir_interpolate_f32(&FIR_int1_I, float_buffer_L, iFFT_buffer, BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF));   // Interpolatikon
     arm_fir_interpolate_f32(&FIR_int1_Q, float_buffer_R, FFT_buffer, BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF));
 
-    // interpolation-by-4
-    arm_fir_interpolate_f32(&FIR_int2_I, iFFT_buffer, float_buffer_L, BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF1));
-    arm_fir_interpolate_f32(&FIR_int2_Q, FFT_buffer, float_buffer_R, BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF1));
+    if (DF1 > 1.0) {
+      // interpolation-by-DF1, 4 at 192K
+      arm_fir_interpolate_f32(&FIR_int2_I, iFFT_buffer, float_buffer_L, BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF1));
+      arm_fir_interpolate_f32(&FIR_int2_Q, FFT_buffer, float_buffer_R, BUFFER_SIZE * N_BLOCKS / (uint32_t)(DF1));
+    } else {  // 48K, already at the output rate
+      arm_copy_f32(iFFT_buffer, float_buffer_L, BUFFER_SIZE * N_BLOCKS);
+      arm_copy_f32(FFT_buffer, float_buffer_R, BUFFER_SIZE * N_BLOCKS);
+    }
 
     /**********************************************************************************  AFP 12-31-20
       Digital Volume Control
@@ -515,6 +592,8 @@ void ProcessIQData()
     if (auto_codec_gain == 1) {
       Codec_gain();
     }
+    DSP_TIMING_STOP(DSP_TIMING_OUTPUT);
+    DSP_TIMING_STOP(DSP_TIMING_TOTAL);
     elapsed_micros_sum = elapsed_micros_sum + usec;
     elapsed_micros_idx_t++;
   } // end of if(audio blocks available)
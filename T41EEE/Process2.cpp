@@ -24,6 +24,7 @@ int transmitPowerLevelTemp, cwFreqOffsetTemp;
       void
  *****/
 void CalibratePreamble(int setZoom) {
+  SetReceiveSampleRate(SAMPLE_RATE_192K);  // The calibration tones and bins assume 192K.
   calOnFlag = 1;
   corrChange = 0;
   correctionIncrement = 0.01;  //AFP 2-7-23
@@ -124,6 +125,7 @@ void CalibratePrologue() {
   IQChoice = 5;
   calOnFlag = 0;
   radioState = CW_RECEIVE_STATE;  // KF5N
+  SetReceiveSampleRate(EEPROMData.rxSampleRate);  // Restore the user's receive sample rate.
   SetFreq();                      // Return Si5351 to normal operation mode.  KF5N
   lastState = 1111;               // This is required due to the function deactivating the receiver.  This forces a pass through the receiver set-up code.  KF5N October 16, 2023
   return;
@@ -0,0 +1,272 @@
+#ifndef BEENHERE
+#include "SDT.h"
+#endif
+
+// RTTY decoder, 45.45 baud Baudot with 170 Hz shift.  Turn it on with the RTTY menu.
+// RTTYDecoder() runs on the demodulated LSB or USB audio in ProcessIQData(), next to DoCWReceiveProcessing().  The
+// mark and space tones are each mixed down to 0 Hz, summed over RTTY_DECIMATE samples, and filtered with a one bit
+// long Hann window, the filter bank.  Automatic threshold correction follows the envelope and noise floor of each
+// tone, so a selective fade of one tone does not turn into errors.  A start bit edge starts the bit clock, which
+// samples the middle of each bit, and every later transition in the character pulls the clock toward the bit
+// boundary, the bit-sync loop.  Decoded text goes to the decoder line under the waterfall.  The work for a block is
+// the same whatever the signal, and the cycles used are checked against RTTY_CYCLE_BUDGET.
+
+uint32_t rttyBlocks = 0;        // Blocks decoded since the last DSPTimingReport()
+uint64_t rttyCycles = 0;        // Cycles used by RTTYDecoder() since the last DSPTimingReport()
+uint32_t rttyMaxCycles = 0;     // Most cycles used for one block
+uint32_t rttyOverBudget = 0;    // Blocks over RTTY_CYCLE_BUDGET
+
+// Letters and figures shifts.  0 is a code that prints nothing: blank, bell, and the two shifts.
+static const char rttyLetters[32] = { 0, 'E', '\n', 'A', ' ', 'S', 'I', 'U', '\r', 'D', 'R', 'J', 'N', 'F', 'C', 'K',
+                                      'T', 'Z', 'L', 'W', 'H', 'Y', 'P', 'Q', 'O', 'B', 'G', 0, 'M', 'X', 'V', 0 };
+static const char rttyFigures[32] = { 0, '3', '\n', '-', ' ', 0, '8', '7', '\r', '$', '4', '\'', ',', '!', ':', '(',
+                                      '5', '"', ')', '2', '#', '6', '0', '1', '9', '?', '&', 0, '.', '/', ';', 0 };
+
+static float32_t rttyPhasor[2][2];  // Mark and space oscillators, cos and sin
+static float32_t rttyStep[2][2];    // Oscillator rotation per sample
+static float32_t rttySum[4];        // Mark I and Q, space I and Q, summed over RTTY_DECIMATE samples
+static int rttySums;                // Samples in rttySum[]
+static float32_t rttyHistory[4][2 * RTTY_TAPS_MAX];  // Filter bank inputs, each written twice so the taps are in a row
+static float32_t rttyFilter[RTTY_TAPS_MAX];          // One bit Hann window
+static int rttyTaps;
+static int rttyIndex;               // Oldest sample in rttyHistory[][]
+static float32_t rttyBitSamples;    // Filter bank samples per bit
+static float32_t markEnv, spaceEnv, markNoise, spaceNoise;  // Automatic threshold correction
+static float32_t rttyContrast;       // Mark and space envelope difference over their sum, averaged.  Near 1 for RTTY.
+static float32_t rttyLastLevel;     // Last mark minus space decision level
+static int rttyBit;                 // -1 hunting for a start bit, 0 start bit, 1 to 5 data bits, 6 stop bit
+static float32_t rttyClock;         // Filter bank samples since the start bit edge, corrected by the bit-sync loop
+static int rttyCode;
+static bool rttyShift;              // Figures shift
+static char rttyPending;            // Character waiting to be shown, 0 for none
+static char rttyLastChar;
+static int rttyMode = -1;           // Demodulation mode the tones were set for
+static float32_t rttyRate = 0.0;    // Sample rate the tones were set for
+
+/*****
+  Purpose: Set the mark and space tones for the demodulation mode, build the filter bank, and start the decoder
+           hunting for a start bit.  Called when the decoder is turned on or off and when the mode changes.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+void RTTYReset() {
+  float32_t mark = RTTY_MARK;
+  float32_t space = RTTY_MARK + RTTY_SHIFT;
+  float32_t tone, sum;
+
+  rttyMode = bands[EEPROMData.currentBand].mode;
+  rttyRate = decimatedRate;
+  if ((rttyMode == DEMOD_USB) != (EEPROMData.rttyDecoder == RTTY_REVERSE)) {  // Upper sideband puts mark above space
+    mark = RTTY_MARK + RTTY_SHIFT;
+    space = RTTY_MARK;
+  }
+  for (int t = 0; t < 2; t++) {
+    tone = TWO_PI * (t == 0 ? mark : space) / decimatedRate;
+    rttyStep[t][0] = cosf(tone);
+    rttyStep[t][1] = -sinf(tone);
+    rttyPhasor[t][0] = 1.0;
+    rttyPhasor[t][1] = 0.0;
+  }
+
+  rttyBitSamples = decimatedRate / RTTY_DECIMATE / RTTY_BAUD;
+  rttyTaps = min((int)(rttyBitSamples + 0.5), RTTY_TAPS_MAX);
+  sum = 0.0;
+  for (int i = 0; i < rttyTaps; i++) {
+    rttyFilter[i] = 0.5 - 0.5 * cosf(TWO_PI * (i + 0.5) / rttyTaps);
+    sum += rttyFilter[i];
+  }
+  for (int i = 0; i < rttyTaps; i++) {  // Unity gain, and the 1 / RTTY_DECIMATE of the sums
+    rttyFilter[i] /= sum * RTTY_DECIMATE;
+  }
+  memset(rttyHistory, 0, sizeof(rttyHistory));
+  memset(rttySum, 0, sizeof(rttySum));
+  rttySums = 0;
+  rttyIndex = 0;
+
+  markEnv = spaceEnv = markNoise = spaceNoise = 0.0;
+  rttyContrast = 0.0;
+  rttyLastLevel = 0.0;
+  rttyBit = -1;
+  rttyShift = false;
+  rttyPending = 0;
+  rttyLastChar = ' ';
+  MorseCharacterClear();
+  tft.fillRect(CW_TEXT_START_X, CW_TEXT_START_Y, CW_MESSAGE_WIDTH, CW_MESSAGE_HEIGHT * 2, RA8875_BLACK);
+}
+
+/*****
+  Purpose: Move a tracker toward a new value, by 1 / weight of the difference
+
+  Parameter list:
+    float32_t average     the tracker
+    float32_t value       the new value
+    float32_t weight      the time constant, in filter bank samples
+
+  Return value;
+    float32_t             the new tracker value
+*****/
+static inline float32_t RTTYTrack(float32_t average, float32_t value, float32_t weight) {
+  return average + (value - average) / weight;
+}
+
+/*****
+  Purpose: Turn a received Baudot code into a character for the decoder line.  The shift codes change the shift, and
+           a space returns to letters, unshift on space.  Carriage return and line feed become one space.
+
+  Parameter list:
+    int code              the 5 bit code
+
+  Return value;
+    void
+*****/
+static void RTTYCharacter(int code) {
+  char c;
+
+  if (code == RTTY_LTRS) {
+    rttyShift = false;
+    return;
+  }
+  if (code == RTTY_FIGS) {
+    rttyShift = true;
+    return;
+  }
+  c = rttyShift ? rttyFigures[code] : rttyLetters[code];
+  if (c == ' ') {
+    rttyShift = false;
+  }
+  if (c == '\r' || c == '\n') {
+    c = ' ';
+  }
+  if (c == 0 || (c == ' ' && rttyLastChar == ' ')) {
+    return;
+  }
+  rttyPending = c;
+  rttyLastChar = c;
+}
+
+/*****
+  Purpose: Run one filter bank sample through the envelope detectors, the threshold correction, and the
+           start-stop framing with its bit-sync loop.
+
+  Parameter list:
+    void
+
+  Return value;
+    void
+*****/
+static void RTTYSample() {
+  float32_t out[4];
+  float32_t mark, space, noise, markClip, spaceClip, level;
+  float32_t edge, error;
+  int bit;
+
+  for (int k = 0; k < 4; k++) {
+    rttyHistory[k][rttyIndex] = rttyHistory[k][rttyIndex + rttyTaps] = rttySum[k];
+  }
+  rttyIndex = (rttyIndex + 1 == rttyTaps) ? 0 : rttyIndex + 1;
+  for (int k = 0; k < 4; k++) {
+    arm_dot_prod_f32(&rttyHistory[k][rttyIndex], rttyFilter, rttyTaps, &out[k]);
+  }
+  mark = sqrtf(out[0] * out[0] + out[1] * out[1]);  // Envelopes
+  space = sqrtf(out[2] * out[2] + out[3] * out[3]);
+
+  // Automatic threshold correction: envelopes follow the tones up quickly, noise floors follow them down quickly
+  markEnv = RTTYTrack(markEnv, mark, mark > markEnv ? rttyBitSamples / 4.0 : rttyBitSamples * 16.0);
+  spaceEnv = RTTYTrack(spaceEnv, space, space > spaceEnv ? rttyBitSamples / 4.0 : rttyBitSamples * 16.0);
+  markNoise = RTTYTrack(markNoise, mark, mark < markNoise ? rttyBitSamples / 4.0 : rttyBitSamples * 48.0);
+  spaceNoise = RTTYTrack(spaceNoise, space, space < spaceNoise ? rttyBitSamples / 4.0 : rttyBitSamples * 48.0);
+  noise = min(markNoise, spaceNoise);
+  rttyContrast = RTTYTrack(rttyContrast, fabsf(mark - space) / (mark + space + 1.0e-20), rttyBitSamples * 8.0);
+  markClip = max(min(mark, markEnv), noise) - noise;
+  spaceClip = max(min(space, spaceEnv), noise) - noise;
+  level = markClip * (markEnv - noise) - spaceClip * (spaceEnv - noise)
+          - 0.25 * ((markEnv - noise) * (markEnv - noise) - (spaceEnv - noise) * (spaceEnv - noise));
+  bit = (level > 0.0);  // 1 for mark
+
+  if (rttyBit < 0) {  // Hunting for a mark to space edge, squelched on noise, which has a contrast of about 0.3
+    if (!bit && rttyLastLevel > 0.0 && rttyContrast > RTTY_SQUELCH) {
+      rttyBit = 0;
+      rttyClock = level / (level - rttyLastLevel);  // Time since the edge, from where the level crossed 0
+      rttyCode = 0;
+    }
+  } else {
+    rttyClock += 1.0;
+    if (bit != (rttyLastLevel > 0.0)) {  // Bit-sync loop: move the clock toward putting the edge on a bit boundary
+      edge = rttyClock - level / (level - rttyLastLevel);
+      error = edge - rttyBitSamples * roundf(edge / rttyBitSamples);
+      rttyClock -= RTTY_SYNC_GAIN * error;
+    }
+    if (rttyClock >= (rttyBit + 0.5) * rttyBitSamples) {  // Middle of the bit
+      if (rttyBit == 0) {
+        if (bit) {
+          rttyBit = -1;  // Not a start bit after all
+        } else {
+          rttyBit++;
+        }
+      } else if (rttyBit <= 5) {
+        rttyCode |= bit << (rttyBit - 1);  // First bit is the least significant
+        rttyBit++;
+      } else {
+        if (bit) {  // Framing error if the stop bit is space
+          RTTYCharacter(rttyCode);
+        }
+        rttyBit = -1;
+      }
+    }
+  }
+  rttyLastLevel = level;
+}
+
+/*****
+  Purpose: Decode RTTY in one block of demodulated audio, and show any decoded character.
+
+  Parameter list:
+    float32_t *audio      BUF_N_DF samples at decimatedRate
+
+  Return value;
+    void
+*****/
+void RTTYDecoder(float32_t *audio) {
+  uint32_t start = ARM_DWT_CYCCNT;
+  uint32_t cycles;
+  float32_t c, s, gain;
+
+  if (bands[EEPROMData.currentBand].mode != rttyMode || decimatedRate != rttyRate) {
+    RTTYReset();
+  }
+  for (uint32_t i = 0; i < BUF_N_DF; i++) {
+    for (int t = 0; t < 2; t++) {
+      rttySum[2 * t] += audio[i] * rttyPhasor[t][0];
+      rttySum[2 * t + 1] += audio[i] * rttyPhasor[t][1];
+      c = rttyPhasor[t][0] * rttyStep[t][0] - rttyPhasor[t][1] * rttyStep[t][1];
+      s = rttyPhasor[t][0] * rttyStep[t][1] + rttyPhasor[t][1] * rttyStep[t][0];
+      rttyPhasor[t][0] = c;
+      rttyPhasor[t][1] = s;
+    }
+    if (++rttySums == RTTY_DECIMATE) {
+      RTTYSample();
+      memset(rttySum, 0, sizeof(rttySum));
+      rttySums = 0;
+    }
+  }
+  for (int t = 0; t < 2; t++) {  // Hold the oscillators at unit amplitude
+    gain = 1.5 - 0.5 * (rttyPhasor[t][0] * rttyPhasor[t][0] + rttyPhasor[t][1] * rttyPhasor[t][1]);
+    rttyPhasor[t][0] *= gain;
+    rttyPhasor[t][1] *= gain;
+  }
+
+  cycles = ARM_DWT_CYCCNT - start;
+  rttyBlocks++;
+  rttyCycles += cycles;
+  if (cycles > rttyMaxCycles) rttyMaxCycles = cycles;
+  if (cycles > RTTY_CYCLE_BUDGET) rttyOverBudget++;
+
+  if (rttyPending) {  // At most one character per block, so the display is outside the budget.  45.45 baud
+    MorseCharacterDisplay(rttyPending);  // is one character every 165 ms.
+    rttyPending = 0;
+  }
+}
@@ -40,6 +40,7 @@ void EthernetEvent();
 
 //======================================== User section that might need to be changed ===================================
 #include "MyConfigurationFile.h"  // This file name should remain unchanged
+#include "DebugConfiguration.h"   // Developer measurement switches
 #define VERSION "T41EEE.1"        // Change this for updates. If you make this longer than 9 characters, brace yourself for surprises
 #define UPDATE_SWITCH_MATRIX 0    // 1 = Yes, redo the switch matrix values, 0 = leave switch matrix values as is from the last change
 struct maps {
@@ -87,7 +88,7 @@ extern struct maps myMapFiles[];
 //======================================== Symbolic Constants for the T41 ===================================================
 #define RIGNAME "T41-EP SDT"
 #define NUMBER_OF_SWITCHES 18  // Number of push button switches. 16 on older boards
-#define TOP_MENU_COUNT 13      // Menus to process AFP 09-27-22, JJP 7-8-23
+#define TOP_MENU_COUNT 14      // Menus to process AFP 09-27-22, JJP 7-8-23
 #define RIGNAME_X_OFFSET 570   // Pixel count to rig name field                                       // Says we are using a Teensy 4 or 4.1
 #define RA8875_DISPLAY 1       // Comment out if not using RA8875 display
 #define TEMPMON_ROOMTEMP 25.0f
@@ -168,6 +169,20 @@ extern struct maps myMapFiles[];
 
 #define CLIP_AUDIO_PEAK 115                                     // The pixel value where audio peak overwrites S-meter
 #define SPECTRUM_RES 512                                        // The value used in the original open-source code is 256.  Al uses 512.
+#define SPECTRUM_WINDOW_HANN 0                                  // Spectrum FFT windows, see spectrumWindowTypes[]
+#define SPECTRUM_WINDOW_BLACKMAN_HARRIS 1
+#define SPECTRUM_WINDOW_FLAT_TOP 2
+#define SPECTRUM_WINDOWS 3
+#define SPECTRUM_FFT_MAX 2048                                  // Largest spectrum FFT, binned down to SPECTRUM_RES columns
+#define SPECTRUM_AVERAGE_OFF 0                                  // Spectrum averaging modes, see SpectrumAverage()
+#define SPECTRUM_AVERAGE_EXPONENTIAL 1
+#define SPECTRUM_AVERAGE_LINEAR 2
+#define SPECTRUM_AVERAGE_PEAK_HOLD 3
+#define SPECTRUM_AVERAGE_MIN_HOLD 4
+#define SPECTRUM_AVERAGE_MODES 5
+#define SPECTRUM_AVERAGE_TAU 0.1                                // Exponential average time constant, seconds
+#define SPECTRUM_AVERAGE_FRAMES 4                               // Spectra in the linear average
+#define SPECTRUM_PEAK_DECAY 20.0                                // Peak hold fall rate, dB per second
 #define SPECTRUM_TOP_Y 100                                      // Start of spectrum plot space
 #define SPECTRUM_HEIGHT 150                                     // This is the pixel height of spectrum plot area without disturbing the axes
 #define SPECTRUM_BOTTOM (SPECTRUM_TOP_Y + SPECTRUM_HEIGHT - 3)  // 247 = 100 + 150 - 3
@@ -175,6 +190,7 @@ extern struct maps myMapFiles[];
 #define AUDIO_SPECTRUM_BOTTOM SPECTRUM_BOTTOM
 #define MAX_WATERFALL_WIDTH 512  // Pixel width of waterfall
 #define MAX_WATERFALL_ROWS 170   // Waterfall rows
+#define DISPLAY_SLICE_PIXELS 32  // ShowSpectrum() checks the filter encoder and front panel once per slice
 
 #define WATERFALL_RIGHT_X (WATERFALL_LEFT_X + MAX_WATERFALL_WIDTH)    // 3 + 512
 #define WATERFALL_TOP_Y (SPECTRUM_TOP_Y + SPECTRUM_HEIGHT + 5)        // 130 + 120 + 5 = 255
@@ -249,12 +265,15 @@ extern struct maps myMapFiles[];
 #define VOLUME_INFO_FIELD_Y 292
 
 #define SAM_PLL_HILBERT_STAGES 7              // AFP 11-02-22
+#define SAM_ATAN_TABLE_SIZE 64                // SAM phase detector arctangent table steps
+#define SAM_STATUS_INTERVAL 100               // Milliseconds between SAM carrier offset display updates
 #define OUT_IDX (3 * SAM_PLL_HILBERT_STAGES)  // AFP 11-02-22
 #define MAX_DECODE_CHARS 32                   // Max chars that can appear on decoder line.  Increased to 32.  KF5N October 29, 2023
 #define DECODER_BUFFER_SIZE 128               // Max chars in binary search string with , . ?
 #define DECODER_CAP_VALUE 6.0
 #define DITLENGTH_DELTA 5  // Number of milliseconds to change ditLEngth with encoder
 #define HISTOGRAM_ELEMENTS 750
+#define HISTOGRAM_MIN_SCALE 1.0e-6                            // Histogram scale factor that triggers a renormalization
 #define LOWEST_ATOM_TIME 20                                   // 60WPM has an atom of 20ms
 #define HIGHEST_ATOM_TIME 240                                 // 5WPM has an atom of 240ms
 #define DIT_WEIGHT 0.3                                        // Previous values account for 90% of average
@@ -289,6 +308,7 @@ extern struct maps myMapFiles[];
 
 //--------------------- decoding stuff
 #define FFT_LENGTH 512
+#define FFT_LENGTH_MAX 2048  // Largest convolution FFT, sizes the convolution buffers
 #define NOISE_SAMPLE_SIZE 500
 #define SD_MULTIPLIER 3
 #define NOISE_MULTIPLIER 0.5   // Signal must be this many time greater than the noise floor
@@ -339,7 +359,7 @@ extern struct maps myMapFiles[];
 
 #define ENCODER_FACTOR 0.25F  // use 0.25f with cheap encoders that have 4 detents per step,
 //                                                  for other encoders or libs we use 1.0f
-#define MAX_ZOOM_ENTRIES 5
+#define MAX_ZOOM_ENTRIES 9
 //#define FREQ_SEP_CHARACTER          ','
 
 //========================================================= Pin Assignments =====================================
@@ -477,8 +497,12 @@ extern int radioState, lastState;  // Used by the loop to monitor current state.
 #define SPECTRUM_ZOOM_4 2
 #define SPECTRUM_ZOOM_8 3
 #define SPECTRUM_ZOOM_16 4
+#define SPECTRUM_ZOOM_32 5
+#define SPECTRUM_ZOOM_64 6
+#define SPECTRUM_ZOOM_128 7
+#define SPECTRUM_ZOOM_256 8
 
-#define SPECTRUM_ZOOM_MAX 4
+#define SPECTRUM_ZOOM_MAX 8
 
 #define SAMPLE_RATE_MIN 6
 #define SAMPLE_RATE_8K 0
@@ -591,6 +615,8 @@ extern int radioState, lastState;  // Used by the loop to monitor current state.
 #define MAX_N_TAU (8)
 #define MAX_TAU_ATTACK (0.01)
 #define RB_SIZE (int)(MAX_SAMPLE_RATE * MAX_N_TAU * MAX_TAU_ATTACK + 1)
+#define AGC_GAIN_SUBBLOCK 16  // Samples per AGC gain law evaluation, the gain is ramped in between.  Divides 256.
+#define AGC_GAIN_RAMP_RATIO 1.01  // Largest change of volts over a sub-block that is ramped, bounds the ramp gain error to 1%
 
 //#define CONFIG_VERSION              "mr1"             //mdrhere ID of the E settings block, change if structure changes
 //#define CONFIG_START 0                                // Address start the EEPROM data. (emulated with size of 4K. Actual address managed in library)
@@ -666,6 +692,37 @@ extern float32_t HP_DC_Filter_Coeffs2[];  // AFP 11-02-22
 #define MAX_LMS_DELAY 256
 #define NR_FFT_L 256
 #define NB_FFT_SIZE FFT_LENGTH / 2
+#define NB_ORDER_MAX 16     // Largest noise blanker LPC order, NB_taps
+#define NB_IMPULSE_MAX 15   // Largest noise blanker impulse length, NB_impulse_samples
+#define NB_GATE_FACTOR 2.0  // Noise blanker gate, sixth difference peak to RMS ratio that starts the LPC analysis, over NB_thresh
+#define NB_GATE_MIN_THRESH 2.5  // Lowest NB_thresh the gate is used at
+#define CW_DETECT_FFT 512   // CW detector correlation FFT, at least 2 x 256 - 1
+#define SKIM_FFT 256                  // CW skimmer channelizer FFT, 93.75 Hz bins at 24K
+#define SKIM_HOP 128                  // CW skimmer samples between channelizer FFTs, 5.3 ms at 24K
+#define SKIM_CHANNELS 8               // CW skimmer decoder pool, also the rows in the waterfall area
+#define SKIM_TEXT_CHARS 48            // Decoded characters shown for each skimmer channel
+#define SKIM_WORD_CHARS 15            // Longest word sent over Serial by the skimmer
+#define SKIM_DETECT_RATIO 100.0       // Keyed carrier: bin peak to floor power ratio, 20 dB
+#define SKIM_KEY_LEVEL 0.25           // Skimmer key threshold is never more than this power ratio, 6 dB, below the peak
+#define SKIM_KEY_HYSTERESIS 1.41      // Skimmer key on and off power ratios around the key threshold
+#define SKIM_FLOOR_FALL 0.1           // Skimmer bin floor step toward a lower level, per channelizer FFT
+#define SKIM_FLOOR_RISE 1.005         // Skimmer bin floor rise per channelizer FFT, 10 dB in 2.5 seconds
+#define SKIM_PEAK_DECAY 0.995         // Skimmer bin peak decay per channelizer FFT, 10 dB in 2.5 seconds
+#define SKIM_IDLE_TIME 15000          // A skimmer channel that decodes nothing for this long is freed, ms
+#define SKIM_ROW_HEIGHT 20            // Skimmer text row spacing in the waterfall area
+#define RTTY_OFF 0                    // EEPROMData.rttyDecoder settings
+#define RTTY_NORMAL 1
+#define RTTY_REVERSE 2                // Mark and space swapped
+#define RTTY_BAUD 45.45
+#define RTTY_MARK 2125.0              // RTTY mark audio tone in LSB, Hz.  The space tone is RTTY_SHIFT above it.
+#define RTTY_SHIFT 170.0
+#define RTTY_DECIMATE 16              // RTTY mixer outputs summed per filter bank sample, 1500 Hz at 24K
+#define RTTY_TAPS_MAX 64              // Longest RTTY filter bank window, one bit
+#define RTTY_SYNC_GAIN 0.25           // Share of an edge timing error the RTTY bit-sync loop corrects
+#define RTTY_SQUELCH 0.45             // RTTY mark and space contrast needed to start a character
+#define RTTY_LTRS 31                  // Baudot letters shift
+#define RTTY_FIGS 27                  // Baudot figures shift
+#define RTTY_CYCLE_BUDGET 30000       // Most cycles RTTYDecoder() should use for a 256 sample block, 50 us at 600 MHz
 #define TABLE_SIZE_64 64
 #define EEPROM_BASE_ADDRESS 0U
 
@@ -735,11 +792,6 @@ extern int endDitFlag;
 extern int endGapFlag;
 extern int topDitIndex;  //AFP 02-20-22
 extern int topDitIndexOld;
-extern int topGapIndex;
-extern int topGapIndexOld;
-
-extern int32_t signalHistogram[];
-extern int32_t gapHistogram[];
 extern uint32_t histMaxIndexDitOld;
 extern uint32_t histMaxIndexDahOld;
 extern uint32_t histMaxDit;
@@ -756,16 +808,7 @@ extern int atomGapLength2;
 extern int charGapLength;
 extern int charGapLength2;
 extern int centerTuneFlag;
-extern long valRef1;
-extern long valRef2;
-extern long gapRef1;
-extern int valFlag;
-extern long signalStartOld;
 extern int valCounter;
-extern long aveDitLength;
-extern long aveDahLength;
-extern float thresholdGeometricMean;
-extern float thresholdArithmeticMean;
 extern float aveAtomGapLength;
 extern float thresholdGapGeometricMean;
 extern float thresholdGapArithmeticMean;
@@ -881,6 +924,13 @@ struct config_t {
   int buttonThresholdPressed = 944;   // switchValues[0] + WIGGLE_ROOM
   int buttonThresholdReleased = 964;  // buttonThresholdPressed + WIGGLE_ROOM
   int buttonRepeatDelay = 300000;     // Increased to 300000 from 200000 to better handle cheap, wornout buttons.
+  int convFFTLength = FFT_LENGTH;     // Convolution filter FFT size: 256, 512, 1024, or 2048
+  int rxSampleRate = SAMPLE_RATE_192K;  // Receive sample rate: SAMPLE_RATE_192K, SAMPLE_RATE_96K, or SAMPLE_RATE_48K
+  int spectrumWindow = SPECTRUM_WINDOW_HANN;  // Spectrum FFT window
+  int spectrumAverage = SPECTRUM_AVERAGE_EXPONENTIAL;  // Spectrum averaging mode
+  int spectrumFFTSize = SPECTRUM_RES;  // Spectrum FFT size: 512, 1024, or 2048
+  bool cwSkimmer = false;  // Multi-channel CW skimmer in place of the waterfall in CW mode
+  int rttyDecoder = RTTY_OFF;  // RTTY decoder in SSB mode: RTTY_OFF, RTTY_NORMAL, or RTTY_REVERSE
 };
 
 extern struct config_t EEPROMData;
@@ -926,21 +976,6 @@ extern float32_t rec_EQ_Band12_state[];
 extern float32_t rec_EQ_Band13_state[];
 extern float32_t rec_EQ_Band14_state[];
 
-extern float32_t rec_EQ1_float_buffer_L[];
-extern float32_t rec_EQ2_float_buffer_L[];
-extern float32_t rec_EQ3_float_buffer_L[];
-extern float32_t rec_EQ4_float_buffer_L[];
-extern float32_t rec_EQ5_float_buffer_L[];
-extern float32_t rec_EQ6_float_buffer_L[];
-extern float32_t rec_EQ7_float_buffer_L[];
-extern float32_t rec_EQ8_float_buffer_L[];
-extern float32_t rec_EQ9_float_buffer_L[];
-extern float32_t rec_EQ10_float_buffer_L[];
-extern float32_t rec_EQ11_float_buffer_L[];
-extern float32_t rec_EQ12_float_buffer_L[];
-extern float32_t rec_EQ13_float_buffer_L[];
-extern float32_t rec_EQ14_float_buffer_L[];
-
 extern float32_t FIR_Hilbert_coeffs90[];
 extern float32_t FIR_Hilbert_coeffs0[];
 
@@ -1026,21 +1061,6 @@ extern arm_biquad_cascade_df2T_instance_f32 S14_Xmt;
 
 //extern float32_t xmtEQ_Level[];
 
-extern float32_t xmt_EQ1_float_buffer_L[];
-extern float32_t xmt_EQ2_float_buffer_L[];
-extern float32_t xmt_EQ3_float_buffer_L[];
-extern float32_t xmt_EQ4_float_buffer_L[];
-extern float32_t xmt_EQ5_float_buffer_L[];
-extern float32_t xmt_EQ6_float_buffer_L[];
-extern float32_t xmt_EQ7_float_buffer_L[];
-extern float32_t xmt_EQ8_float_buffer_L[];
-extern float32_t xmt_EQ9_float_buffer_L[];
-extern float32_t xmt_EQ10_float_buffer_L[];
-extern float32_t xmt_EQ11_float_buffer_L[];
-extern float32_t xmt_EQ12_float_buffer_L[];
-extern float32_t xmt_EQ13_float_buffer_L[];
-extern float32_t xmt_EQ14_float_buffer_L[];
-
 // ================= end  AFP 10-02-22 ===========
 
 
@@ -1143,13 +1163,6 @@ extern long NCOFreq;  // AFP 04-16-22
 //extern long stepFineTune;
 //extern long stepFineTune2;
 extern float32_t NCO_INC;  // AFP 04-16-22
-extern double OSC_COS;
-extern double OSC_SIN;
-extern double Osc_Vect_Q;
-extern double Osc_Vect_I;
-extern double Osc_Gain;
-extern double Osc_Q;
-extern double Osc_I;
 extern float32_t i_temp;
 extern float32_t q_temp;
 //extern float32_t Osc2_Q_buffer [BUFFER_SIZE* N_BLOCKS];
@@ -1321,8 +1334,9 @@ extern bool NR_long_tone_enable;
 //extern bool omitOutputFlag;
 extern bool timeflag;
 extern bool volumeChangeFlag;
+extern bool agcPerSampleGain;  // AGC gain law for every sample, set from AGC_GAIN_REFERENCE
 
-//extern char *bigMorseCodeTree;
+extern char *bigMorseCodeTree;
 extern char decodeBuffer[];
 extern const char DEGREE_SYMBOL[];
 extern char keyboardBuffer[];
@@ -1336,12 +1350,9 @@ extern char theversion[];
 extern const char *topMenus[];
 extern const char *zoomOptions[];
 
-extern byte currentDashJump;
-extern byte currentDecoderIndex;
 
 extern int8_t auto_IQ_correction;
 extern uint8_t IQ_RecCalFlag;  //AFP 04-17-22
-extern int8_t first_block;
 extern int8_t Menu2;
 extern int8_t menuStatus;  // 0 = no primary or secondary menu, 1 = primary, 2 = secondary
 extern int8_t mesz;
@@ -1499,7 +1510,6 @@ extern int buttonRead;
 extern int calibrateFlag;
 extern int chipSelect;
 extern int countryIndex;
-extern int dahLength;
 extern int dcfCount;
 extern int dcfLevel;
 extern int dcfSilenceTimer;
@@ -1524,8 +1534,6 @@ extern int freqIncrement;
 extern int FLoCutOld;
 extern int FHiCutOld;
 extern int (*functionPtr[])();
-extern int gapAtom;  //Space between atoms
-extern int gapChar;  // Space between characters
 extern int hang_counter;
 extern int helpmin;
 extern int helphour;
@@ -1592,6 +1600,10 @@ extern int zoomIndex;
 
 extern int updateDisplayFlag;
 extern int updateDisplayCounter;
+extern uint32_t dspBlocksProcessed;
+extern uint32_t dspDeadlineMisses;
+extern uint32_t dspOverruns;
+extern uint32_t dspMaxQueued;
 
 extern const int DEC2STATESIZE;
 extern const int INT1_STATE_SIZE;
@@ -1628,8 +1640,9 @@ extern const uint32_t NR_add_counter;
 
 extern uint32_t BUF_N_DF;
 extern uint32_t FFT_length;
+extern uint32_t convFFTLength;
+extern uint32_t convNewSamples;
 //extern const uint32_t FFT_L ;
-extern int32_t gapHistogram[];
 extern uint32_t in_index;
 extern uint32_t IQ_counter;
 extern uint32_t MDR;
@@ -1653,7 +1666,7 @@ extern unsigned long ditLength;
 extern unsigned long transmitDitLength;  // JJP 8/19/23
 extern unsigned long transmitDitUnshapedBlocks;
 extern unsigned long transmitDahUnshapedBlocks;
-extern long TxRxFreq;  // = centerFreq+NCOFreq  NCOFreq from FreqShift2()
+extern long TxRxFreq;  // = centerFreq+NCOFreq  NCOFreq from FreqShiftMixer()
 extern long TxRxFreqOld;
 extern long TxRxFreqDE;
 extern long recClockFreq;  //  = TxRxFreq+IFFreq  IFFreq from FreqShift1()=48KHz
@@ -1674,15 +1687,11 @@ extern long lastFrequencies[][2];
 extern long notchCenterBin;
 extern long int n_clear;
 extern long startTime;
-extern long signalElapsedTime;
 extern long spaceSpan;
-extern long signalStart;
-extern long signalEnd;  // Start-end of dit or dah
 extern long spaceStart;
 extern long spaceEnd;
 extern long spaceElapsedTime;
 
-extern uint32_t gapLength;
 extern long gapEnd, gapStart;  // Time for noise measures
 extern long ditTime, dahTime;  // Assume 15wpm to start
 
@@ -1694,7 +1703,6 @@ enum states { state0,
               state4,
               state5,
               state6 };
-extern states decodeStates;
 
 extern ulong samp_ptr;
 extern unsigned long currentFreqs[];
@@ -1730,6 +1738,14 @@ extern float32_t ai, bi, aq, bq;
 extern float32_t ai_ps, bi_ps, aq_ps, bq_ps;
 extern float32_t pll_fmax;
 
+// Written by AMDecodeSAM() once per block and read by ShowSAMStatus() at the display rate.  A 32 bit store is
+// atomic, so no lock is needed.
+struct samStatus_t {
+  volatile float32_t carrierOffset;  // Smoothed carrier offset, Hz
+  volatile uint32_t updates;         // Counts blocks, so the display can tell if SAM is running
+};
+extern struct samStatus_t samStatus;
+
 extern float32_t ANR_d[];
 extern float32_t ANR_den_mult;
 extern float32_t ANR_gamma;
@@ -1800,7 +1816,7 @@ extern float32_t /*DMAMEM*/ FIR_int2_coeffs[];
 extern float32_t /*DMAMEM*/ FIR_dec1_Q_state[];
 extern float32_t /*DMAMEM*/ FIR_dec1_coeffs[];
 extern float32_t /*DMAMEM*/ FIR_dec2_coeffs[];
-extern float32_t /*DMAMEM*/ FIR_filter_mask[];
+extern float32_t *FIR_filter_mask;  // Active slot of the filter mask cache
 extern float32_t /*DMAMEM*/ FIR_int1_I_state[];
 extern float32_t /*DMAMEM*/ FIR_int1_Q_state[];
 extern float32_t /*DMAMEM*/ FIR_int2_I_state[];
@@ -1868,8 +1884,7 @@ extern float32_t K_est;
 extern float32_t K_est_old;
 extern float32_t K_est_mult;
 extern float32_t last_dc_level;
-extern float32_t /*DMAMEM*/ last_sample_buffer_L[];
-extern float32_t /*DMAMEM*/ last_sample_buffer_R[];
+extern float32_t /*DMAMEM*/ convHistory[];
 extern float32_t L_BufferOffset[];
 //extern float32_t LPFcoeff;
 extern float32_t LMS_errsig1[];
@@ -1923,6 +1938,7 @@ extern float32_t NR_G_bin_p_1;
 extern float32_t NR_T;
 extern float32_t NR_output_audio_buffer[];
 extern float32_t NR_last_iFFT_result[];
+extern const float32_t sqrtHann[];
 extern float32_t NR_last_sample_buffer_L[];
 extern float32_t NR_last_sample_buffer_R[];
 extern float32_t NR_X[][3];
@@ -2021,13 +2037,13 @@ extern const float32_t nuttallWindow256[];
 
 extern float32_t FFT_buffer[] __attribute__((aligned(4)));
 
-extern float32_t float_buffer_L_3[];
-extern float32_t float_buffer_R_3[];
 
 extern const float32_t atanTable[];
-extern const float32_t DF1;           // decimation factor
+extern const float32_t DF1_MAX;       // decimation factor at 192K
+extern float32_t DF1;                 // decimation factor, set by SetReceiveSampleRate()
 extern const float32_t DF2;           // decimation factor
-extern const float32_t DF;            // decimation factor
+extern float32_t DF;                  // decimation factor
+extern float32_t decimatedRate;       // receive DSP sample rate after decimation
 extern const float32_t n_att;         // desired stopband attenuation
 extern const float32_t n_desired_BW;  // desired max BW of the filters
 extern const float32_t n_fpass1;
@@ -2040,16 +2056,187 @@ extern double elapsed_micros_idx_t;
 extern double elapsed_micros_mean;
 extern double elapsed_micros_sum;
 
+//======================================== DSP stage timing ============================================================
+// Enabled by DSP_TIMING in DebugConfiguration.h.  Each stage of ProcessIQData() is timed with the Cortex-M7 cycle
+// counter and a min/mean/max summary is printed to the Serial port every DSP_TIMING_REPORT_BLOCKS blocks.
+#define DSP_TIMING_TOTAL 0        // Whole ProcessIQData() block
+#define DSP_TIMING_FRONT_END 1    // Queue read, RF gain, DC filter, IQ correction
+#define DSP_TIMING_FREQ_SHIFT 2   // Fs/4 and NCO frequency translation
+#define DSP_TIMING_DECIMATE 3     // 192K to 24K decimation
+#define DSP_TIMING_CONVOLVE 4     // Overlap-save FFT filter
+#define DSP_TIMING_AGC 5          // AGC
+#define DSP_TIMING_DEMOD 6        // Demodulation and receive EQ
+#define DSP_TIMING_NR 7           // Noise reduction, notch, and noise blanker
+#define DSP_TIMING_CW 8           // CW decoder and CW audio filters
+#define DSP_TIMING_OUTPUT 9       // Interpolation, volume, and queue write
+#define DSP_TIMING_SPECTRUM 10    // Zoom FFT and 1x spectrum FFT
+#define DSP_TIMING_SKIM 11        // CW skimmer channelizer and decoders
+#define DSP_TIMING_RTTY 12        // RTTY decoder
+#define DSP_TIMING_STAGES 13
+#define DSP_TIMING_REPORT_BLOCKS 94  // About one second of 2048 sample blocks at 192K
+#define FREQ_SHIFT_GAIN 1.0721       // 1.1 x sqrt(0.95), the level the original oscillator settled at
+
+struct dspTiming_t {
+  uint32_t start;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t sumCycles;
+  uint32_t count;
+};
+extern struct dspTiming_t dspTiming[];
+extern uint32_t dspTimingBlocks;
+
+#ifdef DSP_TIMING
+#define DSP_TIMING_START(stage) (dspTiming[stage].start = ARM_DWT_CYCCNT)
+#define DSP_TIMING_STOP(stage) DSPTimingStop(stage)
+#else
+#define DSP_TIMING_START(stage)
+#define DSP_TIMING_STOP(stage)
+#endif
+
+//======================================== Receive decimation ==========================================================
+// The receive front end runs at SR[SampleRate].rate, 192K, 96K, or 48K, chosen with SetReceiveSampleRate().  DF1 takes
+// it to 48K and DF2 to DECIMATED_RATE, so everything after decimation works on 256 samples at decimatedRate.
+#define DECIMATED_RATE 24000      // Receive filter, demodulator, and audio sample rate for every front end rate
+// Polyphase decimators for the front end rate to 24K receive path.  Designs are cached per DECIMATE_BUCKET_HZ of filter
+// bandwidth, so a bandwidth change only swaps coefficient pointers.  DECIMATE_REFERENCE in DebugConfiguration.h
+// selects the original arm_fir_decimate_f32() stages instead.
+#define DECIMATE_BUCKET_HZ 500    // Width of one bandwidth bucket
+#define DECIMATE_BUCKETS 20       // Covers the 10 kHz limit in SetDecIntFilters()
+#define DECIMATE_MAX_TAPS 48      // Must be >= n_dec1_taps and n_dec2_taps
+// The audio interpolators use the same buckets, and DECIMATE_REFERENCE designs them for the exact bandwidth too.  Their
+// designs depend on the front end rate, so SetInterpolatorBandwidth() starts again when the rate changes.
+#define INTERPOLATE1_TAPS 48      // DECIMATED_RATE to 48K
+#define INTERPOLATE2_TAPS 32      // 48K to the front end rate
+
+struct polyphaseDecimator_t {
+  uint16_t numTaps;
+  uint16_t factor;              // Decimation factor M
+  uint32_t blockSize;           // Input samples per call, a multiple of factor
+  const float32_t *coeffs;      // Cached design for the current bucket
+  float32_t *stateI;            // numTaps - 1 + blockSize samples each
+  float32_t *stateQ;
+};
+extern struct polyphaseDecimator_t decimator1;
+extern struct polyphaseDecimator_t decimator2;
+
+//======================================== Equalizer filter banks ======================================================
+// The 14 band pass cascades of an equalizer, with the band levels folded in and the outputs summed.  Coefficients and
+// state are stored with the band innermost, so EQBankRun() works one stage of every band in a single loop.
+struct eqBank_t {
+  float32_t coeffs[IIR_NUMSTAGES][5][EQUALIZER_CELL_COUNT];  // b0, b1, b2, a1, a2 of each stage and band
+  float32_t state[IIR_NUMSTAGES][2][EQUALIZER_CELL_COUNT];   // Direct form II transposed
+  int bands;                                                 // Bands with a non-zero level, packed at the front
+};
+extern struct eqBank_t recEQBank;
+extern struct eqBank_t xmtEQBank;
+
+//======================================== Filter mask cache ===========================================================
+// FFT of the complex FIR filter for the overlap-save convolution, cached by mode and filter edges so that turning the
+// filter encoder back and forth does not recompute CalcCplxFIRCoeffs() and the mask FFT.  A new mask is built by
+// FilterMaskBuild() when the receive scheduler is idle, in a slot the convolution is not using, and swapped in at the
+// start of the next block.  The old mask stays in use until then.
+#define FILTER_MASK_CACHE_SIZE 3  // Slots of FFT_LENGTH_MAX * 2 floats.  The active slot is never evicted.
+#define RECEIVE_EQ_FULL_FFT 1024  // Smallest filter FFT with enough taps for the 200 to 400 Hz receive EQ bands in the mask
+
+struct filterMaskEntry_t {
+  bool valid;
+  int mode;
+  int FLoCut;
+  int FHiCut;
+  uint32_t fftLength;
+  uint32_t eqGeneration;  // receiveEQGeneration folded into the mask, 0 for none
+  uint32_t lastUsed;  // filterMaskUseCount when last selected
+};
+extern float32_t filterMaskCache[][FFT_LENGTH_MAX * 2];
+extern struct filterMaskEntry_t filterMaskEntry[];
+extern float32_t *filterMaskPending;
+extern uint32_t filterMaskHits, filterMaskMisses;
+extern uint32_t nbBlocks, nbBlocksAnalysed, nbBlocksBlanked, nbImpulses;
+extern uint64_t nbCycles;
+extern uint32_t receiveEQGeneration;
+
+struct spectrumWindowType_t {
+  const char *name;
+  float32_t a[5];  // Cosine sum coefficients
+};
+extern const struct spectrumWindowType_t spectrumWindowTypes[];
+extern float32_t spectrumWindow[];
+extern const char *spectrumAverageNames[];
+extern uint32_t spectrumFFTLength;
+extern uint32_t spectrumSweeps;
+extern bool spectrumFresh;
+
+// Morse decoder element histogram.  The count in a cell is weight[] * scale, so decaying the histogram only
+// changes scale.  tree[0][] and tree[1][] are max trees over the clusters, the weights summed over each cell +-1
+// and +-3: node n covers nodes 2n and 2n + 1, and the leaves, HISTOGRAM_ELEMENTS + i for cell i, are not stored.
+struct cwHistogram_t {
+  float32_t scale;
+  float32_t weight[HISTOGRAM_ELEMENTS];
+  int16_t tree[2][HISTOGRAM_ELEMENTS];  // Index of the largest cluster below each node, -1 if none
+};
+
+// Morse decoder state, see DoCWDecoding().  The main decoder, cwDecoder, and each skimmer channel have their own.
+// Times are decoder time, ms.
+struct cwDecoder_t {
+  states decodeState;
+  uint32_t signalStart;                       // Last key down
+  uint32_t signalEnd;                         // End of the last element
+  uint32_t gapLength;                         // Last gap between elements
+  long signalElapsedTime;                     // Last element length
+  int32_t ditLength, dahLength;               // Signal histogram estimates
+  int32_t gapAtom, gapChar;                   // Gap histogram estimates
+  long aveDitLength, aveDahLength;            // Averaged from consecutive dit and dah pairs
+  float thresholdGeometricMean;               // Dit/dah decision length
+  float thresholdArithmeticMean;
+  long valRef1, valRef2, gapRef1;             // The element pair and gap DoSignalHistogram() compares
+  int valFlag;
+  uint32_t signalStartOld;
+  int decoderIndex;                           // Position in bigMorseCodeTree
+  int dashJump;
+  bool charProcessFlag;                       // A character is being decoded
+  bool blankFlag;                             // A blank has already been printed
+  struct cwHistogram_t signalHistogram;
+  struct cwHistogram_t gapHistogram;
+};
+extern struct cwDecoder_t cwDecoder;
+
+struct cwSkimChannel_t {
+  int bin;                     // Channelizer bin, -1 when the channel is free
+  bool key;                    // Key down
+  uint32_t lastActivity;       // Skimmer time at the last decoded character, ms
+  struct cwDecoder_t decoder;  // Decoder time is skimmer time
+  char text[SKIM_TEXT_CHARS + 1];
+  int col;
+  char word[SKIM_WORD_CHARS + 1];  // The word being decoded, for Serial
+  int wordCol;
+  bool changed;                // Text or frequency changed since the row was drawn
+};
+extern struct cwSkimChannel_t cwSkimChannels[];
+extern uint64_t cwSampleClock;
+extern uint32_t skimHops;
+extern uint64_t skimCycles;
+extern uint32_t rttyBlocks;
+extern uint64_t rttyCycles;
+extern uint32_t rttyMaxCycles;
+extern uint32_t rttyOverBudget;
+
 //======================================== Function prototypes =========================================================
 
 void AGC();
+void AGCApplyGain(float32_t *buffer);
 void AGCLoadValues();  // AGC fix.  G0ORX September 5, 2023
+void AGCPeakReset();
+void AGCPeakUpdate();
 int AGCOptions();
 void AGCPrep();
 float32_t AlphaBetaMag(float32_t inphase, float32_t quadrature);
 void AltNoiseBlanking(float *insamp, int Nsam, float *E);
 void AMDemodAM();
+void ApplyConfiguration();
 void AMDecodeSAM();  // AFP 11-03-22
+void SAMLoadValues();
+void ShowSAMStatus();
 void AssignEEPROMObjectToVariable();
 
 int BandOptions();
@@ -2088,7 +2275,16 @@ uint16_t Color565(uint8_t r, uint8_t g, uint8_t b);
 void ControlFilterF();
 void CopyEEPROM();
 int CreateMapList(char ptrMaps[10][50], int *count);
+float32_t CWDetect();
+uint32_t CWDecoderTime();
+void CWDetectPrep();
 int CWOptions();
+void CWSkimmer();
+void CWSkimmerDisplay();
+void CWSkimmerReset();
+void RTTYDecoder(float32_t *audio);
+int RTTYOptions();
+void RTTYReset();
 
 #define CW_SHAPING_NONE 0
 #define CW_SHAPING_RISE 1
@@ -2102,18 +2298,31 @@ void DisplayClock();
 void DisplaydbM();
 void DisplayIncrementField();
 void Dit();
-void DoCWDecoding(int audioValue);
+char DoCWDecoding(struct cwDecoder_t *dec, int audioValue, uint32_t time);
 void DoCWReceiveProcessing();  //AFP 09-19-22
 void DoExciterEQ();
 void DoReceiveEQ();
-void DoSignalHistogram(long val);
-void DoGapHistogram(long val);
+void EQBankLoad(struct eqBank_t *bank, arm_biquad_cascade_df2T_instance_f32 *const filters[], const int levels[]);
+void EQBankRun(struct eqBank_t *bank, const float32_t *in, float32_t *out, uint32_t blockSize);
+void XmitEQLoadValues();
+void ApplyReceiveEQ(float32_t *mask);
+float32_t ReceiveEQGain(float32_t omega);
+void DoSignalHistogram(struct cwDecoder_t *dec, long val, uint32_t time);
+void DoGapHistogram(struct cwDecoder_t *dec, long gapLen);
+void CWHistogramClear(struct cwHistogram_t *hist);
+void CWHistogramAdd(struct cwHistogram_t *hist, int32_t index);
+void CWHistogramDecay(struct cwHistogram_t *hist, float32_t factor);
+float32_t CWHistogramValue(struct cwHistogram_t *hist, int32_t index);
+void CWHistogramClusterMax(struct cwHistogram_t *hist, int32_t base, int32_t elements, float32_t *maxCount, int32_t *maxIndex, int32_t spread);
 int DoSplitVFO();
 void DoPaddleFlip();
 void DoXmitCalibrate(int toneFreq);
 void DoReceiveCalibrate();
 void DrawActiveLetter(int row, int horizontalSpacer, int whichLetterIndex, int keyWidth, int keyHeight);
 void DrawBandWidthIndicatorBar();  // AFP 03-27-22 Layers
+void DSPTimingInit();
+void DSPTimingReport();
+void DSPTimingStop(int stage);
 void DrawFrequencyBarValue();
 void DrawInfoWindowFrame();
 void DrawKeyboard();
@@ -2144,6 +2353,8 @@ void EraseSpectrumWindow();
 void ExecuteButtonPress(int val);
 
 void FilterBandwidth();
+void FilterMaskBuild();
+void FilterMaskSwap();
 void FilterOverlay();
 void FilterSetSSB();
 int FindCountry(char *prefix);
@@ -2151,7 +2362,7 @@ int FirstTimeSDCard();
 void FormatFrequency(long f, char *b);
 int FrequencyOptions();
 void FreqShift1();
-void FreqShift2();
+void FreqShiftMixer(bool includeFs4);
 float goertzel_mag(int numSamples, int TARGET_FREQUENCY, int SAMPLING_RATE, float *data);
 int GetEncoderValue(int minValue, int maxValue, int startValue, int increment, char prompt[]);
 float GetEncoderValueLive(float minValue, float maxValue, float startValue, float increment, char prompt[]);  //AFP 10-22-22
@@ -2163,6 +2374,7 @@ int InitializeSDCard();
 void InitializeDataArrays();
 void InitFilterMask();
 void InitLMSNoiseReduction();
+void InitPolyphaseDecimators();
 void initTempMon(uint16_t freq, uint32_t lowAlarmTemp, uint32_t highAlarmTemp, uint32_t panicAlarmTemp);
 void IQPhaseCorrection(float32_t *I_buffer, float32_t *Q_buffer, float32_t factor, uint32_t blocksize);
 float32_t Izero(float32_t x);
@@ -2196,6 +2408,7 @@ float PlotCalSpectrum(int x1, int cal_bins[2], int capture_bins);
 void printFile(const char *filename);
 void EnableButtonInterrupts();
 int ProcessButtonPress(int valPin);
+void PolyphaseDecimate(struct polyphaseDecimator_t *S, float32_t *I_buffer, float32_t *Q_buffer);
 void ProcessEqualizerChoices(int EQType, char *title);
 void ProcessIQData();
 void ProcessIQData2(float toneFreq);
@@ -2203,8 +2416,12 @@ void ProcessIQData2(float toneFreq);
 uint16_t read16(File &f);
 uint32_t read32(File &f);
 int ReadSelectedPushButton();
+void ReceiveFrontEnd(float32_t *I_buffer, float32_t *Q_buffer, uint32_t blocksize);
+void ReceiveFrontEndReference(float32_t *I_buffer, float32_t *Q_buffer, uint32_t blocksize);
 void RedrawDisplayScreen();
 void ResetFlipFlops();
+int CWDecoderWPM(struct cwDecoder_t *dec);
+void CWDecoderReset(struct cwDecoder_t *dec, uint32_t time);
 void ResetHistograms();
 void ResetTuning();  // AFP 10-11-22
 int RFOptions();
@@ -2233,6 +2450,13 @@ extern "C" uint32_t set_arm_clock(uint32_t frequency);
 void SetBand();
 void SetBandRelay(int state);
 void SetDecIntFilters();
+void SetDecimatorBandwidth(int bandwidth);
+void SetInterpolatorBandwidth(int bandwidth);
+void SetConvolutionSize(uint32_t length);
+void SetReceiveSampleRate(uint8_t rate);
+void SetSpectrumFFTSize(uint32_t length);
+void SetSpectrumWindow(int type);
+void ServiceReceiveDSP();
 void SetDitLength(int wpm);
 void SetFavoriteFrequency();
 void SetFreq();
@@ -2284,6 +2508,11 @@ void BandInformation();
 float32_t sign(float32_t x);
 void SpectralNoiseReduction(void);
 void SpectralNoiseReductionInit();
+void SpectralNRLoadValues();
+void SpectrumAverage(float32_t *spec);
+void SpectrumAverageReset();
+void SpectrumBinning();
+bool SpectrumFFTDue();
 void Splash();
 int SubmenuSelect(const char *options[], int numberOfChoices, int defaultStart);
 
@@ -2299,6 +2528,7 @@ void UpdateDecoderField();
 //void UpdateEEPROMSyncIndicator(int);
 void UpdateEEPROMVersionNumber();
 void UpdateIncrementField();
+float32_t UpdateNCO();
 void UpdateNoiseField();
 void UpdateNotchField();
 void UpdateNRField();
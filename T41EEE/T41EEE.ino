@@ -144,13 +144,15 @@ struct band bands[NUMBER_OF_BANDS] = {  //AFP Changed 1-30-21 // G0ORX Changed A
 const char *topMenus[] = { "CW Options", "RF Set", "VFO Select",
                            "EEPROM", "AGC", "Spectrum Options",
                            "Noise Floor", "Mic Gain", "Mic Comp",
-                           "EQ Rec Set", "EQ Xmt Set", "Calibrate", "Bearing" };
+                           "EQ Rec Set", "EQ Xmt Set", "Calibrate", "Bearing",
+                           "RTTY" };
 
 // Pointers to functions which execute the menu options.  Do these functions used the returned integer???
 int (*functionPtr[])() = { &CWOptions, &RFOptions, &VFOSelect,
                            &EEPROMOptions, &AGCOptions, &SpectrumOptions,
                            &ButtonSetNoiseFloor, &MicGainSet, &MicOptions,
-                           &EqualizerRecOptions, &EqualizerXmtOptions, &CalibrateOptions, &BearingMaps };
+                           &EqualizerRecOptions, &EqualizerXmtOptions, &CalibrateOptions, &BearingMaps,
+                           &RTTYOptions };
 const char *labels[] = { "Select", "Menu Up", "Band Up",
                          "Zoom", "Menu Dn", "Band Dn",
                          "Filter", "DeMod", "Mode",
@@ -158,7 +160,9 @@ const char *labels[] = { "Select", "Menu Up", "Band Up",
                          "Fine Tune", "Decoder", "Tune Increment",
                          "Reset Tuning", "Frequ Entry", "User 2" };
 
-uint32_t FFT_length = FFT_LENGTH;
+uint32_t FFT_length = FFT_LENGTH;  // Sets the 256 sample audio block layout, not the convolution size
+uint32_t convFFTLength = FFT_LENGTH;  // Convolution filter FFT size, set by SetConvolutionSize()
+uint32_t convNewSamples = FFT_LENGTH / 2;  // New samples taken by each convolution FFT
 
 extern "C" uint32_t set_arm_clock(uint32_t frequency);
 
@@ -285,21 +289,6 @@ float32_t mic_audio_buffer[256];
 //float32_t recEQ_Level[14];
 //float32_t recEQ_LevelScale[14];
 //Setup for EQ filters
-float32_t rec_EQ1_float_buffer_L[256];
-float32_t rec_EQ2_float_buffer_L[256];
-float32_t rec_EQ3_float_buffer_L[256];
-float32_t rec_EQ4_float_buffer_L[256];
-float32_t rec_EQ5_float_buffer_L[256];
-float32_t rec_EQ6_float_buffer_L[256];
-float32_t rec_EQ7_float_buffer_L[256];
-float32_t rec_EQ8_float_buffer_L[256];
-float32_t rec_EQ9_float_buffer_L[256];
-float32_t rec_EQ10_float_buffer_L[256];
-float32_t rec_EQ11_float_buffer_L[256];
-float32_t rec_EQ12_float_buffer_L[256];
-float32_t rec_EQ13_float_buffer_L[256];
-float32_t rec_EQ14_float_buffer_L[256];
-
 float32_t rec_EQ_Band1_state[IIR_NUMSTAGES * 2] = { 0, 0, 0, 0, 0, 0, 0, 0 };  //declare and zero biquad state variables
 float32_t rec_EQ_Band2_state[IIR_NUMSTAGES * 2] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 float32_t rec_EQ_Band3_state[IIR_NUMSTAGES * 2] = { 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -334,21 +323,6 @@ arm_biquad_cascade_df2T_instance_f32 S14_Rec = { IIR_NUMSTAGES, rec_EQ_Band14_st
 // ===============================  AFP 10-02-22 ================
 
 //EQBuffers
-float32_t DMAMEM xmt_EQ1_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ2_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ3_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ4_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ5_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ6_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ7_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ8_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ9_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ10_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ11_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ12_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ13_float_buffer_L[256];
-float32_t DMAMEM xmt_EQ14_float_buffer_L[256];
-
 float32_t xmt_EQ_Band1_state[IIR_NUMSTAGES * 2] = { 0, 0, 0, 0, 0, 0, 0, 0 };  //declare and zero biquad state variables
 float32_t xmt_EQ_Band2_state[IIR_NUMSTAGES * 2] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 float32_t xmt_EQ_Band3_state[IIR_NUMSTAGES * 2] = { 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -534,13 +508,6 @@ long NCOFreq;
 
 float32_t NCO_INC;
 
-double OSC_COS;
-double OSC_SIN;
-double Osc_Vect_Q = 1.0;
-double Osc_Vect_I = 0.0;
-double Osc_Gain = 0.0;
-double Osc_Q = 0.0;
-double Osc_I = 0.0;
 float32_t i_temp = 0.0;
 float32_t q_temp = 0.0;
 
@@ -683,11 +650,9 @@ const char DEGREE_SYMBOL[] = { 0xB0, '\0' };
 //char EEPROMData.myCall[10];
 //char EEPROMData.EEPROMData.equalizerRec[10];
 const char *tune_text = "Fast Tune";
-const char *zoomOptions[] = { "1x ", "2x ", "4x ", "8x ", "16x" };
+const char *zoomOptions[] = { "1x ", "2x ", "4x ", "8x ", "16x", "32x", "64x", "128x", "256x" };
 //char versionSettings[10];
 
-byte currentDashJump = DECODER_BUFFER_SIZE;
-byte currentDecoderIndex = 0;
 
 //int8_t EEPROMData.AGCMode = 2;
 int8_t auto_IQ_correction;
@@ -700,7 +665,6 @@ int fLoCutOld;
 int fHiCutOld;
 int filterWidth = (int)((bands[EEPROMData.currentBand].FHiCut - bands[EEPROMData.currentBand].FLoCut) / 1000.0 * pixel_per_khz);
 int h = SPECTRUM_HEIGHT + 3;
-int8_t first_block = 1;
 
 int8_t Menu2 = MENU_F_LO_CUT;
 int8_t mesz = -1;
@@ -828,14 +792,9 @@ int endGapFlag = 0;
 int selectedMapIndex;
 int topDitIndex;
 int topDitIndexOld;
-int topGapIndex;
-int topGapIndexOld;
-
-int32_t gapHistogram[HISTOGRAM_ELEMENTS];  // Not used.  KF5N November 12, 2023
-int32_t signalHistogram[HISTOGRAM_ELEMENTS];
+struct cwDecoder_t DMAMEM cwDecoder;  // The main Morse decoder, CWDecoderReset() before use
 
 // This enum is for an experimental Morse decoder change.
-enum states decodeStates;
 
 uint32_t histMaxIndexDitOld = 80;  // Defaults for 15wpm
 uint32_t histMaxIndexDahOld = 200;
@@ -853,23 +812,14 @@ int charGapLength2;
 //int xmitEQFlag;
 int centerTuneFlag = 0;
 int x1AdjMax = 0;  //AFP 2-6-23
-unsigned long cwTimer;
+uint32_t cwTimer;
 long signalTime;
 unsigned long ditTimerOn;
 long DahTimer;
 long cwTime0;
 long cwTime5;
 long cwTime6;
-long valRef1;
-long valRef2;
-long gapRef1;
-int valFlag = 0;
-long signalStartOld = 0;
 int valCounter;
-long aveDitLength = 80;
-long aveDahLength = 200;
-float thresholdGeometricMean = 140.0;  // This changes as decoder runs
-float thresholdArithmeticMean;
 float aveAtomGapLength = 40;
 float thresholdGapGeometricMean;
 float thresholdGapArithmeticMean;
@@ -890,21 +840,23 @@ int16_t y_old, y_new, y1_new, y1_old, y_old2;  //A
 int16_t y1_old_minus = 0;
 int16_t y1_new_minus = 0;
 
-const float32_t DF1 = 4.0;             // decimation factor
+const float32_t DF1_MAX = 4.0;         // decimation factor at 192K, sizes the buffers and the decimation filters
 const float32_t DF2 = 2.0;             // decimation factor
-const float32_t DF = DF1 * DF2;        // decimation factor
+float32_t DF1 = DF1_MAX;               // decimation factor, set by SetReceiveSampleRate()
+float32_t DF = DF1 * DF2;              // decimation factor
+float32_t decimatedRate = DECIMATED_RATE;  // SR[SampleRate].rate / DF, the receive DSP sample rate
 const float32_t n_samplerate = 176.0;  // samplerate before decimation
 
-const uint32_t N_B = FFT_LENGTH / 2 / BUFFER_SIZE * (uint32_t)DF;
-const uint32_t N_DEC_B = N_B / (uint32_t)DF;
+const uint32_t N_B = FFT_LENGTH / 2 / BUFFER_SIZE * (uint32_t)(DF1_MAX * DF2);
+const uint32_t N_DEC_B = N_B / (uint32_t)(DF1_MAX * DF2);
 const uint32_t NR_add_counter = 128;
 
 const float32_t n_att = 90.0;        // need here for later def's
 const float32_t n_desired_BW = 9.0;  // desired max BW of the filters
 const float32_t n_fpass1 = n_desired_BW / n_samplerate;
-const float32_t n_fpass2 = n_desired_BW / (n_samplerate / DF1);
-const float32_t n_fstop1 = ((n_samplerate / DF1) - n_desired_BW) / n_samplerate;
-const float32_t n_fstop2 = ((n_samplerate / (DF1 * DF2)) - n_desired_BW) / (n_samplerate / DF1);
+const float32_t n_fpass2 = n_desired_BW / (n_samplerate / DF1_MAX);
+const float32_t n_fstop1 = ((n_samplerate / DF1_MAX) - n_desired_BW) / n_samplerate;
+const float32_t n_fstop2 = ((n_samplerate / (DF1_MAX * DF2)) - n_desired_BW) / (n_samplerate / DF1_MAX);
 
 const uint32_t IIR_biquad_Zoom_FFT_N_stages = 4;
 const uint32_t N_stages_biquad_lowpass1 = 1;
@@ -959,7 +911,6 @@ int countryIndex = -1;
 //int currentBandA = BAND_40M;
 //int currentBandB = BAND_40M;
 //int EEPROMData.CWFilterIndex = 5;  //AFP10-18-22
-int dahLength;
 int dcfCount;
 int dcfLevel;
 int dcfSilenceTimer;
@@ -979,8 +930,6 @@ int FLoCutOld;
 int FHiCutOld;
 int freqCalibration = -1000;
 //int EEPROMData.freqIncrement = DEFAULTEEPROMData.freqIncrement;
-int gapAtom;  // Space between atoms
-int gapChar;  // Space between characters
 int hang_counter = 0;
 int helpmin;
 int helphour;
@@ -1049,9 +998,9 @@ int updateDisplayCounter = 0;
 int xrState;  // Is the T41 in xmit or rec state? 1 = rec, 0 = xmt
 
 const int BW_indicator_y = SPECTRUM_TOP_Y + SPECTRUM_HEIGHT + 2;
-const int DEC2STATESIZE = n_dec2_taps + (BUFFER_SIZE * N_B / (uint32_t)DF1) - 1;
-const int INT1_STATE_SIZE = 24 + BUFFER_SIZE * N_B / (uint32_t)DF - 1;
-const int INT2_STATE_SIZE = 8 + BUFFER_SIZE * N_B / (uint32_t)DF1 - 1;
+const int DEC2STATESIZE = n_dec2_taps + (BUFFER_SIZE * N_B / (uint32_t)DF1_MAX) - 1;
+const int INT1_STATE_SIZE = 24 + BUFFER_SIZE * N_B / (uint32_t)(DF1_MAX * DF2) - 1;
+const int INT2_STATE_SIZE = 16 + BUFFER_SIZE * N_B / (uint32_t)DF1_MAX - 1;  // 32 taps / DF1, largest at 96K
 const int myInput = AUDIO_INPUT_LINEIN;
 const int pos_x_smeter = 11;
 const int waterfallBottom = spectrum_y + spectrum_height + 4;
@@ -1077,7 +1026,7 @@ int32_t O_integrateCount19;
 //int32_t EEPROMData.spectrum_zoom = SPECTRUM_ZOOM_2;
 
 uint32_t N_BLOCKS = N_B;
-uint32_t BUF_N_DF = BUFFER_SIZE * N_BLOCKS / (uint32_t)DF;
+uint32_t BUF_N_DF = BUFFER_SIZE * N_B / (uint32_t)(DF1_MAX * DF2);
 uint32_t highAlarmTemp;
 uint32_t in_index;
 uint32_t lowAlarmTemp;
@@ -1116,17 +1065,13 @@ long notchPosOld;
 long notchFreq = 1000;
 long notchCenterBin;
 long recClockFreq;  //  = TxRxFreq+IFFreq  IFFreq from FreqShift1()=48KHz
-long signalElapsedTime;
 long spaceSpan;
-long signalStart;
-long signalEnd;  // Start-end of dit or dah
 long spaceStart;
 long spaceEnd;
 long spaceElapsedTime;
-long TxRxFreq;  // = EEPROMData.centerFreq+NCOFreq  NCOFreq from FreqShift2()
+long TxRxFreq;  // = EEPROMData.centerFreq+NCOFreq  NCOFreq from FreqShiftMixer()
 long TxRxFreqOld;
 long TxRxFreqDE;
-uint32_t gapLength;
 long gapEnd, gapStart;               // Time for noise measures
 long ditTime = 80L, dahTime = 240L;  // Assume 15wpm to start
 
@@ -1164,7 +1109,7 @@ float32_t abs_ring[RB_SIZE];
 float32_t abs_out_sample;
 float32_t ai, bi, aq, bq;
 float32_t ai_ps, bi_ps, aq_ps, bq_ps;
-float32_t ANR_d[ANR_DLINE_SIZE];
+float32_t ANR_d[2 * ANR_DLINE_SIZE];  // Xanr() keeps a mirrored copy in the top half
 float32_t ANR_den_mult = 6.25e-10;
 float32_t ANR_gamma = 0.1;
 float32_t ANR_lidx = 120.0;
@@ -1179,7 +1124,7 @@ float32_t attack_mult;
 float32_t audio;
 float32_t audiotmp = 0.0f;
 float32_t audiou;
-float32_t audioSpectBuffer[1024];  // This can't be DMAMEM.  It will break the S-Meter.  KF5N October 10, 2023
+float32_t audioSpectBuffer[1024 + 3];  // This can't be DMAMEM.  It will break the S-Meter.  KF5N October 10, 2023  [1024] and up are used by the audio plot.
 float32_t bass = 0.0;
 float32_t farnsworthValue;
 float32_t midbass = 0.0;
@@ -1190,7 +1135,7 @@ float32_t bin_BW = 1.0 / (DF * FFT_length) * SR[SampleRate].rate;
 float32_t bin = 2000.0 / bin_BW;
 float32_t biquad_lowpass1_state[N_stages_biquad_lowpass1 * 4];
 float32_t biquad_lowpass1_coeffs[5 * N_stages_biquad_lowpass1] = { 0, 0, 0, 0, 0 };
-float32_t DMAMEM buffer_spec_FFT[1024] __attribute__((aligned(4)));
+float32_t DMAMEM buffer_spec_FFT[2 * SPECTRUM_FFT_MAX] __attribute__((aligned(4)));
 float32_t coefficient_set[5] = { 0, 0, 0, 0, 0 };
 float32_t corr[2];
 float32_t Cos = 0.0;
@@ -1201,7 +1146,7 @@ float32_t dbm_old = -145.0;
 float32_t dbmhz = -145.0;
 float32_t decay_mult;
 float32_t display_offset;
-float32_t DMAMEM FFT_buffer[FFT_LENGTH * 2] __attribute__((aligned(4)));
+float32_t DMAMEM FFT_buffer[FFT_LENGTH_MAX * 2] __attribute__((aligned(4)));
 float32_t DMAMEM FFT_spec[1024];
 float32_t DMAMEM FFT_spec_old[1024];
 float32_t dsI;
@@ -1224,8 +1169,8 @@ float32_t DMAMEM Fir_Zoom_FFT_Decimate_I2_state[12 + BUFFER_SIZE * N_B - 1];
 float32_t DMAMEM Fir_Zoom_FFT_Decimate_Q2_state[12 + BUFFER_SIZE * N_B - 1];
 float32_t DMAMEM Fir_Zoom_FFT_Decimate2_coeffs[12];
 
-float32_t DMAMEM FIR_Coef_I[(FFT_LENGTH / 2) + 1];
-float32_t DMAMEM FIR_Coef_Q[(FFT_LENGTH / 2) + 1];
+float32_t DMAMEM FIR_Coef_I[(FFT_LENGTH_MAX / 2) + 1];
+float32_t DMAMEM FIR_Coef_Q[(FFT_LENGTH_MAX / 2) + 1];
 float32_t DMAMEM FIR_dec1_I_state[n_dec1_taps + (uint16_t)BUFFER_SIZE * (uint32_t)N_B - 1];
 float32_t DMAMEM FIR_dec2_I_state[DEC2STATESIZE];
 float32_t DMAMEM FIR_dec2_coeffs[n_dec2_taps];
@@ -1236,7 +1181,6 @@ float32_t DMAMEM FIR_int1_coeffs[48];
 float32_t DMAMEM FIR_int2_coeffs[32];
 float32_t DMAMEM FIR_dec1_Q_state[n_dec1_taps + (uint16_t)BUFFER_SIZE * (uint16_t)N_B - 1];
 float32_t DMAMEM FIR_dec1_coeffs[n_dec1_taps];
-float32_t DMAMEM FIR_filter_mask[FFT_LENGTH * 2] __attribute__((aligned(4)));
 float32_t DMAMEM FIR_int1_I_state[INT1_STATE_SIZE];
 float32_t DMAMEM FIR_int1_Q_state[INT1_STATE_SIZE];
 float32_t DMAMEM Fir_Zoom_FFT_Decimate_I_state[4 + BUFFER_SIZE * N_B - 1];
@@ -1246,9 +1190,6 @@ float32_t fixed_gain = 1.0;
 float32_t DMAMEM float_buffer_L[BUFFER_SIZE * N_B];
 float32_t DMAMEM float_buffer_R[BUFFER_SIZE * N_B];
 float32_t DMAMEM float_buffer_L2[BUFFER_SIZE * N_B];
-float32_t DMAMEM float_buffer_R2[BUFFER_SIZE * N_B];
-float32_t float_buffer_L_3[BUFFER_SIZE * N_B];
-float32_t float_buffer_R_3[BUFFER_SIZE * N_B];
 
 float32_t DMAMEM float_buffer_L_CW[256];       //AFP 09-01-22
 float32_t DMAMEM float_buffer_R_CW[256];       //AFP 09-01-22
@@ -1262,7 +1203,7 @@ float32_t hang_level;
 float32_t hangtime;
 float32_t hh1 = 0.0;
 float32_t hh2 = 0.0;
-float32_t DMAMEM iFFT_buffer[FFT_LENGTH * 2 + 1];
+float32_t DMAMEM iFFT_buffer[FFT_LENGTH_MAX * 2 + 1];
 float32_t I_old = 0.2;
 float32_t I_sum;
 float32_t IIR_biquad_Zoom_FFT_I_state[IIR_biquad_Zoom_FFT_N_stages * 4];
@@ -1275,8 +1216,7 @@ float32_t K_est = 1.0;
 float32_t K_est_old = 0.0;
 float32_t K_est_mult = 1.0 / K_est;
 float32_t last_dc_level = 0.0f;
-float32_t DMAMEM last_sample_buffer_L[BUFFER_SIZE * N_DEC_B];
-float32_t DMAMEM last_sample_buffer_R[BUFFER_SIZE * N_DEC_B];
+float32_t DMAMEM convHistory[FFT_LENGTH_MAX * 2];  // Overlap-save history, interleaved I and Q
 float32_t DMAMEM L_BufferOffset[BUFFER_SIZE * N_B];
 float32_t LMS_errsig1[256 + 10];
 float32_t LMS_NormCoeff_f32[MAX_LMS_TAPS + MAX_LMS_DELAY];
@@ -1664,45 +1604,83 @@ void InitializeDataArrays() {
   CLEAR_VAR(LMS_StateF32);             //memset(LMS_StateF32, 0, 1408);  // 96 + 256 * 4
   CLEAR_VAR(LMS_NormCoeff_f32);        //memset(LMS_NormCoeff_f32, 0, 1408);
   CLEAR_VAR(LMS_nr_delay);             //memset(LMS_nr_delay, 0, 2312);
-
-  CalcCplxFIRCoeffs(FIR_Coef_I, FIR_Coef_Q, m_NumTaps, (float32_t)bands[EEPROMData.currentBand].FLoCut, (float32_t)bands[EEPROMData.currentBand].FHiCut, (float)SR[SampleRate].rate / DF);
+  CWDecoderReset(&cwDecoder, CWDecoderTime());  // The decoder is DMAMEM, and the timing starts at 15 WPM
 
   /****************************************************************************************
-     init complex FFTs
+     init complex FFTs, and calculate the FFT of the FIR filter coefficients to produce the FIR filter mask
   ****************************************************************************************/
-  switch (FFT_length) {
-    case 2048:
-      S = &arm_cfft_sR_f32_len2048;
-      iS = &arm_cfft_sR_f32_len2048;
-      maskS = &arm_cfft_sR_f32_len2048;
-      break;
-    case 1024:
-      S = &arm_cfft_sR_f32_len1024;
-      iS = &arm_cfft_sR_f32_len1024;
-      maskS = &arm_cfft_sR_f32_len1024;
-      break;
-    case 512:
-      S = &arm_cfft_sR_f32_len512;
-      iS = &arm_cfft_sR_f32_len512;
-      maskS = &arm_cfft_sR_f32_len512;
-      break;
-  }
-
-  spec_FFT = &arm_cfft_sR_f32_len512;  //Changed specification to 512 instance
+  spec_FFT = &arm_cfft_sR_f32_len512;  //Changed specification to 512 instance, SetSpectrumFFTSize() sets the spectrum FFT size
   NR_FFT = &arm_cfft_sR_f32_len256;
   NR_iFFT = &arm_cfft_sR_f32_len256;
 
-  /****************************************************************************************
-     Calculate the FFT of the FIR filter coefficients once to produce the FIR filter mask
-  ****************************************************************************************/
+  ApplyConfiguration();  // Convolution size, sample rate, equalizers, and spectrum from EEPROMData
+
+  SpectralNoiseReductionInit();
+  InitLMSNoiseReduction();
+
+  temp_check_frequency = 0x03U;  //updates the temp value at a RTC/3 clock rate
+  //0xFFFF determines a 2 second sample rate period
+  highAlarmTemp = 85U;  //42 degrees C
+  lowAlarmTemp = 25U;
+  panicAlarmTemp = 90U;
+
+  initTempMon(temp_check_frequency, lowAlarmTemp, highAlarmTemp, panicAlarmTemp);
+  // this starts the measurements
+  TEMPMON_TEMPSENSE0 |= 0x2U;
+}
+
+
+/*****
+  Purpose: Bring the DSP into line with the settings in EEPROMData.  setup() calls this once the settings are read,
+           and it is called again whenever the whole configuration is replaced, by the defaults or from the SD
+           card, so nothing keeps running on the tables built for the old settings.
+
+  Parameter list:
+    void
+
+  Return value:
+    void
+*****/
+void ApplyConfiguration() {
+  SetConvolutionSize(EEPROMData.convFFTLength);   // Convolution CFFTs and filter length
+  SetReceiveSampleRate(EEPROMData.rxSampleRate);  // Decimation, interpolation, and zoom filters
+  SAMLoadValues();
+  receiveEQGeneration++;  // New receive EQ levels, so rebuild the filter mask
   InitFilterMask();
+  XmitEQLoadValues();
+  SetSpectrumWindow(EEPROMData.spectrumWindow);
+  SetSpectrumFFTSize(EEPROMData.spectrumFFTSize);  // For the current zoom
+}
 
-  /****************************************************************************************
-     Set sample rate
-  ****************************************************************************************/
-  SetI2SFreq(SR[SampleRate].rate);
-  // essential ?
+
+/*****
+  Purpose: Set the receive sample rate and everything in the receive chain that depends on it.  The first
+           decimation stage takes each rate down to 48K and the second to DECIMATED_RATE, so the block after
+           decimation is always 256 samples at 24K and the filter masks, demodulators, and audio processing do
+           not change.  Lower rates narrow the spectrum display and save processor time.  Only 192K, 96K, and 48K
+           divide down evenly; anything else falls back to 192K.
+
+  Parameter list:
+    uint8_t rate      SAMPLE_RATE_192K, SAMPLE_RATE_96K, or SAMPLE_RATE_48K
+
+  Return value:
+    void
+*****/
+void SetReceiveSampleRate(uint8_t rate) {
+  if (rate != SAMPLE_RATE_96K && rate != SAMPLE_RATE_48K) {  // The only other rate that divides down evenly is 192K
+    rate = SAMPLE_RATE_192K;
+  }
+  SampleRate = rate;
+  DF1 = (float32_t)(SR[SampleRate].rate / (DECIMATED_RATE * (uint32_t)DF2));  // 4, 2, or 1
+  DF = DF1 * DF2;
+  decimatedRate = (float32_t)SR[SampleRate].rate / DF;
+  N_BLOCKS = FFT_LENGTH / 2 / BUFFER_SIZE * (uint32_t)DF;  // 16, 8, or 4 buffers, always 256 samples after decimation
+  BUF_N_DF = BUFFER_SIZE * N_BLOCKS / (uint32_t)DF;
+  bin_BW = 1.0 / (DF * FFT_length) * SR[SampleRate].rate;
   IFFreq = SR[SampleRate].rate / 4;
+  SetI2SFreq(SR[SampleRate].rate);
+  Q_in_L.clear();  // Drop anything queued at the old rate
+  Q_in_R.clear();
 
   biquad_lowpass1.numStages = N_stages_biquad_lowpass1;  // set number of stages
   biquad_lowpass1.pCoeffs = biquad_lowpass1_coeffs;      // set pointer to coefficients file
@@ -1755,13 +1733,16 @@ void InitializeDataArrays() {
     while (1)
       ;
   }
+#ifndef DECIMATE_REFERENCE
+  InitPolyphaseDecimators();  // Same filters as above, I and Q in one pass
+#endif
 
   // Interpolation filter 1, L1 = 2
   // not sure whether I should design with the final sample rate ??
   // yes, because the interpolation filter is AFTER the upsampling, so it has to be in the target sample rate!
   //    CalcFIRCoeffs(FIR_int1_coeffs, 8, (float32_t)5000.0, 80, 0, 0.0, 12000);
   //    CalcFIRCoeffs(FIR_int1_coeffs, 16, (float32_t)(n_desired_BW * 1000.0), n_att, 0, 0.0, SR[SampleRate].rate / 4.0);
-  CalcFIRCoeffs(FIR_int1_coeffs, 48, (float32_t)(n_desired_BW * 1000.0), n_att, 0, 0.0, SR[SampleRate].rate / 4.0);
+  CalcFIRCoeffs(FIR_int1_coeffs, 48, (float32_t)(n_desired_BW * 1000.0), n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
   //    if(arm_fir_interpolate_init_f32(&FIR_int1_I, (uint32_t)DF2, 16, FIR_int1_coeffs, FIR_int1_I_state, BUFFER_SIZE * N_BLOCKS / (uint32_t)DF)) {
   if (arm_fir_interpolate_init_f32(&FIR_int1_I, (uint8_t)DF2, 48, FIR_int1_coeffs, FIR_int1_I_state, BUFFER_SIZE * N_BLOCKS / (uint32_t)DF)) {
     while (1)
@@ -1826,20 +1807,8 @@ void InitializeDataArrays() {
   IIR_biquad_Zoom_FFT_I.pCoeffs = mag_coeffs[EEPROMData.spectrum_zoom];
   IIR_biquad_Zoom_FFT_Q.pCoeffs = mag_coeffs[EEPROMData.spectrum_zoom];
 
-  ZoomFFTPrep();
-
-  SpectralNoiseReductionInit();
-  InitLMSNoiseReduction();
-
-  temp_check_frequency = 0x03U;  //updates the temp value at a RTC/3 clock rate
-  //0xFFFF determines a 2 second sample rate period
-  highAlarmTemp = 85U;  //42 degrees C
-  lowAlarmTemp = 25U;
-  panicAlarmTemp = 90U;
-
-  initTempMon(temp_check_frequency, lowAlarmTemp, highAlarmTemp, panicAlarmTemp);
-  // this starts the measurements
-  TEMPMON_TEMPSENSE0 |= 0x2U;
+  ZoomFFTPrep();  // With the spectrum FFT size, limited by the block length at 1x and the lower sample rates
+  SAMLoadValues();  // The SAM PLL coefficients depend on the decimated rate
 }
 
 
@@ -1870,6 +1839,9 @@ void SetAudioOperatingState(int operatingState) {
   switch (operatingState) {
     case SSB_RECEIVE_STATE:
     case CW_RECEIVE_STATE:
+      if (SampleRate != SAMPLE_RATE_192K) {  // Back to the receive rate after transmit
+        SetI2SFreq(SR[SampleRate].rate);
+      }
       // QSD connected and enabled
       Q_in_L.begin();
       Q_in_R.begin();
@@ -1890,6 +1862,9 @@ void SetAudioOperatingState(int operatingState) {
 
       break;
     case SSB_TRANSMIT_STATE:
+      if (SampleRate != SAMPLE_RATE_192K) {  // The exciter always runs at 192K
+        SetI2SFreq(SR[SAMPLE_RATE_192K].rate);
+      }
       // QSD disabled and disconnected
       patchCord9.disconnect();
       patchCord10.disconnect();
@@ -1911,6 +1886,9 @@ void SetAudioOperatingState(int operatingState) {
       break;
     case CW_TRANSMIT_STRAIGHT_STATE:
     case CW_TRANSMIT_KEYER_STATE:
+      if (SampleRate != SAMPLE_RATE_192K) {  // The exciter always runs at 192K
+        SetI2SFreq(SR[SAMPLE_RATE_192K].rate);
+      }
       // QSD disabled and disconnected
       patchCord9.disconnect();
       patchCord10.disconnect();
@@ -2172,6 +2150,9 @@ void setup() {
   TxRxFreq = EEPROMData.centerFreq = EEPROMData.lastFrequencies[EEPROMData.currentBand][EEPROMData.activeVFO];
 
   InitializeDataArrays();
+#ifdef DSP_TIMING
+  DSPTimingInit();
+#endif
   splitOn = 0;  // Split VFO not active
   SetupMode(bands[EEPROMData.currentBand].mode);
 
@@ -2185,12 +2166,8 @@ void setup() {
   sineTone(EEPROMData.CWOffset + 6);  // This function takes "number of cycles" which is the offset + 6.
   initCWShaping();
   // Initialize buffer used by CW decoder.
-  float freq[4] = { 562.5, 656.5, 750.0, 843.75 };
-  float theta;
-  for (int kf = 0; kf < 255; kf++) {                                   //Calc sine wave
-    theta = (float)kf * TWO_PI * freq[EEPROMData.CWOffset] / 24000.0;  // theta = kf * 2 * PI * freqSideTone / 24000
-    sinBuffer[kf] = sin(theta);
-  }
+  CWDetectPrep();
+  CWSkimmerReset();
   filterEncoderMove = 0;
   fineTuneEncoderMove = 0L;
   xrState = RECEIVE_STATE;  // Enter loop() in receive state.  KF5N July 22, 2023
@@ -2225,7 +2202,6 @@ void setup() {
 
   EEPROMData.sdCardPresent = SDPresentCheck();  // JJP 7/18/23
   lastState = 1111;                             // To make sure the receiver will be configured on the first pass through.  KF5N September 3, 2023
-  decodeStates = state0;                        // Initialize the Morse decoder.
   UpdateDecoderField();                         // Adjust graphics for Morse decoder.
 
   if ((MASTER_CLK_MULT_RX == 2) || (MASTER_CLK_MULT_TX == 2)) ResetFlipFlops();  // Required only for QSD2/QSE2.
@@ -2629,6 +2605,9 @@ FASTRUN void loop()  // Replaced entire loop() with Greg's code  JJP  7/14/23
     // Used to monitor CPU temp and load factors
   }
 #endif
+#ifdef DSP_TIMING
+  DSPTimingReport();  // Prints receive DSP stage timing about once a second.
+#endif
 
   if (volumeChangeFlag == true) {
     volumeChangeFlag = false;
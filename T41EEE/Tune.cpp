@@ -17,7 +17,7 @@ void SetFreqCal(int calFreqShift)
 {  // July 7 2023 KF5N
   // NEVER USE AUDIONOINTERRUPTS HERE: that introduces annoying clicking noise with every frequency change
   // SI5351_FREQ_MULT is 100ULL, MASTER_CLK_MULT is 4;
-  int cwFreqOffset = (EEPROMData.CWOffset + 6) * 24000 / 256;  // Calculate the CW offset based on user selected CW offset frequency.
+  int cwFreqOffset = (EEPROMData.CWOffset + 6) * (int)decimatedRate / 256;  // Calculate the CW offset based on user selected CW offset frequency.
   // The SSB LO frequency is always the same as the displayed transmit frequency.
   // The CW LOT frequency must be shifted by 750 Hz due to the way the CW carrier is generated by a quadrature tone.
   if (bands[EEPROMData.currentBand].mode == DEMOD_LSB)
@@ -60,6 +60,8 @@ void ResetTuning()
 }
 // ===== End AFP 10-11-22
 
+unsigned long long spectrumLOFreq = 0;  // Clk2SetFreq the spectrum average was started at
+
 /*****
   Purpose: SetFrequency
 
@@ -75,7 +77,7 @@ void SetFreq() {  //AFP 09-22-22   Revised July 7 KF5N
 
   // NEVER USE AUDIONOINTERRUPTS HERE: that introduces annoying clicking noise with every frequency change
   // SI5351_FREQ_MULT is 100ULL, MASTER_CLK_MULT is 4;
-  int cwFreqOffset = (EEPROMData.CWOffset + 6) * 24000 / 256;  // Calculate the CW offset based on user selected CW offset frequency.
+  int cwFreqOffset = (EEPROMData.CWOffset + 6) * (int)decimatedRate / 256;  // Calculate the CW offset based on user selected CW offset frequency.
   // The SSB LO frequency is always the same as the displayed transmit frequency.
   // The CW LOT frequency must be shifted by 750 Hz due to the way the CW carrier is generated by a quadrature tone.
   if (radioState == SSB_TRANSMIT_STATE) {
@@ -104,6 +106,12 @@ void SetFreq() {  //AFP 09-22-22   Revised July 7 KF5N
     si5351.output_enable(SI5351_CLK2, 0);  // CLK2 (receive) off during transmit to prevent spurious outputs
     si5351.output_enable(SI5351_CLK1, 1);
   }
+  // A new receive LO frequency moves the whole spectrum, band changes included, so the display average and the
+  // S-meter start again
+  if (Clk2SetFreq != spectrumLOFreq) {
+    spectrumLOFreq = Clk2SetFreq;
+    SpectrumAverageReset();
+  }
   //=====================  AFP 10-03-22 =================
   DrawFrequencyBarValue();
 }
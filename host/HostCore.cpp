@@ -0,0 +1,180 @@
+// The objects and functions behind the host stand-ins in stubs/, and the configuration file routines of
+// JSON.cpp, which needs ArduinoJson and an SD card and is not built on the host.
+#include "SDT.h"
+
+#include <chrono>
+#include <thread>
+
+usb_serial_class Serial;
+usb_serial_class Serial1;
+usb_serial_class SerialUSB1;
+bool HostSerialQuiet = false;
+TwoWire Wire;
+TwoWire Wire1;
+SDClass SD;
+EEPROMClass EEPROM;
+teensy3_clock_class Teensy3Clock;
+
+volatile uint32_t ARM_DEMCR;
+volatile uint32_t ARM_DWT_CTRL;
+volatile uint32_t TEMPMON_TEMPSENSE0;
+volatile uint32_t TEMPMON_TEMPSENSE1;
+volatile uint32_t TEMPMON_TEMPSENSE2;
+volatile uint32_t HW_OCOTP_ANA1;
+volatile uint32_t CCM_CS1CDR;
+volatile uint32_t CCM_CS2CDR;
+volatile uint32_t SNVS_HPCR;
+volatile uint32_t SNVS_LPCR;
+volatile uint32_t SNVS_LPSRTCMR;
+volatile uint32_t SNVS_LPSRTCLR;
+volatile uint32_t SNVS_HPRTCMR;
+volatile uint32_t SNVS_HPRTCLR;
+
+static volatile uint32_t hostPads[64];
+struct digital_pin_bitband_and_config_table_struct digital_pin_to_info_PGM[64] = {};
+
+static struct HostPadInit {
+  HostPadInit() {
+    for (int i = 0; i < 64; i++) digital_pin_to_info_PGM[i].pad = &hostPads[i];
+  }
+} hostPadInit;
+
+/*****
+  Time.  The clock is virtual, so nothing waits in real time.  delay() skips it forward, HostReceiverProcess()
+  moves it on by the length of each block, and each read moves it on a microsecond, for the time the polling
+  code takes.  MyDelay() and the splash screen return at once, and the Metro timers still expire.
+*****/
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+static uint64_t hostMicros = 0;
+
+uint32_t millis() {
+  return ++hostMicros / 1000;
+}
+
+uint32_t micros() {
+  return ++hostMicros;
+}
+
+void delay(uint32_t ms) {
+  hostMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+  hostMicros += us;
+}
+
+uint32_t HostCycleCount() {
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostStart).count();
+  return (uint32_t)(ns * 3 / 5);  // 600 MHz
+}
+
+// Pins hold what was written to them.  Unwritten inputs idle high: keys and PTT have pull ups.
+static int hostPins[256];
+static bool hostPinsSet[256];
+
+void HostSetPin(uint8_t pin, int value) {
+  hostPins[pin] = value;
+  hostPinsSet[pin] = true;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  HostSetPin(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+  return hostPinsSet[pin] ? hostPins[pin] : HIGH;
+}
+
+void digitalWriteFast(uint8_t pin, uint8_t value) {
+  digitalWrite(pin, value);
+}
+
+int digitalReadFast(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+size_t usb_serial_class::write(uint8_t c) {
+  if (!HostSerialQuiet) fputc(c, stderr);
+  return 1;
+}
+
+size_t usb_serial_class::write(const uint8_t *buffer, size_t size) {
+  if (!HostSerialQuiet) fwrite(buffer, 1, size, stderr);
+  return size;
+}
+
+// Audio queues
+void AudioRecordQueue::HostWrite(const int16_t *samples) {
+  if (enabled) blocks.emplace_back(samples, samples + AUDIO_BLOCK_SAMPLES);
+}
+
+int16_t *AudioPlayQueue::getBuffer() {
+  pending.assign(AUDIO_BLOCK_SAMPLES, 0);
+  return pending.data();
+}
+
+void AudioPlayQueue::playBuffer() {
+  if (pending.size() != AUDIO_BLOCK_SAMPLES) return;
+  blocks.push_back(pending);
+  pending.clear();
+  if (blocks.size() > 1024) blocks.pop_front();  // Nobody is collecting this queue
+}
+
+void AudioPlayQueue::play(int16_t data) {
+  if (pending.size() == AUDIO_BLOCK_SAMPLES) pending.clear();
+  pending.push_back(data);
+  if (pending.size() == AUDIO_BLOCK_SAMPLES) playBuffer();
+}
+
+void AudioPlayQueue::play(const int16_t *data, uint32_t len) {
+  while (len--) play(*data++);
+}
+
+bool AudioPlayQueue::HostRead(int16_t *samples) {
+  if (blocks.empty()) return false;
+  memcpy(samples, blocks.front().data(), AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+  blocks.pop_front();
+  return true;
+}
+
+// JSON.cpp stand-ins.  There is no SD card on the host, so there is never a file to load or save.
+void loadConfiguration(const char * /* filename */, config_t & /* config */) {
+}
+
+void saveConfiguration(const char * /* filename */, const config_t & /* config */, bool /* toFile */) {
+}
+
+void printFile(const char * /* filename */) {
+}
+
+// avr-libc conversions
+char *dtostrf(double value, int width, unsigned int precision, char *buffer) {
+  sprintf(buffer, "%*.*f", width, precision, value);
+  return buffer;
+}
+
+char *ultoa(unsigned long value, char *buffer, int radix) {
+  char digits[72];
+  char *p = digits + sizeof(digits) - 1;
+  *p = 0;
+  do {
+    int digit = value % radix;
+    *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= radix;
+  } while (value);
+  strcpy(buffer, p);
+  return buffer;
+}
+
+char *ltoa(long value, char *buffer, int radix) {
+  if (value < 0 && radix == 10) {
+    buffer[0] = '-';
+    ultoa(-(unsigned long)value, buffer + 1, radix);
+    return buffer;
+  }
+  return ultoa((unsigned long)value, buffer, radix);
+}
+
+char *itoa(int value, char *buffer, int radix) {
+  return ltoa(value, buffer, radix);
+}
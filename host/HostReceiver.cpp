@@ -0,0 +1,186 @@
+// WAV file I/O and the receive harness, see HostReceiver.h
+#include "SDT.h"
+#include "HostReceiver.h"
+
+#include <chrono>
+
+/*****
+  WAV files
+*****/
+static uint32_t WavU32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t WavU16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+bool WavRead(const char *path, WavData &wav) {
+  FILE *f = fopen(path, "rb");
+  uint8_t header[12], chunk[8], fmt[40];
+  uint16_t format = 0, channels = 0, bits = 0;
+  bool haveFormat = false;
+
+  if (f == nullptr) return false;
+  if (fread(header, 1, 12, f) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+    fclose(f);
+    return false;
+  }
+  wav.left.clear();
+  wav.right.clear();
+  while (fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = WavU32(chunk + 4);
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      if (size < 16 || fread(fmt, 1, min(size, (uint32_t)sizeof(fmt)), f) != min(size, (uint32_t)sizeof(fmt))) break;
+      if (size > sizeof(fmt)) fseek(f, size - sizeof(fmt), SEEK_CUR);
+      format = WavU16(fmt);
+      channels = WavU16(fmt + 2);
+      wav.rate = WavU32(fmt + 4);
+      bits = WavU16(fmt + 14);
+      if (format == 0xFFFE && size >= 26) format = WavU16(fmt + 24);  // WAVE_FORMAT_EXTENSIBLE
+      haveFormat = true;
+    } else if (memcmp(chunk, "data", 4) == 0 && haveFormat) {
+      bool pcm16 = (format == 1 && bits == 16), float32 = (format == 3 && bits == 32);
+      if ((!pcm16 && !float32) || channels < 1 || channels > 2) break;
+      uint32_t frameBytes = channels * bits / 8;
+      std::vector<uint8_t> data(size);
+      size = fread(data.data(), 1, size, f);
+      for (uint32_t frame = 0; frame + frameBytes <= size; frame += frameBytes) {
+        int16_t sample[2];
+        for (int c = 0; c < channels; c++) {
+          const uint8_t *p = &data[frame + c * bits / 8];
+          if (pcm16) {
+            sample[c] = (int16_t)WavU16(p);
+          } else {
+            float value;
+            uint32_t u = WavU32(p);
+            memcpy(&value, &u, 4);
+            value = constrain(value * 32768.0f, -32768.0f, 32767.0f);
+            sample[c] = (int16_t)lrintf(value);
+          }
+        }
+        wav.left.push_back(sample[0]);
+        wav.right.push_back(sample[channels - 1]);
+      }
+      fclose(f);
+      return true;
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  fclose(f);
+  return false;
+}
+
+static void WavPut32(FILE *f, uint32_t v) {
+  uint8_t p[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+  fwrite(p, 1, 4, f);
+}
+
+static void WavPut16(FILE *f, uint16_t v) {
+  uint8_t p[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+  fwrite(p, 1, 2, f);
+}
+
+bool WavWrite(const char *path, const WavData &wav) {
+  FILE *f = fopen(path, "wb");
+  uint32_t frames = min(wav.left.size(), wav.right.size());
+
+  if (f == nullptr) return false;
+  fwrite("RIFF", 1, 4, f);
+  WavPut32(f, 36 + frames * 4);
+  fwrite("WAVEfmt ", 1, 8, f);
+  WavPut32(f, 16);
+  WavPut16(f, 1);  // PCM
+  WavPut16(f, 2);
+  WavPut32(f, wav.rate);
+  WavPut32(f, wav.rate * 4);
+  WavPut16(f, 4);
+  WavPut16(f, 16);
+  fwrite("data", 1, 4, f);
+  WavPut32(f, frames * 4);
+  for (uint32_t i = 0; i < frames; i++) {
+    WavPut16(f, (uint16_t)wav.left[i]);
+    WavPut16(f, (uint16_t)wav.right[i]);
+  }
+  return fclose(f) == 0;
+}
+
+/*****
+  Receive harness
+*****/
+static uint32_t hostRate;
+
+bool HostReceiverStart(uint32_t rate, bool quiet) {
+  uint8_t rateIndex;
+
+  switch (rate) {
+    case 192000:
+      rateIndex = SAMPLE_RATE_192K;
+      break;
+    case 96000:
+      rateIndex = SAMPLE_RATE_96K;
+      break;
+    case 48000:
+      rateIndex = SAMPLE_RATE_48K;
+      break;
+    default:
+      return false;
+  }
+  hostRate = rate;
+  HostSerialQuiet = quiet;
+  setup();
+  loop();  // Enters SSB_RECEIVE_STATE and draws the first (empty) sweep
+  if (EEPROMData.rxSampleRate != rateIndex) {
+    EEPROMData.rxSampleRate = rateIndex;
+    SetReceiveSampleRate(rateIndex);
+  }
+  // ProcessIQData() waits for more than N_BLOCKS buffers, so the queues run one silent buffer ahead
+  int16_t silence[AUDIO_BLOCK_SAMPLES] = {};
+  Q_in_L.HostWrite(silence);
+  Q_in_R.HostWrite(silence);
+  return true;
+}
+
+void HostReceiverMode(int mode) {
+  for (int i = 0; i <= DEMOD_MAX && bands[EEPROMData.currentBand].mode != mode; i++) {
+    ButtonDemodMode();
+  }
+}
+
+void HostReceiverNR(int option) {
+  for (int i = 0; i < 4 && EEPROMData.nrOptionSelect != option; i++) {
+    ButtonNR();
+  }
+}
+
+void HostReceiverOffset(int32_t hz) {
+  NCOFreq = hz;  // FreqShiftMixer() follows it from the next block
+}
+
+void HostReceiverVolume(int volume) {
+  EEPROMData.audioVolume = constrain(volume, 0, 100);
+}
+
+uint32_t HostReceiverBlockSamples() {
+  return BUFFER_SIZE * N_BLOCKS;
+}
+
+double HostReceiverProcess(const int16_t *i, const int16_t *q, bool sweepStart, std::vector<int16_t> &left, std::vector<int16_t> &right) {
+  int16_t samples[AUDIO_BLOCK_SAMPLES];
+
+  for (uint32_t b = 0; b < N_BLOCKS; b++) {
+    Q_in_L.HostWrite(i + b * AUDIO_BLOCK_SAMPLES);
+    Q_in_R.HostWrite(q + b * AUDIO_BLOCK_SAMPLES);
+  }
+  if (sweepStart) {
+    updateDisplayCounter = 0;
+  }
+  auto start = std::chrono::steady_clock::now();
+  ServiceReceiveDSP();
+  auto end = std::chrono::steady_clock::now();
+  delayMicroseconds((uint64_t)BUFFER_SIZE * N_BLOCKS * 1000000 / hostRate);  // The radio's time for the block
+  while (Q_out_L.HostRead(samples)) left.insert(left.end(), samples, samples + AUDIO_BLOCK_SAMPLES);
+  while (Q_out_R.HostRead(samples)) right.insert(right.end(), samples, samples + AUDIO_BLOCK_SAMPLES);
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
@@ -0,0 +1,38 @@
+// Runs the T41EEE receive chain on the host: WAV file I/O and a harness that feeds I/Q blocks to the sketch's
+// own scheduler and collects the audio it plays.
+#ifndef HOST_RECEIVER_H
+#define HOST_RECEIVER_H
+
+#include <stdint.h>
+#include <vector>
+
+// A stereo WAV file.  For I/Q recordings the left channel is I and the right channel is Q, with positive
+// frequencies above the center.  The T41 receives IFFreq, a quarter of the sample rate, below the center.
+struct WavData {
+  uint32_t rate = 192000;
+  std::vector<int16_t> left;
+  std::vector<int16_t> right;
+};
+
+bool WavRead(const char *path, WavData &wav);  // 16 bit PCM or 32 bit float, mono or stereo
+bool WavWrite(const char *path, const WavData &wav);
+
+// Bring the radio up: setup(), then one pass of loop() to enter receive.  rate is the I/Q sample rate,
+// 192000, 96000, or 48000.  quiet keeps the sketch's Serial output off stderr.
+bool HostReceiverStart(uint32_t rate, bool quiet = true);
+void HostReceiverMode(int mode);     // DEMOD_USB, DEMOD_LSB, DEMOD_AM, or DEMOD_SAM, set with the Mode button
+void HostReceiverNR(int option);     // 0 off, 1 Kim, 2 spectral, 3 LMS, set with the NR button
+void HostReceiverOffset(int32_t hz);  // Fine tune, the receive frequency relative to centerFreq
+void HostReceiverVolume(int volume);  // Audio volume, 0 to 100
+uint32_t HostReceiverBlockSamples();  // I/Q samples per ProcessIQData() block, BUFFER_SIZE * N_BLOCKS
+
+/*****
+  Run one block of I/Q through ServiceReceiveDSP().  sweepStart marks the block as the first of a display
+  sweep, as ShowSpectrum() does.  The played audio is appended to left and right.
+
+  Return value:
+    double        wall time of the block in microseconds
+*****/
+double HostReceiverProcess(const int16_t *i, const int16_t *q, bool sweepStart, std::vector<int16_t> &left, std::vector<int16_t> &right);
+
+#endif
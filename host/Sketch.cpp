@@ -0,0 +1,2 @@
+// The sketch's main file, built as C++ the way the Arduino IDE does
+#include "../T41EEE/T41EEE.ino"
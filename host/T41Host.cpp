@@ -0,0 +1,99 @@
+// t41host: run a recorded I/Q WAV file through the T41EEE receiver and write the demodulated audio.
+//
+//   t41host [-m usb|lsb|am|sam] [-o offset_hz] [-n 0-3] [-a volume] [-s blocks] [-v] input.wav output.wav
+//
+// The input is stereo, I left and Q right, at 192000, 96000, or 48000 samples per second.  The receiver is
+// tuned a quarter of the sample rate below the center of the recording, plus the -o fine tune offset.  The
+// output is the audio the sketch plays, at the same rate.  -s sets how many blocks a display sweep takes,
+// for the spectrum FFT and audio spectrum work that is done once per sweep.  The wall time of each
+// ProcessIQData() block is reported on stdout against the real-time budget for the block.
+#include "SDT.h"
+#include "HostReceiver.h"
+
+#include <algorithm>
+#include <getopt.h>
+
+static void Usage() {
+  fprintf(stderr, "usage: t41host [-m usb|lsb|am|sam] [-o offset_hz] [-n nr] [-a volume] [-s sweep_blocks] [-v] input.wav output.wav\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  int mode = DEMOD_LSB, nr = 0, volume = -1, sweep = 1, option;
+  int32_t offset = 0;
+  bool verbose = false;
+  WavData in, out;
+
+  while ((option = getopt(argc, argv, "m:o:n:a:s:v")) != -1) {
+    switch (option) {
+      case 'm':
+        if (strcasecmp(optarg, "usb") == 0) mode = DEMOD_USB;
+        else if (strcasecmp(optarg, "lsb") == 0) mode = DEMOD_LSB;
+        else if (strcasecmp(optarg, "am") == 0) mode = DEMOD_AM;
+        else if (strcasecmp(optarg, "sam") == 0) mode = DEMOD_SAM;
+        else Usage();
+        break;
+      case 'o':
+        offset = atol(optarg);
+        break;
+      case 'n':
+        nr = atoi(optarg);
+        break;
+      case 'a':
+        volume = atoi(optarg);
+        break;
+      case 's':
+        sweep = max(1, atoi(optarg));
+        break;
+      case 'v':
+        verbose = true;
+        break;
+      default:
+        Usage();
+    }
+  }
+  if (argc - optind != 2) Usage();
+  if (!WavRead(argv[optind], in)) {
+    fprintf(stderr, "t41host: can't read %s, it must be 16 bit PCM or 32 bit float WAV\n", argv[optind]);
+    return 1;
+  }
+  if (!HostReceiverStart(in.rate, !verbose)) {
+    fprintf(stderr, "t41host: %u samples per second is not a receive rate, use 192000, 96000, or 48000\n", in.rate);
+    return 1;
+  }
+  HostReceiverMode(mode);
+  HostReceiverNR(nr);
+  HostReceiverOffset(offset);
+  if (volume >= 0) HostReceiverVolume(volume);
+
+  uint32_t blockSamples = HostReceiverBlockSamples();
+  uint32_t blocks = in.left.size() / blockSamples;
+  double budget = 1.0e6 * blockSamples / in.rate;
+  std::vector<double> times;
+
+  for (uint32_t b = 0; b < blocks; b++) {
+    times.push_back(HostReceiverProcess(&in.left[b * blockSamples], &in.right[b * blockSamples], b % sweep == 0, out.left, out.right));
+  }
+  out.rate = in.rate;
+  if (!WavWrite(argv[optind + 1], out)) {
+    fprintf(stderr, "t41host: can't write %s\n", argv[optind + 1]);
+    return 1;
+  }
+  if (blocks == 0) {
+    printf("No complete %u sample blocks in %s\n", blockSamples, argv[optind]);
+    return 0;
+  }
+
+  double total = 0.0;
+  for (double t : times) total += t;
+  std::vector<double> sorted = times;
+  std::sort(sorted.begin(), sorted.end());
+  printf("%u blocks of %u samples, %.1f us budget per block\n", blocks, blockSamples, budget);
+  printf("Wall time per block: mean %.1f us, median %.1f us, 99th percentile %.1f us, max %.1f us\n",
+         total / blocks, sorted[blocks / 2], sorted[(blocks * 99) / 100], sorted[blocks - 1]);
+  printf("%.2f times real time\n", budget * blocks / total);
+  if (verbose) {
+    for (uint32_t b = 0; b < blocks; b++) printf("block %u %.1f us\n", b, times[b]);
+  }
+  return 0;
+}
@@ -0,0 +1,375 @@
+// Float reference for the CMSIS-DSP functions the T41EEE sketch uses.  See arm_math.h.
+#include "arm_math.h"
+#include "arm_const_structs.h"
+
+#include <vector>
+
+void arm_add_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] + pSrcB[i];
+}
+
+void arm_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] - pSrcB[i];
+}
+
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] * pSrcB[i];
+}
+
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrc[i] * scale;
+}
+
+void arm_negate_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = -pSrc[i];
+}
+
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  memmove(pDst, pSrc, blockSize * sizeof(float32_t));
+}
+
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = value;
+}
+
+void arm_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *result) {
+  float32_t sum = 0.0f;
+  for (uint32_t i = 0; i < blockSize; i++) sum += pSrcA[i] * pSrcB[i];
+  *result = sum;
+}
+
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) {
+    float32_t in = pSrc[i] * 32768.0f;
+    in += in > 0.0f ? 0.5f : -0.5f;  // CMSIS rounds to nearest
+    int32_t value = (int32_t)in;
+    if (value > 32767) value = 32767;
+    if (value < -32768) value = -32768;
+    pDst[i] = (q15_t)value;
+  }
+}
+
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  for (uint32_t i = 0; i < blockSize; i++) pDst[i] = (float32_t)pSrc[i] / 32768.0f;
+}
+
+void arm_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex) {
+  uint32_t index = 0;
+  for (uint32_t i = 1; i < blockSize; i++) {
+    if (pSrc[i] > pSrc[index]) index = i;
+  }
+  *pResult = pSrc[index];
+  *pIndex = index;
+}
+
+void arm_min_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex) {
+  uint32_t index = 0;
+  for (uint32_t i = 1; i < blockSize; i++) {
+    if (pSrc[i] < pSrc[index]) index = i;
+  }
+  *pResult = pSrc[index];
+  *pIndex = index;
+}
+
+void arm_max_q15(const q15_t *pSrc, uint32_t blockSize, q15_t *pResult, uint32_t *pIndex) {
+  uint32_t index = 0;
+  for (uint32_t i = 1; i < blockSize; i++) {
+    if (pSrc[i] > pSrc[index]) index = i;
+  }
+  *pResult = pSrc[index];
+  *pIndex = index;
+}
+
+void arm_power_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult) {
+  float32_t sum = 0.0f;
+  for (uint32_t i = 0; i < blockSize; i++) sum += pSrc[i] * pSrc[i];
+  *pResult = sum;
+}
+
+void arm_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult) {
+  if (blockSize <= 1) {
+    *pResult = 0.0f;
+    return;
+  }
+  float32_t mean = 0.0f, sum = 0.0f;
+  for (uint32_t i = 0; i < blockSize; i++) mean += pSrc[i];
+  mean /= blockSize;
+  for (uint32_t i = 0; i < blockSize; i++) sum += (pSrc[i] - mean) * (pSrc[i] - mean);
+  *pResult = sum / (blockSize - 1);
+}
+
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples) {
+  for (uint32_t i = 0; i < numSamples; i++) pDst[i] = pSrc[2 * i] * pSrc[2 * i] + pSrc[2 * i + 1] * pSrc[2 * i + 1];
+}
+
+void arm_cmplx_mult_cmplx_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t numSamples) {
+  for (uint32_t i = 0; i < numSamples; i++) {
+    float32_t a = pSrcA[2 * i], b = pSrcA[2 * i + 1];
+    float32_t c = pSrcB[2 * i], d = pSrcB[2 * i + 1];
+    pDst[2 * i] = a * c - b * d;
+    pDst[2 * i + 1] = a * d + b * c;
+  }
+}
+
+float32_t arm_sin_f32(float32_t x) {
+  return sinf(x);
+}
+
+float32_t arm_cos_f32(float32_t x) {
+  return cosf(x);
+}
+
+/*****
+  The complex FFT.  A radix 2 decimation in frequency transform leaves the bins in bit reversed order, which
+  is what CMSIS returns with bitReverseFlag 0.  The inverse is scaled by 1 / fftLen, as in CMSIS.
+*****/
+static const std::vector<float32_t> &HostTwiddles(uint32_t fftLen) {
+  static std::vector<float32_t> tables[16];
+  int log2n = 0;
+  while ((1U << log2n) < fftLen) log2n++;
+  std::vector<float32_t> &table = tables[log2n];
+  if (table.empty()) {
+    table.resize(fftLen);
+    for (uint32_t k = 0; k < fftLen / 2; k++) {
+      table[2 * k] = (float32_t)cos(2.0 * M_PI * k / fftLen);
+      table[2 * k + 1] = (float32_t)sin(2.0 * M_PI * k / fftLen);
+    }
+  }
+  return table;
+}
+
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag) {
+  uint32_t n = S->fftLen;
+  const std::vector<float32_t> &w = HostTwiddles(n);
+  float32_t sign = ifftFlag ? 1.0f : -1.0f;
+
+  for (uint32_t span = n / 2, stride = 1; span >= 1; span >>= 1, stride <<= 1) {
+    for (uint32_t start = 0; start < n; start += 2 * span) {
+      for (uint32_t k = 0; k < span; k++) {
+        float32_t *a = p1 + 2 * (start + k);
+        float32_t *b = p1 + 2 * (start + k + span);
+        float32_t re = a[0] - b[0], im = a[1] - b[1];
+        float32_t c = w[2 * k * stride], s = sign * w[2 * k * stride + 1];
+        a[0] += b[0];
+        a[1] += b[1];
+        b[0] = re * c - im * s;
+        b[1] = re * s + im * c;
+      }
+    }
+  }
+  if (bitReverseFlag) {
+    for (uint32_t i = 0, j = 0; i < n; i++) {
+      if (i < j) {
+        float32_t t0 = p1[2 * i], t1 = p1[2 * i + 1];
+        p1[2 * i] = p1[2 * j];
+        p1[2 * i + 1] = p1[2 * j + 1];
+        p1[2 * j] = t0;
+        p1[2 * j + 1] = t1;
+      }
+      uint32_t bit = n >> 1;
+      while (j & bit) {
+        j ^= bit;
+        bit >>= 1;
+      }
+      j |= bit;
+    }
+  }
+  if (ifftFlag) {
+    float32_t scale = 1.0f / n;
+    for (uint32_t i = 0; i < 2 * n; i++) p1[i] *= scale;
+  }
+}
+
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len16 = { 16, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len32 = { 32, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len64 = { 64, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len128 = { 128, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len256 = { 256, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len512 = { 512, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len1024 = { 1024, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len2048 = { 2048, nullptr, nullptr, 0 };
+const arm_cfft_instance_f32 arm_cfft_sR_f32_len4096 = { 4096, nullptr, nullptr, 0 };
+
+/*****
+  FIR filters.  The state holds the newest numTaps - 1 inputs ahead of the block, oldest first, and the
+  coefficients are time reversed, so each output is the dot product of the coefficients with the window of
+  numTaps inputs ending at the current one.
+*****/
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize) {
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (numTaps + blockSize - 1) * sizeof(float32_t));
+}
+
+void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  uint32_t numTaps = S->numTaps;
+  float32_t *state = S->pState;
+
+  memcpy(state + numTaps - 1, pSrc, blockSize * sizeof(float32_t));
+  for (uint32_t i = 0; i < blockSize; i++) {
+    float32_t sum = 0.0f;
+    for (uint32_t k = 0; k < numTaps; k++) sum += state[i + k] * S->pCoeffs[k];
+    pDst[i] = sum;
+  }
+  memmove(state, state + blockSize, (numTaps - 1) * sizeof(float32_t));
+}
+
+arm_status arm_fir_decimate_init_f32(arm_fir_decimate_instance_f32 *S, uint16_t numTaps, uint8_t M, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize) {
+  if (M == 0 || blockSize % M != 0) return ARM_MATH_LENGTH_ERROR;
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->M = M;
+  memset(pState, 0, (numTaps + blockSize - 1) * sizeof(float32_t));
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_decimate_f32(const arm_fir_decimate_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  uint32_t numTaps = S->numTaps, M = S->M;
+  float32_t *state = S->pState;
+
+  memcpy(state + numTaps - 1, pSrc, blockSize * sizeof(float32_t));
+  for (uint32_t i = 0; i < blockSize / M; i++) {
+    const float32_t *window = state + i * M + M - 1;  // Ends at the last of the M new inputs
+    float32_t sum = 0.0f;
+    for (uint32_t k = 0; k < numTaps; k++) sum += window[k] * S->pCoeffs[k];
+    pDst[i] = sum;
+  }
+  memmove(state, state + blockSize, (numTaps - 1) * sizeof(float32_t));
+}
+
+arm_status arm_fir_interpolate_init_f32(arm_fir_interpolate_instance_f32 *S, uint8_t L, uint16_t numTaps, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize) {
+  if (L == 0 || numTaps % L != 0) return ARM_MATH_LENGTH_ERROR;
+  S->L = L;
+  S->phaseLength = numTaps / L;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (blockSize + S->phaseLength - 1) * sizeof(float32_t));
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_interpolate_f32(const arm_fir_interpolate_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  uint32_t L = S->L, phaseLength = S->phaseLength;
+  float32_t *state = S->pState;
+
+  memcpy(state + phaseLength - 1, pSrc, blockSize * sizeof(float32_t));
+  for (uint32_t i = 0; i < blockSize; i++) {
+    for (uint32_t j = 1; j <= L; j++) {
+      float32_t sum = 0.0f;
+      for (uint32_t tap = 0; tap < phaseLength; tap++) sum += state[i + tap] * S->pCoeffs[(L - j) + tap * L];
+      *pDst++ = sum;
+    }
+  }
+  memmove(state, state + blockSize, (phaseLength - 1) * sizeof(float32_t));
+}
+
+/*****
+  Biquads.  Coefficients are b0, b1, b2, a1, a2 for each stage, with the feedback added:
+  y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+*****/
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages, const float32_t *pCoeffs, float32_t *pState) {
+  S->numStages = numStages;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, 4 * numStages * sizeof(float32_t));
+}
+
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  const float32_t *in = pSrc;
+
+  for (uint32_t stage = 0; stage < S->numStages; stage++) {
+    const float32_t *c = S->pCoeffs + 5 * stage;
+    float32_t *d = S->pState + 4 * stage;  // x[n-1], x[n-2], y[n-1], y[n-2]
+    for (uint32_t i = 0; i < blockSize; i++) {
+      float32_t x = in[i];
+      float32_t y = c[0] * x + c[1] * d[0] + c[2] * d[1] + c[3] * d[2] + c[4] * d[3];
+      d[1] = d[0];
+      d[0] = x;
+      d[3] = d[2];
+      d[2] = y;
+      pDst[i] = y;
+    }
+    in = pDst;
+  }
+}
+
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages, const float32_t *pCoeffs, float32_t *pState) {
+  S->numStages = numStages;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, 2 * numStages * sizeof(float32_t));
+}
+
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize) {
+  const float32_t *in = pSrc;
+
+  for (uint32_t stage = 0; stage < S->numStages; stage++) {
+    const float32_t *c = S->pCoeffs + 5 * stage;
+    float32_t *d = S->pState + 2 * stage;
+    for (uint32_t i = 0; i < blockSize; i++) {
+      float32_t x = in[i];
+      float32_t y = c[0] * x + d[0];
+      d[0] = c[1] * x + c[3] * y + d[1];
+      d[1] = c[2] * x + c[4] * y;
+      pDst[i] = y;
+    }
+    in = pDst;
+  }
+}
+
+/*****
+  Correlation, 2 * max(srcALen, srcBLen) - 1 outputs.  Output srcBLen - 1 is the zero lag sum of a[k] b[k].
+*****/
+void arm_correlate_f32(const float32_t *pSrcA, uint32_t srcALen, const float32_t *pSrcB, uint32_t srcBLen, float32_t *pDst) {
+  uint32_t outLen = 2 * (srcALen > srcBLen ? srcALen : srcBLen) - 1;
+
+  for (uint32_t i = 0; i < outLen; i++) {
+    int32_t lag = (int32_t)i - (int32_t)(srcBLen - 1);
+    float32_t sum = 0.0f;
+    for (int32_t k = 0; k < (int32_t)srcBLen; k++) {
+      int32_t j = k + lag;
+      if (j >= 0 && j < (int32_t)srcALen) sum += pSrcA[j] * pSrcB[k];
+    }
+    pDst[i] = sum;
+  }
+}
+
+/*****
+  Normalized LMS, following the CMSIS loop: the energy is a running sum of the squares of the last numTaps
+  inputs, and each coefficient update is error * mu / energy.
+*****/
+void arm_lms_norm_init_f32(arm_lms_norm_instance_f32 *S, uint16_t numTaps, float32_t *pCoeffs, float32_t *pState, float32_t mu, uint32_t blockSize) {
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->mu = mu;
+  S->energy = 0.0f;
+  S->x0 = 0.0f;
+  memset(pState, 0, (numTaps + blockSize - 1) * sizeof(float32_t));
+}
+
+void arm_lms_norm_f32(arm_lms_norm_instance_f32 *S, const float32_t *pSrc, float32_t *pRef, float32_t *pOut, float32_t *pErr, uint32_t blockSize) {
+  uint32_t numTaps = S->numTaps;
+  float32_t *state = S->pState;
+  float32_t energy = S->energy, x0 = S->x0;
+
+  for (uint32_t i = 0; i < blockSize; i++) {
+    float32_t *window = state + i;
+    float32_t in = pSrc[i];
+    window[numTaps - 1] = in;
+    energy -= x0 * x0;
+    energy += in * in;
+    float32_t acc = 0.0f;
+    for (uint32_t k = 0; k < numTaps; k++) acc += window[k] * S->pCoeffs[k];
+    pOut[i] = acc;
+    float32_t e = pRef[i] - acc;
+    pErr[i] = e;
+    float32_t w = e * S->mu / (energy + 0.000000119209289f);
+    for (uint32_t k = 0; k < numTaps; k++) S->pCoeffs[k] += w * window[k];
+    x0 = window[0];
+  }
+  S->energy = energy;
+  S->x0 = x0;
+  memmove(state, state + blockSize, (numTaps - 1) * sizeof(float32_t));
+}
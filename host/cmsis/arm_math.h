@@ -0,0 +1,129 @@
+// Float reference for the CMSIS-DSP functions the T41EEE sketch uses.  Same structures, argument order, and
+// results as CMSIS-DSP, including its coefficient ordering, time reversed for the FIR filters and polyphase
+// for the interpolators, the 1 / N scaling of the inverse FFT, and the sign of the biquad feedback
+// coefficients.  Nothing is optimized; this is for checking the sketch on a PC, not for timing the M7.
+#ifndef HOST_ARM_MATH_H
+#define HOST_ARM_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+typedef float float32_t;
+typedef double float64_t;
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum {
+  ARM_MATH_SUCCESS = 0,
+  ARM_MATH_ARGUMENT_ERROR = -1,
+  ARM_MATH_LENGTH_ERROR = -2,
+  ARM_MATH_SIZE_MISMATCH = -3,
+  ARM_MATH_NANINF = -4,
+  ARM_MATH_SINGULAR = -5,
+  ARM_MATH_TEST_FAILURE = -6
+} arm_status;
+
+typedef struct {
+  uint16_t fftLen;
+  const float32_t *pTwiddle;
+  const uint16_t *pBitRevTable;
+  uint16_t bitRevLength;
+} arm_cfft_instance_f32;
+
+typedef struct {
+  uint16_t numTaps;
+  float32_t *pState;
+  const float32_t *pCoeffs;
+} arm_fir_instance_f32;
+
+typedef struct {
+  uint8_t M;
+  uint16_t numTaps;
+  const float32_t *pCoeffs;
+  float32_t *pState;
+} arm_fir_decimate_instance_f32;
+
+typedef struct {
+  uint8_t L;
+  uint16_t phaseLength;
+  const float32_t *pCoeffs;
+  float32_t *pState;
+} arm_fir_interpolate_instance_f32;
+
+typedef struct {
+  uint32_t numStages;
+  float32_t *pState;
+  const float32_t *pCoeffs;
+} arm_biquad_casd_df1_inst_f32;
+
+typedef struct {
+  uint8_t numStages;
+  float32_t *pState;
+  const float32_t *pCoeffs;
+} arm_biquad_cascade_df2T_instance_f32;
+
+typedef struct {
+  uint16_t numTaps;
+  float32_t *pState;
+  float32_t *pCoeffs;
+  float32_t mu;
+} arm_lms_instance_f32;
+
+typedef struct {
+  uint16_t numTaps;
+  float32_t *pState;
+  float32_t *pCoeffs;
+  float32_t mu;
+  float32_t energy;
+  float32_t x0;
+} arm_lms_norm_instance_f32;
+
+// Basic math
+void arm_add_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize);
+void arm_negate_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize);
+void arm_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *result);
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+// Statistics
+void arm_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+void arm_min_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+void arm_max_q15(const q15_t *pSrc, uint32_t blockSize, q15_t *pResult, uint32_t *pIndex);
+void arm_power_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+void arm_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+
+// Complex math
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+void arm_cmplx_mult_cmplx_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t numSamples);
+
+// Fast math
+float32_t arm_sin_f32(float32_t x);
+float32_t arm_cos_f32(float32_t x);
+
+// Transforms
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag);
+
+// Filters
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize);
+void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+arm_status arm_fir_decimate_init_f32(arm_fir_decimate_instance_f32 *S, uint16_t numTaps, uint8_t M, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize);
+void arm_fir_decimate_f32(const arm_fir_decimate_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+arm_status arm_fir_interpolate_init_f32(arm_fir_interpolate_instance_f32 *S, uint8_t L, uint16_t numTaps, const float32_t *pCoeffs, float32_t *pState, uint32_t blockSize);
+void arm_fir_interpolate_f32(const arm_fir_interpolate_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages, const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages, const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_correlate_f32(const float32_t *pSrcA, uint32_t srcALen, const float32_t *pSrcB, uint32_t srcBLen, float32_t *pDst);
+void arm_lms_norm_init_f32(arm_lms_norm_instance_f32 *S, uint16_t numTaps, float32_t *pCoeffs, float32_t *pState, float32_t mu, uint32_t blockSize);
+void arm_lms_norm_f32(arm_lms_norm_instance_f32 *S, const float32_t *pSrc, float32_t *pRef, float32_t *pOut, float32_t *pErr, uint32_t blockSize);
+
+#endif
@@ -0,0 +1,337 @@
+// Host stand-in for the Teensy 4.1 Arduino core.  Just enough of the core for the T41EEE sketch to compile
+// and run its DSP on a Linux PC.  Pins, interrupts, and registers are no-ops, the clock is virtual so delay()
+// and polling loops return at once, and ARM_DWT_CYCCNT counts 600 MHz cycles of wall time.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <type_traits>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define DMAMEM
+#define FASTRUN
+#define FLASHMEM
+#define PROGMEM
+#define EXTMEM
+#define F(x) (x)
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define CHANGE 4
+#define RISING 3
+#define FALLING 2
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define F_CPU 600000000
+#define F_CPU_ACTUAL 600000000UL
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+template<class A, class B>
+constexpr auto min(A a, B b) -> typename std::common_type<A, B>::type {
+  return (b < a) ? b : a;
+}
+template<class A, class B>
+constexpr auto max(A a, B b) -> typename std::common_type<A, B>::type {
+  return (a < b) ? b : a;
+}
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define sq(x) ((x) * (x))
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+// The avr-libc conversions the Teensy core provides
+char *dtostrf(double value, int width, unsigned int precision, char *buffer);
+char *itoa(int value, char *buffer, int radix);
+char *ltoa(long value, char *buffer, int radix);
+char *ultoa(unsigned long value, char *buffer, int radix);
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Time.  millis() and micros() read a virtual clock that delay() skips forward, see HostCore.cpp.
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+uint32_t HostCycleCount();
+inline void yield() {}
+
+// Cycle counter
+#define ARM_DWT_CYCCNT (HostCycleCount())
+extern volatile uint32_t ARM_DEMCR;
+extern volatile uint32_t ARM_DWT_CTRL;
+#define ARM_DEMCR_TRCENA (1 << 24)
+#define ARM_DWT_CTRL_CYCCNTENA (1 << 0)
+
+// Pins and interrupts.  Inputs read as idle: pulled up keys and PTT are high, the switch matrix is open.
+void HostSetPin(uint8_t pin, int value);
+inline void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void digitalWriteFast(uint8_t pin, uint8_t value);
+int digitalReadFast(uint8_t pin);
+inline int analogRead(uint8_t) { return 1023; }
+inline void analogWrite(uint8_t, int) {}
+inline void analogReadResolution(unsigned int) {}
+inline void analogWriteResolution(unsigned int) {}
+inline void analogWriteFrequency(uint8_t, float) {}
+#define digitalPinToInterrupt(p) (p)
+inline void attachInterrupt(uint8_t, void (*)(void), int) {}
+inline void detachInterrupt(uint8_t) {}
+inline void interrupts() {}
+inline void noInterrupts() {}
+#define __disable_irq()
+#define __enable_irq()
+inline void tone(uint8_t, uint16_t, uint32_t = 0) {}
+inline void noTone(uint8_t) {}
+
+struct digital_pin_bitband_and_config_table_struct {
+  volatile uint32_t *reg;
+  volatile uint32_t *mux;
+  volatile uint32_t *pad;
+  uint32_t mask;
+};
+extern struct digital_pin_bitband_and_config_table_struct digital_pin_to_info_PGM[];
+#define IOMUXC_PAD_DSE(n) ((uint32_t)(((n) & 0x07) << 3))
+#define IOMUXC_PAD_SPEED(n) ((uint32_t)(((n) & 0x03) << 6))
+
+// Registers the sketch touches directly
+extern volatile uint32_t TEMPMON_TEMPSENSE0;
+extern volatile uint32_t TEMPMON_TEMPSENSE1;
+extern volatile uint32_t TEMPMON_TEMPSENSE2;
+extern volatile uint32_t HW_OCOTP_ANA1;
+extern volatile uint32_t CCM_CS1CDR;
+extern volatile uint32_t CCM_CS2CDR;
+extern volatile uint32_t SNVS_HPCR;
+extern volatile uint32_t SNVS_LPCR;
+extern volatile uint32_t SNVS_LPSRTCMR;
+extern volatile uint32_t SNVS_LPSRTCLR;
+extern volatile uint32_t SNVS_HPRTCMR;
+extern volatile uint32_t SNVS_HPRTCLR;
+#define SNVS_HPCR_RTC_EN ((uint32_t)(1 << 0))
+#define SNVS_HPCR_HP_TS ((uint32_t)(1 << 16))
+#define SNVS_LPCR_SRTC_ENV ((uint32_t)(1 << 0))
+#define TEMPMON_TEMPSENSE0_ALARM_VALUE(n) ((uint32_t)(((n) & 0xFFF) << 20))
+#define TEMPMON_TEMPSENSE2_LOW_ALARM_VALUE(n) ((uint32_t)(((n) & 0xFFF) << 0))
+#define TEMPMON_TEMPSENSE2_PANIC_ALARM_VALUE(n) ((uint32_t)(((n) & 0xFFF) << 16))
+#define CCM_CS1CDR_SAI1_CLK_PRED_MASK 0x1C0
+#define CCM_CS1CDR_SAI1_CLK_PRED(n) ((uint32_t)(((n) & 0x07) << 6))
+#define CCM_CS1CDR_SAI1_CLK_PODF_MASK 0x3F
+#define CCM_CS1CDR_SAI1_CLK_PODF(n) ((uint32_t)(((n) & 0x3F) << 0))
+#define CCM_CS2CDR_SAI2_CLK_PRED_MASK 0x1C0
+#define CCM_CS2CDR_SAI2_CLK_PRED(n) ((uint32_t)(((n) & 0x07) << 6))
+#define CCM_CS2CDR_SAI2_CLK_PODF_MASK 0x3F
+#define CCM_CS2CDR_SAI2_CLK_PODF(n) ((uint32_t)(((n) & 0x3F) << 0))
+inline float tempmonGetTemp() { return 40.0; }
+
+class String;
+
+// Print, the base of Serial and the display
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  virtual int availableForWrite() { return 64; }
+  virtual void flush() {}
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(const String &s);
+  size_t print(double n, int digits = 2) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+    return write(buffer);
+  }
+  template<class T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+  size_t print(T n, int base = DEC) {
+    char buffer[72];
+    if (base == 0) return write((uint8_t)n);  // As the Teensy core does
+    if (base == 1 || base == DEC) {
+      if (std::is_signed<T>::value) snprintf(buffer, sizeof(buffer), "%lld", (long long)n);
+      else snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)n);
+    } else {
+      unsigned long long u = (unsigned long long)n;
+      if (std::is_signed<T>::value && sizeof(T) < sizeof(u)) u &= (1ULL << (8 * sizeof(T))) - 1;
+      char *p = buffer + sizeof(buffer) - 1;
+      *p = 0;
+      do {
+        int digit = u % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        u /= base;
+      } while (u);
+      return write(p);
+    }
+    return write(buffer);
+  }
+  template<class T>
+  size_t println(T n) { return print(n) + println(); }
+  template<class T>
+  size_t println(T n, int format) { return print(n, format) + println(); }
+  size_t println() { return write("\r\n"); }
+  // Not format checked: the sketch prints uint32_t with %lu, which is right on the Teensy, where it is unsigned long
+  int printf(const char *format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    write(buffer);
+    return n;
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  size_t readBytes(char *, size_t) { return 0; }
+  void setTimeout(unsigned long) {}
+};
+
+// Serial goes to stderr so the harness can keep stdout for its own reports.  HostSerialQuiet turns it off.
+class usb_serial_class : public Stream {
+public:
+  void begin(long) {}
+  void end() {}
+  using Print::write;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  operator bool() { return true; }
+};
+extern usb_serial_class Serial;
+extern usb_serial_class Serial1;
+extern usb_serial_class SerialUSB1;
+extern bool HostSerialQuiet;
+
+// Arduino String, enough for the debug messages the sketch builds
+class String {
+public:
+  String(const char *s = "") : text(s ? s : "") {}
+  String(const std::string &s) : text(s) {}
+  String(char c) : text(1, c) {}
+  template<class T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+  String(T n, int base = DEC) {
+    char buffer[72];
+    if (base == HEX) snprintf(buffer, sizeof(buffer), "%llX", (unsigned long long)n);
+    else if (std::is_signed<T>::value) snprintf(buffer, sizeof(buffer), "%lld", (long long)n);
+    else snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)n);
+    text = buffer;
+  }
+  String(double n, int digits = 2) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+    text = buffer;
+  }
+  const char *c_str() const { return text.c_str(); }
+  unsigned int length() const { return text.length(); }
+  char charAt(unsigned int i) const { return i < text.length() ? text[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  String &operator+=(const String &s) {
+    text += s.text;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) { return String(a.text + b.text); }
+  friend String operator+(const String &a, const char *b) { return String(a.text + b); }
+  friend String operator+(const char *a, const String &b) { return String(a + b.text); }
+  bool operator==(const String &s) const { return text == s.text; }
+  bool operator!=(const String &s) const { return text != s.text; }
+  int toInt() const { return atoi(text.c_str()); }
+  float toFloat() const { return atof(text.c_str()); }
+  void toCharArray(char *buffer, unsigned int size) const {
+    if (size == 0) return;
+    strncpy(buffer, text.c_str(), size - 1);
+    buffer[size - 1] = 0;
+  }
+  String substring(unsigned int from) const { return from < text.length() ? String(text.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const { return from < text.length() ? String(text.substr(from, to - from)) : String(); }
+  int indexOf(char c) const {
+    size_t i = text.find(c);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  void trim() {
+    size_t a = text.find_first_not_of(" \t\r\n");
+    size_t b = text.find_last_not_of(" \t\r\n");
+    text = (a == std::string::npos) ? "" : text.substr(a, b - a + 1);
+  }
+  std::string text;
+};
+
+inline size_t Print::print(const String &s) {
+  return write(s.c_str());
+}
+
+class elapsedMicros {
+public:
+  elapsedMicros(uint32_t val = 0) { us = micros() - val; }
+  operator uint32_t() const { return micros() - us; }
+  elapsedMicros &operator=(uint32_t val) {
+    us = micros() - val;
+    return *this;
+  }
+private:
+  uint32_t us;
+};
+
+class elapsedMillis {
+public:
+  elapsedMillis(uint32_t val = 0) { ms = millis() - val; }
+  operator uint32_t() const { return millis() - ms; }
+  elapsedMillis &operator=(uint32_t val) {
+    ms = millis() - val;
+    return *this;
+  }
+private:
+  uint32_t ms;
+};
+
+class IntervalTimer {
+public:
+  template<class F, class P>
+  bool begin(F, P) { return true; }
+  void end() {}
+  void priority(uint8_t) {}
+};
+
+// The sketch entry points the host driver calls
+void setup();
+void loop();
+
+#endif
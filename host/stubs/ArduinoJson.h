@@ -0,0 +1,3 @@
+// Host stand-in for ArduinoJson.  JSON.cpp is not built on the host; with no SD card the configuration
+// comes from the defaults in config_t.
+#pragma once
@@ -0,0 +1,98 @@
+// Host stand-in for the Teensy Audio library.  The patch cords and codec controls do nothing.  The record and
+// play queues are real queues of 128 sample blocks, so the harness can feed I/Q into Q_in_L/Q_in_R and collect
+// the audio ProcessIQData() leaves in Q_out_L/Q_out_R.
+#ifndef HOST_AUDIO_H
+#define HOST_AUDIO_H
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706f
+#define AUDIO_SAMPLE_RATE AUDIO_SAMPLE_RATE_EXACT
+#define AUDIO_INPUT_LINEIN 0
+#define AUDIO_INPUT_MIC 1
+
+#define HOST_NOOP(name) \
+  template<class... A> \
+  void name(A...) {}
+
+class AudioStream {
+public:
+  virtual ~AudioStream() {}
+};
+
+class AudioConnection {
+public:
+  AudioConnection() {}
+  AudioConnection(AudioStream &, AudioStream &) {}
+  AudioConnection(AudioStream &, unsigned char, AudioStream &, unsigned char) {}
+  int connect() { return 0; }
+  int disconnect() { return 0; }
+};
+
+inline void AudioMemory(int) {}
+inline void AudioNoInterrupts() {}
+inline void AudioInterrupts() {}
+
+class AudioInputI2SQuad : public AudioStream {};
+class AudioOutputI2SQuad : public AudioStream {};
+
+class AudioMixer4 : public AudioStream {
+public:
+  HOST_NOOP(gain)
+};
+
+class AudioControlSGTL5000 {
+public:
+  bool enable() { return true; }
+  HOST_NOOP(setAddress)
+  HOST_NOOP(inputSelect)
+  HOST_NOOP(volume)
+  HOST_NOOP(micGain)
+  HOST_NOOP(micBiasDisable)
+  HOST_NOOP(micBiasEnable)
+  HOST_NOOP(lineInLevel)
+  HOST_NOOP(lineOutLevel)
+  HOST_NOOP(adcHighPassFilterDisable)
+  HOST_NOOP(adcHighPassFilterEnable)
+  HOST_NOOP(muteHeadphone)
+  HOST_NOOP(unmuteHeadphone)
+  HOST_NOOP(muteLineout)
+  HOST_NOOP(unmuteLineout)
+};
+
+// Blocks waiting for the sketch to read them
+class AudioRecordQueue : public AudioStream {
+public:
+  void begin() { enabled = true; }
+  void end() { enabled = false; }
+  void clear() { blocks.clear(); }
+  int available() { return blocks.size(); }
+  int16_t *readBuffer() { return blocks.empty() ? nullptr : blocks.front().data(); }
+  void freeBuffer() {
+    if (!blocks.empty()) blocks.pop_front();
+  }
+  void HostWrite(const int16_t *samples);  // Append one block, as the I2S input would
+  bool enabled = false;
+  std::deque<std::vector<int16_t>> blocks;
+};
+
+// Blocks the sketch has played, waiting for the harness to collect them
+class AudioPlayQueue : public AudioStream {
+public:
+  enum behaviour_t { ORIGINAL,
+                     NON_STALLING };
+  int16_t *getBuffer();
+  void playBuffer();
+  void play(int16_t data);
+  void play(const int16_t *data, uint32_t len);
+  void setBehaviour(behaviour_t) {}
+  void setMaxBuffers(uint8_t) {}
+  bool HostRead(int16_t *samples);  // Take the oldest played block, false if there is none
+  std::vector<int16_t> pending;
+  std::deque<std::vector<int16_t>> blocks;
+};
+
+#endif
@@ -0,0 +1,28 @@
+// Host stand-in for the Teensy EEPROM, 4284 bytes of RAM that start erased
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+  EEPROMClass() { memset(data, 0xFF, sizeof(data)); }
+  uint8_t read(int address) { return data[address]; }
+  void write(int address, uint8_t value) { data[address] = value; }
+  void update(int address, uint8_t value) { data[address] = value; }
+  template<class T>
+  T &get(int address, T &t) {
+    memcpy((void *)&t, data + address, sizeof(T));
+    return t;
+  }
+  template<class T>
+  const T &put(int address, const T &t) {
+    memcpy(data + address, (const void *)&t, sizeof(T));
+    return t;
+  }
+  uint16_t length() { return sizeof(data); }
+  uint8_t data[4284];
+};
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,4 @@
+// Host stand-in, the font is never drawn.
+#pragma once
+#include <Adafruit_GFX.h>
+const GFXfont FreeMono24pt7b = { nullptr, nullptr, 0x20, 0x7E, 24 };
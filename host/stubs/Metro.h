@@ -0,0 +1,24 @@
+// Host stand-in for Metro, on the host clock
+#ifndef HOST_METRO_H
+#define HOST_METRO_H
+
+#include <Arduino.h>
+
+class Metro {
+public:
+  Metro(unsigned long interval) : period(interval), previous(millis()) {}
+  bool check() {
+    if (millis() - previous >= period) {
+      previous = millis();
+      return true;
+    }
+    return false;
+  }
+  void interval(unsigned long value) { period = value; }
+  void reset() { previous = millis(); }
+private:
+  unsigned long period;
+  unsigned long previous;
+};
+
+#endif
@@ -0,0 +1,42 @@
+// Host stand-in for the OpenAudio F32 library.  Only the microphone compressor chain uses it, and on the
+// host the chain is never fed.
+#ifndef HOST_OPENAUDIO_H
+#define HOST_OPENAUDIO_H
+
+#include <Audio.h>
+
+class AudioStream_F32 : public AudioStream {};
+
+class AudioConnection_F32 {
+public:
+  AudioConnection_F32(AudioStream &, unsigned char, AudioStream &, unsigned char) {}
+  int connect() { return 0; }
+  int disconnect() { return 0; }
+};
+
+inline void AudioMemory_F32(int) {}
+
+class AudioConvert_I16toF32 : public AudioStream_F32 {};
+class AudioConvert_F32toI16 : public AudioStream_F32 {};
+
+class AudioEffectGain_F32 : public AudioStream_F32 {
+public:
+  HOST_NOOP(setGain)
+  HOST_NOOP(setGain_dB)
+};
+
+class AudioEffectCompressor_F32 : public AudioStream_F32 {
+public:
+  HOST_NOOP(setSampleRate_Hz)
+  HOST_NOOP(setPreGain)
+  HOST_NOOP(setPreGain_dB)
+  HOST_NOOP(enableHPFilter)
+  HOST_NOOP(setThresh_dBFS)
+  HOST_NOOP(setCompressionRatio)
+  HOST_NOOP(setAttack_sec)
+  HOST_NOOP(setRelease_sec)
+};
+
+class AudioControlSGTL5000_Extended : public AudioControlSGTL5000 {};
+
+#endif
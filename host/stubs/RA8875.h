@@ -0,0 +1,85 @@
+// Host stand-in for the RA8875 display driver.  Drawing does nothing, and the controller is never busy.
+#ifndef HOST_RA8875_H
+#define HOST_RA8875_H
+
+#include <Adafruit_GFX.h>
+
+#define RA8875_BLACK 0x0000
+#define RA8875_RED 0xF800
+#define RA8875_GREEN 0x07E0
+#define RA8875_CYAN 0x07FF
+#define RA8875_MAGENTA 0xF81F
+#define RA8875_YELLOW 0xFFE0
+#define RA8875_WHITE 0xFFFF
+#define RA8875_LIGHT_GREY 0xC618
+#define RA8875_LIGHT_ORANGE 0xFD20
+#define RA8875_GREENYELLOW 0xAFE5
+
+enum RA8875sizes { RA8875_480x272,
+                   RA8875_800x480 };
+enum RA8875tsize { X16 = 0,
+                   X24,
+                   X32 };
+enum RA8875writes { L1 = 0,
+                    L2,
+                    CGRAM,
+                    PATTERN,
+                    CURSOR };
+enum RA8875boolean { LAYER1,
+                     LAYER2,
+                     TRANSPARENT,
+                     LIGHTEN,
+                     OR,
+                     AND,
+                     FLOATING };
+
+class RA8875 : public Print {
+public:
+  RA8875(uint8_t, uint8_t = 255, uint8_t = 11, uint8_t = 13, uint8_t = 12) {}
+  using Print::write;
+  size_t write(uint8_t) override { return 1; }
+  int16_t width() const { return 800; }
+  int16_t height() const { return 480; }
+  uint8_t getFontWidth(bool = false) { return 8; }
+  uint8_t getFontHeight(bool = false) { return 16; }
+  uint16_t Color565(uint8_t r, uint8_t g, uint8_t b) { return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
+  uint8_t readStatus() { return 0; }
+  uint8_t getINTC2() { return 0; }
+  bool DMAFinished() { return true; }
+  uint8_t KeypadGetKey() { return 0; }
+  HOST_NOOP(begin)
+  HOST_NOOP(BTE_move)
+  HOST_NOOP(Color565ToRGB)
+  HOST_NOOP(clearMemory)
+  HOST_NOOP(clearScreen)
+  HOST_NOOP(drawCircle)
+  HOST_NOOP(drawFastHLine)
+  HOST_NOOP(drawFastVLine)
+  HOST_NOOP(drawLine)
+  HOST_NOOP(drawLineAngle)
+  HOST_NOOP(drawPixel)
+  HOST_NOOP(drawPixels)
+  HOST_NOOP(drawRect)
+  HOST_NOOP(endSend)
+  HOST_NOOP(fillCircle)
+  HOST_NOOP(fillRect)
+  HOST_NOOP(fillWindow)
+  HOST_NOOP(KeypadInit)
+  HOST_NOOP(layerEffect)
+  HOST_NOOP(putPicture_16bpp)
+  HOST_NOOP(SetKeyMap)
+  HOST_NOOP(setCursor)
+  HOST_NOOP(setFont)
+  HOST_NOOP(setFontDefault)
+  HOST_NOOP(setFontScale)
+  HOST_NOOP(setForegroundColor)
+  HOST_NOOP(setRotation)
+  HOST_NOOP(setTextColor)
+  HOST_NOOP(startSend)
+  HOST_NOOP(useCanvas)
+  HOST_NOOP(useLayers)
+  HOST_NOOP(writeRect)
+  HOST_NOOP(writeTo)
+};
+
+#endif
@@ -0,0 +1,37 @@
+// Host stand-in for the SD library.  There is no card.
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include <Arduino.h>
+
+#define BUILTIN_SDCARD 254
+#define FILE_READ 0
+#define FILE_WRITE 1
+
+class File : public Stream {
+public:
+  using Print::write;
+  size_t write(uint8_t) override { return 0; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(void *, size_t) { return 0; }
+  bool seek(uint32_t) { return false; }
+  uint32_t position() { return 0; }
+  uint32_t size() { return 0; }
+  void close() {}
+  bool isDirectory() { return false; }
+  const char *name() { return ""; }
+  File openNextFile() { return File(); }
+  operator bool() const { return false; }
+};
+
+class SDClass {
+public:
+  bool begin(uint8_t) { return false; }
+  File open(const char *, uint8_t = FILE_READ) { return File(); }
+  bool exists(const char *) { return false; }
+  bool remove(const char *) { return false; }
+};
+extern SDClass SD;
+
+#endif
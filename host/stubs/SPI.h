@@ -0,0 +1,10 @@
+// Host stand-in for SPI
+#pragma once
+#include <Arduino.h>
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+
+class SPISettings {
+public:
+  SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
@@ -0,0 +1,33 @@
+// Host stand-in for the Teensy Time library, running from the host clock.
+#ifndef HOST_TIMELIB_H
+#define HOST_TIMELIB_H
+
+#include <Arduino.h>
+#include <time.h>
+
+typedef time_t (*getExternalTime)();
+inline void setSyncProvider(getExternalTime) {}
+inline time_t now() { return time(nullptr); }
+inline void setTime(time_t) {}
+inline struct tm HostLocalTime() {
+  time_t t = now();
+  struct tm result;
+  localtime_r(&t, &result);
+  return result;
+}
+inline int hour() { return HostLocalTime().tm_hour; }
+inline int hourFormat12() { return (hour() + 11) % 12 + 1; }
+inline int minute() { return HostLocalTime().tm_min; }
+inline int second() { return HostLocalTime().tm_sec; }
+inline int day() { return HostLocalTime().tm_mday; }
+inline int month() { return HostLocalTime().tm_mon + 1; }
+inline int year() { return HostLocalTime().tm_year + 1900; }
+
+class teensy3_clock_class {
+public:
+  unsigned long get() { return time(nullptr); }
+  void set(unsigned long) {}
+};
+extern teensy3_clock_class Teensy3Clock;
+
+#endif
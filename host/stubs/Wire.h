@@ -0,0 +1,24 @@
+// Host stand-in for the I2C library.  Nothing answers, so the sketch finds no front panel.
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire : public Stream {
+public:
+  void begin() {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t) {}
+  uint8_t endTransmission(bool = true) { return 2; }  // Address not acknowledged
+  uint8_t requestFrom(uint8_t, uint8_t, bool = true) { return 0; }
+  using Print::write;
+  size_t write(uint8_t) override { return 1; }
+  size_t write(int n) { return write((uint8_t)n); }
+  size_t write(unsigned int n) { return write((uint8_t)n); }
+  size_t write(long n) { return write((uint8_t)n); }
+  size_t write(unsigned long n) { return write((uint8_t)n); }
+};
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,37 @@
+// Host stand-in for the Si5351 synthesizer driver
+#ifndef HOST_SI5351_H
+#define HOST_SI5351_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+#define SI5351_FREQ_MULT 100ULL
+#define SI5351_CRYSTAL_LOAD_10PF (3 << 6)
+
+enum si5351_clock { SI5351_CLK0,
+                    SI5351_CLK1,
+                    SI5351_CLK2 };
+enum si5351_pll { SI5351_PLLA,
+                  SI5351_PLLB };
+enum si5351_drive { SI5351_DRIVE_2MA,
+                    SI5351_DRIVE_4MA,
+                    SI5351_DRIVE_6MA,
+                    SI5351_DRIVE_8MA };
+enum si5351_pll_input { SI5351_PLL_INPUT_XO,
+                        SI5351_PLL_INPUT_CLKIN };
+
+class Si5351 {
+public:
+  bool init(uint8_t, uint32_t, int32_t) { return true; }
+  uint8_t set_freq(uint64_t, enum si5351_clock) { return 0; }
+  HOST_NOOP(reset)
+  HOST_NOOP(set_ms_source)
+  HOST_NOOP(drive_strength)
+  HOST_NOOP(output_enable)
+  HOST_NOOP(set_correction)
+  HOST_NOOP(set_phase)
+  HOST_NOOP(pll_reset)
+  HOST_NOOP(set_freq_manual)
+};
+
+#endif
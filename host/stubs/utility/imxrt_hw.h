@@ -0,0 +1,4 @@
+// Host stand-in for the i.MX RT audio clock helper
+#pragma once
+#include <Arduino.h>
+inline void set_audioClock(int, int, uint32_t, bool = false) {}
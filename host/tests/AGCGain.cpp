@@ -0,0 +1,116 @@
+// The sub-block AGC gain, AGCApplyGain(), against the per-sample gain law that agcPerSampleGain selects.  AGC() runs
+// a strong carrier step and a fading carrier in each AGC speed, once per mode from the same state.  volts does not
+// depend on the gain, so the ratio of the two outputs is the ratio of each sample's ramped gain to AGCGain(volts).
+// The worst case must stay within AGC_GAIN_RAMP_RATIO, and the time per block of each mode is printed.
+#include "HostTest.h"
+
+#define AGC_TEST_SECONDS 6  // Length of each test signal
+
+/*****
+  Purpose: Clear the AGC ring and detector, as at power up, and load the AGC speed.
+
+  Parameter list:
+    void
+
+  Return value:
+    void
+*****/
+static void AGCClear() {
+  memset(ring, 0, RB_SIZE * 2 * sizeof(float32_t));
+  memset(abs_ring, 0, RB_SIZE * sizeof(float32_t));
+  volts = save_volts = 0.0;
+  fast_backaverage = hang_backaverage = 0.0;
+  state = 0;
+  hang_counter = 0;
+  out_index = -1;
+  AGCLoadValues();
+}
+
+/*****
+  Purpose: Carrier envelope for the test signals.
+
+  Parameter list:
+    int signal          0 for the step, 1 for fading
+    float32_t t         time in seconds
+
+  Return value:
+    float32_t           carrier amplitude
+*****/
+static float32_t AGCEnvelope(int signal, float32_t t) {
+  if (signal == 0) {
+    return (t >= 1.0 && t < 3.0) ? 0.5 : 0.0001;  // 74 dB up for two seconds, then back down
+  }
+  // 30 dB fades at 0.7 Hz with 6 dB flutter at 9 Hz
+  return 0.3 * powf(10.0, (-15.0 * (1.0 + sinf(TWO_PI * 0.7 * t)) - 3.0 * (1.0 + sinf(TWO_PI * 9.0 * t))) / 20.0);
+}
+
+/*****
+  Purpose: Run one test signal through AGC() in one gain mode.
+
+  Parameter list:
+    int signal                  0 for the step, 1 for fading
+    bool perSample              agcPerSampleGain for the run
+    std::vector<float32_t> &out the AGC output, interleaved I/Q
+    double *time                time per block, microseconds
+
+  Return value:
+    void
+*****/
+static void AGCRun(int signal, bool perSample, std::vector<float32_t> &out, double *time) {
+  const int blockSize = FFT_length / 2;
+  const int blocks = AGC_TEST_SECONDS * decimatedRate / blockSize;
+  float32_t envelope, phase = 0.0;
+  double start, total = 0.0;
+
+  agcPerSampleGain = perSample;
+  AGCClear();
+  out.resize(2 * blocks * blockSize);
+  for (int block = 0; block < blocks; block++) {
+    for (int i = 0; i < blockSize; i++) {
+      envelope = AGCEnvelope(signal, (float32_t)(block * blockSize + i) / decimatedRate);
+      iFFT_buffer[FFT_length + 2 * i] = envelope * cosf(phase);
+      iFFT_buffer[FFT_length + 2 * i + 1] = envelope * sinf(phase);
+      phase = fmodf(phase + TWO_PI * 700.0 / decimatedRate, TWO_PI);
+    }
+    start = HostMicros();
+    AGC();
+    total += HostMicros() - start;
+    memcpy(&out[2 * block * blockSize], &iFFT_buffer[FFT_length], 2 * blockSize * sizeof(float32_t));
+  }
+  *time = total / blocks;
+}
+
+int main() {
+  const char *signals[] = { "carrier step", "fading carrier" };
+  const char *speeds[] = { "", "long", "slow", "medium", "fast" };
+  std::vector<float32_t> ramped, exact;
+  double rampTime, exactTime, rampTotal = 0.0, exactTotal = 0.0, error, worst, level;
+  int runs = 0;
+
+  HostReceiverStart(192000);
+
+  for (int speed = 1; speed <= 4; speed++) {
+    EEPROMData.AGCMode = speed;
+    for (int signal = 0; signal < 2; signal++) {
+      AGCRun(signal, true, exact, &exactTime);
+      AGCRun(signal, false, ramped, &rampTime);
+      exactTotal += exactTime;
+      rampTotal += rampTime;
+      runs++;
+      worst = 0.0;
+      for (size_t i = 0; i < exact.size(); i += 2) {
+        level = hypot(exact[i], exact[i + 1]);
+        if (level < 1.0e-6) continue;  // Before the first samples leave the look-ahead
+        error = fabs(hypot(ramped[i], ramped[i + 1]) / level - 1.0);
+        worst = fmax(worst, error);
+      }
+      HostCheck(worst < AGC_GAIN_RAMP_RATIO - 1.0, "AGC %s, %s, worst gain error against the per-sample law %.2g", speeds[speed],
+                signals[signal], worst);
+    }
+  }
+  printf("AGC, %u samples: gain per %d sample sub-block %.1f us/block, per sample %.1f us/block\n", FFT_length / 2,
+         AGC_GAIN_SUBBLOCK, rampTotal / runs, exactTotal / runs);
+
+  agcPerSampleGain = false;
+  return hostTestFailures;
+}
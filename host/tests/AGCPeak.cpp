@@ -0,0 +1,126 @@
+// The sliding window AGC peak detector, AGCPeakUpdate(), against the original detector that rescans the look-ahead
+// window, kept here as AGCPeakRescan().  Both run on a carrier with a slowly falling envelope, which keeps the peak
+// leaving the window and is the worst case for the rescan, and on noise bursts.  Every ring_max must match, and the
+// time per block of each on the falling carrier is printed.
+#include "HostTest.h"
+
+/*****
+  Purpose: The original AGC peak detector.  Rescans the whole look-ahead window whenever the sample leaving it could
+           have been the maximum.
+
+  Parameter list:
+    float32_t abs_out_sample    magnitude of the sample leaving the window
+    float32_t *peak             ring_max of the rescan, carried from sample to sample
+
+  Return value:
+    void
+*****/
+static void AGCPeakRescan(float32_t abs_out_sample, float32_t *peak) {
+  int k;
+
+  if ((abs_out_sample >= *peak) && (abs_out_sample > 0.0)) {
+    *peak = 0.0;
+    k = out_index;
+    for (int j = 0; j < attack_buffsize; j++) {
+      if (++k == (int)ring_buffsize)
+        k = 0;
+      if (abs_ring[k] > *peak)
+        *peak = abs_ring[k];
+    }
+  }
+  if (abs_ring[in_index] > *peak)
+    *peak = abs_ring[in_index];
+}
+
+/*****
+  Purpose: Run the AGC ring over the samples the way AGC() does, with one of the two detectors.
+
+  Parameter list:
+    const std::vector<float32_t> &magnitude   sample magnitudes
+    bool rescan                               true for AGCPeakRescan(), false for AGCPeakUpdate()
+    std::vector<float32_t> &peaks             ring_max after each sample
+
+  Return value:
+    double                                    time taken, microseconds
+*****/
+static double AGCPeakPass(const std::vector<float32_t> &magnitude, bool rescan, std::vector<float32_t> &peaks) {
+  float32_t abs_out_sample, rescanMax = 0.0;
+  double start;
+
+  memset(abs_ring, 0, RB_SIZE * sizeof(float32_t));
+  out_index = -1;
+  AGCLoadValues();
+  peaks.resize(magnitude.size());
+
+  start = HostMicros();
+  for (size_t i = 0; i < magnitude.size(); i++) {
+    if (++out_index >= (int)ring_buffsize)
+      out_index -= ring_buffsize;
+    if (++in_index >= ring_buffsize)
+      in_index -= ring_buffsize;
+    abs_out_sample = abs_ring[out_index];
+    abs_ring[in_index] = magnitude[i];
+    if (rescan) {
+      AGCPeakRescan(abs_out_sample, &rescanMax);
+      peaks[i] = rescanMax;
+    } else {
+      AGCPeakUpdate();
+      peaks[i] = ring_max;
+    }
+  }
+  return HostMicros() - start;
+}
+
+/*****
+  Purpose: Run both detectors on the same signal and compare every ring_max.
+
+  Parameter list:
+    int signal              0 for the falling carrier, 1 for noise bursts
+    double *updateTime      time per block of AGCPeakUpdate(), microseconds
+    double *rescanTime      time per block of AGCPeakRescan()
+
+  Return value:
+    int                     samples where the two ring_max differ
+*****/
+static int AGCPeakRun(int signal, double *updateTime, double *rescanTime) {
+  const int blocks = 64;
+  std::vector<float32_t> magnitude(blocks * FFT_length / 2), updatePeaks, rescanPeaks;
+  float32_t envelope = 1.0, phase = 0.0, I, Q;
+  uint32_t seed = 1;
+  int mismatches = 0;
+
+  for (size_t i = 0; i < magnitude.size(); i++) {
+    if (signal == 0) {
+      I = envelope * cosf(phase);
+      Q = envelope * sinf(phase);
+      envelope *= 0.99999;
+      phase = fmodf(phase + TWO_PI * 1000.0 / decimatedRate, TWO_PI);
+    } else {
+      envelope = ((i / 300) % 3 == 0) ? 0.5 : 0.01;  // 300 sample bursts, 600 samples apart
+      I = envelope * HostNoise(&seed);
+      Q = envelope * HostNoise(&seed);
+    }
+    magnitude[i] = sqrtf(I * I + Q * Q);
+  }
+  *rescanTime = AGCPeakPass(magnitude, true, rescanPeaks) / blocks;
+  *updateTime = AGCPeakPass(magnitude, false, updatePeaks) / blocks;
+  for (size_t i = 0; i < magnitude.size(); i++) {
+    if (updatePeaks[i] != rescanPeaks[i]) mismatches++;
+  }
+  return mismatches;
+}
+
+int main() {
+  double updateTime, rescanTime;
+  int mismatches;
+
+  HostReceiverStart(192000);
+
+  mismatches = AGCPeakRun(0, &updateTime, &rescanTime);
+  HostCheck(mismatches == 0, "AGC peak, falling carrier, %d sample window, %d mismatches", attack_buffsize, mismatches);
+  printf("  sliding window %.1f us/block, rescan %.1f us/block\n", updateTime, rescanTime);
+  mismatches = AGCPeakRun(1, &updateTime, &rescanTime);
+  HostCheck(mismatches == 0, "AGC peak, noise bursts, %d sample window, %d mismatches", attack_buffsize, mismatches);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,151 @@
+// The CW receive chain, DoCWReceiveProcessing(), on a corpus of keyed messages at 15 to 35 WPM.  The audio is made
+// here: the CW offset tone with shaped key edges, fading, and white noise in both channels, with a fixed noise seed,
+// so the results are the same every run.  The fading is up to 6 dB, what the AGC leaves of a deeper fade, since the
+// lock threshold of CWDetect() is a fixed level.  The decoder starts from ResetHistograms() for each message and learns
+// the speed from the preamble, and each message must decode to the text sent.  The time per block of the chain is
+// printed.
+#include "HostTest.h"
+
+#define CW_DECODE_TEST_PREAMBLE "VVV VVV "  // Sent before each message, for the decoder to learn the speed
+#define CW_DECODE_TEST_LEVEL 0.05           // Tone amplitude, before fading
+#define CW_DECODE_TEST_RISE 5.0             // Key edge rise and fall time, ms
+
+struct cwDecodeTest_t {
+  int wpm;
+  float32_t snr;     // Tone to noise power in each channel, over the whole decimatedRate / 2 bandwidth, dB
+  float32_t fade;    // Depth of the fading, dB
+  float32_t fadeHz;  // Rate of the fading
+  const char *text;  // Sent after CW_DECODE_TEST_PREAMBLE, and expected at the end of the decoded text
+};
+
+const struct cwDecodeTest_t cwDecodeTests[] = {
+  { 15, 20.0, 0.0, 0.0, "CQ CQ DE W1AW K" },
+  { 18, 10.0, 6.0, 0.3, "UR RST 579 579" },
+  { 20, 5.0, 0.0, 0.0, "5NN TU" },
+  { 25, 10.0, 6.0, 0.5, "TEST K3LR K3LR" },
+  { 30, 15.0, 6.0, 1.0, "73 ES GL" },
+  { 35, 10.0, 3.0, 0.2, "QRZ? DE N0AX" },
+};
+
+static uint32_t cwTestSeed = 1;
+static uint32_t cwTestSample = 0;       // Samples sent, the tone and fading phase
+static float32_t cwTestEnvelope = 0.0;  // Key edge, 0 to 1
+static uint32_t cwTestFill = 0;         // Samples in float_buffer_L and float_buffer_R
+static double cwTestTime = 0.0;         // Time in DoCWReceiveProcessing(), microseconds
+static int cwTestBlocks = 0;
+
+/*****
+  Purpose: Find the dits and dahs of a character by walking bigMorseCodeTree the way DoCWDecoding() does.
+
+  Parameter list:
+    char c              the character to send
+    int index           tree position so far
+    int jump            dah step at this depth
+    char *elements      '.' and '-' so far, and the result
+    int depth           elements so far
+
+  Return value:
+    bool                true if found
+*****/
+static bool CWTestEncode(char c, int index, int jump, char *elements, int depth) {
+  if (depth > 0 && bigMorseCodeTree[index] == c) {
+    elements[depth] = '\0';
+    return true;
+  }
+  jump = jump >> 1;
+  if (jump == 0) {
+    return false;
+  }
+  elements[depth] = '.';
+  if (CWTestEncode(c, index + 1, jump, elements, depth + 1)) return true;
+  elements[depth] = '-';
+  return CWTestEncode(c, index + jump, jump, elements, depth + 1);
+}
+
+/*****
+  Purpose: Send keyed audio through the CW receive chain for a time, a 256 sample block at a time the way
+           ProcessIQData() calls DoCWReceiveProcessing().  The key edges are raised cosine, CW_DECODE_TEST_RISE long,
+           and the fading is a sine in dB, 0 down to test->fade.
+
+  Parameter list:
+    const struct cwDecodeTest_t *test   the SNR and fading
+    int key                             1 for key down
+    float32_t ms                        how long
+    float32_t *keyTime                  time keyed so far, ms, carried from call to call
+
+  Return value:
+    void
+*****/
+static void CWTestKey(const struct cwDecodeTest_t *test, int key, float32_t ms, float32_t *keyTime) {
+  const float freq[4] = { 562.5, 656.5, 750.0, 843.75 };
+  float32_t noiseLevel = CW_DECODE_TEST_LEVEL / sqrtf(2.0) / powf(10.0, test->snr / 20.0);
+  float32_t step = 1000.0 / (CW_DECODE_TEST_RISE * decimatedRate);
+  float32_t tone;
+  double t, start;
+
+  *keyTime += ms;
+  while (cwTestSample * 1000.0 / decimatedRate < *keyTime) {
+    t = (double)cwTestSample / decimatedRate;
+    cwTestEnvelope = key ? fminf(cwTestEnvelope + step, 1.0) : fmaxf(cwTestEnvelope - step, 0.0);
+    tone = CW_DECODE_TEST_LEVEL * (0.5 - 0.5 * cosf(PI * cwTestEnvelope))
+           * powf(10.0, -test->fade * (0.5 - 0.5 * cos(TWO_PI * test->fadeHz * t)) / 20.0)
+           * sin(TWO_PI * freq[EEPROMData.CWOffset] * t);
+    float_buffer_L[cwTestFill] = tone + noiseLevel * HostNoise(&cwTestSeed);
+    float_buffer_R[cwTestFill] = tone + noiseLevel * HostNoise(&cwTestSeed);
+    cwTestSample++;
+    if (++cwTestFill == 256) {
+      start = HostMicros();
+      DoCWReceiveProcessing();
+      cwTestTime += HostMicros() - start;
+      cwTestBlocks++;
+      cwTestFill = 0;
+    }
+  }
+}
+
+int main() {
+  char message[64];
+  char elements[8];
+  char decoded[MAX_DECODE_CHARS + 1];
+  float32_t dit, keyTime;
+  size_t length, expected;
+
+  HostReceiverStart(192000);
+  CWDetectPrep();
+  EEPROMData.decoderFlag = DECODE_ON;
+
+  for (const cwDecodeTest_t &test : cwDecodeTests) {
+    ResetHistograms();
+    MorseCharacterClear();
+    keyTime = cwTestSample * 1000.0 / decimatedRate;
+    dit = 1200.0 / test.wpm;
+
+    snprintf(message, sizeof(message), "%s%s", CW_DECODE_TEST_PREAMBLE, test.text);
+    for (char *c = message; *c; c++) {
+      if (*c == ' ') {
+        CWTestKey(&test, 0, 4.0 * dit, &keyTime);  // With the letter space, 7 dits
+        continue;
+      }
+      if (!CWTestEncode(*c, 0, DECODER_BUFFER_SIZE, elements, 0)) {
+        continue;
+      }
+      for (char *e = elements; *e; e++) {
+        CWTestKey(&test, 1, (*e == '.' ? 1.0 : 3.0) * dit, &keyTime);
+        CWTestKey(&test, 0, dit, &keyTime);
+      }
+      CWTestKey(&test, 0, 2.0 * dit, &keyTime);  // With the element space, 3 dits
+    }
+    CWTestKey(&test, 0, 10.0 * dit, &keyTime);  // Let the last character and word out
+
+    strcpy(decoded, decodeBuffer);
+    for (length = strlen(decoded); length > 0 && decoded[length - 1] == ' '; length--)
+      ;
+    decoded[length] = '\0';
+    expected = strlen(test.text);
+    HostCheck(length >= expected && strcmp(&decoded[length - expected], test.text) == 0, "CW decode %2d WPM, %4.1f dB SNR, %4.1f dB fading, sent \"%s\" decoded \"%s\"",
+              test.wpm, test.snr, test.fade, test.text, decoded);
+  }
+  printf("CW receive chain %.1f us/block\n", cwTestTime / cwTestBlocks);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,100 @@
+// The CW decoder's tone detector, CWDetect(), on the CW offset tone keyed 5 blocks down and 5 blocks up in white
+// noise.  From -5 dB SNR up it must lock on at least 90% of the key down blocks, and at every SNR it must stay off
+// on at least 90% of the key up blocks.  Every block is also run through the original time domain detector, kept
+// here as CWDetectReference(), and the two must agree.  The time per block of each is printed.
+#include "HostTest.h"
+
+#define CW_DETECT_TEST_LEVEL 0.05  // Tone amplitude
+#define CW_DETECT_TOLERANCE 1.0e-3  // Allowed difference from the reference, relative to the lock threshold of 50
+
+static uint32_t seed = 1;
+
+/*****
+  Purpose: Fill float_buffer_L_CW and float_buffer_R_CW with one block of the CW offset tone in white noise.
+
+  Parameter list:
+    bool keyDown          true to include the tone
+    float32_t noiseLevel  RMS noise in each channel
+    uint32_t *phase       sample counter, carried from block to block
+
+  Return value:
+    void
+*****/
+static void CWDetectTestBlock(bool keyDown, float32_t noiseLevel, uint32_t *phase) {
+  const float freq[4] = { 562.5, 656.5, 750.0, 843.75 };
+  float32_t tone;
+
+  for (int i = 0; i < 256; i++, (*phase)++) {
+    tone = keyDown ? CW_DETECT_TEST_LEVEL * sinf(TWO_PI * freq[EEPROMData.CWOffset] * (*phase) / decimatedRate) : 0.0;
+    float_buffer_L_CW[i] = tone + noiseLevel * HostNoise(&seed);
+    float_buffer_R_CW[i] = tone + noiseLevel * HostNoise(&seed);
+  }
+}
+
+/*****
+  Purpose: CW tone detector, the original time domain version, with two 256 x 256 point correlations and two
+           Goertzel filters.  The running averages it kept are not part of the result and are left out.
+
+  Parameter list:
+    void
+
+  Return value:
+    float32_t      the combined correlation and Goertzel coefficient, the lock threshold is 50
+*****/
+static float32_t CWDetectReference() {
+  static float32_t corrBufferL[511], corrBufferR[511];
+  float32_t corrL, corrR;
+  uint32_t index;
+  float goertzelMagnitude1;
+  float goertzelMagnitude2;
+  float freq[4] = { 562.5, 656.5, 750.0, 843.75 };  // User selectable CW offset frequencies.
+
+  arm_correlate_f32(float_buffer_R_CW, 256, sinBuffer, 256, corrBufferR);
+  arm_max_f32(corrBufferR, 511, &corrR, &index);
+  arm_correlate_f32(float_buffer_L_CW, 256, sinBuffer, 256, corrBufferL);
+  arm_max_f32(corrBufferL, 511, &corrL, &index);
+  goertzelMagnitude1 = goertzel_mag(256, freq[EEPROMData.CWOffset], (int)decimatedRate, float_buffer_L_CW);  //AFP 10-25-22
+  goertzelMagnitude2 = goertzel_mag(256, freq[EEPROMData.CWOffset], (int)decimatedRate, float_buffer_R_CW);  //AFP 10-25-22
+  return 10 * (corrR + corrL) / 2 * 100 * (goertzelMagnitude1 + goertzelMagnitude2) / 2;
+}
+
+int main() {
+  const int blocks = 400;                                         // About 4 seconds at each SNR
+  const float32_t snr[] = { -10.0, -5.0, 0.0, 5.0, 10.0, 20.0 };  // Tone power to noise power in 12 kHz, dB
+  float32_t noiseLevel, detected, falseDetected, coeff, referenceCoeff, worstError = 0.0;
+  uint32_t phase;
+  double start, time = 0.0, referenceTime = 0.0;
+  int timedBlocks = 0;
+
+  HostReceiverStart(192000);
+  CWDetectPrep();
+
+  for (unsigned s = 0; s < sizeof(snr) / sizeof(snr[0]); s++) {
+    noiseLevel = CW_DETECT_TEST_LEVEL / sqrtf(2.0) / powf(10.0, snr[s] / 20.0);
+    detected = falseDetected = 0.0;
+    phase = 0;
+    aveCorrResultL = aveCorrResultR = 0.0;
+    for (int block = 0; block < blocks; block++) {
+      CWDetectTestBlock((block / 5) % 2 == 0, noiseLevel, &phase);
+      start = HostMicros();
+      coeff = CWDetect();
+      time += HostMicros() - start;
+      start = HostMicros();
+      referenceCoeff = CWDetectReference();
+      referenceTime += HostMicros() - start;
+      timedBlocks++;
+      worstError = fmaxf(worstError, fabsf(coeff - referenceCoeff) / 50.0);
+      if (coeff > 50) {
+        if ((block / 5) % 2 == 0) detected += 200.0 / blocks;
+        else falseDetected += 200.0 / blocks;
+      }
+    }
+    HostCheck((snr[s] < -5.0 || detected >= 90.0) && falseDetected <= 10.0, "CW detect, %+4.0f dB SNR, %5.1f%% detected, %4.1f%% false",
+              snr[s], detected, falseDetected);
+  }
+  HostCheck(worstError <= CW_DETECT_TOLERANCE, "CW detect against the time domain detector, worst error %.2g of the threshold",
+            worstError);
+  printf("  FFT detector %.1f us/block, time domain detector %.1f us/block\n", time / timedBlocks, referenceTime / timedBlocks);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,196 @@
+// The polyphase receive decimators, PolyphaseDecimate(), against the original arm_fir_decimate_f32() stages that
+// DECIMATE_REFERENCE selects.  With the same filters both run on the same I/Q noise at 192K and at 96K, the rates
+// with two stages, and must agree to float rounding.  For the A/B of passband ripple, each chain then gets its own
+// design as SetDecIntFilters() makes it, the bucket design for the polyphase chain and the exact bandwidth for the
+// reference, and a swept tone measures the ripple of each.  The time per block of each is printed.
+#include "HostTest.h"
+
+#define DECIMATE_TOLERANCE 1.0e-5     // Allowed difference, relative to the largest reference sample
+#define DECIMATE_RIPPLE_SPAN 0.8      // Ripple is measured from DC to this fraction of the bandwidth
+#define DECIMATE_RIPPLE_STEPS 20      // Tones in the ripple sweep
+#define DECIMATE_RIPPLE_MARGIN 0.1    // dB the polyphase ripple may exceed the reference ripple by
+
+static uint32_t seed = 1;
+
+// The original decimators, two arm_fir_decimate_f32() stages for each of I and Q
+struct referenceChain_t {
+  float32_t coeffs1[DECIMATE_MAX_TAPS];
+  float32_t coeffs2[DECIMATE_MAX_TAPS];
+  std::vector<float32_t> state1I, state1Q, state2I, state2Q;
+  arm_fir_decimate_instance_f32 dec1I, dec1Q, dec2I, dec2Q;
+};
+
+/*****
+  Purpose: Set up the reference chain with the given coefficients and cleared state.
+
+  Parameter list:
+    referenceChain_t *chain       the chain
+    const float32_t *coeffs1      first stage design, decimator1.numTaps taps
+    const float32_t *coeffs2      second stage design, decimator2.numTaps taps
+
+  Return value:
+    void
+*****/
+static void ReferenceInit(referenceChain_t *chain, const float32_t *coeffs1, const float32_t *coeffs2) {
+  const uint32_t blockSize = BUFFER_SIZE * N_BLOCKS;
+
+  memcpy(chain->coeffs1, coeffs1, decimator1.numTaps * sizeof(float32_t));
+  memcpy(chain->coeffs2, coeffs2, decimator2.numTaps * sizeof(float32_t));
+  chain->state1I.assign(decimator1.numTaps + blockSize - 1, 0.0);
+  chain->state1Q.assign(decimator1.numTaps + blockSize - 1, 0.0);
+  chain->state2I.assign(decimator2.numTaps + blockSize - 1, 0.0);
+  chain->state2Q.assign(decimator2.numTaps + blockSize - 1, 0.0);
+  arm_fir_decimate_init_f32(&chain->dec1I, decimator1.numTaps, decimator1.factor, chain->coeffs1, chain->state1I.data(), decimator1.blockSize);
+  arm_fir_decimate_init_f32(&chain->dec1Q, decimator1.numTaps, decimator1.factor, chain->coeffs1, chain->state1Q.data(), decimator1.blockSize);
+  arm_fir_decimate_init_f32(&chain->dec2I, decimator2.numTaps, decimator2.factor, chain->coeffs2, chain->state2I.data(), decimator2.blockSize);
+  arm_fir_decimate_init_f32(&chain->dec2Q, decimator2.numTaps, decimator2.factor, chain->coeffs2, chain->state2Q.data(), decimator2.blockSize);
+}
+
+// One block through the reference chain, in place, as ProcessIQData() did it
+static void ReferenceDecimate(referenceChain_t *chain, float32_t *I, float32_t *Q) {
+  arm_fir_decimate_f32(&chain->dec1I, I, I, decimator1.blockSize);
+  arm_fir_decimate_f32(&chain->dec1Q, Q, Q, decimator1.blockSize);
+  arm_fir_decimate_f32(&chain->dec2I, I, I, decimator2.blockSize);
+  arm_fir_decimate_f32(&chain->dec2Q, Q, Q, decimator2.blockSize);
+}
+
+// Clear the polyphase decimator state
+static void PolyphaseClear() {
+  memset(decimator1.stateI, 0, (decimator1.numTaps - 1) * sizeof(float32_t));
+  memset(decimator1.stateQ, 0, (decimator1.numTaps - 1) * sizeof(float32_t));
+  memset(decimator2.stateI, 0, (decimator2.numTaps - 1) * sizeof(float32_t));
+  memset(decimator2.stateQ, 0, (decimator2.numTaps - 1) * sizeof(float32_t));
+}
+
+/*****
+  Purpose: Run one front end rate through both decimator chains with the same filters, check they agree, and
+           print the time per block of each.
+
+  Parameter list:
+    const char *name      rate, for the report
+
+  Return value:
+    void
+*****/
+static void DecimateCompare(const char *name) {
+  const uint32_t blockSize = BUFFER_SIZE * N_BLOCKS;
+  const uint32_t outSize = blockSize / (uint32_t)DF;
+  const int blocks = 20;
+  std::vector<float32_t> I(blockSize), Q(blockSize), I_ref(blockSize), Q_ref(blockSize);
+  referenceChain_t reference;
+  float32_t error, maxError = 0.0, maxRef = 0.0;
+  double start, polyphaseTime = 0.0, referenceTime = 0.0;
+
+  ReferenceInit(&reference, decimator1.coeffs, decimator2.coeffs);
+  PolyphaseClear();
+
+  for (int block = 0; block < blocks; block++) {
+    for (uint32_t i = 0; i < blockSize; i++) {
+      I[i] = I_ref[i] = HostNoise(&seed);
+      Q[i] = Q_ref[i] = HostNoise(&seed);
+    }
+    start = HostMicros();
+    PolyphaseDecimate(&decimator1, I.data(), Q.data());
+    PolyphaseDecimate(&decimator2, I.data(), Q.data());
+    polyphaseTime += HostMicros() - start;
+    start = HostMicros();
+    ReferenceDecimate(&reference, I_ref.data(), Q_ref.data());
+    referenceTime += HostMicros() - start;
+    for (uint32_t i = 0; i < outSize; i++) {
+      error = fmaxf(fabsf(I[i] - I_ref[i]), fabsf(Q[i] - Q_ref[i]));
+      if (error > maxError) maxError = error;
+      maxRef = fmaxf(maxRef, fmaxf(fabsf(I_ref[i]), fabsf(Q_ref[i])));
+    }
+  }
+  HostCheck(maxError <= DECIMATE_TOLERANCE * maxRef, "Decimate %s by %d and %d, relative error %.2g", name, decimator1.factor,
+            decimator2.factor, maxError / maxRef);
+  printf("  polyphase %.1f us/block, arm_fir_decimate_f32() %.1f us/block\n", polyphaseTime / blocks, referenceTime / blocks);
+}
+
+/*****
+  Purpose: Gain of each chain, in dB, for a complex tone, after the filters have filled.
+
+  Parameter list:
+    referenceChain_t *reference   the reference chain, with its own design
+    float32_t hz                  tone frequency
+    float32_t *polyphaseGain      the polyphase chain's gain
+    float32_t *referenceGain      the reference chain's gain
+
+  Return value:
+    void
+*****/
+static void ToneGain(referenceChain_t *reference, float32_t hz, float32_t *polyphaseGain, float32_t *referenceGain) {
+  const uint32_t blockSize = BUFFER_SIZE * N_BLOCKS;
+  const uint32_t outSize = blockSize / (uint32_t)DF;
+  std::vector<float32_t> I(blockSize), Q(blockSize), I_ref(blockSize), Q_ref(blockSize);
+  float32_t power, powerRef;
+  double phase;
+
+  PolyphaseClear();
+  ReferenceInit(reference, reference->coeffs1, reference->coeffs2);
+  for (int block = 0; block < 3; block++) {
+    for (uint32_t i = 0; i < blockSize; i++) {
+      phase = fmod(TWO_PI * hz * (block * blockSize + i) / SR[SampleRate].rate, TWO_PI);
+      I[i] = I_ref[i] = cos(phase);
+      Q[i] = Q_ref[i] = sin(phase);
+    }
+    PolyphaseDecimate(&decimator1, I.data(), Q.data());
+    PolyphaseDecimate(&decimator2, I.data(), Q.data());
+    ReferenceDecimate(reference, I_ref.data(), Q_ref.data());
+  }
+  power = powerRef = 0.0;
+  for (uint32_t i = 0; i < outSize; i++) {
+    power += I[i] * I[i] + Q[i] * Q[i];
+    powerRef += I_ref[i] * I_ref[i] + Q_ref[i] * Q_ref[i];
+  }
+  *polyphaseGain = 10.0 * log10f(power / outSize);
+  *referenceGain = 10.0 * log10f(powerRef / outSize);
+}
+
+/*****
+  Purpose: Passband ripple of the bucket design the polyphase chain uses and of the exact design the reference
+           used, for one filter bandwidth.
+
+  Parameter list:
+    const char *name      rate, for the report
+    int bandwidth         highest filter edge, LP_F_help in SetDecIntFilters()
+
+  Return value:
+    void
+*****/
+static void DecimateRipple(const char *name, int bandwidth) {
+  referenceChain_t reference;
+  float32_t coeffs1[DECIMATE_MAX_TAPS], coeffs2[DECIMATE_MAX_TAPS];
+  float32_t gain, gainRef, edgeGain, edgeGainRef;
+  float32_t low = 1000.0, high = -1000.0, lowRef = 1000.0, highRef = -1000.0;
+
+  SetDecimatorBandwidth(bandwidth);
+  CalcFIRCoeffs(coeffs1, n_dec1_taps, (float32_t)bandwidth, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate));
+  CalcFIRCoeffs(coeffs2, n_dec2_taps, (float32_t)bandwidth, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
+  ReferenceInit(&reference, coeffs1, coeffs2);
+  for (int k = 0; k <= DECIMATE_RIPPLE_STEPS; k++) {
+    ToneGain(&reference, DECIMATE_RIPPLE_SPAN * bandwidth * k / DECIMATE_RIPPLE_STEPS, &gain, &gainRef);
+    low = fminf(low, gain);
+    high = fmaxf(high, gain);
+    lowRef = fminf(lowRef, gainRef);
+    highRef = fmaxf(highRef, gainRef);
+  }
+  ToneGain(&reference, bandwidth, &edgeGain, &edgeGainRef);
+  HostCheck(high - low <= highRef - lowRef + DECIMATE_RIPPLE_MARGIN,
+            "Decimate %s, %4d Hz bandwidth: ripple to %.0f Hz polyphase %.3f dB, reference %.3f dB; at %d Hz %.2f dB, %.2f dB", name,
+            bandwidth, DECIMATE_RIPPLE_SPAN * bandwidth, high - low, highRef - lowRef, bandwidth, edgeGain - high, edgeGainRef - highRef);
+}
+
+int main() {
+  const int bandwidths[] = { 1800, 2700, 3100, 5000 };
+
+  HostReceiverStart(192000);
+  DecimateCompare("192K");
+  for (int bandwidth : bandwidths) DecimateRipple("192K", bandwidth);
+  EEPROMData.rxSampleRate = SAMPLE_RATE_96K;
+  SetReceiveSampleRate(SAMPLE_RATE_96K);
+  DecimateCompare("96K");
+  for (int bandwidth : bandwidths) DecimateRipple("96K", bandwidth);
+
+  return hostTestFailures;
+}
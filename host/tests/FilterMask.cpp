@@ -0,0 +1,141 @@
+// Filter changes at the largest filter FFT.  A filter mask that is not in the cache is only selected by FilterBandwidth()
+// and built by ServiceReceiveDSP() once it has caught up, so the block after the change still runs on the old mask and
+// the next one on the new.  Turning the filter encoder several steps before the scheduler is idle builds only the
+// last mask.  SetDecIntFilters() takes the audio interpolator designs from the bandwidth buckets, which must hold the
+// design for the top of the bucket at the current front end rate.  The time of a filter change with the mask and
+// interpolators deferred or cached, and of the work that no longer happens in it, is printed.
+#include "HostTest.h"
+
+static uint32_t seed = 1;
+
+/*****
+  Purpose: Run one block of noise through the receiver.
+
+  Parameter list:
+    void
+
+  Return value:
+    void
+*****/
+static void FilterMaskBlock() {
+  const uint32_t blockSamples = HostReceiverBlockSamples();
+  std::vector<int16_t> i(blockSamples), q(blockSamples), left, right;
+
+  for (uint32_t k = 0; k < blockSamples; k++) {
+    i[k] = (int16_t)lrint(300.0 * HostNoise(&seed));
+    q[k] = (int16_t)lrint(300.0 * HostNoise(&seed));
+  }
+  HostReceiverProcess(i.data(), q.data(), false, left, right);
+}
+
+/*****
+  Purpose: Find the cache entry for a mask.
+
+  Parameter list:
+    const float32_t *mask     a filter mask cache slot
+
+  Return value:
+    struct filterMaskEntry_t *    its entry, NULL if it is not a slot
+*****/
+static struct filterMaskEntry_t *FilterMaskEntryOf(const float32_t *mask) {
+  for (int i = 0; i < FILTER_MASK_CACHE_SIZE; i++) {
+    if (mask == filterMaskCache[i]) return &filterMaskEntry[i];
+  }
+  return NULL;
+}
+
+/*****
+  Purpose: Check that the interpolators use the design for the top of the current bandwidth's bucket.
+
+  Parameter list:
+    const char *name      front end rate, for the report
+
+  Return value:
+    void
+*****/
+static void InterpolatorCheck(const char *name) {
+  float32_t coeffs1[INTERPOLATE1_TAPS], coeffs2[INTERPOLATE2_TAPS];
+  int bucket = (LP_F_help + DECIMATE_BUCKET_HZ - 1) / DECIMATE_BUCKET_HZ;
+  float32_t cutoff = (float32_t)(bucket * DECIMATE_BUCKET_HZ);
+  bool same;
+
+  CalcFIRCoeffs(coeffs1, INTERPOLATE1_TAPS, cutoff, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
+  CalcFIRCoeffs(coeffs2, INTERPOLATE2_TAPS, cutoff, n_att, 0, 0.0, (float32_t)SR[SampleRate].rate);
+  same = memcmp(FIR_int1_I.pCoeffs, coeffs1, sizeof(coeffs1)) == 0 && FIR_int1_Q.pCoeffs == FIR_int1_I.pCoeffs
+         && memcmp(FIR_int2_I.pCoeffs, coeffs2, sizeof(coeffs2)) == 0 && FIR_int2_Q.pCoeffs == FIR_int2_I.pCoeffs;
+  HostCheck(same, "Filter %s, %d Hz bandwidth: interpolators use the %.0f Hz bucket design", name, LP_F_help, cutoff);
+}
+
+int main() {
+  const int steps[] = { 2600, 2700, 2800, 2900 };
+  const int stepCount = sizeof(steps) / sizeof(steps[0]);
+  const int changes = 20;
+  float32_t *oldMask;
+  float32_t interpolate1[INTERPOLATE1_TAPS], interpolate2[INTERPOLATE2_TAPS];
+  struct filterMaskEntry_t *entry;
+  double start, changeTime = 0.0, buildTime = 0.0, designTime = 0.0;
+  bool built;
+
+  HostReceiverStart(192000);
+  HostReceiverVolume(50);
+  HostReceiverMode(DEMOD_USB);
+  SetConvolutionSize(2048);
+  for (int block = 0; block < 4; block++) FilterMaskBlock();
+
+  // One filter change that misses the cache
+  oldMask = FIR_filter_mask;
+  bands[EEPROMData.currentBand].FHiCut = 2500;
+  FilterBandwidth();
+  HostCheck(FIR_filter_mask == oldMask && filterMaskPending == NULL, "Filter change: old mask still active, nothing pending");
+  FilterMaskBlock();
+  HostCheck(FIR_filter_mask == oldMask && filterMaskPending != NULL,
+            "Filter change: block run on the old mask, new mask built after it");
+  FilterMaskBlock();
+  entry = FilterMaskEntryOf(FIR_filter_mask);
+  HostCheck(FIR_filter_mask != oldMask && entry != NULL && entry->FHiCut == 2500 && entry->fftLength == 2048,
+            "Filter change: next block run on the new mask");
+
+  // Several encoder steps before the scheduler is idle
+  for (int step : steps) {
+    bands[EEPROMData.currentBand].FHiCut = step;
+    FilterBandwidth();
+  }
+  FilterMaskBlock();
+  FilterMaskBlock();
+  built = false;
+  for (int i = 0; i < FILTER_MASK_CACHE_SIZE; i++) {
+    for (int k = 0; k < stepCount - 1; k++) {
+      if (filterMaskEntry[i].valid && filterMaskEntry[i].FHiCut == steps[k]) built = true;
+    }
+  }
+  entry = FilterMaskEntryOf(FIR_filter_mask);
+  HostCheck(!built && entry != NULL && entry->FHiCut == steps[stepCount - 1], "Filter encoder, %d steps: only the last mask built",
+            stepCount);
+
+  InterpolatorCheck("192K");
+
+  // Time a filter change, and the mask build and interpolator designs it used to do
+  for (int i = 0; i < changes; i++) {
+    bands[EEPROMData.currentBand].FHiCut = 3000 + 100 * (i % 2 == 0 ? i : -i);
+    start = HostMicros();
+    FilterBandwidth();
+    changeTime += HostMicros() - start;
+    start = HostMicros();
+    FilterMaskBuild();
+    buildTime += HostMicros() - start;
+    FilterMaskSwap();
+    start = HostMicros();
+    CalcFIRCoeffs(interpolate1, INTERPOLATE1_TAPS, (float32_t)LP_F_help, n_att, 0, 0.0, (float32_t)(SR[SampleRate].rate / DF1));
+    CalcFIRCoeffs(interpolate2, INTERPOLATE2_TAPS, (float32_t)LP_F_help, n_att, 0, 0.0, (float32_t)SR[SampleRate].rate);
+    designTime += HostMicros() - start;
+  }
+  printf("  filter change %.1f us, 2048 point mask build %.1f us, interpolator designs %.1f us\n", changeTime / changes,
+         buildTime / changes, designTime / changes);
+
+  // The interpolator designs follow the front end rate
+  EEPROMData.rxSampleRate = SAMPLE_RATE_96K;
+  SetReceiveSampleRate(SAMPLE_RATE_96K);
+  InterpolatorCheck("96K");
+
+  return hostTestFailures;
+}
@@ -0,0 +1,133 @@
+// The fused Fs/4 and NCO mixer, FreqShiftMixer(), against the original FreqShift1() and FreqShift2() pair, kept
+// here as FreqShift2Reference().  A unit complex tone runs through both for about 20 seconds at each of several NCO
+// frequencies, and each output is compared with an exact double precision mix.  The mixer must hold its level at
+// FREQ_SHIFT_GAIN and its phase to the exact mix over the whole run, and FREQ_SHIFT_GAIN must match the level the
+// original settles at.  The original steps its oscillator by the float cos and sin of NCO_INC, so its phase drifts
+// slowly away from the exact mix; that drift is printed for comparison.  The time per block of each is printed.
+#include "HostTest.h"
+
+#include <complex>
+
+extern double ncoPhase;  // In Freq_Shift.cpp
+
+#define FREQ_SHIFT_BLOCKS 2000          // About 21 seconds of 2048 sample blocks at 192K
+#define FREQ_SHIFT_SETTLE_BLOCKS 1      // The original oscillator amplitude settles within a few hundred samples
+#define FREQ_SHIFT_TOLERANCE 1.0e-4     // Allowed level error, relative, and phase error, radians
+
+static double oscVectQ, oscVectI;  // The original oscillator state, Osc_Vect_Q and Osc_Vect_I in the sketch
+
+/*****
+  Purpose: The original recursive NCO, in place on float_buffer_L/R after FreqShift1().  The amplitude is held
+           by the 1.95 - |v|^2 correction, which settles at |v| = sqrt(0.95).
+
+  Parameter list:
+    void
+
+  Return value:
+    void
+*****/
+static void FreqShift2Reference() {
+  double OSC_COS = cos(NCO_INC);
+  double OSC_SIN = sin(NCO_INC);
+  double Osc_Q, Osc_I, Osc_Gain;
+  float32_t I_sample, Q_sample;
+
+  for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS; i++) {
+    Osc_Q = (oscVectQ * OSC_COS) - (oscVectI * OSC_SIN);
+    Osc_I = (oscVectI * OSC_COS) + (oscVectQ * OSC_SIN);
+    Osc_Gain = 1.95 - ((oscVectQ * oscVectQ) + (oscVectI * oscVectI));
+    oscVectQ = Osc_Gain * Osc_Q;
+    oscVectI = Osc_Gain * Osc_I;
+    float freqAdjFactor = 1.1;
+    I_sample = float_buffer_L[i];
+    Q_sample = float_buffer_R[i];
+    float_buffer_L[i] = (I_sample * freqAdjFactor * Osc_Q) + (Q_sample * freqAdjFactor * Osc_I);
+    float_buffer_R[i] = (Q_sample * freqAdjFactor * Osc_Q) - (I_sample * freqAdjFactor * Osc_I);
+  }
+}
+
+/*****
+  Purpose: Fill float_buffer_L/R with one block of a unit complex tone.
+
+  Parameter list:
+    double hz           tone frequency
+    uint64_t *sample    sample counter, carried from block to block
+
+  Return value:
+    void
+*****/
+static void ToneBlock(double hz, uint64_t *sample) {
+  double phase;
+
+  for (unsigned i = 0; i < BUFFER_SIZE * N_BLOCKS; i++, (*sample)++) {
+    phase = fmod(TWO_PI * hz * (*sample) / 192000.0, TWO_PI);
+    float_buffer_L[i] = cos(phase);
+    float_buffer_R[i] = sin(phase);
+  }
+}
+
+int main() {
+  const long frequencies[] = { 0, 1000, -7350, 23456, -40000 };
+  const uint32_t blockSize = BUFFER_SIZE * N_BLOCKS;
+  std::vector<float32_t> I_ref(blockSize), Q_ref(blockSize), I_in(blockSize), Q_in(blockSize);
+  std::complex<double> exact, mixerRatio, referenceRatio, firstRatio;
+  double start, mixerTime = 0.0, referenceTime = 0.0;
+  double levelError, phaseError, referenceDrift, referenceLevel;
+  uint64_t sample, n;
+  int timedBlocks = 0;
+
+  HostReceiverStart(192000);
+  EEPROMData.xmtMode = SSB_MODE;
+
+  for (long frequency : frequencies) {
+    NCOFreq = frequency;
+    ncoPhase = 0.0;
+    oscVectQ = 1.0;
+    oscVectI = 0.0;
+    sample = 0;
+    levelError = phaseError = referenceDrift = referenceLevel = 0.0;
+    for (int block = 0; block < FREQ_SHIFT_BLOCKS; block++) {
+      ToneBlock(10000.0, &sample);
+      arm_copy_f32(float_buffer_L, I_in.data(), blockSize);
+      arm_copy_f32(float_buffer_R, Q_in.data(), blockSize);
+
+      start = HostMicros();
+      FreqShift1();
+      FreqShift2Reference();
+      referenceTime += HostMicros() - start;
+      arm_copy_f32(float_buffer_L, I_ref.data(), blockSize);
+      arm_copy_f32(float_buffer_R, Q_ref.data(), blockSize);
+
+      arm_copy_f32(I_in.data(), float_buffer_L, blockSize);
+      arm_copy_f32(Q_in.data(), float_buffer_R, blockSize);
+      start = HostMicros();
+      FreqShiftMixer(true);
+      mixerTime += HostMicros() - start;
+      timedBlocks++;
+
+      for (uint32_t i = 0; i < blockSize; i++) {
+        n = (uint64_t)block * blockSize + i;  // Fs/4 is a quarter turn per sample, NCO_INC the other way
+        exact = std::complex<double>(I_in[i], Q_in[i]) * std::polar(1.0, fmod(HALF_PI * (n % 4) - (double)NCO_INC * n, TWO_PI));
+        mixerRatio = std::complex<double>(float_buffer_L[i], float_buffer_R[i]) / exact;
+        levelError = fmax(levelError, fabs(std::abs(mixerRatio) / FREQ_SHIFT_GAIN - 1.0));
+        phaseError = fmax(phaseError, fabs(std::arg(mixerRatio)));
+        if (block < FREQ_SHIFT_SETTLE_BLOCKS) continue;
+        referenceRatio = std::complex<double>(I_ref[i], Q_ref[i]) / exact;
+        if (block == FREQ_SHIFT_SETTLE_BLOCKS && i == 0) {
+          firstRatio = referenceRatio;
+          referenceLevel = std::abs(referenceRatio);
+        }
+        referenceDrift = fmax(referenceDrift, fabs(std::arg(referenceRatio / firstRatio)));
+      }
+    }
+    HostCheck(levelError < FREQ_SHIFT_TOLERANCE && phaseError < FREQ_SHIFT_TOLERANCE,
+              "Mixer, NCO %+6ld Hz, %d blocks: level error %.2g, phase error %.2g rad, original phase drift %.2g rad", frequency,
+              FREQ_SHIFT_BLOCKS, levelError, phaseError, referenceDrift);
+    HostCheck(fabs(referenceLevel / FREQ_SHIFT_GAIN - 1.0) < FREQ_SHIFT_TOLERANCE, "  FREQ_SHIFT_GAIN %.4f, settled original level %.5f",
+              FREQ_SHIFT_GAIN, referenceLevel);
+  }
+  printf("Frequency shift, %u samples: mixer %.1f us/block, FreqShift1() and FreqShift2() %.1f us/block\n", blockSize,
+         mixerTime / timedBlocks, referenceTime / timedBlocks);
+
+  return hostTestFailures;
+}
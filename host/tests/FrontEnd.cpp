@@ -0,0 +1,60 @@
+// The fused receive front end, ReceiveFrontEnd(), against the original pass-per-stage code that FRONT_END_REFERENCE
+// selects, ReceiveFrontEndReference().  Both run on the same blocks of I/Q noise in every mode that has IQ
+// correction, with the phase correction mixed each way, and must agree to float rounding.  The time per block of
+// each is printed.
+#include "HostTest.h"
+
+extern float32_t frontEndState[];  // In DSP_Fn.cpp
+
+#define FRONT_END_TOLERANCE 1.0e-5  // Allowed difference, relative to the largest reference sample
+
+static uint32_t seed = 1;
+
+int main() {
+  const int modes[] = { DEMOD_USB, DEMOD_LSB, DEMOD_AM, DEMOD_SAM };
+  const float32_t phases[] = { 0.02, -0.02 };
+  const uint32_t blockSize = BUFFER_SIZE * N_BLOCKS;
+  const int blocks = 20;
+  std::vector<float32_t> I(blockSize), Q(blockSize), I_ref(blockSize), Q_ref(blockSize);
+  float32_t error, maxError, maxRef;
+  double start, fusedTime = 0.0, referenceTime = 0.0;
+  int timedBlocks = 0;
+
+  HostReceiverStart(192000);
+  EEPROMData.rfGainAllBands = 6;
+  EEPROMData.IQAmpCorrectionFactor[EEPROMData.currentBand] = 1.03;
+
+  for (int mode : modes) {
+    HostReceiverMode(mode);
+    for (float32_t phase : phases) {
+      EEPROMData.IQPhaseCorrectionFactor[EEPROMData.currentBand] = phase;
+      frontEndState[0] = frontEndState[1] = 0.0;
+      HP_DC_Butter_state2[0] = HP_DC_Butter_state2[1] = 0.0;
+      maxError = maxRef = 0.0;
+      for (int block = 0; block < blocks; block++) {
+        for (uint32_t i = 0; i < blockSize; i++) {
+          I[i] = I_ref[i] = 0.01 + 0.1 * HostNoise(&seed);  // With some DC for the high pass to take out
+          Q[i] = Q_ref[i] = -0.01 + 0.1 * HostNoise(&seed);
+        }
+        start = HostMicros();
+        ReceiveFrontEnd(I.data(), Q.data(), blockSize);
+        fusedTime += HostMicros() - start;
+        start = HostMicros();
+        ReceiveFrontEndReference(I_ref.data(), Q_ref.data(), blockSize);
+        referenceTime += HostMicros() - start;
+        timedBlocks++;
+        for (uint32_t i = 0; i < blockSize; i++) {
+          error = fmaxf(fabsf(I[i] - I_ref[i]), fabsf(Q[i] - Q_ref[i]));
+          if (error > maxError) maxError = error;
+          maxRef = fmaxf(maxRef, fmaxf(fabsf(I_ref[i]), fabsf(Q_ref[i])));
+        }
+      }
+      HostCheck(maxError <= FRONT_END_TOLERANCE * maxRef, "Front end, mode %d, phase correction %+.2f, relative error %.2g", mode,
+                phase, maxError / maxRef);
+    }
+  }
+  printf("Front end, %u samples: fused %.1f us/block, reference %.1f us/block\n", blockSize, fusedTime / timedBlocks,
+         referenceTime / timedBlocks);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,69 @@
+// Shared by the host regression tests.  Each test is its own program, run by ctest: it brings the radio up with
+// HostReceiverStart(), drives the sketch's own DSP routines, prints one line per check, and returns the number of
+// checks that failed.
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "SDT.h"
+#include "HostReceiver.h"
+
+#include <chrono>
+#include <stdarg.h>
+#include <vector>
+
+static int hostTestFailures = 0;
+
+/*****
+  Purpose: Print a check and its result, and count it if it failed.
+
+  Parameter list:
+    bool pass             the result
+    const char *format    printf format for the description, then its arguments
+
+  Return value:
+    void
+*****/
+static void HostCheck(bool pass, const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  printf(": %s\n", pass ? "pass" : "FAIL");
+  if (!pass) hostTestFailures++;
+}
+
+/*****
+  Purpose: Gaussian noise from a fixed seed, so the tests give the same results every run.
+
+  Parameter list:
+    uint32_t *seed        generator state, carried from call to call
+
+  Return value:
+    float32_t             a sample with a variance of 1
+*****/
+static float32_t HostNoise(uint32_t *seed) {
+  float32_t sum = 0.0;
+
+  for (int i = 0; i < 12; i++) {  // Sum of 12 uniform samples
+    *seed = *seed * 1664525 + 1013904223;
+    sum += (*seed >> 8) / 16777216.0;
+  }
+  return sum - 6.0;
+}
+
+// Wall time in microseconds, for the time per block the tests print.  Host times are a guide to the relative cost
+// of two versions of a stage, not to the cycles used on the Teensy.
+static double HostMicros() {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Root mean square of the samples from first on
+static double HostRMS(const std::vector<int16_t> &samples, size_t first = 0) {
+  double sum = 0.0;
+
+  for (size_t i = first; i < samples.size(); i++) sum += (double)samples[i] * samples[i];
+  return samples.size() > first ? sqrt(sum / (samples.size() - first)) : 0.0;
+}
+
+#endif
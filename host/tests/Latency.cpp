@@ -0,0 +1,74 @@
+// Receive latency at each filter FFT size.  A short RF click at the receive frequency goes through the whole chain,
+// ServiceReceiveDSP() through to the audio queues, in USB, and the delay to the peak of the played audio is measured.
+// On the radio a block is only processed once all of it has arrived, so the delay from a click to its sound is the
+// delay through the chain plus one block.  Only the group delay of the convolution filter, FFT size / 4 samples at
+// the decimated rate, should change with the size.  The delay and the time per block at each size are printed.
+#include "HostTest.h"
+
+#define LATENCY_TOLERANCE 0.25  // ms the chain delay may differ from the filter delay change
+
+static uint32_t rate = 192000;
+
+/*****
+  Purpose: Run a click through the receiver at the current filter FFT size.
+
+  Parameter list:
+    double *time          time per block, microseconds
+
+  Return value:
+    double                samples from the click to the peak of the played audio, at the I/Q rate
+*****/
+static double LatencyRun(double *time) {
+  const uint32_t blockSamples = HostReceiverBlockSamples();
+  const int settleBlocks = 20, blocks = 40;
+  const uint32_t click = settleBlocks * blockSamples + blockSamples / 3;  // Part way into a block
+  std::vector<int16_t> i(blockSamples), q(blockSamples), left, right;
+  double total = 0.0, phase, peak = 0.0;
+  size_t peakAt = 0;
+  uint32_t seed = 1, n;
+
+  for (int block = 0; block < blocks; block++) {
+    for (uint32_t k = 0; k < blockSamples; k++) {
+      n = block * blockSamples + k;
+      i[k] = (int16_t)lrint(30.0 * HostNoise(&seed));  // A little noise, so the AGC is not at full gain
+      q[k] = (int16_t)lrint(30.0 * HostNoise(&seed));
+      if (n >= click && n < click + 8) {  // 8 samples of the carrier at the receive frequency, a click 24 kHz wide
+        phase = -HALF_PI * n;  // The receiver listens a quarter of the rate below center
+        i[k] += (int16_t)lrint(8000.0 * cos(phase));
+        q[k] += (int16_t)lrint(8000.0 * sin(phase));
+      }
+    }
+    total += HostReceiverProcess(i.data(), q.data(), true, left, right);
+  }
+  for (size_t k = click; k < left.size(); k++) {
+    if (fabs(left[k]) > peak) {
+      peak = fabs(left[k]);
+      peakAt = k;
+    }
+  }
+  *time = total / blocks;
+  return (double)peakAt - click;
+}
+
+int main() {
+  const uint32_t lengths[] = { 256, 512, 1024, 2048 };
+  double delay, time, firstDelay = 0.0, filterDelay, blockDelay;
+
+  HostReceiverStart(rate);
+  HostReceiverVolume(50);
+  HostReceiverMode(DEMOD_USB);
+  blockDelay = 1000.0 * HostReceiverBlockSamples() / rate;
+
+  for (uint32_t length : lengths) {
+    SetConvolutionSize(length);
+    delay = 1000.0 * LatencyRun(&time) / rate;
+    filterDelay = 1000.0 * (length - lengths[0]) / 4.0 / decimatedRate;  // Change in the filter group delay
+    if (length == lengths[0]) firstDelay = delay;
+    HostCheck(fabs(delay - firstDelay - filterDelay) < LATENCY_TOLERANCE,
+              "Latency, %4u point FFT: chain %5.1f ms, with the block wait %5.1f ms, filter delay change %4.1f ms", length, delay,
+              delay + blockDelay, filterDelay);
+    printf("  %.1f us/block\n", time);
+  }
+
+  return hostTestFailures;
+}
@@ -0,0 +1,270 @@
+// The gated noise blanker, AltNoiseBlanking(), against the original that runs the LPC analysis on every block, kept
+// here as AltNoiseBlankingReference().  Both run on speech-like audio, glottal pulses through three formants, band
+// limited to an SSB passband, with receiver noise.  Every third block gets a click, and the click sizes are swept
+// through the LPC detector threshold.  At each NB_thresh the two outputs must match on every block and the detector
+// must have both missed and restored some of the clicks.  From NB_GATE_MIN_THRESH up the gate must also skip most of
+// the clean blocks.  The time per block of each is printed.
+#include "HostTest.h"
+
+#define NB_TEST_BLOCKS 600       // Blocks per click size and noise level
+#define NB_TEST_SKIPPED 0.9      // Fraction of the clean blocks the gate must skip
+#define boundary_blank 14        // As in DSP_Fn.cpp
+#define impulse_length NB_impulse_samples
+#define PL (impulse_length - 1) / 2
+
+// Biquad, direct form I
+struct nbTestBiquad_t {
+  float32_t b0, b1, b2, a1, a2;
+  float32_t x1, x2, y1, y2;
+};
+
+/*****
+  Purpose: The original noise blanker, LPC analysis, impulse detection, and restoration on every block.  The NB_test
+           test frames are left out.
+
+  Parameter list:
+    float *insamp         audio samples, restored in place
+    int Nsam              number of samples, NB_FFT_SIZE
+
+  Return value:
+    void
+*****/
+static void AltNoiseBlankingReference(float *insamp, int Nsam) {
+  int impulse_positions[20];
+  int search_pos = 0;
+  int impulse_count = 0;
+  int order = NB_taps;
+  static float32_t last_frame_end[80];
+  arm_fir_instance_f32 LPC;
+  float32_t lpcs[order + 1];
+  float32_t reverse_lpcs[order + 1];
+  float32_t firStateF32[NB_FFT_SIZE + order];
+  float32_t tempsamp[NB_FFT_SIZE];
+  float32_t sigma2;
+  float32_t lpc_power;
+  float32_t impulse_threshold;
+  float32_t R[11];
+  float32_t k, alfa;
+  float32_t any[order + 1];
+  float32_t Rfw[impulse_length + order];
+  float32_t Rbw[impulse_length + order];
+  float32_t Wfw[impulse_length], Wbw[impulse_length];
+  float32_t s;
+
+  memset(R, 0, sizeof(float32_t) * 11);
+  for (int i = 0; i < impulse_length; i++) {
+    Wbw[i] = 1.0 * i / (impulse_length - 1);
+    Wfw[impulse_length - i - 1] = Wbw[i];
+  }
+  for (int i = 0; i < (order + 1); i++) {
+    arm_dot_prod_f32(&insamp[0], &insamp[i], Nsam - i, &R[i]);
+  }
+  R[0] = R[0] * (1.0 + 1.0e-9);
+  lpcs[0] = 1;
+  for (int i = 1; i < order + 1; i++)
+    lpcs[i] = 0;
+  alfa = R[0];
+  for (int m = 1; m <= order; m++) {
+    s = 0.0;
+    for (int u = 1; u < m; u++)
+      s = s + lpcs[u] * R[m - u];
+    k = -(R[m] + s) / alfa;
+    for (int v = 1; v < m; v++)
+      any[v] = lpcs[v] + k * lpcs[m - v];
+    for (int w = 1; w < m; w++)
+      lpcs[w] = any[w];
+    lpcs[m] = k;
+    alfa = alfa * (1 - k * k);
+  }
+  for (int o = 0; o < order + 1; o++)
+    reverse_lpcs[order - o] = lpcs[o];
+
+  arm_fir_init_f32(&LPC, order + 1, &reverse_lpcs[0], &firStateF32[0], NB_FFT_SIZE);
+  arm_fir_f32(&LPC, insamp, tempsamp, Nsam);
+  arm_fir_init_f32(&LPC, order + 1, &lpcs[0], &firStateF32[0], NB_FFT_SIZE);
+  arm_fir_f32(&LPC, tempsamp, tempsamp, Nsam);
+  arm_var_f32(tempsamp, NB_FFT_SIZE, &sigma2);
+  arm_power_f32(lpcs, order, &lpc_power);
+  impulse_threshold = NB_thresh * sqrtf(sigma2 * lpc_power);
+
+  search_pos = order + PL;
+  impulse_count = 0;
+  do {
+    if ((tempsamp[search_pos] > impulse_threshold) || (tempsamp[search_pos] < (-impulse_threshold))) {
+      impulse_positions[impulse_count] = search_pos - order;
+      impulse_count++;
+      search_pos += PL;
+    }
+    search_pos++;
+  } while (((unsigned int)search_pos < NB_FFT_SIZE - (unsigned int)boundary_blank) && ((unsigned int)impulse_count < 20U));
+
+  arm_negate_f32(&lpcs[1], &lpcs[1], order);
+  arm_negate_f32(&reverse_lpcs[0], &reverse_lpcs[0], order);
+  for (int j = 0; j < impulse_count; j++) {
+    for (int k = 0; k < order; k++) {
+      if ((impulse_positions[j] - PL - order + k) < 0) {
+        Rfw[k] = last_frame_end[impulse_positions[j] + k];
+      } else {
+        Rfw[k] = insamp[impulse_positions[j] - PL - order + k];
+      }
+      Rbw[impulse_length + k] = insamp[impulse_positions[j] + PL + k + 1];
+    }
+    for (int i = 0; i < impulse_length; i++) {
+      arm_dot_prod_f32(&reverse_lpcs[0], &Rfw[i], order, &Rfw[i + order]);
+      arm_dot_prod_f32(&lpcs[1], &Rbw[impulse_length - i], order, &Rbw[impulse_length - i - 1]);
+    }
+    arm_mult_f32(&Wfw[0], &Rfw[order], &Rfw[order], impulse_length);
+    arm_mult_f32(&Wbw[0], &Rbw[0], &Rbw[0], impulse_length);
+    arm_add_f32(&Rfw[order], &Rbw[0], &insamp[impulse_positions[j] - PL], impulse_length);
+  }
+  for (int p = 0; p < (order + PL); p++) {
+    last_frame_end[p] = insamp[NB_FFT_SIZE - 1 - order - PL + p];
+  }
+}
+
+/*****
+  Purpose: Set up a biquad.
+
+  Parameter list:
+    nbTestBiquad_t *q     the filter
+    int type              0 for a 2 pole low pass, 1 for a 2 pole high pass, 2 for a resonator
+    float32_t hz          corner or centre frequency
+    float32_t width       resonator bandwidth, Hz
+
+  Return value:
+    void
+*****/
+static void NBTestBiquadInit(nbTestBiquad_t *q, int type, float32_t hz, float32_t width = 0.0) {
+  float32_t w = TWO_PI * hz / decimatedRate;
+  float32_t c = cosf(w), alpha = sinf(w) / (2.0 * 0.7071), a0 = 1.0 + alpha, r;
+
+  memset(q, 0, sizeof(*q));
+  if (type == 2) {
+    r = expf(-PI * width / decimatedRate);
+    q->b0 = 1.0 - r;
+    q->a1 = -2.0 * r * c;
+    q->a2 = r * r;
+    return;
+  }
+  q->b0 = q->b2 = (type == 0 ? 1.0 - c : 1.0 + c) / 2.0 / a0;
+  q->b1 = (type == 0 ? 1.0 - c : -(1.0 + c)) / a0;
+  q->a1 = -2.0 * c / a0;
+  q->a2 = (1.0 - alpha) / a0;
+}
+
+// One sample through a biquad
+static float32_t NBTestBiquad(nbTestBiquad_t *q, float32_t x) {
+  float32_t y = q->b0 * x + q->b1 * q->x1 + q->b2 * q->x2 - q->a1 * q->y1 - q->a2 * q->y2;
+
+  q->x2 = q->x1;
+  q->x1 = x;
+  q->y2 = q->y1;
+  q->y1 = y;
+  return y;
+}
+
+/*****
+  Purpose: Run both noise blankers over speech at one noise level with clicks of one size.
+
+  Parameter list:
+    float32_t noise       receiver noise RMS before the passband filter, the speech peaks near 1
+    float32_t click       click size, 0 for none
+    int *mismatches       blocks where the outputs differ, added to
+    int *restored         clicked blocks the original changed, added to
+    int *missed           clicked blocks the original left alone, added to
+    int *clean            blocks without a click, added to
+    int *skipped          clean blocks the gate skipped, added to
+    double *gatedTime     time in AltNoiseBlanking(), microseconds, added to
+    double *referenceTime time in AltNoiseBlankingReference(), added to
+
+  Return value:
+    void
+*****/
+static void NBTestRun(float32_t noise, float32_t click, int *mismatches, int *restored, int *missed, int *clean, int *skipped,
+                      double *gatedTime, double *referenceTime) {
+  nbTestBiquad_t formant[3], voice[4], hiss[4];
+  const float32_t formantHz[3] = { 600.0, 1400.0, 2500.0 }, formantWidth[3] = { 100.0, 150.0, 200.0 };
+  const float32_t formantGain[3] = { 1.0, 0.5, 0.25 };
+  std::vector<float32_t> audio(NB_FFT_SIZE), gated(NB_FFT_SIZE), reference(NB_FFT_SIZE);
+  float32_t t, pitch, flow, lastFlow = 0.0, excitation, speech, phase = 0.0;
+  uint32_t seed = 1, analysed;
+  double start;
+  int position;
+
+  for (int i = 0; i < 3; i++) NBTestBiquadInit(&formant[i], 2, formantHz[i], formantWidth[i]);
+  for (int i = 0; i < 4; i++) {  // 300 to 2700 Hz passband, 4 poles each side
+    NBTestBiquadInit(&voice[i], i < 2, i < 2 ? 300.0 : 2700.0);
+    NBTestBiquadInit(&hiss[i], i < 2, i < 2 ? 300.0 : 2700.0);
+  }
+  for (int block = 0; block < NB_TEST_BLOCKS; block++) {
+    for (int i = 0; i < NB_FFT_SIZE; i++) {
+      t = (float32_t)(block * NB_FFT_SIZE + i) / decimatedRate;
+      pitch = 130.0 + 30.0 * sinf(TWO_PI * 0.7 * t);
+      phase += pitch / decimatedRate;
+      if (phase >= 1.0) phase -= 1.0;
+      // Rosenberg glottal flow, and its derivative through the formants
+      flow = phase < 0.4 ? 0.5 * (1.0 - cosf(PI * phase / 0.4)) : (phase < 0.56 ? cosf(PI * (phase - 0.4) / 0.32) : 0.0);
+      excitation = flow - lastFlow;
+      lastFlow = flow;
+      speech = 0.0;
+      for (int k = 0; k < 3; k++) speech += formantGain[k] * NBTestBiquad(&formant[k], excitation);
+      speech *= 4.0 * fmaxf(0.0, sinf(TWO_PI * 2.5 * t));  // Syllables, with gaps
+      audio[i] = noise * HostNoise(&seed);
+      for (int k = 0; k < 4; k++) {
+        speech = NBTestBiquad(&voice[k], speech);
+        audio[i] = NBTestBiquad(&hiss[k], audio[i]);
+      }
+      audio[i] += speech;
+    }
+    if (click > 0.0 && block % 3 == 0) {  // A doublet, like the NB_test frames
+      position = 40 + (block * 37) % 170;
+      audio[position] += click;
+      audio[position + 1] -= click / 3.0;
+    }
+    gated = reference = audio;
+    analysed = nbBlocksAnalysed;
+    start = HostMicros();
+    AltNoiseBlanking(gated.data(), NB_FFT_SIZE, NULL);
+    *gatedTime += HostMicros() - start;
+    start = HostMicros();
+    AltNoiseBlankingReference(reference.data(), NB_FFT_SIZE);
+    *referenceTime += HostMicros() - start;
+    if (gated != reference) (*mismatches)++;
+    if (click > 0.0 && block % 3 == 0) {
+      if (reference != audio) (*restored)++;
+      else (*missed)++;
+    } else {
+      (*clean)++;
+      if (nbBlocksAnalysed == analysed) (*skipped)++;
+    }
+  }
+}
+
+int main() {
+  const float32_t thresholds[] = { 2.0, 2.5, 3.5 };
+  const float32_t noises[] = { 0.3, 0.1, 0.03 };  // Receiver noise RMS before the passband filter
+  int mismatches, restored, missed, clean, skipped, blocks;
+  double gatedTime, referenceTime;
+
+  HostReceiverStart(192000);
+  NB_test = 0;
+
+  for (float32_t threshold : thresholds) {
+    NB_thresh = threshold;
+    mismatches = restored = missed = clean = skipped = blocks = 0;
+    gatedTime = referenceTime = 0.0;
+    for (float32_t noise : noises) {
+      for (float32_t click = 0.0; click <= noise; click += noise / 8.0) {  // Through the detector threshold
+        NBTestRun(noise, click, &mismatches, &restored, &missed, &clean, &skipped, &gatedTime, &referenceTime);
+        blocks += NB_TEST_BLOCKS;
+      }
+    }
+    HostCheck(mismatches == 0 && restored > 0 && missed > 0 && (threshold < NB_GATE_MIN_THRESH || skipped >= NB_TEST_SKIPPED * clean),
+              "Noise blanker, NB_thresh %.1f: %d blocks differ, clicks restored %d, missed %d, clean blocks skipped %d of %d",
+              threshold, mismatches, restored, missed, skipped, clean);
+    printf("  gated %.1f us/block, LPC on every block %.1f us/block\n", gatedTime / blocks, referenceTime / blocks);
+  }
+
+  NB_thresh = 2.5;
+  return hostTestFailures;
+}
@@ -0,0 +1,132 @@
+// The RTTY decoder, RTTYDecoder(), on a corpus of messages keyed at 45.45 baud, from 30 dB down to 0 dB SNR in a
+// 3 kHz bandwidth.  The audio is made here, with a fixed noise seed, so the results are the same every run, and each
+// message must decode to the text sent.  The time per block of the decoder is printed.
+#include "HostTest.h"
+
+#define RTTY_DECODE_TEST_PREAMBLE "RYRY "  // Sent before each message
+#define RTTY_TEST_LEVEL 0.1                // Tone amplitude
+
+struct rttyDecodeTest_t {
+  float32_t snr;     // Tone to noise power in a 3 kHz bandwidth, dB
+  const char *text;  // Sent after RTTY_DECODE_TEST_PREAMBLE, and expected at the end of the decoded text
+};
+
+const struct rttyDecodeTest_t rttyDecodeTests[] = {
+  { 30.0, "CQ CQ DE W1AW W1AW K" },
+  { 20.0, "UR 599 599 IN OHIO" },
+  { 10.0, "QTH NR 73-/? TU" },
+  { 6.0, "THE QUICK BROWN FOX" },
+  { 0.0, "RYRY 0123456789" },
+};
+
+// ITA2 letters and figures, kept apart from the decoder's own tables so a mistake in those shows up here
+static const char testLetters[32] = { 0, 'E', '\n', 'A', ' ', 'S', 'I', 'U', '\r', 'D', 'R', 'J', 'N', 'F', 'C', 'K',
+                                      'T', 'Z', 'L', 'W', 'H', 'Y', 'P', 'Q', 'O', 'B', 'G', 0, 'M', 'X', 'V', 0 };
+static const char testFigures[32] = { 0, '3', '\n', '-', ' ', 0, '8', '7', '\r', '$', '4', '\'', ',', '!', ':', '(',
+                                      '5', '"', ')', '2', '#', '6', '0', '1', '9', '?', '&', 0, '.', '/', ';', 0 };
+
+static float32_t rttyTestPhase;
+static uint32_t rttyTestSeed = 1;
+static double decodeTime = 0.0;  // Time in RTTYDecoder(), microseconds
+static int decodeBlocks = 0;
+
+/*****
+  Purpose: Send one bit of phase continuous frequency shift keyed audio through the decoder, a block at a time the
+           way ProcessIQData() does.
+
+  Parameter list:
+    int bit               1 for mark, 0 for space
+    float32_t bits        how long, in bits
+    float32_t noise       noise standard deviation
+    float32_t *sent       samples sent so far in this test, carried from call to call
+    float32_t *bitTime    bits sent so far in this test, carried from call to call
+
+  Return value:
+    void
+*****/
+static void RTTYTestBit(int bit, float32_t bits, float32_t noise, float32_t *sent, float32_t *bitTime) {
+  static std::vector<float32_t> block(BUF_N_DF);
+  static uint32_t fill = 0;
+  bool upper = (bands[EEPROMData.currentBand].mode == DEMOD_USB);
+  float32_t tone = (bit != upper) ? RTTY_MARK : RTTY_MARK + RTTY_SHIFT;
+  double start;
+
+  *bitTime += bits;
+  while (*sent < *bitTime * decimatedRate / RTTY_BAUD) {
+    block[fill++] = RTTY_TEST_LEVEL * sinf(rttyTestPhase) + noise * HostNoise(&rttyTestSeed);
+    rttyTestPhase += TWO_PI * tone / decimatedRate;
+    if (rttyTestPhase > TWO_PI) rttyTestPhase -= TWO_PI;
+    *sent += 1.0;
+    if (fill == BUF_N_DF) {
+      start = HostMicros();
+      RTTYDecoder(block.data());
+      decodeTime += HostMicros() - start;
+      decodeBlocks++;
+      fill = 0;
+    }
+  }
+}
+
+// Send one character, a start bit, 5 data bits, and 1.5 stop bits
+static void RTTYTestCharacter(int code, float32_t noise, float32_t *sent, float32_t *bitTime) {
+  RTTYTestBit(0, 1.0, noise, sent, bitTime);
+  for (int i = 0; i < 5; i++) RTTYTestBit((code >> i) & 1, 1.0, noise, sent, bitTime);
+  RTTYTestBit(1, 1.5, noise, sent, bitTime);
+}
+
+int main() {
+  char message[64];
+  char decoded[MAX_DECODE_CHARS + 1];
+  int code;
+  bool figures;
+  float32_t noise, sent, bitTime;
+  size_t length, expected;
+
+  HostReceiverStart(192000);
+  EEPROMData.rttyDecoder = RTTY_NORMAL;
+
+  for (const rttyDecodeTest_t &test : rttyDecodeTests) {
+    RTTYReset();
+    sent = bitTime = 0.0;
+    // Noise over the whole decimatedRate / 2 bandwidth, scaled for the SNR in 3 kHz
+    noise = RTTY_TEST_LEVEL / sqrtf(2.0 * powf(10.0, test.snr / 10.0) * 3000.0 / (decimatedRate / 2.0));
+    RTTYTestBit(1, 20.0, noise, &sent, &bitTime);  // Idle mark for the threshold correction to settle
+
+    snprintf(message, sizeof(message), "%s%s\r\n", RTTY_DECODE_TEST_PREAMBLE, test.text);
+    figures = true;  // Make sure the first character has its shift
+    for (char *c = message; *c; c++) {
+      for (code = 0; code < 32 && testLetters[code] != *c; code++)
+        ;
+      if (code < 32) {
+        if (figures && *c != ' ' && *c != '\r' && *c != '\n') {
+          RTTYTestCharacter(RTTY_LTRS, noise, &sent, &bitTime);
+          figures = false;
+        }
+        if (*c == ' ') figures = false;  // The decoder unshifts on space
+      } else {
+        for (code = 0; code < 32 && testFigures[code] != *c; code++)
+          ;
+        if (code == 32) {
+          continue;
+        }
+        if (!figures) {
+          RTTYTestCharacter(RTTY_FIGS, noise, &sent, &bitTime);
+          figures = true;
+        }
+      }
+      RTTYTestCharacter(code, noise, &sent, &bitTime);
+    }
+    RTTYTestBit(1, 20.0, noise, &sent, &bitTime);  // Let the last character out
+
+    strcpy(decoded, decodeBuffer);
+    for (length = strlen(decoded); length > 0 && decoded[length - 1] == ' '; length--)
+      ;
+    decoded[length] = '\0';
+    expected = strlen(test.text);
+    HostCheck(length >= expected && strcmp(&decoded[length - expected], test.text) == 0,
+              "RTTY decode %4.1f dB SNR, sent \"%s\" decoded \"%s\"", test.snr, test.text, decoded);
+  }
+  printf("RTTY decoder %.1f us/block\n", decodeTime / decodeBlocks);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,87 @@
+// The whole receive chain, ServiceReceiveDSP() through to the audio queues, on synthetic I/Q: each sideband passes
+// its own side of the receive frequency and rejects the other, AM and SAM recover the modulation of a carrier, and
+// the AGC takes at least 10 dB out of a 20 dB change of signal.
+#include "HostTest.h"
+
+static uint32_t rate = 192000;
+
+/*****
+  Purpose: Run a second of a carrier through the receiver and return the played audio.
+
+  Parameter list:
+    float32_t offset      carrier frequency relative to the receive frequency, Hz
+    float32_t amplitude   carrier amplitude, full scale is 32767
+    float32_t modulation  AM depth of a 400 Hz tone, 0 for a plain carrier
+
+  Return value:
+    std::vector<int16_t>  the left channel audio
+*****/
+static std::vector<int16_t> RunCarrier(float32_t offset, float32_t amplitude, float32_t modulation) {
+  uint32_t blockSamples = HostReceiverBlockSamples();
+  std::vector<int16_t> i(blockSamples), q(blockSamples), left, right;
+  double phase = 0.0, tonePhase = 0.0;
+  double step = TWO_PI * (offset - rate / 4.0) / rate;  // The receiver listens a quarter of the rate below center
+
+  for (uint32_t block = 0; block < rate / blockSamples; block++) {
+    for (uint32_t k = 0; k < blockSamples; k++) {
+      double envelope = amplitude * (1.0 + modulation * sin(tonePhase));
+      i[k] = (int16_t)lrint(envelope * cos(phase));
+      q[k] = (int16_t)lrint(envelope * sin(phase));
+      phase = fmod(phase + step, TWO_PI);
+      tonePhase = fmod(tonePhase + TWO_PI * 400.0 / rate, TWO_PI);
+    }
+    HostReceiverProcess(i.data(), q.data(), true, left, right);
+  }
+  return left;
+}
+
+// Audio frequency from the zero crossings of the second half
+static double AudioFrequency(const std::vector<int16_t> &audio) {
+  int crossings = 0;
+
+  for (size_t k = audio.size() / 2 + 1; k < audio.size(); k++) {
+    if ((audio[k - 1] < 0) != (audio[k] < 0)) crossings++;
+  }
+  return crossings / 2.0 / ((audio.size() - audio.size() / 2) / (double)rate);
+}
+
+int main() {
+  double wanted, unwanted, frequency, strong, weak;
+
+  HostReceiverStart(rate);
+  HostReceiverVolume(75);
+
+  HostReceiverMode(DEMOD_USB);
+  weak = HostRMS(RunCarrier(1000.0, 900.0, 0.0), rate / 2);  // Weak first, the AGC decay is slow
+  strong = HostRMS(RunCarrier(1000.0, 9000.0, 0.0), rate / 2);
+  HostCheck(strong < 3.16 * weak, "AGC, 20 dB change of signal changes the audio %.1f dB", 20.0 * log10(strong / weak));
+
+  std::vector<int16_t> audio = RunCarrier(1000.0, 9000.0, 0.0);
+  wanted = HostRMS(audio, audio.size() / 2);
+  frequency = AudioFrequency(audio);
+  unwanted = HostRMS(RunCarrier(-1000.0, 9000.0, 0.0), audio.size() / 2);
+  HostCheck(fabs(frequency - 1000.0) < 10.0, "USB, carrier 1 kHz up gives %.1f Hz audio", frequency);
+  HostCheck(wanted > 1000.0 && wanted > 31.6 * unwanted, "USB, opposite sideband rejection %.1f dB", 20.0 * log10(wanted / unwanted));
+
+  HostReceiverMode(DEMOD_LSB);
+  audio = RunCarrier(-1000.0, 9000.0, 0.0);
+  wanted = HostRMS(audio, audio.size() / 2);
+  frequency = AudioFrequency(audio);
+  unwanted = HostRMS(RunCarrier(1000.0, 9000.0, 0.0), audio.size() / 2);
+  HostCheck(fabs(frequency - 1000.0) < 10.0, "LSB, carrier 1 kHz down gives %.1f Hz audio", frequency);
+  HostCheck(wanted > 1000.0 && wanted > 31.6 * unwanted, "LSB, opposite sideband rejection %.1f dB", 20.0 * log10(wanted / unwanted));
+
+  HostReceiverMode(DEMOD_AM);
+  audio = RunCarrier(0.0, 6000.0, 0.5);
+  frequency = AudioFrequency(audio);
+  HostCheck(fabs(frequency - 400.0) < 10.0 && HostRMS(audio, audio.size() / 2) > 300.0, "AM, 400 Hz modulation gives %.1f Hz audio",
+            frequency);
+
+  HostReceiverMode(DEMOD_SAM);
+  audio = RunCarrier(200.0, 6000.0, 0.5);
+  frequency = AudioFrequency(audio);
+  HostCheck(fabs(frequency - 400.0) < 15.0 && HostRMS(audio, audio.size() / 2) > 300.0,
+            "SAM, 400 Hz modulation on a carrier 200 Hz off gives %.1f Hz audio", frequency);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,126 @@
+// The receive equalizer against the response it was asked for, ReceiveEQGain(), on a USB filter at each filter FFT
+// size.  From RECEIVE_EQ_FULL_FFT points up it is folded into the filter mask by ApplyReceiveEQ(), and below that it
+// is the filter bank in DoReceiveEQ(), measured with tones.  With two sets of band levels, including a deep cut at
+// 200 Hz, the mask and the bank together must follow the asked response within 1 dB from 200 Hz up at every size.
+// The time per block of DoReceiveEQ() is printed.
+#include "HostTest.h"
+
+#define RECEIVE_EQ_LOW_HZ 200.0   // Lowest band
+#define RECEIVE_EQ_HIGH_HZ 2800.0
+#define RECEIVE_EQ_TOLERANCE 1.0  // dB
+#define RECEIVE_EQ_SETTLE 40      // Blocks for the bank to settle on a tone
+#define RECEIVE_EQ_MEASURE 8      // Blocks the bank's gain is measured over
+
+static float32_t flatTaps[FFT_LENGTH_MAX * 2];
+static float32_t eqTaps[FFT_LENGTH_MAX * 2];
+
+/*****
+  Purpose: Select the filter mask for the current settings and take it back to its taps.
+
+  Parameter list:
+    float32_t *taps       convFFTLength complex taps, the result
+
+  Return value:
+    void
+*****/
+static void ReceiveEQTestTaps(float32_t *taps) {
+  InitFilterMask();
+  FilterMaskBuild();
+  FilterMaskSwap();
+  memcpy(taps, FIR_filter_mask, sizeof(float32_t) * 2 * convFFTLength);
+  arm_cfft_f32(maskS, taps, 1, 1);
+}
+
+/*****
+  Purpose: Response of a filter at one frequency, from its taps, so it can be read between the FFT bins.
+
+  Parameter list:
+    float32_t *taps       convFFTLength complex taps
+    float32_t hz          audio frequency
+
+  Return value:
+    float32_t             magnitude
+*****/
+static float32_t ReceiveEQTestGain(const float32_t *taps, float32_t hz) {
+  float32_t re = 0.0, im = 0.0;
+  float32_t omega = TWO_PI * hz / decimatedRate;
+
+  for (uint32_t n = 0; n < convFFTLength; n++) {
+    re += taps[2 * n] * cosf(omega * n) + taps[2 * n + 1] * sinf(omega * n);
+    im += taps[2 * n + 1] * cosf(omega * n) - taps[2 * n] * sinf(omega * n);
+  }
+  return sqrtf(re * re + im * im);
+}
+
+/*****
+  Purpose: Gain of DoReceiveEQ() for a tone, from a cleared bank.
+
+  Parameter list:
+    float32_t hz          audio frequency
+    double *time          total time in DoReceiveEQ(), microseconds, added to
+    int *blocks           blocks run, added to
+
+  Return value:
+    float32_t             magnitude
+*****/
+static float32_t ReceiveEQTestBankGain(float32_t hz, double *time, int *blocks) {
+  const uint32_t blockSize = FFT_length / 2;
+  float32_t omega = TWO_PI * hz / decimatedRate;
+  double start, inPower = 0.0, outPower = 0.0;
+  uint32_t n = 0;
+
+  memset(recEQBank.state, 0, sizeof(recEQBank.state));
+  for (int block = 0; block < RECEIVE_EQ_SETTLE + RECEIVE_EQ_MEASURE; block++) {
+    for (uint32_t i = 0; i < blockSize; i++, n++) {
+      float_buffer_L[i] = sinf(fmodf(omega * n, TWO_PI));
+      if (block >= RECEIVE_EQ_SETTLE) inPower += float_buffer_L[i] * float_buffer_L[i];
+    }
+    start = HostMicros();
+    DoReceiveEQ();
+    *time += HostMicros() - start;
+    (*blocks)++;
+    if (block < RECEIVE_EQ_SETTLE) continue;
+    for (uint32_t i = 0; i < blockSize; i++) {
+      outPower += float_buffer_L[i] * float_buffer_L[i];
+    }
+  }
+  return sqrt(outPower / inPower);
+}
+
+int main() {
+  const uint32_t lengths[] = { 256, 512, 1024, 2048 };
+  const int levels[2][EQUALIZER_CELL_COUNT] = { { 2, 100, 100, 50, 100, 150, 100, 30, 100, 100, 170, 100, 60, 100 },
+                                                { 100, 160, 40, 100, 100, 100, 180, 100, 20, 100, 100, 100, 130, 100 } };
+  float32_t gain, error, worstError;
+  double bankTime = 0.0;
+  int bankBlocks = 0;
+
+  HostReceiverStart(192000);
+  bands[EEPROMData.currentBand].mode = DEMOD_USB;
+  bands[EEPROMData.currentBand].FLoCut = 50;
+  bands[EEPROMData.currentBand].FHiCut = 3000;
+
+  for (uint32_t length : lengths) {
+    SetConvolutionSize(length);
+    EEPROMData.receiveEQFlag = OFF;
+    ReceiveEQTestTaps(flatTaps);
+    worstError = 0.0;
+    for (int set = 0; set < 2; set++) {
+      memcpy(EEPROMData.equalizerRec, levels[set], sizeof(EEPROMData.equalizerRec));
+      receiveEQGeneration++;
+      EEPROMData.receiveEQFlag = ON;
+      ReceiveEQTestTaps(eqTaps);
+      for (float32_t hz = RECEIVE_EQ_LOW_HZ; hz <= RECEIVE_EQ_HIGH_HZ; hz += 10.0) {
+        gain = ReceiveEQTestGain(eqTaps, hz) / ReceiveEQTestGain(flatTaps, hz);
+        if (length < RECEIVE_EQ_FULL_FFT) gain *= ReceiveEQTestBankGain(hz, &bankTime, &bankBlocks);
+        error = fabsf(20.0 * log10f(gain) - 20.0 * log10f(ReceiveEQGain(TWO_PI * hz / decimatedRate)));
+        worstError = fmaxf(worstError, error);
+      }
+    }
+    HostCheck(worstError <= RECEIVE_EQ_TOLERANCE, "Receive EQ, %4u point FFT, %s, worst error %4.2f dB from %.0f Hz", length,
+              length < RECEIVE_EQ_FULL_FFT ? "filter bank" : "filter mask", worstError, RECEIVE_EQ_LOW_HZ);
+  }
+  printf("  DoReceiveEQ() %.1f us/block\n", bankTime / bankBlocks);
+
+  return hostTestFailures;
+}
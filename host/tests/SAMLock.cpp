@@ -0,0 +1,90 @@
+// The SAM PLL, AMDecodeSAM(), on synthetic AM: with the default omegaN of 200 it must pull in within a second at
+// carrier offsets out to 700 Hz, and follow a carrier drifting at 200 Hz per second to within 5 Hz.  The time per
+// block is printed.
+#include "HostTest.h"
+
+// The PLL and fade leveler state, in Demod.cpp
+extern float32_t dc, dc_insert, dcu, dc_insertu, del_out, omega2, phzerror, SAM_carrier, samCos, samSin;
+
+// Reset the SAM PLL and fade leveler state
+static void SAMResetState() {
+  dc = dc_insert = dcu = dc_insertu = 0.0;
+  del_out = omega2 = fil_out = phzerror = 0.0;
+  samCos = 1.0;
+  samSin = 0.0;
+  SAM_carrier = 0.0;
+  samStatus.carrierOffset = 0.0;
+}
+
+/*****
+  Purpose: Fill one block of iFFT_buffer with an AM signal, 30% modulated by 400 Hz.
+
+  Parameter list:
+    float32_t startHz         carrier offset at the start of the block
+    float32_t endHz           carrier offset at the end of the block, the same as startHz for a steady carrier
+    float32_t *carrierPhase   carrier phase, carried from block to block
+    float32_t *tonePhase      modulation phase, carried from block to block
+
+  Return value:
+    void
+*****/
+static void SAMTestBlock(float32_t startHz, float32_t endHz, float32_t *carrierPhase, float32_t *tonePhase) {
+  float32_t envelope;
+
+  for (unsigned i = 0; i < FFT_length / 2; i++) {
+    envelope = 1.0 + 0.3 * sinf(*tonePhase);
+    iFFT_buffer[FFT_length + 2 * i] = envelope * cosf(*carrierPhase);
+    iFFT_buffer[FFT_length + 2 * i + 1] = envelope * sinf(*carrierPhase);
+    *carrierPhase = fmodf(*carrierPhase + TWO_PI * (startHz + (endHz - startHz) * i / (FFT_length / 2)) / decimatedRate, TWO_PI);
+    *tonePhase = fmodf(*tonePhase + TWO_PI * 400.0 / decimatedRate, TWO_PI);
+  }
+}
+
+int main() {
+  const float32_t offsets[] = { -700.0, -500.0, -300.0, -100.0, 0.0, 100.0, 300.0, 500.0, 700.0 };
+  const float32_t driftSpan = 400.0;
+  float32_t carrierPhase, tonePhase, startHz, endHz, lockedHz, error;
+  float32_t worstError = 0.0;
+  int settleBlocks, driftBlocks, blocks = 0;
+  double start, time = 0.0;
+
+  HostReceiverStart(192000);
+  SAMLoadValues();
+  settleBlocks = decimatedRate / (FFT_length / 2);  // A second
+  driftBlocks = 2 * settleBlocks;
+
+  for (unsigned k = 0; k < sizeof(offsets) / sizeof(offsets[0]); k++) {
+    SAMResetState();
+    carrierPhase = tonePhase = 0.0;
+    for (int block = 0; block < settleBlocks; block++) {
+      SAMTestBlock(offsets[k], offsets[k], &carrierPhase, &tonePhase);
+      start = HostMicros();
+      AMDecodeSAM();
+      time += HostMicros() - start;
+      blocks++;
+    }
+    lockedHz = omega2 * decimatedRate / TWO_PI;
+    HostCheck(fabsf(lockedHz - offsets[k]) < 5.0 && fabsf(samStatus.carrierOffset - offsets[k]) < 10.0,
+              "SAM, carrier %+6.0f Hz, omegaN %.0f: PLL %+8.1f Hz, display %+8.1f Hz", offsets[k], EEPROMData.omegaN, lockedHz,
+              samStatus.carrierOffset);
+  }
+
+  // Carrier drifting from -200 Hz to +200 Hz.  Measure over the second half, after the PLL has pulled in.
+  SAMResetState();
+  carrierPhase = tonePhase = 0.0;
+  for (int block = 0; block < driftBlocks; block++) {
+    startHz = -driftSpan / 2 + driftSpan * block / driftBlocks;
+    endHz = -driftSpan / 2 + driftSpan * (block + 1) / driftBlocks;
+    SAMTestBlock(startHz, endHz, &carrierPhase, &tonePhase);
+    start = HostMicros();
+    AMDecodeSAM();
+    time += HostMicros() - start;
+    blocks++;
+    error = fabsf(omega2 * decimatedRate / TWO_PI - endHz);
+    if (block >= driftBlocks / 2 && error > worstError) worstError = error;
+  }
+  HostCheck(worstError < 5.0, "SAM, carrier drifting 200 Hz per second, worst tracking error %.1f Hz", worstError);
+  printf("AMDecodeSAM(), %u samples: %.1f us/block\n", FFT_length / 2, time / blocks);
+
+  return hostTestFailures;
+}
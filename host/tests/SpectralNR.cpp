@@ -0,0 +1,370 @@
+// The spectral noise reduction, SpectralNoiseReduction(), against the original version, kept here as
+// SpectralNoiseReductionReference().  Both run on three tones keyed on and off at a syllable rate like speech, in
+// noise band limited to the 3 kHz the receive filter would pass.  Once the noise estimate has settled the output
+// must be at least 3 dB closer to the clean signal than the input was, and no more than SPECTRAL_NR_MARGIN worse
+// than the original's.  The time per block of each is printed.
+#include "HostTest.h"
+
+#define NOISE_TAPS 63
+#define SPECTRAL_NR_MARGIN 0.5  // dB the output SNR may fall short of the original's
+
+static uint32_t seed;
+static float32_t noiseTaps[NOISE_TAPS];  // 3 kHz windowed sinc lowpass
+static float32_t noiseLine[NOISE_TAPS];  // White noise, newest first
+
+/*****
+  Purpose: spectral_noise_reduction, the original version.
+  Parameter list:
+    void
+  Return value;
+    void
+*****/
+static void SpectralNoiseReductionReference()
+/************************************************************************************************************
+
+      Noise reduction with spectral subtraction rule
+      based on Romanin et al. 2009 & Schmitt et al. 2002
+      and MATLAB voicebox
+      and Gerkmann & Hendriks 2002
+      and Yao et al. 2016
+
+   STAND: UHSDR github 14.1.2018
+   ************************************************************************************************************/
+{
+  static uint8_t NR_init_counter = 0;
+  uint8_t VAD_low = 0;
+  uint8_t VAD_high = 127;
+  float32_t lf_freq; // = (offset - width/2) / (12000 / NR_FFT_L); // bin BW is 46.9Hz [12000Hz / 256 bins] @96kHz
+  float32_t uf_freq; //= (offset + width/2) / (12000 / NR_FFT_L);
+
+  const float32_t tinc = 0.00533333;  // frame time 5.3333ms
+  const float32_t tax = 0.0239;       // noise output smoothing time constant = -tinc/ln(0.8)
+  const float32_t tap = 0.05062;      // speech prob smoothing time constant = -tinc/ln(0.9) tinc = frame time (5.33ms)
+  const float32_t psthr = 0.99;       // threshold for smoothed speech probability [0.99]
+  const float32_t pnsaf = 0.01;       // noise probability safety value [0.01]
+  const float32_t asnr = 20;          // active SNR in dB
+  const float32_t psini = 0.5;        // initial speech probability [0.5]
+  const float32_t pspri = 0.5;        // prior speech probability [0.5]
+  static float32_t ax;                //=0.8;       // ax=exp(-tinc/tax); % noise output smoothing factor
+  static float32_t ap;                //=0.9;        // ap=exp(-tinc/tap); % noise output smoothing factor
+  static float32_t xih1;              // = 31.6;
+  ax = expf(-tinc / tax);
+  ap = expf(-tinc / tap);
+  xih1 = powf(10, (float32_t)asnr / 10.0);
+  static float32_t xih1r = 1.0 / (1.0 + xih1) - 1.0;
+  static float32_t pfac = (1.0 / pspri - 1.0) * (1.0 + xih1);
+  float32_t snr_prio_min = powf(10, - (float32_t)20 / 20.0);
+  static float32_t pslp[NR_FFT_L / 2];
+  static float32_t xt[NR_FFT_L / 2];
+  static float32_t xtr;
+  static float32_t pre_power;
+  static float32_t post_power;
+  static float32_t power_ratio;
+  static int16_t NN;
+  const int16_t NR_width = 4;
+  const float32_t power_threshold = 0.4;
+  float32_t ph1y[NR_FFT_L / 2];
+  static int NR_first_time_2 = 1;
+
+  if (bands[EEPROMData.currentBand].FLoCut <= 0 && bands[EEPROMData.currentBand].FHiCut >= 0) {
+    lf_freq = 0.0;
+    uf_freq = fmax(-(float32_t)bands[EEPROMData.currentBand].FLoCut, (float32_t)bands[EEPROMData.currentBand].FHiCut);
+  } else {
+    if (bands[EEPROMData.currentBand].FLoCut > 0) {
+      lf_freq = (float32_t)bands[EEPROMData.currentBand].FLoCut;
+      uf_freq = (float32_t)bands[EEPROMData.currentBand].FHiCut;
+    } else {
+      uf_freq = -(float32_t)bands[EEPROMData.currentBand].FLoCut;
+      lf_freq = -(float32_t)bands[EEPROMData.currentBand].FHiCut;
+    }
+  }
+  // / rate DF SR[SampleRate].rate/DF
+  lf_freq /= (decimatedRate / NR_FFT_L); // bin BW is 46.9Hz [12000Hz / 256 bins] @96kHz
+  uf_freq /= (decimatedRate / NR_FFT_L);
+
+
+  // INITIALIZATION ONCE 1
+  if (NR_first_time_2 == 1) { // TODO: properly initialize all the variables
+    for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
+      NR_last_sample_buffer_L[bindx] = 0.0;
+      NR_G[bindx] = 1.0;
+      //xu[bindx] = 1.0;  //has to be replaced by other variable
+      NR_Hk_old[bindx] = 1.0; // old gain or xu in development mode
+      NR_Nest[bindx][0] = 0.0;
+      NR_Nest[bindx][1] = 1.0;
+      pslp[bindx] = 0.5;
+    }
+    NR_first_time_2 = 2; // we need to do some more a bit later down
+  }
+
+  for (int k = 0; k < 2; k++) {
+    // NR_FFT_buffer is 512 floats big
+    // interleaved r, i, r, i . . .
+    // fill first half of FFT_buffer with last events audio samples
+    for (int i = 0; i < NR_FFT_L / 2; i++) {
+      NR_FFT_buffer[i * 2] = NR_last_sample_buffer_L[i]; // real
+      NR_FFT_buffer[i * 2 + 1] = 0.0; // imaginary
+    }
+    // copy recent samples to last_sample_buffer for next time!
+    for (int i = 0; i < NR_FFT_L  / 2; i++) {
+      NR_last_sample_buffer_L [i] = float_buffer_L[i + k * (NR_FFT_L / 2)];
+    }
+    // now fill recent audio samples into second half of FFT_buffer
+    for (int i = 0; i < NR_FFT_L / 2; i++) {
+      NR_FFT_buffer[NR_FFT_L + i * 2] = float_buffer_L[i + k * (NR_FFT_L / 2)]; // real
+      NR_FFT_buffer[NR_FFT_L + i * 2 + 1] = 0.0;
+    }
+    // perform windowing on samples in the NR_FFT_buffer
+    for (int idx = 0; idx < NR_FFT_L; idx++) { // sqrt Hann window
+      NR_FFT_buffer[idx * 2] *= sqrtHann[idx];
+    }
+
+    // NR_FFT
+    // calculation is performed in-place the FFT_buffer [re, im, re, im, re, im . . .]
+    arm_cfft_f32(NR_FFT, NR_FFT_buffer, 0, 1);
+
+    for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
+      // this is squared magnitude for the current frame
+      NR_X[bindx][0] = (NR_FFT_buffer[bindx * 2] * NR_FFT_buffer[bindx * 2] + NR_FFT_buffer[bindx * 2 + 1] * NR_FFT_buffer[bindx * 2 + 1]);
+    }
+
+    if (NR_first_time_2 == 2) { // TODO: properly initialize all the variables
+      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {
+        NR_Nest[bindx][0] = NR_Nest[bindx][0] + 0.05 * NR_X[bindx][0]; // we do it 20 times to average over 20 frames for app. 100ms only on NR_on/bandswitch/modeswitch,...
+        xt[bindx] = psini * NR_Nest[bindx][0];
+      }
+      NR_init_counter++;
+      if (NR_init_counter > 19)  { //average over 20 frames for app. 100ms
+        NR_init_counter = 0;
+        NR_first_time_2 = 3;  // now we did all the necessary initialization to actually start the noise reduction
+      }
+    }
+
+    if (NR_first_time_2 == 3) {
+      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) { // 1. Step of NR - calculate the SNR's
+        ph1y[bindx] = 1.0 / (1.0 + pfac * expf(xih1r * NR_X[bindx][0] / xt[bindx]));
+        pslp[bindx] = ap * pslp[bindx] + (1.0 - ap) * ph1y[bindx];
+
+        if (pslp[bindx] > psthr) {
+          ph1y[bindx] = 1.0 - pnsaf;
+        } else {
+          ph1y[bindx] = fmin(ph1y[bindx] , 1.0);
+        }
+        xtr = (1.0 - ph1y[bindx]) * NR_X[bindx][0] + ph1y[bindx] * xt[bindx];
+        xt[bindx] = ax * xt[bindx] + (1.0 - ax) * xtr;
+      }
+      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) { // 1. Step of NR - calculate the SNR's
+        NR_SNR_post[bindx] = fmax(fmin(NR_X[bindx][0] / xt[bindx], 1000.0), snr_prio_min); // limited to +30 /-15 dB, might be still too much of reduction, let's try it?
+        NR_SNR_prio[bindx] = fmax(EEPROMData.NR_alpha * NR_Hk_old[bindx] + (1.0 - EEPROMData.NR_alpha) * fmax(NR_SNR_post[bindx] - 1.0, 0.0), 0.0);
+      }
+
+      VAD_low = (int)lf_freq;
+      VAD_high = (int)uf_freq;
+      if (VAD_low == VAD_high) {
+        VAD_high++;
+      }
+      if (VAD_low < 1) {
+        VAD_low = 1;
+      } else if (VAD_low > NR_FFT_L / 2 - 2) {
+        VAD_low = NR_FFT_L / 2 - 2;
+      }
+      if (VAD_high < 1) {
+        VAD_high = 1;
+      } else if (VAD_high > NR_FFT_L / 2) {
+        VAD_high = NR_FFT_L / 2;
+      }
+
+      float32_t v;
+      for (int bindx = VAD_low; bindx < VAD_high; bindx++) { // maybe we should limit this to the signal containing bins (filtering!!)
+        {
+          v = NR_SNR_prio[bindx] * NR_SNR_post[bindx] / (1.0 + NR_SNR_prio[bindx]);
+          NR_G[bindx] = 1.0 / NR_SNR_post[bindx] * sqrtf((0.7212 * v + v * v));
+          NR_Hk_old[bindx] = NR_SNR_post[bindx] * NR_G[bindx] * NR_G[bindx]; //
+        }
+
+        // MUSICAL NOISE TREATMENT HERE, DL2FW
+
+        // musical noise "artefact" reduction by dynamic averaging - depending on SNR ratio
+        pre_power  = 0.0;
+        post_power = 0.0;
+        for (int bindx = VAD_low; bindx < VAD_high; bindx++) {
+          pre_power += NR_X[bindx][0];
+          post_power += NR_G[bindx] * NR_G[bindx]  * NR_X[bindx][0];
+        }
+
+        power_ratio = post_power / pre_power;
+        if (power_ratio > power_threshold) {
+          power_ratio = 1.0;
+          NN = 1;
+        } else {
+          NN = 1 + 2 * (int)(0.5 + NR_width * (1.0 - power_ratio / power_threshold));
+        }
+
+        for (int bindx = VAD_low + NN / 2; bindx < VAD_high - NN / 2; bindx++) {
+          NR_Nest[bindx][0] = 0.0;
+          for (int m = bindx - NN / 2; m <= bindx + NN / 2; m++) {
+            NR_Nest[bindx][0] += NR_G[m];
+          }
+          NR_Nest[bindx][0] /= (float32_t)NN;
+        }
+
+        // and now the edges - only going NN steps forward and taking the average
+        // lower edge
+        for (int bindx = VAD_low; bindx < VAD_low + NN / 2; bindx++) {
+          NR_Nest[bindx][0] = 0.0;
+          for (int m = bindx; m < (bindx + NN); m++) {
+            NR_Nest[bindx][0] += NR_G[m];
+          }
+          NR_Nest[bindx][0] /= (float32_t)NN;
+        }
+
+        // upper edge - only going NN steps backward and taking the average
+        for (int bindx = VAD_high - NN; bindx < VAD_high; bindx++) {
+          NR_Nest[bindx][0] = 0.0;
+          for (int m = bindx; m > (bindx - NN); m--) {
+            NR_Nest[bindx][0] += NR_G[m];
+          }
+          NR_Nest[bindx][0] /= (float32_t)NN;
+        }
+
+        // end of edge treatment
+
+        for (int bindx = VAD_low + NN / 2; bindx < VAD_high - NN / 2; bindx++) {
+          NR_G[bindx] = NR_Nest[bindx][0];
+        }
+        // end of musical noise reduction
+      } //end of "if ts.nr_first_time == 3"
+
+      // FINAL SPECTRAL WEIGHTING: Multiply current FFT results with NR_FFT_buffer for 128 bins with the 128 bin-specific gain factors G
+      for (int bindx = 0; bindx < NR_FFT_L / 2; bindx++) {                              // try 128:
+        NR_FFT_buffer[bindx * 2]                    = NR_FFT_buffer [bindx * 2] * NR_G[bindx] * NR_long_tone_gain[bindx];              // real part
+        NR_FFT_buffer[bindx * 2 + 1]                = NR_FFT_buffer [bindx * 2 + 1] * NR_G[bindx] * NR_long_tone_gain[bindx];      // imag part
+        NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 2] = NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 2] * NR_G[bindx] * NR_long_tone_gain[bindx]; // real part conjugate symmetric
+        NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 1] = NR_FFT_buffer[NR_FFT_L * 2 - bindx * 2 - 1] * NR_G[bindx] * NR_long_tone_gain[bindx]; // imag part conjugate symmetric
+      }
+
+      arm_cfft_f32(NR_iFFT, NR_FFT_buffer, 1, 1);
+
+      for (int idx = 0; idx < NR_FFT_L; idx++) {
+        NR_FFT_buffer[idx * 2] *= sqrtHann[idx];      // sqrt Hann window
+      }
+
+      // do the overlap & add
+      for (int i = 0; i < NR_FFT_L / 2; i++) {        // take real part of first half of current iFFT result and add to 2nd half of last iFFT_result
+        float_buffer_L[i + k * (NR_FFT_L / 2)] = NR_FFT_buffer[i * 2] + NR_last_iFFT_result[i];
+        float_buffer_R[i + k * (NR_FFT_L / 2)] = float_buffer_L[i + k * (NR_FFT_L / 2)];
+      }
+      for (int i = 0; i < NR_FFT_L / 2; i++) {
+        NR_last_iFFT_result[i] = NR_FFT_buffer[NR_FFT_L + i * 2];
+      }
+      // end of "for" loop which repeats the FFT_iFFT_chain two times !!!
+    }
+  }
+}
+
+/*****
+  Purpose: Fill float_buffer_L with one block of the test signal.  The clean signal is left in clean.
+
+  Parameter list:
+    float32_t *clean      FFT_length / 2 samples of the signal without noise
+    uint32_t *phase       sample counter, carried from block to block
+
+  Return value:
+    void
+*****/
+static void SpectralNRTestBlock(float32_t *clean, uint32_t *phase) {
+  const float32_t tones[] = { 400.0, 1100.0, 2300.0 };
+  float32_t t, envelope, noise;
+
+  for (unsigned i = 0; i < FFT_length / 2; i++, (*phase)++) {
+    t = *phase / decimatedRate;
+    envelope = (fmodf(t, 0.3) < 0.18) ? 1.0 : 0.0;  // 180 ms on, 120 ms off
+    clean[i] = 0.0;
+    for (int j = 0; j < 3; j++) {
+      clean[i] += envelope * 0.1 * sinf(TWO_PI * tones[j] * t);
+    }
+    memmove(&noiseLine[1], noiseLine, (NOISE_TAPS - 1) * sizeof(float32_t));
+    noiseLine[0] = HostNoise(&seed);
+    arm_dot_prod_f32(noiseTaps, noiseLine, NOISE_TAPS, &noise);
+    float_buffer_L[i] = clean[i] + 0.1 * noise;
+    float_buffer_R[i] = float_buffer_L[i];
+  }
+}
+
+/*****
+  Purpose: Run one of the two noise reductions on the test signal from a cleared state.  The output is 128 samples
+           late, so it is compared with the clean signal from then.
+
+  Parameter list:
+    bool reference        true for SpectralNoiseReductionReference(), false for SpectralNoiseReduction()
+    float32_t *inSNR      SNR of the input once the noise estimate has settled, dB
+    float32_t *outSNR     SNR of the output over the same blocks
+
+  Return value:
+    double                time per block, microseconds
+*****/
+static double SpectralNRRun(bool reference, float32_t *inSNR, float32_t *outSNR) {
+  const int blocks = 200;  // About two seconds
+  const int delay = NR_FFT_L / 2;
+  float32_t clean[FFT_LENGTH_MAX / 2 + NR_FFT_L / 2];  // Last block's tail, then this block
+  float32_t error, inSignal = 0.0, inError = 0.0, outSignal = 0.0, outError = 0.0;
+  uint32_t phase = 0;
+  double start, total = 0.0;
+
+  seed = 1;
+  arm_fill_f32(0.0, noiseLine, NOISE_TAPS);
+  arm_fill_f32(0.0, clean, FFT_LENGTH_MAX / 2 + NR_FFT_L / 2);
+  arm_fill_f32(0.0, NR_last_iFFT_result, NR_FFT_L / 2);
+  arm_fill_f32(1.0, NR_long_tone_gain, NR_FFT_L / 2);
+  SpectralNoiseReductionInit();
+
+  for (int block = 0; block < blocks; block++) {
+    arm_copy_f32(&clean[FFT_length / 2], clean, delay);
+    SpectralNRTestBlock(&clean[delay], &phase);
+    if (block >= blocks / 2) {
+      for (unsigned i = 0; i < FFT_length / 2; i++) {
+        error = float_buffer_L[i] - clean[delay + i];
+        inSignal += clean[delay + i] * clean[delay + i];
+        inError += error * error;
+      }
+    }
+    start = HostMicros();
+    if (reference) {
+      SpectralNoiseReductionReference();
+    } else {
+      SpectralNoiseReduction();
+    }
+    total += HostMicros() - start;
+    if (block >= blocks / 2) {
+      for (unsigned i = 0; i < FFT_length / 2; i++) {
+        error = float_buffer_L[i] - clean[i];
+        outSignal += clean[i] * clean[i];
+        outError += error * error;
+      }
+    }
+  }
+  *inSNR = 10.0 * log10f(inSignal / inError);
+  *outSNR = 10.0 * log10f(outSignal / outError);
+  return total / blocks;
+}
+
+int main() {
+  float32_t inSNR, outSNR, referenceSNR;
+  double time, referenceTime;
+
+  HostReceiverStart(192000);
+  HostReceiverMode(DEMOD_USB);  // A 3 kHz passband
+  for (int k = 0; k < NOISE_TAPS; k++) {
+    float32_t x = k - (NOISE_TAPS - 1) / 2;
+    float32_t fc = 3000.0 / decimatedRate;
+    noiseTaps[k] = (x == 0.0 ? 2.0 * fc : sinf(TWO_PI * fc * x) / (PI * x)) * (0.54 - 0.46 * cosf(TWO_PI * k / (NOISE_TAPS - 1)));
+  }
+
+  referenceTime = SpectralNRRun(true, &inSNR, &referenceSNR);
+  time = SpectralNRRun(false, &inSNR, &outSNR);
+  HostCheck(outSNR > inSNR + 3.0, "Spectral NR, input SNR %.1f dB, output SNR %.1f dB", inSNR, outSNR);
+  HostCheck(outSNR > referenceSNR - SPECTRAL_NR_MARGIN, "  original output SNR %.1f dB", referenceSNR);
+  printf("  restructured %.1f us/block, original %.1f us/block\n", time, referenceTime);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,65 @@
+// The display spectrum average, SpectrumAverage(), in the hold modes.  The display holds, but the S-meter spectrum in
+// FFT_spec_old must follow the signal, and a new receive frequency must start the display hold again.
+#include "HostTest.h"
+
+/*****
+  Purpose: Run a flat spectrum through SpectrumAverage() 20 times a second.
+
+  Parameter list:
+    float32_t level       power in every bin
+    int frames            how many spectra
+    float32_t *display    SPECTRUM_RES values, the display spectrum after the last one
+
+  Return value:
+    void
+*****/
+static void SpectrumAverageTest(float32_t level, int frames, float32_t *display) {
+  for (int k = 0; k < frames; k++) {
+    delay(50);
+    arm_fill_f32(level, display, SPECTRUM_RES);
+    SpectrumAverage(display);
+  }
+}
+
+// Level of a bin in dB, for the reports
+static float32_t SpectrumAverageDB(float32_t power) {
+  return 10.0 * log10f(power);
+}
+
+int main() {
+  float32_t display[SPECTRUM_RES];
+
+  HostReceiverStart(192000);
+
+  // Min hold: the display keeps the quiet level, the meter follows the signal up
+  EEPROMData.spectrumAverage = SPECTRUM_AVERAGE_MIN_HOLD;
+  SpectrumAverageReset();
+  SpectrumAverageTest(1.0, 10, display);
+  SpectrumAverageTest(100.0, 20, display);
+  HostCheck(fabsf(SpectrumAverageDB(display[100])) < 0.1, "Min hold, display %.1f dB after a 20 dB rise", SpectrumAverageDB(display[100]));
+  HostCheck(fabsf(SpectrumAverageDB(FFT_spec_old[100]) - 20.0) < 0.5, "Min hold, S-meter spectrum %.1f dB after a 20 dB rise",
+            SpectrumAverageDB(FFT_spec_old[100]));
+
+  // Peak hold: half a second after the signal goes the display is still falling, a second after the meter has
+  // followed it down
+  EEPROMData.spectrumAverage = SPECTRUM_AVERAGE_PEAK_HOLD;
+  SpectrumAverageReset();
+  SpectrumAverageTest(100.0, 10, display);
+  SpectrumAverageTest(1.0, 10, display);
+  HostCheck(SpectrumAverageDB(display[100]) > 5.0, "Peak hold, display %.1f dB half a second after a 20 dB fall",
+            SpectrumAverageDB(display[100]));
+  SpectrumAverageTest(1.0, 10, display);
+  HostCheck(fabsf(SpectrumAverageDB(FFT_spec_old[100])) < 0.5, "Peak hold, S-meter spectrum %.1f dB a second after a 20 dB fall",
+            SpectrumAverageDB(FFT_spec_old[100]));
+
+  // A new receive frequency drops the held spectrum
+  EEPROMData.spectrumAverage = SPECTRUM_AVERAGE_MIN_HOLD;
+  SpectrumAverageTest(100.0, 1, display);
+  EEPROMData.centerFreq += 10000;
+  SetFreq();
+  SpectrumAverageTest(100.0, 1, display);
+  HostCheck(fabsf(SpectrumAverageDB(display[100]) - 20.0) < 0.1, "Min hold, display %.1f dB on the first spectrum after retuning",
+            SpectrumAverageDB(display[100]));
+
+  return hostTestFailures;
+}
@@ -0,0 +1,70 @@
+// The spectrum FFT throttle, SpectrumFFTDue(), counted in display sweeps.  At 48K a 2048 point setting runs 512
+// points at 1x, which transforms one block, and must give a new spectrum every sweep.  The 2x zoom fills its own
+// ring, so it must get the full 2048 points, and a new spectrum in one sweep out of four, never two in a row.
+#include "HostTest.h"
+
+#define SPECTRUM_SWEEP_BLOCKS 4  // Blocks in each display sweep
+#define SPECTRUM_SWEEP_COUNT 40
+
+/*****
+  Purpose: Run display sweeps of noise through the receiver, clearing spectrumFresh after each one the way
+           ShowSpectrum() does when it scrolls the waterfall.
+
+  Parameter list:
+    int *shortestGap      fewest sweeps from one spectrum to the next, the result
+    int *longestGap       most sweeps from one spectrum to the next, the result
+
+  Return value:
+    int                   sweeps that had a new spectrum
+*****/
+static int SpectrumSweepRun(int *shortestGap, int *longestGap) {
+  static uint32_t seed = 1;
+  std::vector<int16_t> i(HostReceiverBlockSamples()), q(HostReceiverBlockSamples()), left, right;
+  int fresh = 0, gap = 0;
+
+  *shortestGap = SPECTRUM_SWEEP_COUNT;
+  *longestGap = 0;
+  spectrumFresh = false;
+  for (int sweep = 0; sweep < SPECTRUM_SWEEP_COUNT; sweep++) {
+    for (int block = 0; block < SPECTRUM_SWEEP_BLOCKS; block++) {
+      for (uint32_t k = 0; k < HostReceiverBlockSamples(); k++) {
+        i[k] = 1000.0 * HostNoise(&seed);
+        q[k] = 1000.0 * HostNoise(&seed);
+      }
+      HostReceiverProcess(i.data(), q.data(), block == 0, left, right);
+    }
+    gap++;
+    if (spectrumFresh) {
+      if (fresh > 0) {
+        *longestGap = max(*longestGap, gap);
+        *shortestGap = min(*shortestGap, gap);
+      }
+      fresh++;
+      gap = 0;
+    }
+    spectrumFresh = false;
+  }
+  return fresh;
+}
+
+int main() {
+  int fresh, shortestGap, longestGap;
+
+  HostReceiverStart(48000);
+  EEPROMData.spectrumFFTSize = SPECTRUM_FFT_MAX;
+
+  EEPROMData.spectrum_zoom = SPECTRUM_ZOOM_1;
+  ZoomFFTPrep();
+  fresh = SpectrumSweepRun(&shortestGap, &longestGap);
+  HostCheck(spectrumFFTLength == BUFFER_SIZE * N_BLOCKS && fresh == SPECTRUM_SWEEP_COUNT,
+            "1x, %u point FFT, new spectrum in %d of %d sweeps", spectrumFFTLength, fresh, SPECTRUM_SWEEP_COUNT);
+
+  EEPROMData.spectrum_zoom = SPECTRUM_ZOOM_2;
+  ZoomFFTPrep();
+  fresh = SpectrumSweepRun(&shortestGap, &longestGap);
+  HostCheck(spectrumFFTLength == SPECTRUM_FFT_MAX && shortestGap == SPECTRUM_FFT_MAX / SPECTRUM_RES && longestGap == shortestGap,
+            "2x, %u point FFT, new spectrum in %d of %d sweeps, every %d to %d sweeps", spectrumFFTLength, fresh,
+            SPECTRUM_SWEEP_COUNT, shortestGap, longestGap);
+
+  return hostTestFailures;
+}
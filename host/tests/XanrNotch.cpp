@@ -0,0 +1,134 @@
+// The variable leak LMS filter, Xanr(), as the automatic notch on a 1 kHz tone in white noise: from cleared weights
+// it must take the tone out within three seconds, leaving little more than the noise.  The original version on a
+// masked circular delay line, kept here as XanrReference(), runs alongside from the same start and the two outputs
+// must agree.  The time per block of each is printed.
+#include "HostTest.h"
+
+#define XANR_TOLERANCE 1.0e-3  // Allowed difference from the reference, relative to the tone amplitude
+
+static uint32_t seed = 1;
+
+// XanrReference() state, apart from the sketch's so both start the same
+static float32_t referenceD[ANR_DLINE_SIZE];
+static float32_t referenceW[ANR_DLINE_SIZE];
+static int referenceInIdx = 0;
+static float32_t referenceLidx;
+static float32_t referenceNgamma;
+
+/*****
+  Purpose: Fill float_buffer_L with one block of a 1 kHz tone in white noise.
+
+  Parameter list:
+    uint32_t *phase       sample counter, carried from block to block
+
+  Return value:
+    void
+*****/
+static void XanrTestBlock(uint32_t *phase) {
+  for (int i = 0; i < ANR_buff_size; i++, (*phase)++) {
+    float_buffer_L[i] = 0.2 * sinf(TWO_PI * 1000.0 * (*phase) / decimatedRate) + 0.02 * HostNoise(&seed);
+  }
+}
+
+/*****
+  Purpose: Variable leak LMS, the original version.  Reads float_buffer_L like Xanr() and writes its output to out.
+
+  Parameter list:
+    float32_t *out        ANR_buff_size samples
+
+  Return value:
+    void
+*****/
+static void XanrReference(float32_t *out) // variable leak LMS algorithm for automatic notch or noise reduction
+{ // (c) Warren Pratt wdsp library 2016
+  int idx;
+  float32_t c0, c1;
+  float32_t y, error, sigma, inv_sigp;
+  float32_t nel, nev;
+
+  for (int i = 0; i < ANR_buff_size; i++) {
+    referenceD[referenceInIdx] = float_buffer_L[i];
+
+    y = 0;
+    sigma = 0;
+
+    for (int j = 0; j < ANR_taps; j++) {
+      idx = (referenceInIdx + j + ANR_delay) & ANR_mask;
+      y += referenceW[j] * referenceD[idx];
+      sigma += referenceD[idx] * referenceD[idx];
+    }
+    inv_sigp = 1.0 / (sigma + 1e-10);
+    error = referenceD[referenceInIdx] - y;
+
+    if (ANR_notch)
+      out[i] = error;                            // NOTCH FILTER
+    else
+      out[i] = y;                                // NOISE REDUCTION
+
+    if ((nel = error * (1.0 - ANR_two_mu * sigma * inv_sigp)) < 0.0)
+      nel = -nel;
+    if ((nev = referenceD[referenceInIdx] - (1.0 - ANR_two_mu * referenceNgamma) * y - ANR_two_mu * error * sigma * inv_sigp) < 0.0)
+      nev = -nev;
+    if (nev < nel) {
+      if ((referenceLidx += ANR_lincr) > ANR_lidx_max)
+        referenceLidx = ANR_lidx_max;
+      else if ((referenceLidx -= ANR_ldecr) < ANR_lidx_min)
+        referenceLidx = ANR_lidx_min;
+    }
+    referenceNgamma = ANR_gamma * (referenceLidx * referenceLidx) * (referenceLidx * referenceLidx) * ANR_den_mult;
+
+    c0 = 1.0 - ANR_two_mu * referenceNgamma;
+    c1 = ANR_two_mu * error * inv_sigp;
+
+    for (int j = 0; j < ANR_taps; j++) {
+      idx = (referenceInIdx + j + ANR_delay) & ANR_mask;
+      referenceW[j] = c0 * referenceW[j] + c1 * referenceD[idx];
+    }
+    referenceInIdx = (referenceInIdx + ANR_mask) & ANR_mask;
+  }
+}
+
+int main() {
+  const int blocks = 300;  // About three seconds
+  const float32_t noisePower = 0.02 * 0.02;
+  float32_t power, firstPower = 0.0, lastPower = 0.0, worstError = 0.0;
+  float32_t reference[ANR_DLINE_SIZE];
+  uint32_t phase = 0;
+  double start, time = 0.0, referenceTime = 0.0;
+
+  HostReceiverStart(192000);
+  ANR_notch = 1;
+  memset(ANR_d, 0, sizeof(float32_t) * 2 * ANR_DLINE_SIZE);
+  memset(ANR_w, 0, sizeof(float32_t) * ANR_DLINE_SIZE);
+  ANR_in_idx = 0;
+  ANR_lidx = ANR_lidx_min;
+  ANR_ngamma = 0.001;
+  referenceLidx = ANR_lidx;
+  referenceNgamma = ANR_ngamma;
+
+  for (int block = 0; block < blocks; block++) {
+    XanrTestBlock(&phase);
+    start = HostMicros();
+    XanrReference(reference);
+    referenceTime += HostMicros() - start;
+    start = HostMicros();
+    Xanr();
+    time += HostMicros() - start;
+    for (int i = 0; i < ANR_buff_size; i++) {
+      worstError = fmaxf(worstError, fabsf(float_buffer_R[i] - reference[i]) / 0.2);
+    }
+    arm_power_f32(float_buffer_R, ANR_buff_size, &power);
+    power /= ANR_buff_size;
+    if (block == 0) firstPower = power;
+    if (block >= blocks - 10) lastPower += power / 10;
+  }
+  HostCheck(firstPower > 10.0 * noisePower, "LMS notch, %d taps, first block %.1f dB over the noise", ANR_taps,
+            10.0 * log10f(firstPower / noisePower));
+  HostCheck(lastPower < 2.0 * noisePower, "LMS notch, %d taps, after three seconds %.1f dB over the noise", ANR_taps,
+            10.0 * log10f(lastPower / noisePower));
+  HostCheck(worstError <= XANR_TOLERANCE, "LMS notch against the circular delay line version, worst error %.2g of the tone",
+            worstError);
+  printf("  mirrored delay line %.1f us/block, circular delay line %.1f us/block\n", time / blocks, referenceTime / blocks);
+
+  return hostTestFailures;
+}
@@ -0,0 +1,146 @@
+// The transmit equalizer, DoExciterEQ(), against the original 14 separate band cascades, scales, and adds, kept here
+// as ExciterEQReference(), and against the band by band single pass it replaced, ExciterEQPerSample().  All three
+// run on the same blocks of noise with a spread of band levels, including bands set to zero, and must agree to float
+// rounding.  The time per block of each is printed.
+#include "HostTest.h"
+
+#define XMIT_EQ_TOLERANCE 1.0e-5  // Allowed difference, relative to the largest reference sample
+
+static uint32_t seed = 1;
+static float32_t bandBuffer[EQUALIZER_CELL_COUNT][256];
+static float32_t perSampleCoeffs[EQUALIZER_CELL_COUNT][IIR_NUMSTAGES][5];
+static float32_t perSampleState[EQUALIZER_CELL_COUNT][IIR_NUMSTAGES][2];
+static int perSampleActive[EQUALIZER_CELL_COUNT];
+static int perSampleActiveCount = 0;
+
+/*****
+  Purpose: Transmit equalizer, the original version.  Each band runs into its own buffer, is scaled by its level with
+           alternating signs, and the 14 buffers are added.
+
+  Parameter list:
+    float32_t *buffer     256 samples, equalized in place
+
+  Return value:
+    void
+*****/
+static void ExciterEQReference(float32_t *buffer) {
+  arm_biquad_cascade_df2T_instance_f32 *eqBands[] = { &S1_Xmt, &S2_Xmt, &S3_Xmt, &S4_Xmt, &S5_Xmt, &S6_Xmt, &S7_Xmt,
+                                                      &S8_Xmt, &S9_Xmt, &S10_Xmt, &S11_Xmt, &S12_Xmt, &S13_Xmt, &S14_Xmt };
+
+  for (int band = 0; band < EQUALIZER_CELL_COUNT; band++) {
+    arm_biquad_cascade_df2T_f32(eqBands[band], buffer, bandBuffer[band], 256);
+    arm_scale_f32(bandBuffer[band], (band % 2 == 0 ? -1.0 : 1.0) * (float)EEPROMData.equalizerXmt[band] / 100.0, bandBuffer[band], 256);
+  }
+  arm_add_f32(bandBuffer[0], bandBuffer[1], buffer, 256);
+  for (int band = 2; band < EQUALIZER_CELL_COUNT; band++) {
+    arm_add_f32(buffer, bandBuffer[band], buffer, 256);
+  }
+}
+
+/*****
+  Purpose: Set up ExciterEQPerSample() from the band filters and equalizerXmt[], with each level folded into the
+           numerator of the band's last stage.
+
+  Parameter list:
+    void
+
+  Return value:
+    void
+*****/
+static void ExciterEQPerSampleLoad() {
+  arm_biquad_cascade_df2T_instance_f32 *eqBands[] = { &S1_Xmt, &S2_Xmt, &S3_Xmt, &S4_Xmt, &S5_Xmt, &S6_Xmt, &S7_Xmt,
+                                                      &S8_Xmt, &S9_Xmt, &S10_Xmt, &S11_Xmt, &S12_Xmt, &S13_Xmt, &S14_Xmt };
+  float32_t level;
+
+  perSampleActiveCount = 0;
+  for (int band = 0; band < EQUALIZER_CELL_COUNT; band++) {
+    level = (band % 2 == 0 ? -1.0 : 1.0) * EEPROMData.equalizerXmt[band] / 100.0;
+    memcpy(perSampleCoeffs[band], eqBands[band]->pCoeffs, sizeof(perSampleCoeffs[band]));
+    for (int i = 0; i < 3; i++) {
+      perSampleCoeffs[band][IIR_NUMSTAGES - 1][i] *= level;
+    }
+    if (level != 0.0) {
+      perSampleActive[perSampleActiveCount++] = band;
+    }
+  }
+  memset(perSampleState, 0, sizeof(perSampleState));
+}
+
+/*****
+  Purpose: Transmit equalizer, one sample at a time through each band's whole cascade in turn.
+
+  Parameter list:
+    float32_t *buffer     256 samples, equalized in place
+
+  Return value:
+    void
+*****/
+static void ExciterEQPerSample(float32_t *buffer) {
+  const float32_t *coeffs;
+  float32_t *state;
+  float32_t in, x, y, sum;
+
+  for (int i = 0; i < 256; i++) {
+    in = buffer[i];
+    sum = 0.0;
+    for (int k = 0; k < perSampleActiveCount; k++) {
+      coeffs = perSampleCoeffs[perSampleActive[k]][0];
+      state = perSampleState[perSampleActive[k]][0];
+      x = in;
+      for (int stage = 0; stage < IIR_NUMSTAGES; stage++, coeffs += 5, state += 2) {
+        y = coeffs[0] * x + state[0];
+        state[0] = coeffs[1] * x + coeffs[3] * y + state[1];
+        state[1] = coeffs[2] * x + coeffs[4] * y;
+        x = y;
+      }
+      sum += x;
+    }
+    buffer[i] = sum;
+  }
+}
+
+int main() {
+  const int levels[EQUALIZER_CELL_COUNT] = { 0, 20, 100, 100, 80, 100, 60, 100, 100, 40, 100, 100, 0, 10 };
+  arm_biquad_cascade_df2T_instance_f32 *eqBands[] = { &S1_Xmt, &S2_Xmt, &S3_Xmt, &S4_Xmt, &S5_Xmt, &S6_Xmt, &S7_Xmt,
+                                                      &S8_Xmt, &S9_Xmt, &S10_Xmt, &S11_Xmt, &S12_Xmt, &S13_Xmt, &S14_Xmt };
+  float32_t reference[256], perSample[256];
+  float32_t error, maxError = 0.0, maxPerSampleError = 0.0, maxRef = 0.0;
+  double start, bankTime = 0.0, perSampleTime = 0.0, referenceTime = 0.0;
+  const int blocks = 50;
+
+  HostReceiverStart(192000);
+  for (int band = 0; band < EQUALIZER_CELL_COUNT; band++) {
+    EEPROMData.equalizerXmt[band] = levels[band];
+    memset(eqBands[band]->pState, 0, 2 * IIR_NUMSTAGES * sizeof(float32_t));
+  }
+  XmitEQLoadValues();
+  ExciterEQPerSampleLoad();
+
+  for (int block = 0; block < blocks; block++) {
+    for (int i = 0; i < 256; i++) {
+      float_buffer_L_EX[i] = reference[i] = perSample[i] = 0.1 * HostNoise(&seed);
+    }
+    start = HostMicros();
+    DoExciterEQ();
+    bankTime += HostMicros() - start;
+    start = HostMicros();
+    ExciterEQReference(reference);
+    referenceTime += HostMicros() - start;
+    start = HostMicros();
+    ExciterEQPerSample(perSample);
+    perSampleTime += HostMicros() - start;
+    for (int i = 0; i < 256; i++) {
+      error = fabsf(float_buffer_L_EX[i] - reference[i]);
+      if (error > maxError) maxError = error;
+      maxPerSampleError = fmaxf(maxPerSampleError, fabsf(perSample[i] - reference[i]));
+      maxRef = fmaxf(maxRef, fabsf(reference[i]));
+    }
+  }
+  HostCheck(maxError <= XMIT_EQ_TOLERANCE * maxRef, "Transmit EQ against the separate band filters, relative error %.2g",
+            maxError / maxRef);
+  HostCheck(maxPerSampleError <= XMIT_EQ_TOLERANCE * maxRef, "  band by band single pass, relative error %.2g", maxPerSampleError / maxRef);
+  printf("  bands interleaved %.1f us/block, band by band %.1f us/block, 14 band buffers %.1f us/block\n", bankTime / blocks,
+         perSampleTime / blocks, referenceTime / blocks);
+
+  return hostTestFailures;
+}